@@ -58,14 +58,18 @@ typedef struct {
 /* -----------------------------------------------------------------------
    Limits
    ----------------------------------------------------------------------- */
-#define MAX_BOTS         16    /* maximum concurrent bots                   */
+#ifndef MAX_BOTS
+#define MAX_BOTS         16    /* maximum concurrent bots; -DBOT_MAX_BOTS=n */
+#endif                         /* at configure time for a load-test build   */
 #define BOT_THINK_RATE   0.1f  /* seconds between bot think calls           */
 
 /* -----------------------------------------------------------------------
    Navigation constants
    ----------------------------------------------------------------------- */
 #define BOT_MAX_PATH_NODES  256   /* maximum path length in nodes           */
+#define BOT_FLY_MAX_POINTS  32    /* free-space flight path, world points   */
 #define BOT_INVALID_NODE    -1    /* sentinel for "no node"                 */
+#define BOT_STUCK_WINDOW    8     /* progress samples kept for stuck check  */
 
 /* -----------------------------------------------------------------------
    Memory / awareness constants
@@ -126,14 +130,27 @@ typedef struct {
 typedef struct {
     int      current_node;                    /* nav node at/near current pos  */
     int      goal_node;                       /* final destination nav node    */
-    int      path[BOT_MAX_PATH_NODES];        /* computed path (node indices)  */
-    int      path_length;                     /* valid entries in path[]       */
-    int      path_index;                      /* current position in path[]    */
+    int      path_handle;                     /* shared path (see bot_path.h)  */
+    int      path_index;                      /* cursor into the shared path   */
     vec3_t   goal_origin;                     /* world position of goal        */
     float    arrived_dist;                    /* "arrived" threshold (units)   */
     qboolean path_valid;                      /* is the current path usable?   */
     qboolean wall_walking;                    /* alien: currently wall/ceiling */
     vec3_t   wall_normal;                     /* surface normal when wall-walk */
+
+    /* progress monitor — see BotNav_CheckProgress in bot_nav.c */
+    float    progress_dist[BOT_STUCK_WINDOW]; /* recent distances to next node */
+    int      progress_count;                  /* samples taken this waypoint   */
+    float    progress_next_time;              /* level.time of next sample     */
+    int      stuck_stage;                     /* next rung on recovery ladder  */
+    int      stuck_index;                     /* path_index where stuck began  */
+    vec3_t   escape_velocity;                 /* local escape being applied    */
+    float    escape_until;                    /* level.time escape expires     */
+
+    /* free-space flight — see bot_navfly.h */
+    vec3_t   fly_points[BOT_FLY_MAX_POINTS];  /* octree path, goal last        */
+    int      fly_count;                       /* points in fly_points          */
+    int      fly_index;                       /* next point to steer at        */
 } bot_nav_state_t;
 
 /* -----------------------------------------------------------------------
@@ -249,17 +266,30 @@ typedef struct bot_state_s {
    ----------------------------------------------------------------------- */
 extern bot_state_t g_bots[MAX_BOTS];
 extern int         num_bots;
+extern const int   bot_max_bots;    /* MAX_BOTS, looked up by tools/gamehost */
 
 /* -----------------------------------------------------------------------
    Public bot API (implemented in bot_main.c)
    ----------------------------------------------------------------------- */
 void         Bot_Init(void);
 void         Bot_Shutdown(void);
+void         Bot_MapStart(const char *mapname);
 bot_state_t *Bot_Connect(edict_t *ent, int team, float skill);
+void         Bot_ResetState(bot_state_t *bs, int team, float skill);
+void         Bot_SetClass(bot_state_t *bs, int team, gloom_class_t requested_class);
 void         Bot_Disconnect(edict_t *ent);
 void         Bot_Frame(void);
+void         Bot_ClientThink(edict_t *ent, usercmd_t *cmd);
 void         Bot_Think(bot_state_t *bs);
 
+/* Bot client pool: MAX_BOTS preallocated gclient_t, zeroed on allocation */
+gclient_t   *Bot_AllocClient(void);
+void         Bot_FreeClient(gclient_t *client);
+
+/* Persistent bot state across level changes and saves (bot_snapshot.c) */
+qboolean     Bot_WriteSnapshot(const char *filename);
+qboolean     Bot_ReadSnapshot(const char *filename);
+
 /* Integration helpers (implemented in bot_main.c) */
 void         Bot_UpdateAwareness(bot_state_t *bs);
 void         Bot_EvaluateClassUpgrade(bot_state_t *bs);
@@ -101,7 +101,6 @@ void BotAutofill_Frame(void)
         int team;
         float skill;
         edict_t *ent;
-        int i;
 
         /* Balance teams */
         alien_bots = BotAutofill_CountBotsOnTeam(TEAM_ALIEN);
@@ -129,21 +128,13 @@ void BotAutofill_Frame(void)
             skill = bot_skill ? bot_skill->value : 0.5f;
         }
 
-        /* Find a free edict slot */
-        ent = NULL;
-        for (i = 0; i < globals.max_edicts; i++) {
-            if (!g_edicts[i].inuse) {
-                ent = &g_edicts[i];
-                break;
-            }
-        }
-
+        /* Claim a client slot (top-down, clear of human players) */
+        ent = G_AllocClientSlot();
         if (ent) {
-            G_InitEdict(ent);
-            ent->client = (gclient_t *)gi.TagMalloc(sizeof(gclient_t), TAG_GAME);
-            if (ent->client) {
-                memset(ent->client, 0, sizeof(gclient_t));
-                Bot_Connect(ent, team, skill);
+            ent->client = Bot_AllocClient();
+            if (!ent->client || !Bot_Connect(ent, team, skill)) {
+                Bot_FreeClient(ent->client);
+                G_FreeClientSlot(ent);
             }
         }
 
@@ -15,12 +15,20 @@
  *   sv botstrategy [team]             — show current team strategy
  *   sv botversion                     — print GloomBot version string
  *   sv navgen                         — auto-generate navigation nodes for current map
+ *   sv navstuck [save|clear]          — list, save or reset stuck hotspots per nav edge
+ *   sv navsave [text]                 — write the nav graph, binary or hand-editable text
+ *   sv navlearn [save|clear]          — list, save or reset nav edges learned from humans
+ *   sv navstats [reset]               — path search counts and bidirectional savings
+ *   sv botconfig [reload]             — show or re-read the bot config files
+ *   sv botskill <profile>             — apply skill_<profile>.cfg (easy/medium/hard/nightmare)
  */
 
 #include "bot.h"
 #include "bot_cvars.h"
+#include "bot_config.h"
 #include "bot_debug.h"
 #include "bot_nav.h"
+#include "bot_navlearn.h"
 #include "bot_strategy.h"
 
 /* -----------------------------------------------------------------------
@@ -165,7 +173,6 @@ static void SV_AddBot_f(void)
     int         argc  = gi.argc();
     const char *arg;
     edict_t    *ent;
-    int         i;
 
     if (argc >= 2) {
         arg = gi.argv(1);
@@ -181,30 +188,23 @@ static void SV_AddBot_f(void)
         if (skill > 1.0f) skill = 1.0f;
     }
 
-    /* Find a free edict slot beyond the reserved client slots */
-    ent = NULL;
-    for (i = (maxclients ? (int)maxclients->value + 1 : 1);
-         i < globals.max_edicts; i++) {
-        if (!g_edicts[i].inuse) {
-            ent = &g_edicts[i];
-            break;
-        }
-    }
-
+    ent = G_AllocClientSlot();
     if (!ent) {
-        gi.dprintf("addbot: no free edict slots\n");
+        gi.dprintf("addbot: no free client slots (raise maxclients)\n");
         return;
     }
 
-    G_InitEdict(ent);
-    ent->client = (gclient_t *)gi.TagMalloc(sizeof(gclient_t), TAG_GAME);
+    ent->client = Bot_AllocClient();
     if (!ent->client) {
-        gi.dprintf("addbot: out of memory\n");
+        gi.dprintf("addbot: bot client pool exhausted (%d bots)\n", MAX_BOTS);
+        G_FreeClientSlot(ent);
         return;
     }
-    memset(ent->client, 0, sizeof(gclient_t));
 
-    Bot_Connect(ent, team, skill);
+    if (!Bot_Connect(ent, team, skill)) {
+        Bot_FreeClient(ent->client);
+        G_FreeClientSlot(ent);
+    }
 }
 
 /* -----------------------------------------------------------------------
@@ -282,9 +282,111 @@ static void SV_NavGen_f(void)
     gi.dprintf("navgen: generating navigation nodes for '%s'...\n",
                level.mapname);
     BotNav_LoadMap(level.mapname);
+    BotNav_WaitLoad();
     gi.dprintf("navgen: done.\n");
 }
 
+/* -----------------------------------------------------------------------
+   SV_NavStuck_f  —  "sv navstuck [save|clear]"
+   List nav edges where bots got stuck, save them to maps/<map>.stuck,
+   or reset the tallies.
+   ----------------------------------------------------------------------- */
+static void SV_NavStuck_f(void)
+{
+    const char *arg = (gi.argc() >= 2) ? gi.argv(1) : "";
+
+    if (Q_stricmp(arg, "save") == 0) {
+        BotNav_SaveStuckHotspots(level.mapname);
+    } else if (Q_stricmp(arg, "clear") == 0) {
+        BotNav_ClearStuckHotspots();
+        gi.dprintf("navstuck: hotspots cleared\n");
+    } else {
+        BotNav_PrintStuckHotspots();
+    }
+}
+
+/* -----------------------------------------------------------------------
+   SV_NavSave_f  —  "sv navsave [text]"
+   Write the live graph to maps/<map>.nav, in binary or, for hand
+   editing, in text.  Either form loads.
+   ----------------------------------------------------------------------- */
+static void SV_NavSave_f(void)
+{
+    const char *arg = (gi.argc() >= 2) ? gi.argv(1) : "";
+
+    if (Q_stricmp(arg, "text") == 0)
+        Node_SaveText(level.mapname);
+    else
+        Node_Save(level.mapname);
+}
+
+/* -----------------------------------------------------------------------
+   SV_NavStats_f  —  "sv navstats [reset]"
+   Show how many path searches ran, how many nodes each expanded and
+   what the bidirectional search saved on sampled long queries.
+   ----------------------------------------------------------------------- */
+static void SV_NavStats_f(void)
+{
+    const char *arg = (gi.argc() >= 2) ? gi.argv(1) : "";
+
+    if (Q_stricmp(arg, "reset") == 0) {
+        BotNav_ResetSearchStats();
+        gi.dprintf("navstats: counters reset\n");
+    } else {
+        BotNav_PrintSearchStats();
+    }
+}
+
+/* -----------------------------------------------------------------------
+   SV_NavLearn_f  —  "sv navlearn [save|clear]"
+   Show nav edges learned from human movement, save the grown graph to
+   maps/<map>.nav, or drop pending candidates.
+   ----------------------------------------------------------------------- */
+static void SV_NavLearn_f(void)
+{
+    const char *arg = (gi.argc() >= 2) ? gi.argv(1) : "";
+
+    if (Q_stricmp(arg, "save") == 0) {
+        if (Node_Save(level.mapname))
+            gi.dprintf("navlearn: saved maps/%s.nav (%d edges learned)\n",
+                       level.mapname, BotNavLearn_Merged());
+    } else if (Q_stricmp(arg, "clear") == 0) {
+        BotNavLearn_Clear();
+        gi.dprintf("navlearn: candidates cleared\n");
+    } else {
+        BotNavLearn_Print();
+    }
+}
+
+/* -----------------------------------------------------------------------
+   SV_BotConfig_f  —  "sv botconfig [reload]"
+   Show the loaded config files, or re-read all of them now.
+   ----------------------------------------------------------------------- */
+static void SV_BotConfig_f(void)
+{
+    const char *arg = (gi.argc() >= 2) ? gi.argv(1) : "";
+
+    if (Q_stricmp(arg, "reload") == 0) {
+        BotConfig_Reload();
+        gi.dprintf("botconfig: reloaded\n");
+    }
+    BotConfig_Print();
+}
+
+/* -----------------------------------------------------------------------
+   SV_BotSkill_f  —  "sv botskill <profile>"
+   Apply a parsed skill profile without re-executing its .cfg file.
+   ----------------------------------------------------------------------- */
+static void SV_BotSkill_f(void)
+{
+    if (gi.argc() < 2) {
+        gi.dprintf("usage: sv botskill <easy|medium|hard|nightmare>\n");
+        return;
+    }
+    if (BotConfig_ApplySkill(gi.argv(1)))
+        gi.dprintf("botskill: '%s' applied\n", gi.argv(1));
+}
+
 /* -----------------------------------------------------------------------
    Bot_ServerCommand  —  dispatch "sv <cmd>" to the appropriate handler
    Returns true if the command was handled.
@@ -309,6 +411,30 @@ qboolean Bot_ServerCommand(void)
         SV_NavGen_f();
         return true;
     }
+    if (Q_stricmp(cmd, "navstuck") == 0) {
+        SV_NavStuck_f();
+        return true;
+    }
+    if (Q_stricmp(cmd, "navsave") == 0) {
+        SV_NavSave_f();
+        return true;
+    }
+    if (Q_stricmp(cmd, "navstats") == 0) {
+        SV_NavStats_f();
+        return true;
+    }
+    if (Q_stricmp(cmd, "navlearn") == 0) {
+        SV_NavLearn_f();
+        return true;
+    }
+    if (Q_stricmp(cmd, "botconfig") == 0) {
+        SV_BotConfig_f();
+        return true;
+    }
+    if (Q_stricmp(cmd, "botskill") == 0) {
+        SV_BotSkill_f();
+        return true;
+    }
     if (Q_stricmp(cmd, "botversion") == 0) {
         SV_BotVersion_f();
         return true;
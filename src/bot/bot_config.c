@@ -1,24 +1,29 @@
 /*
  * bot_config.c -- configuration file loading for q2gloombot
  *
- * Loads gloombot.cfg (if present) on initialization and provides
- * bot name roster management for both teams.
+ * Parses gloombot.cfg, bot_config.cfg, the name rosters, the skill
+ * profiles and bot_classes.cfg into typed state (see bot_config.h), and
+ * re-parses whichever of them changed on disk at each map start.
  */
 
-#include "bot.h"
+#include "bot_config.h"
+#include "bot_mapprofile.h"
 #include "bot_cvars.h"
 #include "bot_safety.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
 
 /* -----------------------------------------------------------------------
    Bot name rosters
    ----------------------------------------------------------------------- */
-#define BOT_MAX_NAMES 32
+#define BOT_MAX_NAMES BOT_CONFIG_MAX_NAMES
 
-static char bot_names_alien[BOT_MAX_NAMES][32];
+static char bot_names_alien[BOT_MAX_NAMES][BOT_CONFIG_NAME_LEN];
 static int  bot_names_alien_count = 0;
 static int  bot_names_alien_next  = 0;
 
-static char bot_names_human[BOT_MAX_NAMES][32];
+static char bot_names_human[BOT_MAX_NAMES][BOT_CONFIG_NAME_LEN];
 static int  bot_names_human_count = 0;
 static int  bot_names_human_next  = 0;
 
@@ -48,36 +53,446 @@ static const char *default_human_names[] = {
 };
 
 /* -----------------------------------------------------------------------
-   BotConfig_Init -- load config files at startup
+   Typed configuration state
    ----------------------------------------------------------------------- */
-void BotConfig_Init(void)
+static bot_skill_profile_t s_skill[BOT_SKILL_PROFILE_MAX];
+static bot_class_tuning_t  s_class_tuning[GLOOM_CLASS_MAX];
+
+/* -----------------------------------------------------------------------
+   Config file table
+   ----------------------------------------------------------------------- */
+#define CONFIG_MAX_ARGS  8
+#define CONFIG_LINE_LEN  256
+
+typedef struct config_file_s {
+    const char *name;           /* relative to the gamedir                */
+    int         arg;            /* team or profile index for the handlers */
+    void      (*begin)(struct config_file_s *f);
+    void      (*line)(struct config_file_s *f, int argc, char **argv,
+                      int lineno);
+    void      (*end)(struct config_file_s *f);
+    qboolean    present;
+    long        size;           /* stat() at the last parse               */
+    long        mtime;
+    char        path[MAX_OSPATH];   /* name resolved by BotConfig_GamePath */
+} config_file_t;
+
+static void Config_CvarLine(config_file_t *f, int argc, char **argv, int lineno);
+static void Config_NamesBegin(config_file_t *f);
+static void Config_NameLine(config_file_t *f, int argc, char **argv, int lineno);
+static void Config_NamesEnd(config_file_t *f);
+static void Config_SkillBegin(config_file_t *f);
+static void Config_SkillLine(config_file_t *f, int argc, char **argv, int lineno);
+static void Config_ClassesBegin(config_file_t *f);
+static void Config_ClassLine(config_file_t *f, int argc, char **argv, int lineno);
+
+static config_file_t s_files[] = {
+    { "gloombot.cfg",        0,          NULL,               Config_CvarLine,  NULL },
+    { "bot_config.cfg",      0,          NULL,               Config_CvarLine,  NULL },
+    { "bot_names_alien.txt", TEAM_ALIEN, Config_NamesBegin,  Config_NameLine,  Config_NamesEnd },
+    { "bot_names_human.txt", TEAM_HUMAN, Config_NamesBegin,  Config_NameLine,  Config_NamesEnd },
+    { "skill_easy.cfg",      0,          Config_SkillBegin,  Config_SkillLine, NULL },
+    { "skill_medium.cfg",    1,          Config_SkillBegin,  Config_SkillLine, NULL },
+    { "skill_hard.cfg",      2,          Config_SkillBegin,  Config_SkillLine, NULL },
+    { "skill_nightmare.cfg", 3,          Config_SkillBegin,  Config_SkillLine, NULL },
+    { "bot_classes.cfg",     0,          Config_ClassesBegin, Config_ClassLine, NULL },
+};
+
+#define CONFIG_NUM_FILES  ((int)(sizeof(s_files) / sizeof(s_files[0])))
+
+static const char *s_skill_names[BOT_SKILL_PROFILE_MAX] = {
+    "easy", "medium", "hard", "nightmare"
+};
+
+/* -----------------------------------------------------------------------
+   BotConfig_Tokenize
+   ----------------------------------------------------------------------- */
+int BotConfig_Tokenize(char *line, char **argv, int max_args)
+{
+    int   argc = 0;
+    char *p    = line;
+
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+            p++;
+        if (!*p || *p == '#' || (p[0] == '/' && p[1] == '/'))
+            break;
+        if (argc >= max_args)
+            break;
+
+        if (*p == '"') {
+            argv[argc++] = ++p;
+            while (*p && *p != '"')
+                p++;
+        } else {
+            argv[argc++] = p;
+            while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+                p++;
+        }
+        if (*p)
+            *p++ = '\0';
+    }
+    return argc;
+}
+
+/*
+ * "set name value" or "seta name value".  The bare "name value" form is
+ * only taken when allow_bare is set: in a cvar file it is just as likely
+ * to be a console command ("sv addbot", "map gloom1"), so those lines go
+ * to the console, which only treats them as a cvar if one exists.
+ */
+static qboolean Config_SplitSetting(int argc, char **argv, qboolean allow_bare,
+                                    char **name, char **value)
+{
+    if (argc >= 3 && (Q_stricmp(argv[0], "set") == 0 ||
+                      Q_stricmp(argv[0], "seta") == 0)) {
+        *name  = argv[1];
+        *value = argv[2];
+        return true;
+    }
+    if (allow_bare && argc == 2) {
+        *name  = argv[0];
+        *value = argv[1];
+        return true;
+    }
+    return false;
+}
+
+/* -----------------------------------------------------------------------
+   Line handlers
+   ----------------------------------------------------------------------- */
+static void Config_CvarLine(config_file_t *f, int argc, char **argv, int lineno)
+{
+    char *name, *value;
+
+    if (Config_SplitSetting(argc, argv, false, &name, &value)) {
+        gi.cvar_set(name, value);
+        return;
+    }
+
+    /* Anything else (exec, alias, sv ..., bare cvars) goes to the console */
+    {
+        char cmd[CONFIG_LINE_LEN];
+        int  i, len = 0;
+
+        cmd[0] = '\0';
+        for (i = 0; i < argc && len < (int)sizeof(cmd) - 2; i++) {
+            Com_sprintf(cmd + len, (int)sizeof(cmd) - len, i ? " %s" : "%s",
+                        argv[i]);
+            len = (int)strlen(cmd);
+        }
+        Com_sprintf(cmd + len, (int)sizeof(cmd) - len, "\n");
+        gi.AddCommandString(cmd);
+    }
+    (void)f; (void)lineno;
+}
+
+static void Config_NamesBegin(config_file_t *f)
+{
+    if (f->arg == TEAM_ALIEN)
+        bot_names_alien_count = 0;
+    else
+        bot_names_human_count = 0;
+}
+
+static void Config_NameLine(config_file_t *f, int argc, char **argv, int lineno)
+{
+    char (*names)[BOT_CONFIG_NAME_LEN];
+    int   *count;
+
+    if (f->arg == TEAM_ALIEN) {
+        names = bot_names_alien;
+        count = &bot_names_alien_count;
+    } else {
+        names = bot_names_human;
+        count = &bot_names_human_count;
+    }
+
+    if (argc < 1 || *count >= BOT_MAX_NAMES)
+        return;
+    if (argc > 1)
+        gi.dprintf("BotConfig: %s:%d: names with spaces must be quoted\n",
+                   f->path, lineno);
+    Q_strncpyz(names[(*count)++], argv[0], BOT_CONFIG_NAME_LEN);
+}
+
+/* An empty or missing roster falls back to the compiled-in names */
+static void Config_NamesEnd(config_file_t *f)
 {
     int i;
 
-    gi.dprintf("BotConfig_Init: loading configuration\n");
+    if (f->arg == TEAM_ALIEN) {
+        if (bot_names_alien_count == 0) {
+            for (i = 0; i < BOT_MAX_NAMES; i++)
+                Q_strncpyz(bot_names_alien[i], default_alien_names[i],
+                           sizeof(bot_names_alien[i]));
+            bot_names_alien_count = BOT_MAX_NAMES;
+        }
+        if (bot_names_alien_next >= bot_names_alien_count)
+            bot_names_alien_next = 0;
+    } else {
+        if (bot_names_human_count == 0) {
+            for (i = 0; i < BOT_MAX_NAMES; i++)
+                Q_strncpyz(bot_names_human[i], default_human_names[i],
+                           sizeof(bot_names_human[i]));
+            bot_names_human_count = BOT_MAX_NAMES;
+        }
+        if (bot_names_human_next >= bot_names_human_count)
+            bot_names_human_next = 0;
+    }
+}
 
-    /* Exec the main config file if it exists */
-    gi.AddCommandString("exec gloombot.cfg\n");
+static void Config_SkillBegin(config_file_t *f)
+{
+    bot_skill_profile_t *p = &s_skill[f->arg];
 
-    /* Load default name rosters (file loading is engine-dependent;
-     * for now use the compiled-in defaults) */
-    bot_names_alien_count = BOT_MAX_NAMES;
-    for (i = 0; i < BOT_MAX_NAMES; i++)
-        Q_strncpyz(bot_names_alien[i], default_alien_names[i],
-                    sizeof(bot_names_alien[i]));
+    memset(p, 0, sizeof(*p));
+    Q_strncpyz(p->name, s_skill_names[f->arg], sizeof(p->name));
+}
 
-    bot_names_human_count = BOT_MAX_NAMES;
-    for (i = 0; i < BOT_MAX_NAMES; i++)
-        Q_strncpyz(bot_names_human[i], default_human_names[i],
-                    sizeof(bot_names_human[i]));
+static void Config_SkillLine(config_file_t *f, int argc, char **argv, int lineno)
+{
+    bot_skill_profile_t *p = &s_skill[f->arg];
+    char  *name, *value;
+    float  v;
+
+    /* Skill keys are checked against the list below, so bare is safe */
+    if (!Config_SplitSetting(argc, argv, true, &name, &value)) {
+        gi.dprintf("BotConfig: %s:%d: expected 'set <cvar> <value>'\n",
+                   f->path, lineno);
+        return;
+    }
+
+    v = (float)atof(value);
+    if (Q_stricmp(name, "bot_skill") == 0) {
+        p->skill = v;            p->set |= BOT_SKILL_SET_SKILL;
+    } else if (Q_stricmp(name, "bot_reaction_scale") == 0) {
+        p->reaction_scale = v;   p->set |= BOT_SKILL_SET_REACTION;
+    } else if (Q_stricmp(name, "bot_aim_skill_scale") == 0) {
+        p->aim_skill_scale = v;  p->set |= BOT_SKILL_SET_AIM;
+    } else if (Q_stricmp(name, "bot_awareness_range") == 0) {
+        p->awareness_range = v;  p->set |= BOT_SKILL_SET_AWARENESS;
+    } else if (Q_stricmp(name, "bot_fov") == 0) {
+        p->fov = v;              p->set |= BOT_SKILL_SET_FOV;
+    } else {
+        gi.dprintf("BotConfig: %s:%d: '%s' is not a skill setting\n",
+                   f->path, lineno, name);
+    }
+}
+
+static void Config_ClassesBegin(config_file_t *f)
+{
+    memset(s_class_tuning, 0, sizeof(s_class_tuning));
+    (void)f;
+}
+
+static void Config_ClassLine(config_file_t *f, int argc, char **argv, int lineno)
+{
+    int cls;
+
+    if (argc != 3) {
+        gi.dprintf("BotConfig: %s:%d: expected '<class> <key> <value>'\n",
+                   f->path, lineno);
+        return;
+    }
+
+    for (cls = 0; cls < GLOOM_CLASS_MAX; cls++) {
+        if (Q_stricmp(argv[0], gloom_class_info[cls].name) == 0)
+            break;
+    }
+    if (cls >= GLOOM_CLASS_MAX) {
+        gi.dprintf("BotConfig: %s:%d: unknown class '%s'\n",
+                   f->path, lineno, argv[0]);
+        return;
+    }
+
+    if (Q_stricmp(argv[1], "preferred_range") == 0)
+        s_class_tuning[cls].preferred_range = (float)atof(argv[2]);
+    else
+        gi.dprintf("BotConfig: %s:%d: unknown class key '%s'\n",
+                   f->path, lineno, argv[1]);
+}
+
+/* -----------------------------------------------------------------------
+   Loading
+   ----------------------------------------------------------------------- */
+static void Config_Parse(config_file_t *f)
+{
+    char  line[CONFIG_LINE_LEN];
+    char *argv[CONFIG_MAX_ARGS];
+    FILE *fp;
+    int   lineno = 0;
+
+    if (f->begin)
+        f->begin(f);
+
+    fp = f->present ? fopen(f->path, "r") : NULL;
+    if (fp) {
+        while (fgets(line, sizeof(line), fp)) {
+            int argc;
+
+            lineno++;
+            argc = BotConfig_Tokenize(line, argv, CONFIG_MAX_ARGS);
+            if (argc > 0)
+                f->line(f, argc, argv, lineno);
+        }
+        fclose(fp);
+    }
+
+    if (f->end)
+        f->end(f);
+}
+
+/*
+ * BotConfig_GamePath
+ * The files live in the mod directory, where the engine's exec found
+ * them, not the server's working directory.  Like the engine's
+ * filesystem, look in <basedir>/<game>/ and then <basedir>/baseq2/.
+ */
+void BotConfig_GamePath(char *out, int size, const char *relative)
+{
+    cvar_t     *basedir = gi.cvar("basedir", ".", CVAR_NOSET);
+    cvar_t     *game    = gi.cvar("game", "", CVAR_LATCH | CVAR_SERVERINFO);
+    const char *base    = (basedir && basedir->string[0]) ? basedir->string : ".";
+    struct stat st;
+
+    if (game && game->string[0] && Q_stricmp(game->string, BOT_BASEDIRNAME)) {
+        Com_sprintf(out, size, "%s/%s/%s", base, game->string, relative);
+        if (stat(out, &st) == 0)
+            return;
+        Com_sprintf(out, size, "%s/%s/%s", base, BOT_BASEDIRNAME, relative);
+        if (stat(out, &st) == 0)
+            return;
+        Com_sprintf(out, size, "%s/%s/%s", base, game->string, relative);
+        return;
+    }
+    Com_sprintf(out, size, "%s/%s/%s", base, BOT_BASEDIRNAME, relative);
+}
+
+/* Re-parse f if its stat() changed (or always if force); true if parsed */
+static qboolean Config_Check(config_file_t *f, qboolean force)
+{
+    struct stat st;
+    qboolean    present;
+    long        size, mtime;
+
+    BotConfig_GamePath(f->path, sizeof(f->path), f->name);
+    present = stat(f->path, &st) == 0;
+    size    = present ? (long)st.st_size  : -1;
+    mtime   = present ? (long)st.st_mtime : -1;
+
+    if (!force && present == f->present && size == f->size && mtime == f->mtime)
+        return false;
+
+    f->present = present;
+    f->size    = size;
+    f->mtime   = mtime;
+    Config_Parse(f);
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   BotConfig_Init -- load config files at startup
+   ----------------------------------------------------------------------- */
+void BotConfig_Init(void)
+{
+    gi.dprintf("BotConfig_Init: loading configuration\n");
 
     bot_names_alien_next = 0;
     bot_names_human_next = 0;
+    BotConfig_Reload();
 
     gi.dprintf("BotConfig_Init: %d alien names, %d human names loaded\n",
                bot_names_alien_count, bot_names_human_count);
 }
 
+void BotConfig_Reload(void)
+{
+    int i;
+
+    for (i = 0; i < CONFIG_NUM_FILES; i++)
+        Config_Check(&s_files[i], true);
+}
+
+int BotConfig_Poll(void)
+{
+    int i, changed = 0;
+
+    for (i = 0; i < CONFIG_NUM_FILES; i++) {
+        if (Config_Check(&s_files[i], false)) {
+            gi.dprintf("BotConfig: reloaded '%s'\n", s_files[i].path);
+            changed++;
+        }
+    }
+    return changed;
+}
+
+/* -----------------------------------------------------------------------
+   Accessors
+   ----------------------------------------------------------------------- */
+const bot_skill_profile_t *BotConfig_SkillProfile(const char *name)
+{
+    int i;
+
+    for (i = 0; i < BOT_SKILL_PROFILE_MAX; i++) {
+        if (s_skill[i].set && Q_stricmp(s_skill[i].name, name) == 0)
+            return &s_skill[i];
+    }
+    return NULL;
+}
+
+qboolean BotConfig_ApplySkill(const char *name)
+{
+    const bot_skill_profile_t *p = BotConfig_SkillProfile(name);
+    char buf[32];
+
+    if (!p) {
+        gi.dprintf("BotConfig_ApplySkill: no skill profile '%s'\n", name);
+        return false;
+    }
+
+#define CONFIG_APPLY(bit, cvar, field) \
+    if (p->set & (bit)) { \
+        Com_sprintf(buf, sizeof(buf), "%g", p->field); \
+        gi.cvar_set(cvar, buf); \
+    }
+    CONFIG_APPLY(BOT_SKILL_SET_SKILL,     "bot_skill",           skill)
+    CONFIG_APPLY(BOT_SKILL_SET_REACTION,  "bot_reaction_scale",  reaction_scale)
+    CONFIG_APPLY(BOT_SKILL_SET_AIM,       "bot_aim_skill_scale", aim_skill_scale)
+    CONFIG_APPLY(BOT_SKILL_SET_AWARENESS, "bot_awareness_range", awareness_range)
+    CONFIG_APPLY(BOT_SKILL_SET_FOV,       "bot_fov",             fov)
+#undef CONFIG_APPLY
+
+    return true;
+}
+
+float BotConfig_ClassRange(gloom_class_t cls)
+{
+    if (cls < 0 || cls >= GLOOM_CLASS_MAX)
+        return 0.0f;
+    if (bot_map_profile.class_range[cls] > 0.0f)
+        return bot_map_profile.class_range[cls];
+    if (s_class_tuning[cls].preferred_range > 0.0f)
+        return s_class_tuning[cls].preferred_range;
+    return gloom_class_info[cls].preferred_range;
+}
+
+void BotConfig_Print(void)
+{
+    int i;
+
+    for (i = 0; i < CONFIG_NUM_FILES; i++)
+        gi.dprintf("  %-20s %s\n", s_files[i].name,
+                   s_files[i].present ? "loaded" : "(missing, defaults)");
+    gi.dprintf("  names: %d alien, %d human\n",
+               bot_names_alien_count, bot_names_human_count);
+    for (i = 0; i < BOT_SKILL_PROFILE_MAX; i++) {
+        if (s_skill[i].set)
+            gi.dprintf("  skill %-10s bot_skill %.2f\n",
+                       s_skill[i].name, s_skill[i].skill);
+    }
+}
+
 /* -----------------------------------------------------------------------
    BotConfig_NextName -- get the next name for a team
    Returns a pointer to a static name buffer; caller should copy.
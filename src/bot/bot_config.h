@@ -0,0 +1,86 @@
+/*
+ * bot_config.h -- parsed bot configuration files
+ *
+ * The config files are read by a native parser into typed structs
+ * instead of being pushed through the console one command at a time:
+ *
+ *   gloombot.cfg, bot_config.cfg    cvar settings ("set name value",
+ *                                   "seta name value" or "name value")
+ *   bot_names_alien.txt,            name rosters, one name per line
+ *   bot_names_human.txt
+ *   skill_<profile>.cfg             skill profiles (easy, medium, hard,
+ *                                   nightmare); applied by "sv botskill"
+ *   bot_classes.cfg                 per-class tuning, "<class> <key> <value>"
+ *
+ * All of them are looked up in the mod directory (BotConfig_GamePath).
+ * Blank lines and "#" / "//" comments are ignored.  Each file's size and
+ * mtime are remembered; BotConfig_Poll re-parses only files that changed
+ * and is called at every map start, so edits take effect on the next
+ * round without a server restart.  A missing file keeps the built-in
+ * defaults.
+ */
+
+#ifndef BOT_CONFIG_H
+#define BOT_CONFIG_H
+
+#include "bot.h"
+
+#define BOT_CONFIG_MAX_NAMES    32
+#define BOT_CONFIG_NAME_LEN     32
+#define BOT_SKILL_PROFILE_MAX   4
+#define BOT_BASEDIRNAME         "baseq2"   /* engine fallback game dir   */
+
+/* Fields a skill profile sets (bot_skill_profile_t::set) */
+#define BOT_SKILL_SET_SKILL     0x01
+#define BOT_SKILL_SET_REACTION  0x02
+#define BOT_SKILL_SET_AIM       0x04
+#define BOT_SKILL_SET_AWARENESS 0x08
+#define BOT_SKILL_SET_FOV       0x10
+
+typedef struct {
+    char         name[16];          /* "easy", "medium", ...               */
+    unsigned int set;               /* BOT_SKILL_SET_* present in the file */
+    float        skill;             /* bot_skill                           */
+    float        reaction_scale;    /* bot_reaction_scale                  */
+    float        aim_skill_scale;   /* bot_aim_skill_scale                 */
+    float        awareness_range;   /* bot_awareness_range                 */
+    float        fov;               /* bot_fov                             */
+} bot_skill_profile_t;
+
+typedef struct {
+    float preferred_range;          /* 0 = gloom_class_info default        */
+} bot_class_tuning_t;
+
+/*
+ * Path of a file relative to the mod directory: <basedir>/<game>/relative
+ * if it exists there, else <basedir>/baseq2/relative if that exists, else
+ * the first.  Same search as the engine filesystem.
+ */
+void BotConfig_GamePath(char *out, int size, const char *relative);
+
+/* Re-parse any config file whose size or mtime changed; returns how many. */
+int  BotConfig_Poll(void);
+
+/* Re-parse every config file unconditionally. */
+void BotConfig_Reload(void);
+
+/* Skill profile by name, or NULL if no such file was loaded. */
+const bot_skill_profile_t *BotConfig_SkillProfile(const char *name);
+
+/* Set the cvars of a loaded skill profile; false if unknown. */
+qboolean BotConfig_ApplySkill(const char *name);
+
+/* Preferred engagement range: map profile, then bot_classes.cfg, then built-in. */
+float BotConfig_ClassRange(gloom_class_t cls);
+
+/* Print loaded files, roster sizes and profiles to the console. */
+void BotConfig_Print(void);
+
+/*
+ * Split a line in place into at most max_args whitespace-separated
+ * tokens.  Double quotes group a token; '#' or '//' outside quotes ends
+ * the line.  Returns the token count.
+ */
+int  BotConfig_Tokenize(char *line, char **argv, int max_args);
+
+#endif /* BOT_CONFIG_H */
@@ -43,6 +43,8 @@ cvar_t *bot_taunt           = NULL;
 cvar_t *bot_nav_autogen = NULL;
 cvar_t *bot_nav_show    = NULL;
 cvar_t *bot_nav_density = NULL;
+cvar_t *bot_nav_shared  = NULL;
+cvar_t *bot_nav_learn   = NULL;
 
 /* Debug */
 cvar_t *bot_debug_cvar   = NULL;
@@ -86,11 +88,13 @@ void BotCvars_Init(void)
     bot_nav_autogen = gi.cvar("bot_nav_autogen", "1",   CVAR_ARCHIVE);
     bot_nav_show    = gi.cvar("bot_nav_show",    "0",   0);
     bot_nav_density = gi.cvar("bot_nav_density", "128", CVAR_ARCHIVE);
+    bot_nav_shared  = gi.cvar("bot_nav_shared",  "1",   CVAR_ARCHIVE);
+    bot_nav_learn   = gi.cvar("bot_nav_learn",   "0",   CVAR_ARCHIVE);
 
     /* Debug */
     bot_debug_cvar   = gi.cvar("bot_debug",        "0", 0);
     bot_debug_target = gi.cvar("bot_debug_target", "",  0);
     bot_perf         = gi.cvar("bot_perf",         "0", 0);
 
-    gi.dprintf("BotCvars_Init: %d cvars registered\n", 27);
+    gi.dprintf("BotCvars_Init: %d cvars registered\n", 30);
 }
@@ -46,6 +46,8 @@ extern cvar_t *bot_taunt;
 extern cvar_t *bot_nav_autogen;
 extern cvar_t *bot_nav_show;
 extern cvar_t *bot_nav_density;
+extern cvar_t *bot_nav_shared;
+extern cvar_t *bot_nav_learn;
 
 /* Debug */
 extern cvar_t *bot_debug_cvar;
@@ -3,6 +3,7 @@
  */
 
 #include "bot_debug.h"
+#include "bot_nodes.h"
 #include "bot_strategy.h"
 
 /* -----------------------------------------------------------------------
@@ -117,7 +118,8 @@ void BotDebug_PrintBotStatus(bot_state_t *bs)
     gi.dprintf("  Frags:     %d  Upgrades: %d\n",
                bs->frag_count, bs->class_upgrades);
     gi.dprintf("  Nav:       node=%d goal=%d path_valid=%d wall_walk=%d\n",
-               bs->nav.current_node, bs->nav.goal_node,
+               Node_ExternalId(bs->nav.current_node),
+               Node_ExternalId(bs->nav.goal_node),
                (int)bs->nav.path_valid, (int)bs->nav.wall_walking);
     gi.dprintf("  Combat:    target=%s visible=%d range=%.0f\n",
                bs->combat.target ? "YES" : "no",
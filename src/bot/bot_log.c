@@ -0,0 +1,236 @@
+/*
+ * bot_log.c -- rate-limited console logging for hot-path diagnostics
+ *
+ * See bot_log.h.  One mutex guards the sites and the queue so worker
+ * threads can log; gi.dprintf itself is only called from BotLog_Flush
+ * and BotLog_Shutdown, outside the lock.
+ */
+
+#include "bot_log.h"
+#include "bot_safety.h"
+#include "bot_thread.h"
+#include <stdio.h>
+#include <string.h>
+
+static bot_mutex_t     s_lock;
+static qboolean        s_lock_ready;
+static qboolean        s_active;
+
+static char            s_queue[BOT_LOG_QUEUE][BOT_LOG_LINE];
+static int             s_head, s_count;
+static int             s_overflow;     /* lines lost to a full queue */
+static int             s_suppressed;
+static bot_log_site_t *s_sites;
+
+/* -----------------------------------------------------------------------
+   Helpers (called with s_lock held)
+   ----------------------------------------------------------------------- */
+static void Log_Enqueue(const char *text, bot_log_level_t severity)
+{
+    int limit = (severity == BOT_LOG_INFO) ? BOT_LOG_INFO_QUEUE : BOT_LOG_QUEUE;
+
+    if (s_count >= limit) {
+        s_overflow++;
+        return;
+    }
+    Q_strncpyz(s_queue[(s_head + s_count) % BOT_LOG_QUEUE], text, BOT_LOG_LINE);
+    s_count++;
+}
+
+/*
+ * Queue "<last> (repeated N times)" and the dropped count, then reset.
+ * The message is cut short to leave room for the count.
+ */
+static void Log_Summarize(bot_log_site_t *site)
+{
+    char msg[BOT_LOG_LINE];
+    int  len = (int)strlen(site->last);
+
+    while (len > 0 && site->last[len - 1] == '\n')
+        len--;
+    if (len > BOT_LOG_LINE - 64)
+        len = BOT_LOG_LINE - 64;
+
+    if (site->repeats) {
+        Com_sprintf(msg, sizeof(msg), "%.*s (repeated %d times)\n",
+                    len, site->last, site->repeats);
+        Log_Enqueue(msg, site->severity);
+    }
+    if (site->dropped) {
+        Com_sprintf(msg, sizeof(msg), "%.*s (%d similar messages suppressed)\n",
+                    len, site->last, site->dropped);
+        Log_Enqueue(msg, site->severity);
+    }
+    site->repeats = 0;
+    site->dropped = 0;
+}
+
+static void Log_ResetSite(bot_log_site_t *site)
+{
+    site->tokens      = BOT_LOG_BURST;
+    site->refill_time = level.time;
+    site->repeats     = 0;
+    site->dropped     = 0;
+    site->last[0]     = '\0';
+}
+
+/* Take one queued line; false when the queue is empty. */
+static qboolean Log_Dequeue(char *out)
+{
+    qboolean ok = false;
+
+    BotMutex_Lock(&s_lock);
+    if (s_count > 0) {
+        Q_strncpyz(out, s_queue[s_head], BOT_LOG_LINE);
+        s_head = (s_head + 1) % BOT_LOG_QUEUE;
+        s_count--;
+        ok = true;
+    } else if (s_overflow) {
+        Com_sprintf(out, BOT_LOG_LINE, "BotLog: %d lines dropped, queue full\n",
+                    s_overflow);
+        s_overflow = 0;
+        ok = true;
+    }
+    BotMutex_Unlock(&s_lock);
+    return ok;
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+void BotLog_Init(void)
+{
+    bot_log_site_t *site;
+
+    if (!s_lock_ready) {
+        BotMutex_Init(&s_lock);
+        s_lock_ready = true;
+    }
+
+    BotMutex_Lock(&s_lock);
+    s_head = s_count = 0;
+    s_overflow   = 0;
+    s_suppressed = 0;
+    for (site = s_sites; site; site = site->next)
+        Log_ResetSite(site);
+    s_active = true;
+    BotMutex_Unlock(&s_lock);
+}
+
+void BotLog_Site(bot_log_site_t *site, bot_log_level_t severity,
+                 const char *fmt, ...)
+{
+    va_list ap;
+    char    msg[BOT_LOG_LINE];
+    float   elapsed;
+
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    /* Before Bot_Init there is no frame to flush from */
+    if (!s_active) {
+        gi.dprintf("%s", msg);
+        return;
+    }
+
+    BotMutex_Lock(&s_lock);
+
+    if (!site->registered) {
+        Log_ResetSite(site);
+        site->registered = true;
+        site->severity   = severity;
+        site->next = s_sites;
+        s_sites    = site;
+    }
+
+    /* Refill; a level change winds level.time back, so start full */
+    elapsed = level.time - site->refill_time;
+    if (elapsed < 0.0f) {
+        site->tokens = BOT_LOG_BURST;
+    } else {
+        site->tokens += elapsed * BOT_LOG_RATE;
+        if (site->tokens > BOT_LOG_BURST)
+            site->tokens = BOT_LOG_BURST;
+    }
+    site->refill_time = level.time;
+
+    if (strcmp(msg, site->last) == 0) {
+        if (!site->repeats && !site->dropped)
+            site->fold_time = level.time;
+        site->repeats++;
+        s_suppressed++;
+    } else if (site->tokens < 1.0f) {
+        if (!site->repeats && !site->dropped)
+            site->fold_time = level.time;
+        site->dropped++;
+        s_suppressed++;
+    } else {
+        if (site->repeats || site->dropped)
+            Log_Summarize(site);
+        site->tokens -= 1.0f;
+        memcpy(site->last, msg, strlen(msg) + 1);   /* same size as msg */
+        Log_Enqueue(msg, severity);
+    }
+
+    BotMutex_Unlock(&s_lock);
+}
+
+void BotLog_Flush(void)
+{
+    bot_log_site_t *site;
+    char            line[BOT_LOG_LINE];
+    int             i;
+
+    if (!s_active)
+        return;
+
+    BotMutex_Lock(&s_lock);
+    for (site = s_sites; site; site = site->next) {
+        if ((site->repeats || site->dropped) &&
+            (level.time - site->fold_time >= BOT_LOG_FOLD_TIME ||
+             level.time < site->fold_time))
+            Log_Summarize(site);
+    }
+    BotMutex_Unlock(&s_lock);
+
+    for (i = 0; i < BOT_LOG_FLUSH_LINES && Log_Dequeue(line); i++)
+        gi.dprintf("%s", line);
+}
+
+void BotLog_Shutdown(void)
+{
+    bot_log_site_t *site;
+    char            line[BOT_LOG_LINE];
+
+    if (!s_active)
+        return;
+
+    BotMutex_Lock(&s_lock);
+    for (site = s_sites; site; site = site->next) {
+        if (site->repeats || site->dropped)
+            Log_Summarize(site);
+    }
+    BotMutex_Unlock(&s_lock);
+
+    while (Log_Dequeue(line))
+        gi.dprintf("%s", line);
+    s_active = false;
+}
+
+int BotLog_Queued(void)
+{
+    int n;
+
+    if (!s_lock_ready)
+        return 0;
+    BotMutex_Lock(&s_lock);
+    n = s_count;
+    BotMutex_Unlock(&s_lock);
+    return n;
+}
+
+int BotLog_Suppressed(void)
+{
+    return s_suppressed;
+}
@@ -0,0 +1,87 @@
+/*
+ * bot_log.h -- rate-limited console logging for hot-path diagnostics
+ *
+ * Failures on hot paths ("neighbor list full", "path pool full", autofill
+ * connect churn) can fire every frame on a broken map.  Printing each one
+ * floods the console and stalls the server thread on console I/O, so
+ * those sites log through BotLog_Warn, or BotLog_Info for routine
+ * notices, instead of gi.dprintf:
+ *
+ *   - every call site gets its own token bucket (BOT_LOG_BURST messages,
+ *     refilled at BOT_LOG_RATE per second); over-budget messages are
+ *     counted, not printed
+ *   - a message identical to the site's previous one is folded and
+ *     reported once as "... (repeated N times)"
+ *   - accepted lines go into a queue that BotLog_Flush drains on the
+ *     server thread, at most BOT_LOG_FLUSH_LINES per frame
+ *   - info lines may fill only BOT_LOG_INFO_QUEUE of the queue, so a
+ *     burst of connects cannot crowd out warnings
+ *
+ * BotLog_Warn and BotLog_Info may be called from worker threads; only
+ * BotLog_Flush and BotLog_Shutdown touch gi.dprintf.
+ */
+
+#ifndef BOT_LOG_H
+#define BOT_LOG_H
+
+#include "bot.h"
+
+#define BOT_LOG_LINE         256     /* longest queued line                  */
+#define BOT_LOG_QUEUE        128     /* queued lines before new ones drop    */
+#define BOT_LOG_INFO_QUEUE   64      /* queued lines before info lines drop  */
+#define BOT_LOG_FLUSH_LINES  16      /* lines printed per server frame       */
+#define BOT_LOG_BURST        5.0f    /* messages a site may print at once    */
+#define BOT_LOG_RATE         1.0f    /* bucket refill, messages per second   */
+#define BOT_LOG_FOLD_TIME    5.0f    /* report folded repeats after (s)      */
+
+typedef enum {
+    BOT_LOG_INFO,                              /* routine notices            */
+    BOT_LOG_WARN                               /* failures                   */
+} bot_log_level_t;
+
+/* Per call site state; declared static by BotLog_Warn and BotLog_Info. */
+typedef struct bot_log_site_s {
+    qboolean               registered;
+    bot_log_level_t        severity;
+    float                  tokens;
+    float                  refill_time;        /* level.time of last refill  */
+    float                  fold_time;          /* first uncounted suppression */
+    int                    repeats;            /* identical, folded          */
+    int                    dropped;            /* different, over budget     */
+    char                   last[BOT_LOG_LINE]; /* last message printed       */
+    struct bot_log_site_s *next;
+} bot_log_site_t;
+
+/* Log through a token bucket private to this call site. */
+#define BotLog_Warn(...)                                        \
+    do {                                                        \
+        static bot_log_site_t bot_log_site_;                    \
+        BotLog_Site(&bot_log_site_, BOT_LOG_WARN, __VA_ARGS__); \
+    } while (0)
+
+#define BotLog_Info(...)                                        \
+    do {                                                        \
+        static bot_log_site_t bot_log_site_;                    \
+        BotLog_Site(&bot_log_site_, BOT_LOG_INFO, __VA_ARGS__); \
+    } while (0)
+
+/* Reset the queue, counters and every site seen so far. */
+void BotLog_Init(void);
+
+/* Format and queue a message for site, subject to its bucket. */
+void BotLog_Site(bot_log_site_t *site, bot_log_level_t severity,
+                 const char *fmt, ...);
+
+/* Queue due repeat summaries and print up to BOT_LOG_FLUSH_LINES lines. */
+void BotLog_Flush(void);
+
+/* Print everything still queued, including pending summaries. */
+void BotLog_Shutdown(void);
+
+/* Lines waiting in the queue. */
+int  BotLog_Queued(void);
+
+/* Messages folded or dropped since BotLog_Init. */
+int  BotLog_Suppressed(void);
+
+#endif /* BOT_LOG_H */
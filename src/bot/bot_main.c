@@ -37,8 +37,15 @@
 #include "bot.h"
 #include "bot_safety.h"
 #include "bot_cvars.h"
+#include "bot_config.h"
+#include "bot_mapprofile.h"
 #include "bot_debug.h"
+#include "bot_log.h"
 #include "bot_nav.h"
+#include "bot_navcache.h"
+#include "bot_navlearn.h"
+#include "bot_navnear.h"
+#include "bot_snapshot.h"
 #include "bot_combat.h"
 #include "bot_team.h"
 #include "bot_strategy.h"
@@ -52,6 +59,16 @@
    ----------------------------------------------------------------------- */
 bot_state_t g_bots[MAX_BOTS];
 int         num_bots = 0;
+const int   bot_max_bots = MAX_BOTS;
+
+/*
+ * Bot client pool.  Bots never outnumber MAX_BOTS, so their gclient_t
+ * structs are preallocated here and handed out from a free-list rather
+ * than going through TagMalloc/TagFree on every connect/disconnect.
+ */
+static gclient_t s_bot_clients[MAX_BOTS];
+static int       s_free_clients[MAX_BOTS];
+static int       s_free_client_count = 0;
 
 /* Forward declarations — state handlers */
 static void Bot_StateIdle(bot_state_t *bs);
@@ -67,8 +84,6 @@ static void Bot_StateUpgrade(bot_state_t *bs);
 
 /* Forward declarations — helpers */
 static void           Bot_SetState(bot_state_t *bs, bot_ai_state_t new_state);
-static void           Bot_SetClass(bot_state_t *bs, int team,
-                                    gloom_class_t requested_class);
 static void           Bot_UpdateBuildPriority(bot_state_t *bs);
 static build_priority_t Bot_AssessBuildNeeds(bot_state_t *bs);
 
@@ -89,7 +104,13 @@ void Bot_Init(void)
         g_bots[i].bot_index = i;
     }
 
+    /* Fill the client free-list so slot 0 is handed out first */
+    for (i = 0; i < MAX_BOTS; i++)
+        s_free_clients[i] = MAX_BOTS - 1 - i;
+    s_free_client_count = MAX_BOTS;
+
     /* Initialise subsystems */
+    BotLog_Init();
     BotCvars_Init();
     BotConfig_Init();
     BotAutofill_Init();
@@ -117,37 +138,95 @@ void Bot_Shutdown(void)
             Bot_Disconnect(g_bots[i].ent);
     }
     num_bots = 0;
+
+    /* Worker threads must be gone before the DLL is unloaded */
+    Node_Shutdown();
+    BotNavCache_Shutdown();
+    BotLog_Shutdown();
 }
 
 /* -----------------------------------------------------------------------
-   Bot_Connect
+   Bot_MapStart
+   Called from SpawnEntities, after the level has been reset.  Bots keep
+   their slots across the change; their persistent state goes through an
+   in-memory snapshot while everything keyed to the old level (timers,
+   targets, paths, structure memory) starts fresh.  The nav load runs in
+   the background so map change time does not depend on nav data size.
    ----------------------------------------------------------------------- */
-bot_state_t *Bot_Connect(edict_t *ent, int team, float skill)
+void Bot_MapStart(const char *mapname)
 {
-    int          i;
-    bot_state_t *bs = NULL;
-    gloom_class_t cls;
+    static bot_snapshot_t snap;
 
-    if (!ent || !ent->client) {
-        gi.dprintf("Bot_Connect: NULL entity/client\n");
-        return NULL;
-    }
+    BotConfig_Poll();
+    BotMapProfile_Load(mapname);
+    BotSnapshot_Capture(&snap);
 
-    if (num_bots >= MAX_BOTS) {
-        gi.dprintf("Bot_Connect: max bots (%d) reached\n", MAX_BOTS);
-        return NULL;
-    }
+    BotAutofill_Init();
+    BotBuild_Init();
+    BotUpgrade_Init();
+    BotSnapshot_Apply(&snap);
 
-    for (i = 0; i < MAX_BOTS; i++) {
-        if (!g_bots[i].in_use) { bs = &g_bots[i]; break; }
+    /*
+     * Restarting the same map with an unchanged .nav file: keep the graph,
+     * its derived data and the stuck tallies warm; only the zone
+     * ownership is level state.
+     */
+    if (Node_FileUnchanged(mapname)) {
+        BotMapControl_Init();
+        gi.dprintf("Bot_MapStart: '%s' unchanged, keeping nav graph\n", mapname);
+        return;
     }
-    if (!bs) {
-        gi.dprintf("Bot_Connect: no free slots\n");
+    BotNav_LoadMap(mapname);
+}
+
+/* -----------------------------------------------------------------------
+   Bot_AllocClient
+   Take a zeroed gclient_t from the bot client pool, or NULL if empty.
+   ----------------------------------------------------------------------- */
+gclient_t *Bot_AllocClient(void)
+{
+    gclient_t *client;
+
+    if (s_free_client_count <= 0)
         return NULL;
-    }
+
+    client = &s_bot_clients[s_free_clients[--s_free_client_count]];
+    memset(client, 0, sizeof(*client));
+    return client;
+}
+
+/* -----------------------------------------------------------------------
+   Bot_FreeClient
+   Return a pool client to the free-list.  Clients that did not come
+   from the pool are ignored.
+   ----------------------------------------------------------------------- */
+void Bot_FreeClient(gclient_t *client)
+{
+    int index;
+
+    if (client < s_bot_clients || client >= s_bot_clients + MAX_BOTS)
+        return;
+
+    index = (int)(client - s_bot_clients);
+    if (s_free_client_count < MAX_BOTS)
+        s_free_clients[s_free_client_count++] = index;
+}
+
+/* -----------------------------------------------------------------------
+   Bot_ResetState
+   (Re)initialise everything about an occupied bot slot except its edict
+   and index: class, resources, AI, personality.  Team must be valid.
+   ----------------------------------------------------------------------- */
+void Bot_ResetState(bot_state_t *bs, int team, float skill)
+{
+    edict_t      *ent   = bs->ent;
+    int           index = bs->bot_index;
+    gloom_class_t cls;
+
+    BotNav_ClearPath(bs);
 
     memset(bs, 0, sizeof(*bs));
-    bs->bot_index = i;
+    bs->bot_index = index;
     bs->in_use    = true;
     bs->ent       = ent;
 
@@ -155,11 +234,7 @@ bot_state_t *Bot_Connect(edict_t *ent, int team, float skill)
     if (skill < 0.0f) skill = 0.0f;
     if (skill > 1.0f) skill = 1.0f;
     bs->skill = skill;
-
-    /* Team */
-    if (team != TEAM_HUMAN && team != TEAM_ALIEN)
-        team = (num_bots % 2 == 0) ? TEAM_HUMAN : TEAM_ALIEN;
-    bs->team = team;
+    bs->team  = team;
 
     /* Default class: Alien bots start as Dretch (basic tier-1);
      * Human bots start as Marine_Light and accumulate credits. */
@@ -167,10 +242,10 @@ bot_state_t *Bot_Connect(edict_t *ent, int team, float skill)
     Bot_SetClass(bs, team, cls);
 
     Com_sprintf(bs->name, sizeof(bs->name), "Bot_%s_%02d",
-                Gloom_ClassName(bs->gloom_class), i);
+                Gloom_ClassName(bs->gloom_class), index);
 
     /* Timing */
-    bs->think_interval  = BOT_THINK_RATE;
+    bs->think_interval  = bot_map_profile.think_rate;
     bs->reaction_time   = 0.5f - (skill * 0.4f); /* 0.5s (novice) → 0.1s (expert) */
     bs->next_think_time = 0.0f;
 
@@ -189,7 +264,7 @@ bot_state_t *Bot_Connect(edict_t *ent, int team, float skill)
     bs->combat.target         = NULL;
     bs->combat.target_visible = false;
     bs->combat.engagement_range =
-        gloom_class_info[bs->gloom_class].preferred_range;
+        BotConfig_ClassRange(bs->gloom_class);
 
     /*
      * Asymmetric combat defaults:
@@ -227,10 +302,47 @@ bot_state_t *Bot_Connect(edict_t *ent, int team, float skill)
     Bot_Humanize_Init(bs);
 
     bs->initialized = true;
+}
+
+/* -----------------------------------------------------------------------
+   Bot_Connect
+   ----------------------------------------------------------------------- */
+bot_state_t *Bot_Connect(edict_t *ent, int team, float skill)
+{
+    int          i;
+    bot_state_t *bs = NULL;
+
+    if (!ent || !ent->client) {
+        BotLog_Warn("Bot_Connect: NULL entity/client\n");
+        return NULL;
+    }
+
+    if (num_bots >= MAX_BOTS) {
+        BotLog_Warn("Bot_Connect: max bots (%d) reached\n", MAX_BOTS);
+        return NULL;
+    }
+
+    for (i = 0; i < MAX_BOTS; i++) {
+        if (!g_bots[i].in_use) { bs = &g_bots[i]; break; }
+    }
+    if (!bs) {
+        BotLog_Warn("Bot_Connect: no free slots\n");
+        return NULL;
+    }
+
+    memset(bs, 0, sizeof(*bs));
+    bs->bot_index = i;
+    bs->ent       = ent;
+
+    /* Team */
+    if (team != TEAM_HUMAN && team != TEAM_ALIEN)
+        team = (num_bots % 2 == 0) ? TEAM_HUMAN : TEAM_ALIEN;
+
+    Bot_ResetState(bs, team, skill);
     num_bots++;
 
-    gi.dprintf("Bot_Connect: '%s' (team=%d skill=%.2f class=%s)\n",
-               bs->name, team, skill, Gloom_ClassName(bs->gloom_class));
+    BotLog_Info("Bot_Connect: '%s' (team=%d skill=%.2f class=%s)\n",
+                bs->name, team, bs->skill, Gloom_ClassName(bs->gloom_class));
     return bs;
 }
 
@@ -245,21 +357,36 @@ void Bot_Disconnect(edict_t *ent)
     bs = Bot_GetState(ent);
     if (!bs) return;
 
-    gi.dprintf("Bot_Disconnect: removing '%s'\n", bs->name);
+    BotLog_Info("Bot_Disconnect: removing '%s'\n", bs->name);
+
+    BotNav_ClearPath(bs);
 
     if (ent->client) {
         ent->client->is_bot    = false;
         ent->client->bot_state = NULL;
-        gi.TagFree(ent->client);
+        Bot_FreeClient(ent->client);
         ent->client = NULL;
     }
 
+    /* Hand the client slot back for the next bot or human */
+    G_FreeClientSlot(ent);
+
     memset(bs, 0, sizeof(*bs));
     bs->in_use = false;
 
     if (num_bots > 0) num_bots--;
 }
 
+/* -----------------------------------------------------------------------
+   Bot_ClientThink
+   Called from ClientThink for every client usercmd.  Human movement feeds
+   the nav learner; bots are driven by Bot_Frame instead.
+   ----------------------------------------------------------------------- */
+void Bot_ClientThink(edict_t *ent, usercmd_t *cmd)
+{
+    BotNavLearn_Sample(ent, cmd);
+}
+
 /* -----------------------------------------------------------------------
    Bot_Frame
    Called every server frame from G_RunFrame() in g_main.c.
@@ -268,6 +395,12 @@ void Bot_Frame(void)
 {
     int i;
 
+    /* Publish a finished background nav load even while bots are off */
+    BotNav_Frame();
+
+    /* Print queued warnings, a few lines per frame */
+    BotLog_Flush();
+
     /* If bots are disabled via cvar, skip all processing */
     if (bot_enable && (int)bot_enable->value == 0)
         return;
@@ -289,6 +422,7 @@ void Bot_Frame(void)
     /* 3. Per-frame build structure tracking */
     BotBuild_UpdateStructures(TEAM_HUMAN);
     BotBuild_UpdateStructures(TEAM_ALIEN);
+    BotNavNear_Frame();
 
     /* 4. Individual bot think */
     for (i = 0; i < MAX_BOTS; i++) {
@@ -585,6 +719,25 @@ static void Bot_UpdateBuildPriority(bot_state_t *bs)
      * has already set bs->build.priority and bs->build.what_to_build */
 }
 
+/*
+ * Bot_HeadForStruct
+ * Path toward the friendly structure of the given type that is nearest
+ * by travel distance, unless already headed there.  Returns false if
+ * none is reachable from the bot's node.
+ */
+static qboolean Bot_HeadForStruct(bot_state_t *bs, gloom_struct_type_t type)
+{
+    edict_t *target = BotNavNear_Find(bs->nav.current_node, type, NULL, NULL);
+
+    if (!target)
+        return false;
+    if (bs->nav.goal_origin[0] != target->s.origin[0] ||
+        bs->nav.goal_origin[1] != target->s.origin[1] ||
+        bs->nav.goal_origin[2] != target->s.origin[2])
+        BotNav_FindPath(bs, target->s.origin);
+    return true;
+}
+
 /* =======================================================================
    AI state handlers
    ======================================================================= */
@@ -702,11 +855,17 @@ static void Bot_StateCombat(bot_state_t *bs)
 static void Bot_StateFlee(bot_state_t *bs)
 {
     /* Recovered enough health to fight again */
-    if (bs->ent->health >= (int)(bs->ent->max_health * 0.5f))
+    if (bs->ent->health >= (int)(bs->ent->max_health * 0.5f)) {
         Bot_SetState(bs, BOTSTATE_IDLE);
+        return;
+    }
 
-    /* Human bots flee toward the Reactor / Medistation.
-     * Alien bots flee to any nearby Egg to re-spawn/heal. */
+    /* Human bots flee toward the Reactor.
+     * Alien bots flee to a Cocoon to heal, or else the nearest Egg. */
+    if (bs->team == TEAM_HUMAN)
+        Bot_HeadForStruct(bs, STRUCT_REACTOR);
+    else if (!Bot_HeadForStruct(bs, STRUCT_COCOON))
+        Bot_HeadForStruct(bs, STRUCT_EGG);
 }
 
 static void Bot_StateDefend(bot_state_t *bs)
@@ -781,8 +940,8 @@ static void Bot_StateEvolve(bot_state_t *bs)
         return;
     }
 
-    /* Actual evolution (navigation to Overmind, stat change) in bot_nav.c
-     * and resolved when the bot edict reaches the Overmind entity. */
+    /* Stat change is resolved when the bot edict reaches the Overmind */
+    Bot_HeadForStruct(bs, STRUCT_OVERMIND);
 }
 
 /*
@@ -810,7 +969,7 @@ static void Bot_StateUpgrade(bot_state_t *bs)
    Bot class selection
    ======================================================================= */
 
-static void Bot_SetClass(bot_state_t *bs, int team, gloom_class_t requested_class)
+void Bot_SetClass(bot_state_t *bs, int team, gloom_class_t requested_class)
 {
     if (requested_class < GLOOM_CLASS_MAX &&
         Gloom_ClassTeam(requested_class) == team) {
@@ -821,5 +980,5 @@ static void Bot_SetClass(bot_state_t *bs, int team, gloom_class_t requested_clas
             : GLOOM_CLASS_DRETCH;
     }
     bs->combat.engagement_range =
-        gloom_class_info[bs->gloom_class].preferred_range;
+        BotConfig_ClassRange(bs->gloom_class);
 }
@@ -0,0 +1,264 @@
+/*
+ * bot_mapprofile.c -- per-map AI tuning compiled into flat tables
+ *
+ * See bot_mapprofile.h.  Parsing goes into a staging copy seeded from the
+ * defaults; the live profile is only replaced once the whole file has
+ * been read, so bots never see a half-compiled profile.
+ */
+
+#include "bot_mapprofile.h"
+#include "bot_config.h"
+#include "bot_build.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+
+/* -----------------------------------------------------------------------
+   Defaults (the former per-module constants)
+   ----------------------------------------------------------------------- */
+#define MAP_PROFILE_DEFAULTS {                                              \
+    /* Strategy: reassess every 3 s, first 2 minutes are early */           \
+    3.0f, 120.0f, 1,                                                        \
+                                                                            \
+    /* Teamwork: share / help / cluster ranges (squared), rush size */      \
+    800.0f * 800.0f, 600.0f * 600.0f, 400.0f * 400.0f, 3,                   \
+                                                                            \
+    /* Map control */                                                       \
+    5.0f, 2,                                                                \
+                                                                            \
+    /* Building */                                                          \
+    BOT_BUILD_REPAIR_THRESHOLD,                                             \
+    { 0, 6, 7 },                                                            \
+    {                                                                       \
+        { { STRUCT_NONE, 0, BUILD_PRIORITY_NONE } },                        \
+        {   /* TEAM_HUMAN */                                                \
+            { STRUCT_TELEPORTER,    1, BUILD_PRIORITY_SPAWNS  },            \
+            { STRUCT_TURRET_MG,     2, BUILD_PRIORITY_DEFENSE },            \
+            { STRUCT_AMMO_DEPOT,    1, BUILD_PRIORITY_UTILITY },            \
+            { STRUCT_CAMERA,        1, BUILD_PRIORITY_UTILITY },            \
+            { STRUCT_TELEPORTER,    2, BUILD_PRIORITY_EXPAND  },            \
+            { STRUCT_TURRET_MG,     4, BUILD_PRIORITY_DEFENSE },            \
+        },                                                                  \
+        {   /* TEAM_ALIEN */                                                \
+            { STRUCT_EGG,           1, BUILD_PRIORITY_SPAWNS  },            \
+            { STRUCT_SPIKER,        1, BUILD_PRIORITY_DEFENSE },            \
+            { STRUCT_COCOON,        1, BUILD_PRIORITY_UTILITY },            \
+            { STRUCT_EGG,           2, BUILD_PRIORITY_SPAWNS  },            \
+            { STRUCT_OBSTACLE,      1, BUILD_PRIORITY_DEFENSE },            \
+            { STRUCT_EGG,           3, BUILD_PRIORITY_EXPAND  },            \
+            { STRUCT_SPIKER,        3, BUILD_PRIORITY_DEFENSE },            \
+        },                                                                  \
+    },                                                                      \
+                                                                            \
+    /* Bots */                                                              \
+    BOT_THINK_RATE,                                                         \
+    { 0 },                                                                  \
+}
+
+static const bot_map_profile_t s_defaults = MAP_PROFILE_DEFAULTS;
+bot_map_profile_t bot_map_profile         = MAP_PROFILE_DEFAULTS;
+
+/* -----------------------------------------------------------------------
+   Key tables
+   ----------------------------------------------------------------------- */
+typedef enum { KEY_FLOAT, KEY_INT, KEY_RANGE_SQ } mapprofile_key_type_t;
+
+typedef struct {
+    const char           *name;
+    size_t                offset;
+    mapprofile_key_type_t type;
+    float                 min, max;
+} mapprofile_key_t;
+
+#define MP_KEY(name, field, type, lo, hi) \
+    { name, offsetof(bot_map_profile_t, field), type, lo, hi }
+
+static const mapprofile_key_t s_keys[] = {
+    MP_KEY("strategy_interval",       strategy_interval,       KEY_FLOAT,    0.5f, 60.0f),
+    MP_KEY("phase_early_time",        phase_early_time,        KEY_FLOAT,    0.0f, 3600.0f),
+    MP_KEY("phase_desperate_spawns",  phase_desperate_spawns,  KEY_INT,      0.0f, 16.0f),
+    MP_KEY("share_enemy_range",       share_enemy_range_sq,    KEY_RANGE_SQ, 0.0f, 8192.0f),
+    MP_KEY("help_request_range",      help_request_range_sq,   KEY_RANGE_SQ, 0.0f, 8192.0f),
+    MP_KEY("alien_cluster_range",     alien_cluster_range_sq,  KEY_RANGE_SQ, 0.0f, 8192.0f),
+    MP_KEY("rush_trigger",            rush_trigger,            KEY_INT,      1.0f, MAX_BOTS),
+    MP_KEY("mapctrl_update_interval", mapctrl_update_interval, KEY_FLOAT,    0.5f, 60.0f),
+    MP_KEY("mapctrl_control_bots",    mapctrl_control_bots,    KEY_INT,      1.0f, MAX_BOTS),
+    MP_KEY("repair_threshold",        repair_threshold,        KEY_FLOAT,    0.0f, 1.0f),
+    MP_KEY("think_rate",              think_rate,              KEY_FLOAT,    0.05f, 1.0f),
+};
+
+#define MP_NUM_KEYS  ((int)(sizeof(s_keys) / sizeof(s_keys[0])))
+
+static const struct {
+    const char          *name;
+    gloom_struct_type_t  type;
+} s_struct_names[] = {
+    { "teleporter",    STRUCT_TELEPORTER    },
+    { "turret_mg",     STRUCT_TURRET_MG     },
+    { "turret_rocket", STRUCT_TURRET_ROCKET },
+    { "ammo_depot",    STRUCT_AMMO_DEPOT    },
+    { "camera",        STRUCT_CAMERA        },
+    { "reactor",       STRUCT_REACTOR       },
+    { "egg",           STRUCT_EGG           },
+    { "spiker",        STRUCT_SPIKER        },
+    { "cocoon",        STRUCT_COCOON        },
+    { "obstacle",      STRUCT_OBSTACLE      },
+    { "overmind",      STRUCT_OVERMIND      },
+};
+
+static const char *s_priority_names[] = {
+    "critical", "spawns", "defense", "utility", "repair", "expand"
+};
+
+/* -----------------------------------------------------------------------
+   Line compilers
+   ----------------------------------------------------------------------- */
+static qboolean MapProfile_Scalar(bot_map_profile_t *p, int argc, char **argv)
+{
+    int   i;
+    float v;
+
+    for (i = 0; i < MP_NUM_KEYS; i++) {
+        const mapprofile_key_t *k = &s_keys[i];
+        char *field;
+
+        if (Q_stricmp(argv[0], k->name) != 0)
+            continue;
+        if (argc != 2)
+            return false;
+
+        v = (float)atof(argv[1]);
+        if (v < k->min || v > k->max)
+            return false;
+
+        field = (char *)p + k->offset;
+        switch (k->type) {
+        case KEY_INT:      *(int *)field   = (int)v;  break;
+        case KEY_RANGE_SQ: *(float *)field = v * v;   break;
+        default:           *(float *)field = v;       break;
+        }
+        return true;
+    }
+    return false;
+}
+
+static qboolean MapProfile_ClassRange(bot_map_profile_t *p, int argc, char **argv)
+{
+    int   cls;
+    float v;
+
+    if (argc != 3)
+        return false;
+    for (cls = 0; cls < GLOOM_CLASS_MAX; cls++) {
+        if (Q_stricmp(argv[1], gloom_class_info[cls].name) == 0)
+            break;
+    }
+    v = (float)atof(argv[2]);
+    if (cls >= GLOOM_CLASS_MAX || v <= 0.0f || v > 8192.0f)
+        return false;
+    p->class_range[cls] = v;
+    return true;
+}
+
+static qboolean MapProfile_Build(bot_map_profile_t *p, qboolean *replaced,
+                                 int argc, char **argv)
+{
+    bot_build_step_t *step;
+    int team, i, count;
+    int type = STRUCT_NONE, prio = -1;
+
+    if (argc != 5)
+        return false;
+
+    if (Q_stricmp(argv[1], "human") == 0)
+        team = TEAM_HUMAN;
+    else if (Q_stricmp(argv[1], "alien") == 0)
+        team = TEAM_ALIEN;
+    else
+        return false;
+
+    for (i = 0; i < (int)(sizeof(s_struct_names) / sizeof(s_struct_names[0])); i++) {
+        if (Q_stricmp(argv[2], s_struct_names[i].name) == 0)
+            type = s_struct_names[i].type;
+    }
+    for (i = 0; i < (int)(sizeof(s_priority_names) / sizeof(s_priority_names[0])); i++) {
+        if (Q_stricmp(argv[4], s_priority_names[i]) == 0)
+            prio = i;
+    }
+    count = atoi(argv[3]);
+    if (type == STRUCT_NONE || prio < 0 || count < 1 || count > BOT_BUILD_MAX_STRUCTS)
+        return false;
+
+    if (!replaced[team]) {
+        p->build_len[team] = 0;
+        replaced[team] = true;
+    }
+    if (p->build_len[team] >= BOT_MAP_PROFILE_MAX_BUILD)
+        return false;
+
+    step = &p->build_order[team][p->build_len[team]++];
+    step->type      = (gloom_struct_type_t)type;
+    step->min_count = count;
+    step->priority  = (build_priority_t)prio;
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+void BotMapProfile_Reset(void)
+{
+    bot_map_profile = s_defaults;
+}
+
+qboolean BotMapProfile_Load(const char *mapname)
+{
+    static bot_map_profile_t staging;
+    char     name[MAX_QPATH + 16];
+    char     path[MAX_OSPATH];
+    char     line[256];
+    char    *argv[8];
+    qboolean replaced[3] = { false, false, false };
+    FILE    *f;
+    int      lineno = 0, errors = 0;
+
+    BotMapProfile_Reset();
+    if (!mapname || !mapname[0])
+        return false;
+
+    Com_sprintf(name, sizeof(name), "maps/%s.aip", mapname);
+    BotConfig_GamePath(path, sizeof(path), name);
+    f = fopen(path, "r");
+    if (!f)
+        return false;
+
+    staging = s_defaults;
+    while (fgets(line, sizeof(line), f)) {
+        int      argc;
+        qboolean ok;
+
+        lineno++;
+        argc = BotConfig_Tokenize(line, argv, 8);
+        if (argc == 0)
+            continue;
+
+        if (Q_stricmp(argv[0], "build") == 0)
+            ok = MapProfile_Build(&staging, replaced, argc, argv);
+        else if (Q_stricmp(argv[0], "class_range") == 0)
+            ok = MapProfile_ClassRange(&staging, argc, argv);
+        else
+            ok = MapProfile_Scalar(&staging, argc, argv);
+
+        if (!ok) {
+            gi.dprintf("BotMapProfile: %s:%d: bad setting '%s'\n",
+                       path, lineno, argv[0]);
+            errors++;
+        }
+    }
+    fclose(f);
+
+    bot_map_profile = staging;
+    gi.dprintf("BotMapProfile: loaded '%s'%s\n", path,
+               errors ? " (with errors)" : "");
+    return true;
+}
@@ -0,0 +1,77 @@
+/*
+ * bot_mapprofile.h -- per-map AI tuning compiled into flat tables
+ *
+ * Strategy, teamwork, map-control and build tuning used to be #defines
+ * in the modules that use them.  It now lives in bot_map_profile, which
+ * holds the built-in defaults until a map with a maps/<mapname>.aip file
+ * is loaded.  The profile is compiled once at map start: keys are
+ * resolved to fields, ranges are squared for the distance checks, and
+ * build orders become per-team arrays.  Hot paths read a field of one
+ * global struct, which costs the same as the old constants.
+ *
+ * FILE FORMAT (maps/<mapname>.aip)
+ * --------------------------------
+ * Text, one setting per line; '#' and '//' start comments.
+ *
+ *   <key> <value>                                   scalar settings
+ *   class_range <class> <units>                     engagement range
+ *   build <human|alien> <struct> <count> <priority> build order step
+ *
+ * The first "build" line for a team replaces that team's default order.
+ * Keys that are not set keep their defaults; bad lines are reported
+ * and skipped.
+ */
+
+#ifndef BOT_MAPPROFILE_H
+#define BOT_MAPPROFILE_H
+
+#include "bot.h"
+
+#define BOT_MAP_PROFILE_MAX_BUILD  16   /* build order steps per team */
+
+typedef struct {
+    gloom_struct_type_t type;
+    int                 min_count;  /* build until we have this many */
+    build_priority_t    priority;
+} bot_build_step_t;
+
+typedef struct {
+    /* Strategy (bot_strategy.c) */
+    float strategy_interval;        /* seconds between reassessments       */
+    float phase_early_time;         /* seconds of PHASE_EARLY              */
+    int   phase_desperate_spawns;   /* <= this many spawns = desperate     */
+
+    /* Teamwork (bot_teamwork.c); ranges are stored squared */
+    float share_enemy_range_sq;     /* broadcast enemy pos to allies       */
+    float help_request_range_sq;    /* answer help requests within this    */
+    float alien_cluster_range_sq;   /* range for rush detection            */
+    int   rush_trigger;             /* aliens clustered to trigger a rush  */
+
+    /* Map control (bot_mapcontrol.c) */
+    float mapctrl_update_interval;  /* seconds between zone updates        */
+    int   mapctrl_control_bots;     /* bots needed to claim a zone         */
+
+    /* Building (bot_build.c) */
+    float            repair_threshold;  /* repair below this health fraction */
+    int              build_len[3];      /* indexed by team                   */
+    bot_build_step_t build_order[3][BOT_MAP_PROFILE_MAX_BUILD];
+
+    /* Bots */
+    float think_rate;                       /* seconds between thinks       */
+    float class_range[GLOOM_CLASS_MAX];     /* 0 = not set for this map     */
+} bot_map_profile_t;
+
+/* The live profile; defaults until BotMapProfile_Load finds a file. */
+extern bot_map_profile_t bot_map_profile;
+
+/* Restore the built-in defaults. */
+void     BotMapProfile_Reset(void);
+
+/*
+ * Compile maps/<mapname>.aip (in the mod directory, see
+ * BotConfig_GamePath) over the defaults.  Returns true if a file was
+ * found; with no file the defaults stay in effect.
+ */
+qboolean BotMapProfile_Load(const char *mapname);
+
+#endif /* BOT_MAPPROFILE_H */
@@ -8,6 +8,7 @@
  */
 
 #include "bot_personality.h"
+#include "bot_log.h"
 #include <math.h>
 #include <string.h>
 
@@ -87,14 +88,14 @@ void Bot_GeneratePersonality(bot_state_t *bs)
     bs->personality.patience    = box_muller(PERSONALITY_MEAN, PERSONALITY_STDDEV, u[6], u[7]);
     bs->personality.build_focus = box_muller(PERSONALITY_MEAN, PERSONALITY_STDDEV, u[8], u[9]);
 
-    gi.dprintf("Bot_GeneratePersonality: %s agg=%.2f caut=%.2f team=%.2f "
-               "pat=%.2f build=%.2f\n",
-               bs->name,
-               bs->personality.aggression,
-               bs->personality.caution,
-               bs->personality.teamwork,
-               bs->personality.patience,
-               bs->personality.build_focus);
+    BotLog_Info("Bot_GeneratePersonality: %s agg=%.2f caut=%.2f team=%.2f "
+                "pat=%.2f build=%.2f\n",
+                bs->name,
+                bs->personality.aggression,
+                bs->personality.caution,
+                bs->personality.teamwork,
+                bs->personality.patience,
+                bs->personality.build_focus);
 }
 
 /* -----------------------------------------------------------------------
@@ -0,0 +1,152 @@
+/*
+ * bot_pool.c -- work-stealing fork/join over an index range
+ *
+ * See bot_pool.h.
+ */
+
+#include "bot_pool.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef struct {
+    bot_mutex_t lock;
+    int         begin, end;          /* indices not yet taken */
+} pool_range_t;
+
+typedef struct {
+    pool_range_t    ranges[BOT_POOL_MAX_WORKERS];
+    int             workers;
+    int             grain;
+    bot_pool_func_t func;
+    void           *ctx;
+} pool_job_t;
+
+typedef struct {
+    pool_job_t  *job;
+    int          worker;
+    bot_thread_t thread;
+} pool_worker_t;
+
+/* Take up to grain indices from the front of r; false if it is empty */
+static qboolean BotPool_Take(pool_range_t *r, int grain, int *begin, int *end)
+{
+    qboolean ok;
+
+    BotMutex_Lock(&r->lock);
+    ok = r->begin < r->end;
+    if (ok) {
+        *begin = r->begin;
+        *end   = (r->end - r->begin > grain) ? r->begin + grain : r->end;
+        r->begin = *end;
+    }
+    BotMutex_Unlock(&r->lock);
+    return ok;
+}
+
+/*
+ * Move the back half of some other worker's range into worker's own.
+ * A range of one grain or less is taken whole.  False once every
+ * range is empty.
+ */
+static qboolean BotPool_Steal(pool_job_t *job, int worker)
+{
+    int i;
+
+    for (i = 1; i < job->workers; i++) {
+        pool_range_t *victim = &job->ranges[(worker + i) % job->workers];
+        pool_range_t *own    = &job->ranges[worker];
+        int           begin = 0, end = 0;
+
+        BotMutex_Lock(&victim->lock);
+        if (victim->begin < victim->end) {
+            end = victim->end;
+            begin = (end - victim->begin > job->grain)
+                  ? victim->begin + (end - victim->begin) / 2
+                  : victim->begin;
+            victim->end = begin;
+        }
+        BotMutex_Unlock(&victim->lock);
+
+        if (begin < end) {
+            BotMutex_Lock(&own->lock);
+            own->begin = begin;
+            own->end   = end;
+            BotMutex_Unlock(&own->lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void BotPool_Work(void *arg)
+{
+    pool_worker_t *w   = (pool_worker_t *)arg;
+    pool_job_t    *job = w->job;
+    int            begin, end;
+
+    do {
+        while (BotPool_Take(&job->ranges[w->worker], job->grain, &begin, &end))
+            job->func(job->ctx, w->worker, begin, end);
+    } while (BotPool_Steal(job, w->worker));
+}
+
+int BotPool_DefaultWorkers(void)
+{
+    int n;
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    n = (int)info.dwNumberOfProcessors;
+#else
+    n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1)
+        n = 1;
+    return n > BOT_POOL_MAX_WORKERS ? BOT_POOL_MAX_WORKERS : n;
+}
+
+void BotPool_Run(int count, int workers, int grain,
+                 bot_pool_func_t func, void *ctx)
+{
+    static pool_job_t    job;
+    static pool_worker_t threads[BOT_POOL_MAX_WORKERS];
+    int i;
+
+    if (count <= 0)
+        return;
+    if (workers < 1)
+        workers = 1;
+    if (workers > BOT_POOL_MAX_WORKERS)
+        workers = BOT_POOL_MAX_WORKERS;
+    if (workers > count)
+        workers = count;
+
+    job.workers = workers;
+    job.grain   = grain > 0 ? grain : 1;
+    job.func    = func;
+    job.ctx     = ctx;
+    for (i = 0; i < workers; i++) {
+        BotMutex_Init(&job.ranges[i].lock);
+        job.ranges[i].begin = (int)((long long)count * i / workers);
+        job.ranges[i].end   = (int)((long long)count * (i + 1) / workers);
+        threads[i].job      = &job;
+        threads[i].worker   = i;
+        threads[i].thread.running = false;
+    }
+
+    for (i = 1; i < workers; i++)
+        BotThread_Start(&threads[i].thread, BotPool_Work, &threads[i]);
+    BotPool_Work(&threads[0]);
+    for (i = 1; i < workers; i++)
+        BotThread_Join(&threads[i].thread);
+
+    for (i = 0; i < workers; i++)
+        BotMutex_Destroy(&job.ranges[i].lock);
+}
@@ -0,0 +1,38 @@
+/*
+ * bot_pool.h -- work-stealing fork/join over an index range
+ *
+ * For offline tools (tools/navtool) that run millions of independent
+ * traces.  BotPool_Run splits 0..count-1 into one contiguous range per
+ * worker.  Each worker takes grain indices at a time from the front of
+ * its own range.  When it runs dry it steals the back half of another
+ * worker's range, so uneven jobs (long rows of a visibility matrix,
+ * columns crossing many floors) still keep every core busy.
+ *
+ * Each range has its own mutex and no thread ever holds two, so there
+ * is no lock ordering to get wrong.  Like bot_thread, this is not for
+ * the game DLL: jobs must not call gi.*.
+ */
+
+#ifndef BOT_POOL_H
+#define BOT_POOL_H
+
+#include "bot_thread.h"
+
+#define BOT_POOL_MAX_WORKERS  64
+
+/* Run indices begin..end-1 on worker (0 .. workers-1). */
+typedef void (*bot_pool_func_t)(void *ctx, int worker, int begin, int end);
+
+/* Online CPU count, at least 1 and at most BOT_POOL_MAX_WORKERS. */
+int  BotPool_DefaultWorkers(void);
+
+/*
+ * Call func over 0..count-1 in pieces of at most grain indices, on the
+ * calling thread plus workers - 1 more, and return when all are done.
+ * workers is clamped to 1..BOT_POOL_MAX_WORKERS; if a thread cannot be
+ * started its range is stolen by the others.  One run at a time.
+ */
+void BotPool_Run(int count, int workers, int grain,
+                 bot_pool_func_t func, void *ctx);
+
+#endif /* BOT_POOL_H */
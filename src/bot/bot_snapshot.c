@@ -0,0 +1,198 @@
+/*
+ * bot_snapshot.c -- persistent bot state across level changes and saves
+ *
+ * See bot_snapshot.h.  File layout (native endianness, like .nav files):
+ *
+ *   int magic, version, record_size, count
+ *   bot_strategy_snapshot_t
+ *   bot_snapshot_rec_t × count
+ */
+
+#include "bot_snapshot.h"
+#include "bot_humanize.h"
+#include <stdio.h>
+
+/* -----------------------------------------------------------------------
+   BotSnapshot_Capture
+   ----------------------------------------------------------------------- */
+void BotSnapshot_Capture(bot_snapshot_t *snap)
+{
+    int i;
+
+    memset(snap, 0, sizeof(*snap));
+    BotStrategy_Save(&snap->strategy);
+
+    for (i = 0; i < MAX_BOTS; i++) {
+        const bot_state_t  *bs = &g_bots[i];
+        bot_snapshot_rec_t *r;
+
+        if (!bs->in_use || !bs->ent)
+            continue;
+
+        r = &snap->bots[snap->count++];
+        r->bot_index      = (unsigned char)i;
+        r->team           = (unsigned char)bs->team;
+        r->gloom_class    = (unsigned char)bs->gloom_class;
+        r->class_upgrades = (unsigned char)(bs->class_upgrades > 255
+                                            ? 255 : bs->class_upgrades);
+        memcpy(r->name, bs->name, sizeof(r->name));
+        r->name[sizeof(r->name) - 1] = '\0';
+        r->skill          = bs->skill;
+        r->credits        = bs->credits;
+        r->evos           = bs->evos;
+        r->personality    = bs->personality;
+    }
+}
+
+/* Reconnect a bot that is not in g_bots, the same way addbot does. */
+static bot_state_t *BotSnapshot_Reconnect(const bot_snapshot_rec_t *r)
+{
+    edict_t     *ent;
+    bot_state_t *bs;
+
+    ent = G_AllocClientSlot();
+    if (!ent)
+        return NULL;
+
+    ent->client = Bot_AllocClient();
+    if (!ent->client) {
+        G_FreeClientSlot(ent);
+        return NULL;
+    }
+
+    bs = Bot_Connect(ent, r->team, r->skill);
+    if (!bs) {
+        Bot_FreeClient(ent->client);
+        G_FreeClientSlot(ent);
+    }
+    return bs;
+}
+
+/* -----------------------------------------------------------------------
+   BotSnapshot_Apply
+   ----------------------------------------------------------------------- */
+int BotSnapshot_Apply(const bot_snapshot_t *snap)
+{
+    int i, restored = 0;
+
+    for (i = 0; i < snap->count && i < MAX_BOTS; i++) {
+        const bot_snapshot_rec_t *r = &snap->bots[i];
+        bot_state_t *bs;
+
+        if (r->bot_index >= MAX_BOTS ||
+            (r->team != TEAM_HUMAN && r->team != TEAM_ALIEN))
+            continue;
+
+        bs = &g_bots[r->bot_index];
+        if (!bs->in_use || !bs->ent || !bs->ent->client) {
+            bs = BotSnapshot_Reconnect(r);
+            if (!bs)
+                continue;
+        }
+
+        /* Fresh level state, then lay the persistent fields back on */
+        Bot_ResetState(bs, r->team, r->skill);
+        memcpy(bs->name, r->name, sizeof(bs->name));
+        bs->name[sizeof(bs->name) - 1] = '\0';
+        Bot_SetClass(bs, r->team, (gloom_class_t)r->gloom_class);
+        bs->class_upgrades = r->class_upgrades;
+        bs->credits        = r->credits;
+        bs->evos           = r->evos;
+        bs->personality    = r->personality;
+        Bot_Humanize_Init(bs);      /* seeded from the restored name */
+        restored++;
+    }
+
+    BotStrategy_Restore(&snap->strategy);
+    return restored;
+}
+
+/* -----------------------------------------------------------------------
+   Bot_WriteSnapshot
+   ----------------------------------------------------------------------- */
+qboolean Bot_WriteSnapshot(const char *filename)
+{
+    static bot_snapshot_t snap;
+    int   header[4];
+    FILE *f;
+    qboolean ok;
+
+    BotSnapshot_Capture(&snap);
+
+    f = fopen(filename, "wb");
+    if (!f) {
+        gi.dprintf("Bot_WriteSnapshot: cannot open '%s' for writing\n", filename);
+        return false;
+    }
+
+    header[0] = BOT_SNAPSHOT_MAGIC;
+    header[1] = BOT_SNAPSHOT_VERSION;
+    header[2] = (int)sizeof(bot_snapshot_rec_t);
+    header[3] = snap.count;
+
+    ok = fwrite(header, sizeof(header), 1, f) == 1 &&
+         fwrite(&snap.strategy, sizeof(snap.strategy), 1, f) == 1 &&
+         (snap.count == 0 ||
+          fwrite(snap.bots, sizeof(bot_snapshot_rec_t), (size_t)snap.count, f)
+              == (size_t)snap.count);
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok) {
+        gi.dprintf("Bot_WriteSnapshot: write to '%s' failed\n", filename);
+        return false;
+    }
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   Bot_ReadSnapshot
+   ----------------------------------------------------------------------- */
+qboolean Bot_ReadSnapshot(const char *filename)
+{
+    static bot_snapshot_t snap;
+    int   header[4];
+    FILE *f;
+
+    f = fopen(filename, "rb");
+    if (!f) {
+        gi.dprintf("Bot_ReadSnapshot: cannot open '%s'\n", filename);
+        return false;
+    }
+
+    memset(&snap, 0, sizeof(snap));
+    if (fread(header, sizeof(header), 1, f) != 1) {
+        gi.dprintf("Bot_ReadSnapshot: '%s' truncated header\n", filename);
+        fclose(f);
+        return false;
+    }
+
+    if (header[0] != BOT_SNAPSHOT_MAGIC ||
+        header[1] != BOT_SNAPSHOT_VERSION ||
+        header[2] != (int)sizeof(bot_snapshot_rec_t)) {
+        gi.dprintf("Bot_ReadSnapshot: '%s' unsupported version %d\n",
+                   filename, header[1]);
+        fclose(f);
+        return false;
+    }
+
+    if (header[3] < 0 || header[3] > MAX_BOTS) {
+        gi.dprintf("Bot_ReadSnapshot: '%s' invalid bot count %d\n",
+                   filename, header[3]);
+        fclose(f);
+        return false;
+    }
+
+    snap.count = header[3];
+    if (fread(&snap.strategy, sizeof(snap.strategy), 1, f) != 1 ||
+        (snap.count > 0 &&
+         fread(snap.bots, sizeof(bot_snapshot_rec_t), (size_t)snap.count, f)
+             != (size_t)snap.count)) {
+        gi.dprintf("Bot_ReadSnapshot: '%s' truncated\n", filename);
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+
+    BotSnapshot_Apply(&snap);
+    return true;
+}
@@ -0,0 +1,53 @@
+/*
+ * bot_snapshot.h -- persistent bot state across level changes and saves
+ *
+ * A snapshot holds what a bot should keep when the level restarts:
+ * identity, team, class, skill, resources and personality, plus the
+ * team strategy state.  Everything else (targets, paths, timers keyed to
+ * level.time, edict pointers) is level-scoped and rebuilt.
+ *
+ * Snapshots are taken in memory on every SpawnEntities and written to
+ * disk by the game's WriteLevel/WriteGame exports.  The file is a fixed
+ * header followed by the strategy block and one record per bot.  Bump
+ * BOT_SNAPSHOT_VERSION when the meaning of a field changes; records of a
+ * different size are rejected automatically.
+ */
+
+#ifndef BOT_SNAPSHOT_H
+#define BOT_SNAPSHOT_H
+
+#include "bot.h"
+#include "bot_strategy.h"
+
+#define BOT_SNAPSHOT_MAGIC    0x50534E42  /* "BNSP" little-endian */
+#define BOT_SNAPSHOT_VERSION  1
+
+typedef struct {
+    unsigned char     bot_index;        /* g_bots[] slot                     */
+    unsigned char     team;
+    unsigned char     gloom_class;
+    unsigned char     class_upgrades;
+    char              name[32];
+    float             skill;
+    int               credits;
+    int               evos;
+    bot_personality_t personality;
+} bot_snapshot_rec_t;
+
+typedef struct {
+    int                     count;
+    bot_strategy_snapshot_t strategy;
+    bot_snapshot_rec_t      bots[MAX_BOTS];
+} bot_snapshot_t;
+
+/* Record every active bot and the strategy state. */
+void BotSnapshot_Capture(bot_snapshot_t *snap);
+
+/*
+ * Reset each recorded bot's level state and restore its persistent
+ * state.  Bots missing from g_bots (e.g. after the DLL was reloaded for
+ * a saved game) are reconnected first.  Returns the number restored.
+ */
+int  BotSnapshot_Apply(const bot_snapshot_t *snap);
+
+#endif /* BOT_SNAPSHOT_H */
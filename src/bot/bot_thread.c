@@ -0,0 +1,74 @@
+/*
+ * bot_thread.c -- minimal portable threads for q2gloombot
+ *
+ * See bot_thread.h.  Worker functions must not call gi.* — the engine
+ * import table is not thread-safe.
+ */
+
+#include "bot_thread.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+static DWORD WINAPI BotThread_Trampoline(LPVOID param)
+{
+    bot_thread_t *t = (bot_thread_t *)param;
+    t->func(t->arg);
+    return 0;
+}
+
+qboolean BotThread_Start(bot_thread_t *t, bot_thread_func_t func, void *arg)
+{
+    t->func    = func;
+    t->arg     = arg;
+    t->handle  = CreateThread(NULL, 0, BotThread_Trampoline, t, 0, NULL);
+    t->running = (t->handle != NULL);
+    return t->running;
+}
+
+void BotThread_Join(bot_thread_t *t)
+{
+    if (!t->running)
+        return;
+    WaitForSingleObject((HANDLE)t->handle, INFINITE);
+    CloseHandle((HANDLE)t->handle);
+    t->running = false;
+}
+
+void BotMutex_Init(bot_mutex_t *m)    { InitializeSRWLock((PSRWLOCK)m); }
+void BotMutex_Destroy(bot_mutex_t *m) { (void)m; }
+void BotMutex_Lock(bot_mutex_t *m)    { AcquireSRWLockExclusive((PSRWLOCK)m); }
+void BotMutex_Unlock(bot_mutex_t *m)  { ReleaseSRWLockExclusive((PSRWLOCK)m); }
+
+#else
+
+static void *BotThread_Trampoline(void *param)
+{
+    bot_thread_t *t = (bot_thread_t *)param;
+    t->func(t->arg);
+    return NULL;
+}
+
+qboolean BotThread_Start(bot_thread_t *t, bot_thread_func_t func, void *arg)
+{
+    t->func    = func;
+    t->arg     = arg;
+    t->running = (pthread_create(&t->handle, NULL, BotThread_Trampoline, t) == 0);
+    return t->running;
+}
+
+void BotThread_Join(bot_thread_t *t)
+{
+    if (!t->running)
+        return;
+    pthread_join(t->handle, NULL);
+    t->running = false;
+}
+
+void BotMutex_Init(bot_mutex_t *m)    { pthread_mutex_init(m, NULL); }
+void BotMutex_Destroy(bot_mutex_t *m) { pthread_mutex_destroy(m); }
+void BotMutex_Lock(bot_mutex_t *m)    { pthread_mutex_lock(m); }
+void BotMutex_Unlock(bot_mutex_t *m)  { pthread_mutex_unlock(m); }
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * bot_thread.h -- minimal portable threads for q2gloombot
+ *
+ * The game DLL is single-threaded by contract: every gi.* call and every
+ * touch of edicts or live bot state must happen on the server thread.
+ * Worker threads are only used for self-contained jobs (e.g. parsing a
+ * .nav file into a private buffer) whose results the server thread
+ * picks up and publishes itself.
+ *
+ * Wraps pthreads on POSIX and the Win32 thread API on Windows.
+ */
+
+#ifndef BOT_THREAD_H
+#define BOT_THREAD_H
+
+#include "q_shared.h"
+
+#ifdef _WIN32
+typedef void *bot_thread_handle_t;              /* HANDLE                  */
+typedef struct { void *ptr; } bot_mutex_t;      /* SRWLOCK                 */
+#else
+#include <pthread.h>
+typedef pthread_t       bot_thread_handle_t;
+typedef pthread_mutex_t bot_mutex_t;
+#endif
+
+typedef void (*bot_thread_func_t)(void *arg);
+
+typedef struct {
+    bot_thread_handle_t handle;
+    bot_thread_func_t   func;
+    void               *arg;
+    qboolean            running;    /* started and not yet joined */
+} bot_thread_t;
+
+/* Start func(arg) on a new thread; returns false if the OS refused. */
+qboolean BotThread_Start(bot_thread_t *t, bot_thread_func_t func, void *arg);
+
+/* Wait for a started thread to finish; no-op if it is not running. */
+void     BotThread_Join(bot_thread_t *t);
+
+void     BotMutex_Init(bot_mutex_t *m);
+void     BotMutex_Destroy(bot_mutex_t *m);
+void     BotMutex_Lock(bot_mutex_t *m);
+void     BotMutex_Unlock(bot_mutex_t *m);
+
+#endif /* BOT_THREAD_H */
@@ -7,7 +7,8 @@
 
 #include "bot_upgrade.h"
 #include "bot_strategy.h"
-#include "../nav/bot_nodes.h"
+#include "bot_log.h"
+#include "../nav/bot_navcache.h"
 
 /* -----------------------------------------------------------------------
    Composition caps (enforced by the decision logic below)
@@ -140,36 +141,6 @@ void BotUpgrade_Init(void)
     g_game_state.last_update           = 0.0f;
 }
 
-/*
- * Determine map openness from nav node distribution:
- *   - High ratio of NAV_SNIPE nodes  → open sightlines → MAP_TYPE_OPEN
- *   - High ratio of NAV_WALLCLIMB nodes relative to NAV_GROUND → tight corridors
- *     that force close-quarters → MAP_TYPE_TIGHT
- *   - Otherwise → MAP_TYPE_MIXED
- */
-static bot_map_type_t DeriveMapType(void)
-{
-    int i, snipe = 0, wallclimb = 0, ground = 0, total = 0;
-
-    for (i = 0; i < nav_node_count; i++) {
-        if (nav_nodes[i].id == BOT_INVALID_NODE) continue;
-        total++;
-        if (nav_nodes[i].flags & NAV_SNIPE)     snipe++;
-        if (nav_nodes[i].flags & NAV_WALLCLIMB) wallclimb++;
-        if (nav_nodes[i].flags & NAV_GROUND)    ground++;
-    }
-
-    if (total == 0) return MAP_TYPE_MIXED;
-
-    /* More than 20% of nodes are sniper perches → open */
-    if (snipe * 5 > total) return MAP_TYPE_OPEN;
-
-    /* Wall-climb nodes outnumber ground nodes 2:1 → tight corridor map */
-    if (ground > 0 && wallclimb > ground * 2) return MAP_TYPE_TIGHT;
-
-    return MAP_TYPE_MIXED;
-}
-
 void BotUpgrade_UpdateGameState(void)
 {
     int   i;
@@ -205,7 +176,8 @@ void BotUpgrade_UpdateGameState(void)
         g_game_state.win_state[TEAM_ALIEN] = WIN_STATE_EVEN;
     }
 
-    g_game_state.map_type = DeriveMapType();
+    /* Computed once per nav graph, see bot_navcache.c */
+    g_game_state.map_type = (bot_map_type_t)BotNavCache_Get()->map_type;
 }
 
 bot_win_state_t BotUpgrade_GetWinState(int team)
@@ -454,8 +426,8 @@ int Bot_ChooseClass(bot_state_t *bs)
     bs->combat.engagement_range = gloom_class_info[chosen].preferred_range;
     bs->class_upgrades++;
 
-    gi.dprintf("Bot_ChooseClass: '%s' → %s (evos=%d credits=%d)\n",
-               bs->name, Gloom_ClassName(chosen), bs->evos, bs->credits);
+    BotLog_Info("Bot_ChooseClass: '%s' → %s (evos=%d credits=%d)\n",
+                bs->name, Gloom_ClassName(chosen), bs->evos, bs->credits);
 
     return (int)chosen;
 }
@@ -6,6 +6,8 @@
  *
  * BUILD ORDER REFERENCE
  * ----------------------
+ * Default orders; a map's .aip profile may replace them (bot_mapprofile.h).
+ *
  * Human Engineer:
  *   1. Teleporter (spawn)
  *   2. 2× Turret_MG (defense)
@@ -25,41 +27,13 @@
  */
 
 #include "bot_build.h"
+#include "../bot_mapprofile.h"
 
 /* -----------------------------------------------------------------------
    Module state — one build memory block per team
    ----------------------------------------------------------------------- */
 static bot_build_memory_t s_build_mem[3]; /* indices: TEAM_HUMAN, TEAM_ALIEN */
 
-/* -----------------------------------------------------------------------
-   Human build order table
-   Entries are tried in order; the first unsatisfied one is chosen.
-   ----------------------------------------------------------------------- */
-typedef struct {
-    gloom_struct_type_t type;
-    int                 min_count; /* build until we have this many         */
-    build_priority_t    priority;
-} build_order_entry_t;
-
-static const build_order_entry_t s_human_build_order[] = {
-    { STRUCT_TELEPORTER,    1, BUILD_PRIORITY_SPAWNS  },
-    { STRUCT_TURRET_MG,     2, BUILD_PRIORITY_DEFENSE },
-    { STRUCT_AMMO_DEPOT,    1, BUILD_PRIORITY_UTILITY },
-    { STRUCT_CAMERA,        1, BUILD_PRIORITY_UTILITY },
-    { STRUCT_TELEPORTER,    2, BUILD_PRIORITY_EXPAND  },
-    { STRUCT_TURRET_MG,     4, BUILD_PRIORITY_DEFENSE },
-};
-
-static const build_order_entry_t s_alien_build_order[] = {
-    { STRUCT_EGG,           1, BUILD_PRIORITY_SPAWNS  },
-    { STRUCT_SPIKER,        1, BUILD_PRIORITY_DEFENSE },
-    { STRUCT_COCOON,        1, BUILD_PRIORITY_UTILITY },
-    { STRUCT_EGG,           2, BUILD_PRIORITY_SPAWNS  },
-    { STRUCT_OBSTACLE,      1, BUILD_PRIORITY_DEFENSE },
-    { STRUCT_EGG,           3, BUILD_PRIORITY_EXPAND  },
-    { STRUCT_SPIKER,        3, BUILD_PRIORITY_DEFENSE },
-};
-
 /* -----------------------------------------------------------------------
    BotBuild_Init
    Called once during Bot_Init().
@@ -121,24 +95,18 @@ static int CountStructType(int team, gloom_struct_type_t type)
 
 /* -----------------------------------------------------------------------
    BotBuild_ChooseNext
-   Walk the build order table and choose the first unsatisfied entry.
-   Updates bs->build.priority and bs->build.what_to_build.
+   Walk the map profile's build order and choose the first unsatisfied
+   entry.  Updates bs->build.priority and bs->build.what_to_build.
    ----------------------------------------------------------------------- */
 void BotBuild_ChooseNext(bot_state_t *bs)
 {
-    const build_order_entry_t *order;
-    int                        order_len;
-    int                        i;
-
-    if (bs->team == TEAM_HUMAN) {
-        order     = s_human_build_order;
-        order_len = (int)(sizeof(s_human_build_order) /
-                          sizeof(s_human_build_order[0]));
-    } else {
-        order     = s_alien_build_order;
-        order_len = (int)(sizeof(s_alien_build_order) /
-                          sizeof(s_alien_build_order[0]));
-    }
+    const bot_build_step_t *order;
+    int                     order_len;
+    int                     i;
+    int                     team = (bs->team == TEAM_HUMAN) ? TEAM_HUMAN : TEAM_ALIEN;
+
+    order     = bot_map_profile.build_order[team];
+    order_len = bot_map_profile.build_len[team];
 
     for (i = 0; i < order_len; i++) {
         if (CountStructType(bs->team, order[i].type) < order[i].min_count) {
@@ -169,7 +137,7 @@ edict_t *BotBuild_FindRepairTarget(bot_state_t *bs)
     int                 i;
     bot_build_memory_t *mem;
     edict_t            *best      = NULL;
-    float               best_pct  = BOT_BUILD_REPAIR_THRESHOLD;
+    float               best_pct  = bot_map_profile.repair_threshold;
 
     if (bs->team < 1 || bs->team > 2) return NULL;
     mem = &s_build_mem[bs->team];
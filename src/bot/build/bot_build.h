@@ -23,7 +23,8 @@
 #include "bot.h"
 
 /* -----------------------------------------------------------------------
-   Structure health threshold for triggering a repair
+   Default structure health threshold for triggering a repair; a map
+   profile may override it (bot_map_profile.repair_threshold)
    ----------------------------------------------------------------------- */
 #define BOT_BUILD_REPAIR_THRESHOLD  0.50f  /* repair when below 50% HP     */
 
@@ -18,6 +18,9 @@
  * CANDIDATE GENERATION
  * --------------------
  * Candidates are generated from nav nodes nearest the bot's position.
+ * "Nearest" is travel distance along the nav graph (BotNav_Distance),
+ * so a node on the floor above is not mistaken for one next to the bot.
+ * While the graph's distance labels are being rebuilt it is straight-line.
  * Wall-type nodes (NAV_WALLCLIMB) are preferred for alien placements.
  * Floor nodes are used for human placements.
  */
@@ -99,6 +102,20 @@ static float Placement_ClusterPenalty(vec3_t origin, int team,
     return 0.0f;
 }
 
+/* -----------------------------------------------------------------------
+   Internal: travel distance from the builder's node to a candidate.
+   Straight-line distances beyond the limit are rejected first, since
+   travel is never shorter.  Falls back to straight-line when the builder
+   is off the graph.
+   ----------------------------------------------------------------------- */
+static float Placement_Distance(int from, unsigned int caps, int node,
+                                float straight, float limit)
+{
+    if (straight > limit || from == BOT_INVALID_NODE)
+        return straight;
+    return BotNav_Distance(from, node, caps);
+}
+
 /* -----------------------------------------------------------------------
    BotBuildPlacement_ForSpawn
    Find a defensible, somewhat concealed location for a spawn structure
@@ -109,10 +126,14 @@ qboolean BotBuildPlacement_ForSpawn(bot_state_t *bs, vec3_t out_origin)
 {
     int   best_node = BOT_INVALID_NODE;
     float best_score = -9999.0f;
-    int   i;
+    int   i, from;
+    unsigned int caps;
 
     if (!bs->ent) return false;
 
+    from = BotNav_NearestNode(bs->ent->s.origin, Bot_CanWallWalk(bs));
+    caps = BotNav_Caps(bs);
+
     for (i = 0; i < nav_node_count; i++) {
         vec3_t delta;
         float  dist, score, penalty;
@@ -130,6 +151,7 @@ qboolean BotBuildPlacement_ForSpawn(bot_state_t *bs, vec3_t out_origin)
         delta[2] = nav_nodes[i].origin[2] - bs->ent->s.origin[2];
         dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
                                     delta[2]*delta[2]));
+        dist = Placement_Distance(from, caps, i, dist, PLACEMENT_SEARCH_RADIUS);
 
         if (dist > PLACEMENT_SEARCH_RADIUS) continue;
         if (!Placement_IsValidSurface(nav_nodes[i].origin)) continue;
@@ -174,10 +196,14 @@ qboolean BotBuildPlacement_ForDefense(bot_state_t *bs,
 {
     int   best_node = BOT_INVALID_NODE;
     float best_score = -9999.0f;
-    int   i;
+    int   i, from;
+    unsigned int caps;
 
     if (!bs->ent) return false;
 
+    from = BotNav_NearestNode(bs->ent->s.origin, Bot_CanWallWalk(bs));
+    caps = BotNav_Caps(bs);
+
     for (i = 0; i < nav_node_count; i++) {
         vec3_t delta;
         float  dist, score;
@@ -194,6 +220,7 @@ qboolean BotBuildPlacement_ForDefense(bot_state_t *bs,
         delta[2] = nav_nodes[i].origin[2] - bs->ent->s.origin[2];
         dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
                                     delta[2]*delta[2]));
+        dist = Placement_Distance(from, caps, i, dist, PLACEMENT_SEARCH_RADIUS);
 
         if (dist > PLACEMENT_SEARCH_RADIUS) continue;
         if (!Placement_IsValidSurface(nav_nodes[i].origin)) continue;
@@ -236,10 +263,14 @@ qboolean BotBuildPlacement_ForUtility(bot_state_t *bs,
 {
     int   best_node = BOT_INVALID_NODE;
     float best_score = -9999.0f;
-    int   i;
+    int   i, from;
+    unsigned int caps;
 
     if (!bs->ent) return false;
 
+    from = BotNav_NearestNode(bs->ent->s.origin, Bot_CanWallWalk(bs));
+    caps = BotNav_Caps(bs);
+
     for (i = 0; i < nav_node_count; i++) {
         vec3_t delta;
         float  dist, score;
@@ -256,6 +287,8 @@ qboolean BotBuildPlacement_ForUtility(bot_state_t *bs,
         delta[2] = nav_nodes[i].origin[2] - bs->ent->s.origin[2];
         dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
                                     delta[2]*delta[2]));
+        dist = Placement_Distance(from, caps, i, dist,
+                                  PLACEMENT_SEARCH_RADIUS * 0.5f);
 
         if (dist > PLACEMENT_SEARCH_RADIUS * 0.5f) continue;
         if (!Placement_IsValidSurface(nav_nodes[i].origin)) continue;
@@ -10,6 +10,7 @@
 
 #include "../bot.h"
 #include "../nav/bot_nav.h"
+#include "../nav/bot_navnear.h"
 
 /* -----------------------------------------------------------------------
    BotAlien_CountClass
@@ -113,8 +114,13 @@ qboolean BotAlien_ShouldRetreatToCocoon(bot_state_t *bs)
    ----------------------------------------------------------------------- */
 int BotAlien_GetNearestEgg(bot_state_t *bs)
 {
-    /* Navigation to eggs is handled via nav nodes flagged NAV_EGG. */
+    int node;
+
     if (!bs || !bs->ent) return BOT_INVALID_NODE;
+
+    /* Nearest live Egg by travel distance, else a node flagged NAV_EGG */
+    if (BotNavNear_Find(bs->nav.current_node, STRUCT_EGG, &node, NULL))
+        return node;
     return BotNav_NearestNode(bs->ent->s.origin, NAV_EGG);
 }
 
@@ -15,6 +15,7 @@
  */
 
 #include "../bot.h"
+#include "../bot_config.h"
 
 /* -----------------------------------------------------------------------
    Constants
@@ -39,7 +40,7 @@ static const gloom_class_t biotech_escort_priority[] = {
    ----------------------------------------------------------------------- */
 void BotClass_Init_biotech(bot_state_t *bs)
 {
-    bs->combat.engagement_range = gloom_class_info[GLOOM_CLASS_BIOTECH].preferred_range;
+    bs->combat.engagement_range = BotConfig_ClassRange(GLOOM_CLASS_BIOTECH);
     bs->combat.prefer_cover     = true;  /* stay behind front line          */
     bs->combat.max_range_engage = true;
     bs->nav.wall_walking        = false;
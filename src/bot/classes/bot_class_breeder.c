@@ -16,6 +16,7 @@
  */
 
 #include "../bot.h"
+#include "../bot_config.h"
 
 /* -----------------------------------------------------------------------
    Engagement / health constants
@@ -31,7 +32,7 @@
    ----------------------------------------------------------------------- */
 void BotClass_Init_breeder(bot_state_t *bs)
 {
-    bs->combat.engagement_range = gloom_class_info[GLOOM_CLASS_BREEDER].preferred_range;
+    bs->combat.engagement_range = BotConfig_ClassRange(GLOOM_CLASS_BREEDER);
     bs->combat.prefer_cover     = true;
     bs->combat.max_range_engage = false;
     bs->nav.wall_walking        = true; /* Breeders use wall paths to reach hidden spots */
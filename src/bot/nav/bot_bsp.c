@@ -0,0 +1,633 @@
+/*
+ * bot_bsp.c -- Quake 2 BSP (IBSP v38) collision model for offline tools
+ *
+ * See bot_bsp.h.  The trace follows the engine's box trace: the swept
+ * box is pushed down the node tree with each plane moved out by the
+ * box's extent along its normal, and every brush in a leaf it reaches is
+ * clipped against the segment with its planes moved out the same way.
+ */
+
+#include "bot_bsp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define BSP_DIST_EPSILON  0.03125f
+#define BSP_MAX_LEAFS     1024       /* leafs one position test may touch */
+
+/* Lumps used for collision, plus the entity string */
+#define LUMP_ENTITIES     0
+#define LUMP_PLANES       1
+#define LUMP_NODES        4
+#define LUMP_TEXINFO      5
+#define LUMP_LEAFS        8
+#define LUMP_LEAFBRUSHES  10
+#define LUMP_MODELS       13
+#define LUMP_BRUSHES      14
+#define LUMP_BRUSHSIDES   15
+#define LUMP_COUNT        19
+
+/* On-disk record sizes */
+#define DISK_PLANE        20
+#define DISK_NODE         28
+#define DISK_TEXINFO      76
+#define DISK_LEAF         28
+#define DISK_LEAFBRUSH    2
+#define DISK_MODEL        48
+#define DISK_BRUSH        12
+#define DISK_BRUSHSIDE    4
+
+static csurface_t s_null_surface;
+
+/* Per-trace state, on the caller's stack */
+typedef struct {
+    bsp_tracer_t *t;
+    trace_t       trace;
+    vec3_t        start, end, mins, maxs, extents;
+    int           mask;
+    qboolean      is_point;
+} bsp_work_t;
+
+/* -----------------------------------------------------------------------
+   Loading
+   ----------------------------------------------------------------------- */
+
+static int Bsp_Int(const byte *p)
+{
+    return (int)((unsigned int)p[0] | (unsigned int)p[1] << 8 |
+                 (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24);
+}
+
+static int Bsp_Short(const byte *p)
+{
+    return (short)(p[0] | p[1] << 8);
+}
+
+static int Bsp_UShort(const byte *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+static float Bsp_Float(const byte *p)
+{
+    union { int i; float f; } u;
+
+    u.i = Bsp_Int(p);
+    return u.f;
+}
+
+/*
+ * Find lump and check it holds whole records of size bytes; sets *data
+ * and *count.  False with err filled in otherwise.
+ */
+static qboolean Bsp_Lump(const byte *file, int filelen, int lump, int size,
+                         const byte **data, int *count, const char *path,
+                         char *err, int errsize)
+{
+    int ofs = Bsp_Int(file + 8 + lump * 8);
+    int len = Bsp_Int(file + 12 + lump * 8);
+
+    if (ofs < 0 || len < 0 || ofs > filelen || len > filelen - ofs ||
+        len % size) {
+        Com_sprintf(err, errsize, "'%s' lump %d out of range", path, lump);
+        return false;
+    }
+    *data  = file + ofs;
+    *count = len / size;
+    return true;
+}
+
+static void *Bsp_Alloc(int count, int size)
+{
+    return calloc(count > 0 ? (size_t)count : 1, (size_t)size);
+}
+
+/* Decode the lumps; file has passed the header checks */
+static qboolean Bsp_Parse(const byte *file, int filelen, bsp_map_t *map,
+                          const char *path, char *err, int errsize)
+{
+    const byte *d;
+    int         n, i, j;
+
+    /* Entity string; the compiler's NUL is not counted on */
+    if (!Bsp_Lump(file, filelen, LUMP_ENTITIES, 1, &d, &n, path, err, errsize))
+        return false;
+    map->entities = Bsp_Alloc(n + 1, 1);
+    memcpy(map->entities, d, (size_t)n);
+    map->entities[n] = '\0';
+
+    /* Planes */
+    if (!Bsp_Lump(file, filelen, LUMP_PLANES, DISK_PLANE, &d, &n, path, err, errsize))
+        return false;
+    map->planes = Bsp_Alloc(n, sizeof(cplane_t));
+    map->num_planes = n;
+    for (i = 0; i < n; i++, d += DISK_PLANE) {
+        cplane_t *p = &map->planes[i];
+
+        p->signbits = 0;
+        for (j = 0; j < 3; j++) {
+            p->normal[j] = Bsp_Float(d + j * 4);
+            if (p->normal[j] < 0.0f)
+                p->signbits |= 1 << j;
+        }
+        p->dist = Bsp_Float(d + 12);
+        p->type = (byte)Bsp_Int(d + 16);
+    }
+
+    /* Surfaces, one per texinfo */
+    if (!Bsp_Lump(file, filelen, LUMP_TEXINFO, DISK_TEXINFO, &d, &n, path, err, errsize))
+        return false;
+    map->surfaces = Bsp_Alloc(n, sizeof(csurface_t));
+    map->num_surfaces = n;
+    for (i = 0; i < n; i++, d += DISK_TEXINFO) {
+        csurface_t *s = &map->surfaces[i];
+
+        s->flags = Bsp_Int(d + 32);
+        s->value = Bsp_Int(d + 36);
+        memcpy(s->name, d + 40, sizeof(s->name) - 1);
+        s->name[sizeof(s->name) - 1] = '\0';
+    }
+
+    /* Brush sides */
+    if (!Bsp_Lump(file, filelen, LUMP_BRUSHSIDES, DISK_BRUSHSIDE, &d, &n, path, err, errsize))
+        return false;
+    map->sides = Bsp_Alloc(n, sizeof(bsp_side_t));
+    map->num_sides = n;
+    for (i = 0; i < n; i++, d += DISK_BRUSHSIDE) {
+        int plane = Bsp_UShort(d), tex = Bsp_Short(d + 2);
+
+        if (plane >= map->num_planes || tex >= map->num_surfaces) {
+            Com_sprintf(err, errsize, "'%s' brush side %d out of range", path, i);
+            return false;
+        }
+        map->sides[i].plane   = &map->planes[plane];
+        map->sides[i].surface = tex < 0 ? &s_null_surface : &map->surfaces[tex];
+    }
+
+    /* Brushes */
+    if (!Bsp_Lump(file, filelen, LUMP_BRUSHES, DISK_BRUSH, &d, &n, path, err, errsize))
+        return false;
+    map->brushes = Bsp_Alloc(n, sizeof(bsp_brush_t));
+    map->num_brushes = n;
+    for (i = 0; i < n; i++, d += DISK_BRUSH) {
+        bsp_brush_t *b = &map->brushes[i];
+
+        b->first_side = Bsp_Int(d);
+        b->num_sides  = Bsp_Int(d + 4);
+        b->contents   = Bsp_Int(d + 8);
+        if (b->first_side < 0 || b->num_sides < 0 ||
+            b->first_side > map->num_sides - b->num_sides) {
+            Com_sprintf(err, errsize, "'%s' brush %d out of range", path, i);
+            return false;
+        }
+    }
+
+    /* Leaf brushes */
+    if (!Bsp_Lump(file, filelen, LUMP_LEAFBRUSHES, DISK_LEAFBRUSH, &d, &n, path, err, errsize))
+        return false;
+    map->leaf_brushes = Bsp_Alloc(n, sizeof(unsigned short));
+    map->num_leaf_brushes = n;
+    for (i = 0; i < n; i++, d += DISK_LEAFBRUSH) {
+        map->leaf_brushes[i] = (unsigned short)Bsp_UShort(d);
+        if (map->leaf_brushes[i] >= map->num_brushes) {
+            Com_sprintf(err, errsize, "'%s' leaf brush %d out of range", path, i);
+            return false;
+        }
+    }
+
+    /* Leafs */
+    if (!Bsp_Lump(file, filelen, LUMP_LEAFS, DISK_LEAF, &d, &n, path, err, errsize))
+        return false;
+    if (n < 1) {
+        Com_sprintf(err, errsize, "'%s' has no leafs", path);
+        return false;
+    }
+    map->leafs = Bsp_Alloc(n, sizeof(bsp_leaf_t));
+    map->num_leafs = n;
+    for (i = 0; i < n; i++, d += DISK_LEAF) {
+        bsp_leaf_t *l = &map->leafs[i];
+
+        l->contents    = Bsp_Int(d);
+        l->first_brush = Bsp_UShort(d + 24);
+        l->num_brushes = Bsp_UShort(d + 26);
+        if (l->first_brush > map->num_leaf_brushes - l->num_brushes) {
+            Com_sprintf(err, errsize, "'%s' leaf %d out of range", path, i);
+            return false;
+        }
+    }
+
+    /* Nodes */
+    if (!Bsp_Lump(file, filelen, LUMP_NODES, DISK_NODE, &d, &n, path, err, errsize))
+        return false;
+    map->nodes = Bsp_Alloc(n, sizeof(bsp_node_t));
+    map->num_nodes = n;
+    for (i = 0; i < n; i++, d += DISK_NODE) {
+        bsp_node_t *node = &map->nodes[i];
+        int         plane = Bsp_Int(d);
+
+        if (plane < 0 || plane >= map->num_planes) {
+            Com_sprintf(err, errsize, "'%s' node %d out of range", path, i);
+            return false;
+        }
+        node->plane = &map->planes[plane];
+        for (j = 0; j < 2; j++) {
+            int child = Bsp_Int(d + 4 + j * 4);
+
+            /* Children point forward in the tree, so no loops */
+            if (child >= 0 ? (child <= i || child >= n)
+                           : (-1 - child >= map->num_leafs)) {
+                Com_sprintf(err, errsize, "'%s' node %d out of range", path, i);
+                return false;
+            }
+            node->children[j] = child;
+        }
+    }
+
+    /* World model */
+    if (!Bsp_Lump(file, filelen, LUMP_MODELS, DISK_MODEL, &d, &n, path, err, errsize))
+        return false;
+    if (n < 1) {
+        Com_sprintf(err, errsize, "'%s' has no world model", path);
+        return false;
+    }
+    for (j = 0; j < 3; j++) {
+        map->mins[j] = Bsp_Float(d + j * 4);
+        map->maxs[j] = Bsp_Float(d + 12 + j * 4);
+    }
+    map->headnode = Bsp_Int(d + 36);
+    if (map->headnode < 0 || map->headnode >= map->num_nodes) {
+        Com_sprintf(err, errsize, "'%s' world head node out of range", path);
+        return false;
+    }
+    return true;
+}
+
+qboolean Bsp_Load(const char *path, bsp_map_t *map, char *err, int errsize)
+{
+    FILE    *f;
+    byte    *file;
+    long     len;
+    qboolean ok;
+
+    memset(map, 0, sizeof(*map));
+
+    f = fopen(path, "rb");
+    if (!f) {
+        Com_sprintf(err, errsize, "cannot open '%s'", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (len < 8 + LUMP_COUNT * 8 || len > 0x7FFFFFFFL) {
+        fclose(f);
+        Com_sprintf(err, errsize, "'%s' truncated header", path);
+        return false;
+    }
+    file = malloc((size_t)len);
+    if (!file || fread(file, 1, (size_t)len, f) != (size_t)len) {
+        free(file);
+        fclose(f);
+        Com_sprintf(err, errsize, "cannot read '%s'", path);
+        return false;
+    }
+    fclose(f);
+
+    if (Bsp_Int(file) != BSP_IDENT) {
+        Com_sprintf(err, errsize, "'%s' is not a Quake 2 BSP", path);
+        ok = false;
+    } else if (Bsp_Int(file + 4) != BSP_VERSION) {
+        Com_sprintf(err, errsize, "'%s' unsupported BSP version %d", path,
+                    Bsp_Int(file + 4));
+        ok = false;
+    } else {
+        ok = Bsp_Parse(file, (int)len, map, path, err, errsize);
+    }
+
+    free(file);
+    if (!ok)
+        Bsp_Free(map);
+    return ok;
+}
+
+void Bsp_Free(bsp_map_t *map)
+{
+    free(map->planes);
+    free(map->nodes);
+    free(map->leafs);
+    free(map->leaf_brushes);
+    free(map->brushes);
+    free(map->sides);
+    free(map->surfaces);
+    free(map->entities);
+    memset(map, 0, sizeof(*map));
+}
+
+qboolean Bsp_TracerInit(bsp_tracer_t *t, const bsp_map_t *map)
+{
+    t->map   = map;
+    t->stamp = 0;
+    t->marks = Bsp_Alloc(map->num_brushes, sizeof(unsigned int));
+    return t->marks != NULL;
+}
+
+void Bsp_TracerFree(bsp_tracer_t *t)
+{
+    free(t->marks);
+    t->marks = NULL;
+}
+
+/* -----------------------------------------------------------------------
+   Queries
+   ----------------------------------------------------------------------- */
+
+/* Distance from plane p to v */
+static float Bsp_PlaneDist(const cplane_t *p, const vec3_t v)
+{
+    if (p->type < 3)
+        return v[p->type] - p->dist;
+    return DotProduct(p->normal, v) - p->dist;
+}
+
+int Bsp_PointContents(const bsp_map_t *map, const vec3_t p)
+{
+    int num = map->headnode;
+
+    if (!map->num_nodes)
+        return 0;
+    while (num >= 0) {
+        const bsp_node_t *node = &map->nodes[num];
+
+        num = node->children[Bsp_PlaneDist(node->plane, p) < 0.0f];
+    }
+    return map->leafs[-1 - num].contents;
+}
+
+/* Clip the swept box against brush b, keeping the earliest entry */
+static void Bsp_ClipToBrush(bsp_work_t *w, const bsp_brush_t *b)
+{
+    const bsp_map_t  *map = w->t->map;
+    const cplane_t   *clip = NULL;
+    const bsp_side_t *lead = NULL;
+    float    enter = -1.0f, leave = 1.0f;
+    qboolean get_out = false, start_out = false;
+    int      i, j;
+
+    for (i = 0; i < b->num_sides; i++) {
+        const bsp_side_t *side  = &map->sides[b->first_side + i];
+        const cplane_t   *plane = side->plane;
+        float dist = plane->dist, d1, d2, f;
+
+        if (!w->is_point) {
+            vec3_t ofs;
+
+            for (j = 0; j < 3; j++)
+                ofs[j] = plane->normal[j] < 0.0f ? w->maxs[j] : w->mins[j];
+            dist -= DotProduct(ofs, plane->normal);
+        }
+        d1 = DotProduct(w->start, plane->normal) - dist;
+        d2 = DotProduct(w->end, plane->normal) - dist;
+
+        if (d2 > 0.0f)
+            get_out = true;
+        if (d1 > 0.0f)
+            start_out = true;
+        if (d1 > 0.0f && d2 >= d1)
+            return;                          /* outside and moving away */
+        if (d1 <= 0.0f && d2 <= 0.0f)
+            continue;
+
+        if (d1 > d2) {
+            f = (d1 - BSP_DIST_EPSILON) / (d1 - d2);
+            if (f > enter) {
+                enter = f;
+                clip  = plane;
+                lead  = side;
+            }
+        } else {
+            f = (d1 + BSP_DIST_EPSILON) / (d1 - d2);
+            if (f < leave)
+                leave = f;
+        }
+    }
+
+    if (!start_out) {
+        w->trace.startsolid = true;
+        if (!get_out)
+            w->trace.allsolid = true;
+        return;
+    }
+    if (enter < leave && enter > -1.0f && enter < w->trace.fraction) {
+        w->trace.fraction = enter < 0.0f ? 0.0f : enter;
+        w->trace.plane    = *clip;
+        w->trace.surface  = lead->surface;
+        w->trace.contents = b->contents;
+    }
+}
+
+/* Position test: is the box at start inside brush b? */
+static void Bsp_TestInBrush(bsp_work_t *w, const bsp_brush_t *b)
+{
+    const bsp_map_t *map = w->t->map;
+    int i, j;
+
+    if (!b->num_sides)
+        return;
+    for (i = 0; i < b->num_sides; i++) {
+        const cplane_t *plane = map->sides[b->first_side + i].plane;
+        vec3_t ofs;
+
+        for (j = 0; j < 3; j++)
+            ofs[j] = plane->normal[j] < 0.0f ? w->maxs[j] : w->mins[j];
+        if (DotProduct(w->start, plane->normal) -
+            (plane->dist - DotProduct(ofs, plane->normal)) > 0.0f)
+            return;
+    }
+    w->trace.startsolid = w->trace.allsolid = true;
+    w->trace.fraction   = 0.0f;
+    w->trace.contents   = b->contents;
+}
+
+/* Clip or test against each brush of a leaf not already seen */
+static void Bsp_Leaf(bsp_work_t *w, int leafnum, qboolean test)
+{
+    const bsp_map_t  *map  = w->t->map;
+    const bsp_leaf_t *leaf = &map->leafs[leafnum];
+    int i;
+
+    if (!(leaf->contents & w->mask))
+        return;
+    for (i = 0; i < leaf->num_brushes; i++) {
+        int                k = map->leaf_brushes[leaf->first_brush + i];
+        const bsp_brush_t *b = &map->brushes[k];
+
+        if (w->t->marks[k] == w->t->stamp)
+            continue;
+        w->t->marks[k] = w->t->stamp;
+        if (!(b->contents & w->mask))
+            continue;
+        if (test)
+            Bsp_TestInBrush(w, b);
+        else
+            Bsp_ClipToBrush(w, b);
+        if (w->trace.fraction == 0.0f)
+            return;
+    }
+}
+
+/* Leafs the box lo..hi touches under node num */
+static void Bsp_BoxLeafs(const bsp_map_t *map, int num, const vec3_t lo,
+                         const vec3_t hi, int *leafs, int *count)
+{
+    while (num >= 0) {
+        const bsp_node_t *node  = &map->nodes[num];
+        const cplane_t   *plane = node->plane;
+        float front, back;
+        int   j;
+
+        /* Signed distance of the box's most positive and negative corners */
+        front = back = -plane->dist;
+        for (j = 0; j < 3; j++) {
+            front += plane->normal[j] * (plane->normal[j] < 0.0f ? lo[j] : hi[j]);
+            back  += plane->normal[j] * (plane->normal[j] < 0.0f ? hi[j] : lo[j]);
+        }
+        if (back >= 0.0f) {
+            num = node->children[0];
+        } else if (front < 0.0f) {
+            num = node->children[1];
+        } else {
+            Bsp_BoxLeafs(map, node->children[0], lo, hi, leafs, count);
+            num = node->children[1];
+        }
+    }
+    if (*count < BSP_MAX_LEAFS)
+        leafs[(*count)++] = -1 - num;
+}
+
+/* Push the segment p1..p2 (fractions f1..f2 of the trace) down the tree */
+static void Bsp_HullCheck(bsp_work_t *w, int num, float f1, float f2,
+                          const vec3_t p1, const vec3_t p2)
+{
+    const bsp_node_t *node;
+    const cplane_t   *plane;
+    float  t1, t2, offset, frac, frac2, idist, midf;
+    vec3_t mid;
+    int    side, i;
+
+    if (w->trace.fraction <= f1)
+        return;                              /* already hit something nearer */
+    if (num < 0) {
+        Bsp_Leaf(w, -1 - num, false);
+        return;
+    }
+
+    node  = &w->t->map->nodes[num];
+    plane = node->plane;
+    t1 = Bsp_PlaneDist(plane, p1);
+    t2 = Bsp_PlaneDist(plane, p2);
+    if (plane->type < 3)
+        offset = w->extents[plane->type];
+    else if (w->is_point)
+        offset = 0.0f;
+    else
+        offset = fabsf(w->extents[0] * plane->normal[0]) +
+                 fabsf(w->extents[1] * plane->normal[1]) +
+                 fabsf(w->extents[2] * plane->normal[2]);
+
+    if (t1 >= offset && t2 >= offset) {
+        Bsp_HullCheck(w, node->children[0], f1, f2, p1, p2);
+        return;
+    }
+    if (t1 < -offset && t2 < -offset) {
+        Bsp_HullCheck(w, node->children[1], f1, f2, p1, p2);
+        return;
+    }
+
+    /* Split, with each half overlapping the plane by the extent */
+    if (t1 < t2) {
+        idist = 1.0f / (t1 - t2);
+        side  = 1;
+        frac2 = (t1 + offset + BSP_DIST_EPSILON) * idist;
+        frac  = (t1 - offset + BSP_DIST_EPSILON) * idist;
+    } else if (t1 > t2) {
+        idist = 1.0f / (t1 - t2);
+        side  = 0;
+        frac2 = (t1 - offset - BSP_DIST_EPSILON) * idist;
+        frac  = (t1 + offset + BSP_DIST_EPSILON) * idist;
+    } else {
+        side  = 0;
+        frac  = 1.0f;
+        frac2 = 0.0f;
+    }
+
+    if (frac < 0.0f) frac = 0.0f;
+    if (frac > 1.0f) frac = 1.0f;
+    midf = f1 + (f2 - f1) * frac;
+    for (i = 0; i < 3; i++)
+        mid[i] = p1[i] + frac * (p2[i] - p1[i]);
+    Bsp_HullCheck(w, node->children[side], f1, midf, p1, mid);
+
+    if (frac2 < 0.0f) frac2 = 0.0f;
+    if (frac2 > 1.0f) frac2 = 1.0f;
+    midf = f1 + (f2 - f1) * frac2;
+    for (i = 0; i < 3; i++)
+        mid[i] = p1[i] + frac2 * (p2[i] - p1[i]);
+    Bsp_HullCheck(w, node->children[side ^ 1], midf, f2, mid, p2);
+}
+
+trace_t Bsp_Trace(bsp_tracer_t *t, const vec3_t start, const vec3_t mins,
+                  const vec3_t maxs, const vec3_t end, int mask)
+{
+    bsp_work_t w;
+    int        i;
+
+    memset(&w.trace, 0, sizeof(w.trace));
+    w.trace.fraction = 1.0f;
+    w.trace.surface  = &s_null_surface;
+    if (!t->map->num_nodes) {
+        VectorCopy(end, w.trace.endpos);
+        return w.trace;
+    }
+
+    w.t    = t;
+    w.mask = mask;
+    VectorCopy(start, w.start);
+    VectorCopy(end, w.end);
+    VectorCopy(mins, w.mins);
+    VectorCopy(maxs, w.maxs);
+    if (++t->stamp == 0) {
+        memset(t->marks, 0, sizeof(t->marks[0]) * (size_t)t->map->num_brushes);
+        t->stamp = 1;
+    }
+
+    if (start[0] == end[0] && start[1] == end[1] && start[2] == end[2]) {
+        int    leafs[BSP_MAX_LEAFS], count = 0;
+        vec3_t lo, hi;
+
+        for (i = 0; i < 3; i++) {
+            lo[i] = start[i] + mins[i] - 1.0f;
+            hi[i] = start[i] + maxs[i] + 1.0f;
+        }
+        Bsp_BoxLeafs(t->map, t->map->headnode, lo, hi, leafs, &count);
+        for (i = 0; i < count && !w.trace.allsolid; i++)
+            Bsp_Leaf(&w, leafs[i], true);
+        VectorCopy(start, w.trace.endpos);
+        return w.trace;
+    }
+
+    w.is_point = true;
+    for (i = 0; i < 3; i++) {
+        w.extents[i] = -mins[i] > maxs[i] ? -mins[i] : maxs[i];
+        if (mins[i] != 0.0f || maxs[i] != 0.0f)
+            w.is_point = false;
+    }
+
+    Bsp_HullCheck(&w, t->map->headnode, 0.0f, 1.0f, start, end);
+    if (w.trace.fraction == 1.0f) {
+        VectorCopy(end, w.trace.endpos);
+    } else {
+        for (i = 0; i < 3; i++)
+            w.trace.endpos[i] = start[i] + w.trace.fraction * (end[i] - start[i]);
+    }
+    return w.trace;
+}
@@ -0,0 +1,95 @@
+/*
+ * bot_bsp.h -- Quake 2 BSP (IBSP v38) collision model for offline tools
+ *
+ * Nav analysis that needs gi.trace (node generation, node-to-node
+ * visibility) cannot run without an engine.  This reads the collision
+ * lumps of a compiled map (planes, nodes, leafs, leaf brushes, brushes,
+ * brush sides, texinfo and the world model) and traces boxes through
+ * them the way the engine's collision model does, so tools/navtool
+ * sees the same walls the server will.
+ *
+ * A loaded map is read-only and may be shared between threads.  Tracing
+ * needs a per-thread bsp_tracer_t, which holds the marks that stop a
+ * brush from being clipped twice in one trace.  Only the world model
+ * is loaded: doors, lifts and other brush entities are not solid here.
+ *
+ * The file is decoded byte by byte as little-endian, so this also works
+ * on big-endian hosts.  Not part of the game DLL.
+ */
+
+#ifndef BOT_BSP_H
+#define BOT_BSP_H
+
+#include "q_shared.h"
+
+#define BSP_IDENT    0x50534249  /* "IBSP" little-endian */
+#define BSP_VERSION  38
+
+typedef struct {
+    cplane_t *plane;
+    int       children[2];       /* negative: -1 - leaf index */
+} bsp_node_t;
+
+typedef struct {
+    int contents;
+    int first_brush;             /* into leaf_brushes */
+    int num_brushes;
+} bsp_leaf_t;
+
+typedef struct {
+    cplane_t   *plane;
+    csurface_t *surface;
+} bsp_side_t;
+
+typedef struct {
+    int contents;
+    int first_side;
+    int num_sides;
+} bsp_brush_t;
+
+typedef struct {
+    cplane_t       *planes;
+    bsp_node_t     *nodes;
+    bsp_leaf_t     *leafs;
+    unsigned short *leaf_brushes;
+    bsp_brush_t    *brushes;
+    bsp_side_t     *sides;
+    csurface_t     *surfaces;
+    int             num_planes, num_nodes, num_leafs, num_leaf_brushes;
+    int             num_brushes, num_sides, num_surfaces;
+    int             headnode;    /* of the world model */
+    vec3_t          mins, maxs;  /* world model bounds */
+    char           *entities;    /* entity lump, NUL-terminated */
+} bsp_map_t;
+
+typedef struct {
+    const bsp_map_t *map;
+    unsigned int    *marks;      /* per brush; == stamp once clipped */
+    unsigned int     stamp;
+} bsp_tracer_t;
+
+/*
+ * Read the collision model and entity string of path into map (the
+ * string is what the engine hands SpawnEntities).  Returns false with err
+ * filled in if the file cannot be read, is not IBSP v38, or has a lump
+ * or index out of range.  Free with Bsp_Free.
+ */
+qboolean Bsp_Load(const char *path, bsp_map_t *map, char *err, int errsize);
+void     Bsp_Free(bsp_map_t *map);
+
+/* Per-thread trace scratch for map; false if out of memory. */
+qboolean Bsp_TracerInit(bsp_tracer_t *t, const bsp_map_t *map);
+void     Bsp_TracerFree(bsp_tracer_t *t);
+
+/*
+ * Sweep the box mins..maxs from start to end against the brushes whose
+ * contents match mask, like gi.trace with no entities.  start == end is
+ * a position test.  surface is never NULL.
+ */
+trace_t  Bsp_Trace(bsp_tracer_t *t, const vec3_t start, const vec3_t mins,
+                   const vec3_t maxs, const vec3_t end, int mask);
+
+/* Contents of the leaf holding p, like gi.pointcontents. */
+int      Bsp_PointContents(const bsp_map_t *map, const vec3_t p);
+
+#endif /* BOT_BSP_H */
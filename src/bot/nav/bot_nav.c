@@ -15,25 +15,177 @@
  *  - BotNav_UpdateWallWalk() is called each think tick for alien bots;
  *    it fires a surface-normal trace and updates nav.wall_walking and
  *    nav.wall_normal accordingly.
+ *
+ *  - Path following steers at a "carrot" a fixed distance ahead along
+ *    the path polyline rather than at the next waypoint, so bots round
+ *    corners smoothly.  Corners are only cut across walk/fly/swim edges;
+ *    jump, ladder and climb edges must be entered from their start node,
+ *    and bots slow down as they approach one.
+ *
+ *  - Path following runs a progress monitor.  A bot that stops closing
+ *    on its next waypoint works through a ladder of cheap local escapes
+ *    (strafe, jump, skip a waypoint, back away from it) before paying
+ *    for a global replan.  Each stuck event is tallied against the edge
+ *    being traversed so bad links can be found and fixed offline.
  */
 
 #include "bot_nav.h"
+#include "bot_path.h"
+#include "bot_navcache.h"
+#include "bot_navlearn.h"
+#include "bot_navdist.h"
+#include "bot_navfly.h"
+#include "bot_navnear.h"
+#include "bot_navpack.h"
+#include "bot_debug.h"
+#include "bot_team.h"
 #include <float.h>
+#include <stdio.h>
 
 /* Default movement speed for path following (units/sec) */
 #define BOT_MOVEMENT_SPEED 300.0f
 
+/* Lookahead path following */
+#define BOT_LOOKAHEAD_DIST  128.0f  /* carrot distance along the path        */
+#define BOT_LOOKAHEAD_MIN   32.0f   /* shortest pulled-back carrot distance  */
+#define BOT_SLOWDOWN_DIST   128.0f  /* start braking this far from a hard edge */
+#define BOT_SLOWDOWN_MIN    0.35f   /* speed fraction when at the hard edge   */
+
+/* Stuck detection / recovery tuning */
+#define BOT_STUCK_SAMPLE_INTERVAL 0.25f  /* seconds between progress samples  */
+#define BOT_STUCK_MIN_PROGRESS    16.0f  /* units gained across a full window */
+#define BOT_ESCAPE_TIME           0.5f   /* seconds an escape move is held    */
+#define BOT_ESCAPE_JUMP_SPEED     270.0f /* upward velocity for a jump escape */
+
+/* Rungs of the recovery ladder, cheapest first */
+enum {
+    BOT_STUCK_STRAFE,
+    BOT_STUCK_JUMP,
+    BOT_STUCK_SKIP,
+    BOT_STUCK_BACKOFF,
+    BOT_STUCK_REPLAN
+};
+
+/* Map whose graph is loading or live; names the derived-data cache */
+static char s_nav_mapname[MAX_QPATH];
+
+/* Per-edge stuck tallies, indexed like nav_nodes[from].neighbors[] */
+static unsigned short s_stuck_hits[MAX_NAV_NODES][MAX_NODE_NEIGHBORS];
+
+/* Long queries: straight-line distance at which search goes bidirectional */
+#define BOT_NAV_BIDIR_DIST    2048.0f
+#define BOT_NAV_BIDIR_SAMPLE  16     /* 1 in N also runs A* to measure savings */
+
+/* Incoming edges of the live graph, CSR by target slot (BotNav_SearchBidir) */
+static int            s_rev_start[MAX_NAV_NODES + 1];
+static unsigned short s_rev_from[MAX_NAV_NODES * MAX_NODE_NEIGHBORS];
+static unsigned char  s_rev_slot[MAX_NAV_NODES * MAX_NODE_NEIGHBORS];
+static const nav_node_t *s_rev_bank;
+static unsigned int   s_rev_version;
+
+/* Node expansions by every search; read around a query to count it */
+static unsigned int   s_expanded;
+
+/* Search counters for "sv navstats", reset with each map */
+static struct {
+    unsigned int astar, astar_expanded;
+    unsigned int bidir, bidir_expanded;
+    unsigned int sampled, sampled_bidir, sampled_astar;
+} s_search_stats;
+
 void BotNav_Init(void)
 {
+    BotPath_Clear();
     gi.dprintf("BotNav_Init: navigation subsystem ready\n");
 }
 
+/*
+ * Derived per-map data is rebuilt here, on the server thread, whenever a
+ * freshly loaded graph goes live.
+ */
+static void BotNav_OnGraphLoaded(void)
+{
+    vec3_t mins, maxs;
+    int    i, j, count = 0;
+
+    BotNav_ClearStuckHotspots();
+    BotPath_Clear();
+    BotNavCache_Attach(s_nav_mapname);
+    BotNavDist_BuildAll();
+    BotMapControl_Init();
+
+    /* Flight octree over the graph's bounds, built over the next frames */
+    for (i = 0; i < nav_node_count; i++) {
+        if (nav_nodes[i].id == BOT_INVALID_NODE)
+            continue;
+        for (j = 0; j < 3; j++) {
+            if (!count || nav_nodes[i].origin[j] < mins[j])
+                mins[j] = nav_nodes[i].origin[j];
+            if (!count || nav_nodes[i].origin[j] > maxs[j])
+                maxs[j] = nav_nodes[i].origin[j];
+        }
+        count++;
+    }
+    if (count)
+        BotNavFly_Begin(mins, maxs);
+}
+
+/*
+ * Start loading the map's graph in the background.  The old graph is
+ * dropped straight away so no bot paths through stale nodes; bots fall
+ * back to direct movement until BotNav_Frame publishes the new one.
+ */
 void BotNav_LoadMap(const char *mapname)
 {
+    Com_sprintf(s_nav_mapname, sizeof(s_nav_mapname), "%s", mapname);
+    BotNav_ClearStuckHotspots();
+    BotNavLearn_Clear();
+    BotPath_Clear();
     Node_Clear();
-    if (!Node_Load(mapname))
+    BotNavDist_Clear();
+    BotNavNear_Clear();
+    BotNavFly_Clear();
+    BotMapControl_Init();
+    BotNav_ResetSearchStats();
+    if (!Node_LoadAsync(mapname))
         gi.dprintf("BotNav_LoadMap: '%s' (no nav file — bots will roam freely)\n",
                    mapname);
+    else if (!Node_LoadPending())
+        BotNav_OnGraphLoaded();     /* fell back to a synchronous load */
+}
+
+/* Called once per server frame before any bot thinks. */
+void BotNav_Frame(void)
+{
+    switch (Node_PollLoad()) {
+    case NODE_LOAD_PUBLISHED:
+        BotNav_OnGraphLoaded();
+        break;
+    case NODE_LOAD_FAILED:
+        gi.dprintf("BotNav_LoadMap: no usable nav file — bots will roam freely\n");
+        break;
+    default:
+        break;
+    }
+
+    BotNavLearn_Frame();
+    BotNavDist_Frame();
+    BotNavFly_Frame();
+}
+
+/* Block until a pending load is live; true if a graph was published. */
+qboolean BotNav_WaitLoad(void)
+{
+    switch (Node_WaitLoad()) {
+    case NODE_LOAD_PUBLISHED:
+        BotNav_OnGraphLoaded();
+        return true;
+    case NODE_LOAD_FAILED:
+        gi.dprintf("BotNav_LoadMap: no usable nav file — bots will roam freely\n");
+        return false;
+    default:
+        return false;
+    }
 }
 
 /*
@@ -46,29 +198,6 @@ typedef struct {
     float f_cost;   /* g_cost + heuristic to goal   */
 } astar_entry_t;
 
-/*
- * BotNav_CanTraverse
- * Returns true if the bot is capable of traversing the given edge
- * movement type.  Wall-climb edges require Bot_CanWallWalk, and
- * fly edges require Gloom_ClassCanFly.
- */
-static qboolean BotNav_CanTraverse(const bot_state_t *bs, int move_type)
-{
-    switch (move_type) {
-    case NAV_MOVE_WALK:
-    case NAV_MOVE_JUMP:
-    case NAV_MOVE_SWIM:
-    case NAV_MOVE_LADDER:
-        return true;
-    case NAV_MOVE_CLIMB:
-        return Bot_CanWallWalk(bs);
-    case NAV_MOVE_FLY:
-        return Gloom_ClassCanFly(bs->gloom_class) ? true : false;
-    default:
-        return true;
-    }
-}
-
 /*
  * BotNav_Heuristic
  * Euclidean distance heuristic between two world positions.
@@ -80,42 +209,75 @@ static float BotNav_Heuristic(vec3_t a, vec3_t b)
     return VectorLength(delta);
 }
 
-void BotNav_FindPath(bot_state_t *bs, vec3_t goal)
+/*
+ * BotNav_ClearPath
+ * Drop the bot's reference to its current path.
+ */
+void BotNav_ClearPath(bot_state_t *bs)
 {
-    static astar_entry_t open_set[MAX_NAV_NODES];
-    static float         g_cost[MAX_NAV_NODES];
-    static int           came_from[MAX_NAV_NODES];
-    static qboolean      closed[MAX_NAV_NODES];
-    int  open_count = 0;
-    int  start_node, goal_node;
-    int  current, i, j;
-    qboolean can_wall = Bot_CanWallWalk(bs);
-
-    VectorCopy(goal, bs->nav.goal_origin);
-    bs->nav.goal_node  = BOT_INVALID_NODE;
-    bs->nav.path_valid = false;
-    bs->nav.path_length = 0;
+    BotPath_Release(bs->nav.path_handle);
+    bs->nav.path_handle = BOT_PATH_NONE;
     bs->nav.path_index  = 0;
+    bs->nav.path_valid  = false;
+    bs->nav.fly_count   = 0;
+    bs->nav.fly_index   = 0;
+}
 
-    if (nav_node_count == 0)
-        return;  /* no nav data — bot will roam freely */
-
-    start_node = BotNav_NearestNode(bs->ent->s.origin, can_wall);
-    goal_node  = BotNav_NearestNode(goal, can_wall);
+/*
+ * BotNav_SetPath
+ * Point the bot at a shared path handle (already retained) with its
+ * cursor at the given index.
+ */
+static void BotNav_SetPath(bot_state_t *bs, int handle, int cursor,
+                           int goal_node)
+{
+    if (handle == BOT_PATH_NONE)
+        return;
+    bs->nav.path_handle = handle;
+    bs->nav.path_index  = cursor;
+    bs->nav.goal_node   = goal_node;
+    bs->nav.path_valid  = true;
+}
 
-    if (start_node == BOT_INVALID_NODE || goal_node == BOT_INVALID_NODE)
-        return;  /* disconnected or no nearby nodes */
+/*
+ * BotNav_BuildPath
+ * Walk came_from back from goal_node and write the path start-first.
+ */
+static int BotNav_BuildPath(const int *came_from, int start_node,
+                            int goal_node, int *path)
+{
+    int path_buf[BOT_MAX_PATH_NODES];
+    int path_len = 0;
+    int node = goal_node;
+    int i;
 
-    if (start_node == goal_node) {
-        bs->nav.goal_node    = goal_node;
-        bs->nav.path[0]      = goal_node;
-        bs->nav.path_length  = 1;
-        bs->nav.path_index   = 0;
-        bs->nav.path_valid   = true;
-        return;
+    while (node != BOT_INVALID_NODE && path_len < BOT_MAX_PATH_NODES) {
+        path_buf[path_len++] = node;
+        if (node == start_node) break;
+        node = came_from[node];
     }
 
-    /* Initialise A* data structures */
+    for (i = 0; i < path_len; i++)
+        path[i] = path_buf[path_len - 1 - i];
+    return path_len;
+}
+
+/*
+ * BotNav_Search
+ * A* over the float graph.  Routing uses the packed graph
+ * (BotNavPack_Search); this is the reference the "sv navstats" sample
+ * measures the bidirectional search against, on the same costs.
+ */
+int BotNav_Search(int start_node, int goal_node, unsigned int caps, int *path)
+{
+    static astar_entry_t open_set[MAX_NAV_NODES];
+    static float         g_cost[MAX_NAV_NODES];
+    static int           came_from[MAX_NAV_NODES];
+    static qboolean      closed[MAX_NAV_NODES];
+    const unsigned int   denied = ~caps;
+    int  open_count;
+    int  current, i, j;
+
     for (i = 0; i < nav_node_count; i++) {
         g_cost[i]    = FLT_MAX;
         came_from[i] = BOT_INVALID_NODE;
@@ -126,13 +288,15 @@ void BotNav_FindPath(bot_state_t *bs, vec3_t goal)
     open_set[0].node_id = start_node;
     open_set[0].g_cost  = 0.0f;
     open_set[0].f_cost  = BotNav_Heuristic(nav_nodes[start_node].origin,
-                                            nav_nodes[goal_node].origin);
+                                           nav_nodes[goal_node].origin);
     open_count = 1;
 
     while (open_count > 0) {
-        /* Find the entry with lowest f_cost */
+        const nav_node_t *n;
         int   best_idx = 0;
         float best_f   = open_set[0].f_cost;
+
+        /* Find the entry with lowest f_cost */
         for (i = 1; i < open_count; i++) {
             if (open_set[i].f_cost < best_f) {
                 best_f   = open_set[i].f_cost;
@@ -146,37 +310,22 @@ void BotNav_FindPath(bot_state_t *bs, vec3_t goal)
         open_set[best_idx] = open_set[open_count - 1];
         open_count--;
 
-        if (current == goal_node) {
-            /* Reconstruct path in reverse */
-            int path_buf[BOT_MAX_PATH_NODES];
-            int path_len = 0;
-            int node = goal_node;
-
-            while (node != BOT_INVALID_NODE && path_len < BOT_MAX_PATH_NODES) {
-                path_buf[path_len++] = node;
-                if (node == start_node) break;
-                node = came_from[node];
-            }
-
-            /* Reverse into bs->nav.path */
-            bs->nav.path_length = path_len;
-            for (i = 0; i < path_len; i++)
-                bs->nav.path[i] = path_buf[path_len - 1 - i];
-
-            bs->nav.goal_node  = goal_node;
-            bs->nav.path_index = 0;
-            bs->nav.path_valid = true;
-            return;
-        }
+        if (current == goal_node)
+            return BotNav_BuildPath(came_from, start_node, goal_node, path);
 
         closed[current] = true;
+        s_expanded++;
+        n = &nav_nodes[current];
 
         /* Expand neighbors */
-        for (j = 0; j < nav_nodes[current].num_neighbors; j++) {
-            int   neighbor = nav_nodes[current].neighbors[j];
-            float edge_cost;
+        for (j = 0; j < n->num_neighbors; j++) {
+            int   neighbor = n->neighbors[j];
             float tentative_g;
+            float f;
 
+            /* Check movement capability */
+            if (n->edge_caps[j] & denied)
+                continue;
             if (neighbor < 0 || neighbor >= nav_node_count)
                 continue;
             if (nav_nodes[neighbor].id == BOT_INVALID_NODE)
@@ -184,13 +333,7 @@ void BotNav_FindPath(bot_state_t *bs, vec3_t goal)
             if (closed[neighbor])
                 continue;
 
-            /* Check movement capability */
-            if (!BotNav_CanTraverse(bs, nav_nodes[current].movement_required[j]))
-                continue;
-
-            edge_cost   = nav_nodes[current].neighbor_costs[j];
-            tentative_g = g_cost[current] + edge_cost;
-
+            tentative_g = g_cost[current] + n->neighbor_costs[j];
             if (tentative_g >= g_cost[neighbor])
                 continue;
 
@@ -198,71 +341,877 @@ void BotNav_FindPath(bot_state_t *bs, vec3_t goal)
             came_from[neighbor] = current;
 
             /* Add to open set (or update existing entry) */
-            {
-                float f = tentative_g +
-                          BotNav_Heuristic(nav_nodes[neighbor].origin,
-                                           nav_nodes[goal_node].origin);
-                qboolean found = false;
-                for (i = 0; i < open_count; i++) {
-                    if (open_set[i].node_id == neighbor) {
-                        open_set[i].g_cost = tentative_g;
-                        open_set[i].f_cost = f;
-                        found = true;
-                        break;
-                    }
+            f = tentative_g + BotNav_Heuristic(nav_nodes[neighbor].origin,
+                                               nav_nodes[goal_node].origin);
+            for (i = 0; i < open_count; i++) {
+                if (open_set[i].node_id == neighbor)
+                    break;
+            }
+            if (i == open_count) {
+                if (open_count >= MAX_NAV_NODES)
+                    continue;
+                open_set[i].node_id = neighbor;
+                open_count++;
+            }
+            open_set[i].g_cost = tentative_g;
+            open_set[i].f_cost = f;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * BotNav_BuildReverse
+ * (Re)build the incoming-edge index if the graph changed since the last
+ * bidirectional search.  Each entry names the source slot and its edge
+ * index, so cost and edge_caps are read from the forward arrays.
+ */
+static void BotNav_BuildReverse(void)
+{
+    static int fill[MAX_NAV_NODES];
+    int i, j, total;
+
+    if (s_rev_bank == nav_nodes && s_rev_version == nav_graph_version)
+        return;
+
+    memset(fill, 0, sizeof(fill));
+    for (i = 0; i < nav_node_count; i++) {
+        if (nav_nodes[i].id == BOT_INVALID_NODE)
+            continue;
+        for (j = 0; j < nav_nodes[i].num_neighbors; j++) {
+            int to = nav_nodes[i].neighbors[j];
+            if (to >= 0 && to < nav_node_count)
+                fill[to]++;
+        }
+    }
+
+    total = 0;
+    for (i = 0; i < nav_node_count; i++) {
+        s_rev_start[i] = total;
+        total  += fill[i];
+        fill[i] = s_rev_start[i];
+    }
+    s_rev_start[nav_node_count] = total;
+
+    for (i = 0; i < nav_node_count; i++) {
+        if (nav_nodes[i].id == BOT_INVALID_NODE)
+            continue;
+        for (j = 0; j < nav_nodes[i].num_neighbors; j++) {
+            int to = nav_nodes[i].neighbors[j];
+            if (to < 0 || to >= nav_node_count)
+                continue;
+            s_rev_from[fill[to]] = (unsigned short)i;
+            s_rev_slot[fill[to]] = (unsigned char)j;
+            fill[to]++;
+        }
+    }
+
+    s_rev_bank    = nav_nodes;
+    s_rev_version = nav_graph_version;
+}
+
+int BotNav_Incoming(int node, const unsigned short **from,
+                    const unsigned char **slot)
+{
+    BotNav_BuildReverse();
+    *from = &s_rev_from[s_rev_start[node]];
+    *slot = &s_rev_slot[s_rev_start[node]];
+    return s_rev_start[node + 1] - s_rev_start[node];
+}
+
+/* Take the lowest-key entry out of an open set. */
+static int BotNav_PopOpen(astar_entry_t *open_set, int *open_count)
+{
+    int best_idx = 0;
+    int i, node;
+
+    for (i = 1; i < *open_count; i++) {
+        if (open_set[i].f_cost < open_set[best_idx].f_cost)
+            best_idx = i;
+    }
+    node = open_set[best_idx].node_id;
+    open_set[best_idx] = open_set[--(*open_count)];
+    return node;
+}
+
+/* Lowest key in a non-empty open set. */
+static float BotNav_MinOpen(const astar_entry_t *open_set, int open_count)
+{
+    float best = open_set[0].f_cost;
+    int   i;
+
+    for (i = 1; i < open_count; i++) {
+        if (open_set[i].f_cost < best)
+            best = open_set[i].f_cost;
+    }
+    return best;
+}
+
+/* Insert node with key f, or lower the key of its existing entry. */
+static void BotNav_PushOpen(astar_entry_t *open_set, int *open_count,
+                            int node, float g, float f)
+{
+    int i;
+
+    for (i = 0; i < *open_count; i++) {
+        if (open_set[i].node_id == node)
+            break;
+    }
+    if (i == *open_count) {
+        if (*open_count >= MAX_NAV_NODES)
+            return;
+        open_set[i].node_id = node;
+        (*open_count)++;
+    }
+    open_set[i].g_cost = g;
+    open_set[i].f_cost = f;
+}
+
+/*
+ * Potential for bidirectional A*: half the difference of the distances
+ * to goal and to start.  The forward search keys nodes by g + p(v) and
+ * the backward one by g - p(v), so both run on the same non-negative
+ * reduced costs and the plain bidirectional Dijkstra stopping rule
+ * (top_f + top_b >= best meeting cost) stays exact.
+ */
+static float BotNav_BidirPotential(int node, int start_node, int goal_node)
+{
+    return 0.5f * (BotNav_Heuristic(nav_nodes[node].origin,
+                                    nav_nodes[goal_node].origin) -
+                   BotNav_Heuristic(nav_nodes[node].origin,
+                                    nav_nodes[start_node].origin));
+}
+
+/*
+ * BotNav_SearchBidir
+ * Bidirectional A* for long queries.  The backward search walks the
+ * incoming-edge index, so one-way links (drops) and edge_caps are
+ * honoured from both ends.  Each step expands the side with the smaller
+ * frontier.  Same contract as BotNav_Search.
+ */
+int BotNav_SearchBidir(int start_node, int goal_node, unsigned int caps,
+                       int *path)
+{
+    static astar_entry_t open_f[MAX_NAV_NODES], open_b[MAX_NAV_NODES];
+    static float         dist_f[MAX_NAV_NODES], dist_b[MAX_NAV_NODES];
+    static int           prev_f[MAX_NAV_NODES], next_b[MAX_NAV_NODES];
+    static qboolean      closed_f[MAX_NAV_NODES], closed_b[MAX_NAV_NODES];
+    const unsigned int   denied = ~caps;
+    int   count_f = 0, count_b = 0;
+    int   meet = BOT_INVALID_NODE;
+    float best = FLT_MAX;
+    int   path_buf[BOT_MAX_PATH_NODES];
+    int   len, node, i, k;
+
+    if (start_node == goal_node) {
+        path[0] = start_node;
+        return 1;
+    }
+
+    BotNav_BuildReverse();
+
+    for (i = 0; i < nav_node_count; i++) {
+        dist_f[i]   = dist_b[i]   = FLT_MAX;
+        prev_f[i]   = next_b[i]   = BOT_INVALID_NODE;
+        closed_f[i] = closed_b[i] = false;
+    }
+
+    dist_f[start_node] = 0.0f;
+    dist_b[goal_node]  = 0.0f;
+    BotNav_PushOpen(open_f, &count_f, start_node, 0.0f,
+                    BotNav_BidirPotential(start_node, start_node, goal_node));
+    BotNav_PushOpen(open_b, &count_b, goal_node, 0.0f,
+                    -BotNav_BidirPotential(goal_node, start_node, goal_node));
+
+    while (count_f > 0 && count_b > 0) {
+        if (BotNav_MinOpen(open_f, count_f) +
+            BotNav_MinOpen(open_b, count_b) >= best)
+            break;
+
+        if (count_f <= count_b) {
+            const nav_node_t *n;
+            int u = BotNav_PopOpen(open_f, &count_f);
+
+            closed_f[u] = true;
+            s_expanded++;
+            n = &nav_nodes[u];
+
+            for (k = 0; k < n->num_neighbors; k++) {
+                int   v = n->neighbors[k];
+                float g;
+
+                if (n->edge_caps[k] & denied)
+                    continue;
+                if (v < 0 || v >= nav_node_count)
+                    continue;
+                if (nav_nodes[v].id == BOT_INVALID_NODE || closed_f[v])
+                    continue;
+
+                g = dist_f[u] + n->neighbor_costs[k];
+                if (g >= dist_f[v])
+                    continue;
+                dist_f[v] = g;
+                prev_f[v] = u;
+                BotNav_PushOpen(open_f, &count_f, v, g,
+                                g + BotNav_BidirPotential(v, start_node, goal_node));
+                if (dist_b[v] < FLT_MAX && g + dist_b[v] < best) {
+                    best = g + dist_b[v];
+                    meet = v;
                 }
-                if (!found && open_count < MAX_NAV_NODES) {
-                    open_set[open_count].node_id = neighbor;
-                    open_set[open_count].g_cost  = tentative_g;
-                    open_set[open_count].f_cost  = f;
-                    open_count++;
+            }
+        } else {
+            int u = BotNav_PopOpen(open_b, &count_b);
+
+            closed_b[u] = true;
+            s_expanded++;
+
+            for (k = s_rev_start[u]; k < s_rev_start[u + 1]; k++) {
+                int               w = s_rev_from[k];
+                int               j = s_rev_slot[k];
+                const nav_node_t *n = &nav_nodes[w];
+                float             g;
+
+                if (n->edge_caps[j] & denied)
+                    continue;
+                if (closed_b[w])
+                    continue;
+
+                g = dist_b[u] + n->neighbor_costs[j];
+                if (g >= dist_b[w])
+                    continue;
+                dist_b[w] = g;
+                next_b[w] = u;
+                BotNav_PushOpen(open_b, &count_b, w, g,
+                                g - BotNav_BidirPotential(w, start_node, goal_node));
+                if (dist_f[w] < FLT_MAX && g + dist_f[w] < best) {
+                    best = g + dist_f[w];
+                    meet = w;
                 }
             }
         }
     }
 
+    if (meet == BOT_INVALID_NODE)
+        return 0;
+
+    /* start .. meet from the forward tree, then meet .. goal backward */
+    len  = 0;
+    node = meet;
+    while (node != BOT_INVALID_NODE && len < BOT_MAX_PATH_NODES) {
+        path_buf[len++] = node;
+        if (node == start_node) break;
+        node = prev_f[node];
+    }
+    for (i = 0; i < len; i++)
+        path[i] = path_buf[len - 1 - i];
+
+    for (node = next_b[meet]; node != BOT_INVALID_NODE &&
+                              len < BOT_MAX_PATH_NODES; node = next_b[node])
+        path[len++] = node;
+
+    return len;
+}
+
+/*
+ * BotNav_Route
+ * Pick the search for a query: bidirectional when start and goal are
+ * BOT_NAV_BIDIR_DIST or more apart (several zone seeds), A* on the
+ * packed graph (bot_navpack.h) otherwise.
+ * One long query in BOT_NAV_BIDIR_SAMPLE is also run through the float
+ * A* so "sv navstats" can report the expansions the bidirectional search
+ * saved.
+ */
+static int BotNav_Route(int start_node, int goal_node, unsigned int caps,
+                        int *path)
+{
+    unsigned int before = s_expanded;
+    int          len;
+
+    if (BotNav_Heuristic(nav_nodes[start_node].origin,
+                         nav_nodes[goal_node].origin) < BOT_NAV_BIDIR_DIST) {
+        len = BotNavPack_Search(start_node, goal_node, caps, false, path,
+                                &s_expanded);
+        s_search_stats.astar++;
+        s_search_stats.astar_expanded += s_expanded - before;
+        return len;
+    }
+
+    len = BotNav_SearchBidir(start_node, goal_node, caps, path);
+    s_search_stats.bidir++;
+    s_search_stats.bidir_expanded += s_expanded - before;
+
+    if (s_search_stats.bidir % BOT_NAV_BIDIR_SAMPLE == 1) {
+        static int scratch[BOT_MAX_PATH_NODES];
+        unsigned int mid = s_expanded;
+
+        BotNav_Search(start_node, goal_node, caps, scratch);
+        s_search_stats.sampled++;
+        s_search_stats.sampled_bidir += mid - before;
+        s_search_stats.sampled_astar += s_expanded - mid;
+    }
+    return len;
+}
+
+void BotNav_ResetSearchStats(void)
+{
+    memset(&s_search_stats, 0, sizeof(s_search_stats));
+    BotNavFly_ResetStats();
+}
+
+void BotNav_PrintSearchStats(void)
+{
+    gi.dprintf("Path searches: %u A*, %u bidirectional\n",
+               s_search_stats.astar, s_search_stats.bidir);
+    if (s_search_stats.astar)
+        gi.dprintf("  A*:            %.1f nodes expanded per search\n",
+                   (float)s_search_stats.astar_expanded / s_search_stats.astar);
+    if (s_search_stats.bidir)
+        gi.dprintf("  bidirectional: %.1f nodes expanded per search\n",
+                   (float)s_search_stats.bidir_expanded / s_search_stats.bidir);
+    if (s_search_stats.sampled_astar)
+        gi.dprintf("  %u long queries sampled: %u expanded vs %u by A* "
+                   "(%.0f%% saved)\n",
+                   s_search_stats.sampled, s_search_stats.sampled_bidir,
+                   s_search_stats.sampled_astar,
+                   100.0f * ((float)s_search_stats.sampled_astar -
+                             (float)s_search_stats.sampled_bidir) /
+                   s_search_stats.sampled_astar);
+    gi.dprintf("Distance labels (hubs per node): ground %.1f, wall-walk %.1f, "
+               "fly %.1f\n", BotNavDist_MeanLabel(0),
+               BotNavDist_MeanLabel(NAV_CAP_WALL),
+               BotNavDist_MeanLabel(NAV_CAP_FLY));
+    BotNavFly_PrintStats();
+}
+
+unsigned int BotNav_Caps(const bot_state_t *bs)
+{
+    unsigned int caps = 0;
+
+    if (Bot_CanWallWalk(bs))
+        caps |= NAV_CAP_WALL;
+    if (bs && Gloom_ClassCanFly(bs->gloom_class))
+        caps |= NAV_CAP_FLY;
+    return caps;
+}
+
+/*
+ * BotNav_Distance
+ * Shortest travel distance from a to b using hub labels.  Scoring loops
+ * call this per candidate, so when the labels cannot answer it returns
+ * the straight-line distance instead of searching.
+ */
+float BotNav_Distance(int a, int b, unsigned int caps)
+{
+    vec3_t delta;
+    float  d;
+
+    if (a < 0 || a >= nav_node_count || nav_nodes[a].id == BOT_INVALID_NODE ||
+        b < 0 || b >= nav_node_count || nav_nodes[b].id == BOT_INVALID_NODE)
+        return FLT_MAX;
+    if (a == b)
+        return 0.0f;
+    if (BotNavDist_Lookup(a, b, caps, &d))
+        return d;
+
+    VectorSubtract(nav_nodes[b].origin, nav_nodes[a].origin, delta);
+    return VectorLength(delta);
+}
+
+/*
+ * BotNav_PointDistance
+ * Travel distance between two world positions via their nearest nodes.
+ * Straight-line when the map has no nav graph.
+ */
+float BotNav_PointDistance(vec3_t from, vec3_t to, unsigned int caps)
+{
+    int a, b;
+
+    if (nav_node_count == 0)
+        return BotNav_Heuristic(from, to);
+
+    a = BotNav_NearestNode(from, (caps & NAV_CAP_WALL) ? true : false);
+    b = BotNav_NearestNode(to,   (caps & NAV_CAP_WALL) ? true : false);
+    if (a == BOT_INVALID_NODE || b == BOT_INVALID_NODE)
+        return BotNav_Heuristic(from, to);
+    return BotNav_Distance(a, b, caps);
+}
+
+/*
+ * BotNav_FindGraphPath
+ * Route over the node graph only.  The bot's path must already be clear.
+ */
+static void BotNav_FindGraphPath(bot_state_t *bs, vec3_t goal)
+{
+    int  start_node, goal_node;
+    int  path[BOT_MAX_PATH_NODES];
+    int  path_len;
+    int  handle, cursor;
+    qboolean can_wall = Bot_CanWallWalk(bs);
+    unsigned int caps = BotNav_Caps(bs);
+
+    if (nav_node_count == 0)
+        return;  /* no nav data — bot will roam freely */
+
+    start_node = BotNav_NearestNode(bs->ent->s.origin, can_wall);
+    goal_node  = BotNav_NearestNode(goal, can_wall);
+
+    if (start_node == BOT_INVALID_NODE || goal_node == BOT_INVALID_NODE)
+        return;  /* disconnected or no nearby nodes */
+
+    /* Share another bot's path if it already runs through our start */
+    handle = BotPath_Find(start_node, goal_node, caps, &cursor);
+    if (handle != BOT_PATH_NONE) {
+        BotNav_SetPath(bs, handle, cursor, goal_node);
+        return;
+    }
+
+    if (start_node == goal_node) {
+        BotNav_SetPath(bs, BotPath_Store(&goal_node, 1, caps), 0, goal_node);
+        return;
+    }
+
+    /* Different components: A* would only exhaust the reachable set */
+    if (!BotNavCache_Connected(start_node, goal_node))
+        return;
+
+    path_len = BotNav_Route(start_node, goal_node, caps, path);
+    if (path_len > 0)
+        BotNav_SetPath(bs, BotPath_Store(path, path_len, caps), 0, goal_node);
+
     /* No path found — path remains invalid; bot falls back to direct movement */
 }
 
+void BotNav_FindPath(bot_state_t *bs, vec3_t goal)
+{
+    VectorCopy(goal, bs->nav.goal_origin);
+    bs->nav.goal_node = BOT_INVALID_NODE;
+    BotNav_ClearPath(bs);
+
+    /* A fresh route starts the recovery ladder from the bottom */
+    bs->nav.stuck_stage        = BOT_STUCK_STRAFE;
+    bs->nav.stuck_index        = 0;
+    bs->nav.progress_count     = 0;
+    bs->nav.progress_next_time = 0.0f;
+
+    /* Flyers cross open space on the octree; the graph is the fallback */
+    if (Gloom_ClassCanFly(bs->gloom_class) && BotNavFly_Ready()) {
+        bs->nav.fly_count = BotNavFly_Plan(bs->ent->s.origin, goal,
+                                           bs->nav.fly_points,
+                                           BOT_FLY_MAX_POINTS);
+        if (bs->nav.fly_count > 0)
+            return;
+    }
+
+    BotNav_FindGraphPath(bs, goal);
+}
+
+/* -----------------------------------------------------------------------
+   Stuck detection and local recovery
+   ----------------------------------------------------------------------- */
+
+/*
+ * BotNav_ResetProgress
+ * Discard the progress window, e.g. after reaching a waypoint or
+ * applying an escape move.
+ */
+static void BotNav_ResetProgress(bot_state_t *bs)
+{
+    bs->nav.progress_count     = 0;
+    bs->nav.progress_next_time = 0.0f;
+}
+
+/*
+ * BotNav_RecordStuck
+ * Tally a stuck event against the edge from -> to.  Edges that are not
+ * in the graph (e.g. the first leg of a path) are ignored.
+ */
+static void BotNav_RecordStuck(int from, int to)
+{
+    int j;
+
+    if (from < 0 || from >= nav_node_count)
+        return;
+
+    for (j = 0; j < nav_nodes[from].num_neighbors; j++) {
+        if (nav_nodes[from].neighbors[j] == to) {
+            if (s_stuck_hits[from][j] < 0xFFFF)
+                s_stuck_hits[from][j]++;
+            return;
+        }
+    }
+}
+
+/*
+ * BotNav_RecoverStuck
+ * Apply the next rung of the recovery ladder.  Only the last rung
+ * throws the path away; the others keep the bot on its current route.
+ */
+static void BotNav_RecoverStuck(bot_state_t *bs, vec3_t dir)
+{
+    int    handle = bs->nav.path_handle;
+    int    index  = bs->nav.path_index;
+    int    from   = (index > 0) ? BotPath_Node(handle, index - 1)
+                                : bs->nav.current_node;
+    int    to     = BotPath_Node(handle, index);
+    int    stage;
+    vec3_t goal;
+
+    BotNav_RecordStuck(from, to);
+
+    if (bs->nav.stuck_stage == BOT_STUCK_STRAFE)
+        bs->nav.stuck_index = index;
+    stage = bs->nav.stuck_stage++;
+
+    BotDebug_Log(BOT_DEBUG_NAV, "%s stuck on edge %d -> %d (stage %d)\n",
+                 bs->name, from, to, stage);
+
+    BotNav_ResetProgress(bs);
+
+    switch (stage) {
+    case BOT_STUCK_STRAFE:
+        /* Sidestep, alternating sides between bots */
+        bs->nav.escape_velocity[0] = -dir[1] * BOT_MOVEMENT_SPEED;
+        bs->nav.escape_velocity[1] =  dir[0] * BOT_MOVEMENT_SPEED;
+        bs->nav.escape_velocity[2] = 0.0f;
+        if (bs->bot_index & 1)
+            VectorScale(bs->nav.escape_velocity, -1.0f,
+                        bs->nav.escape_velocity);
+        bs->nav.escape_until = level.time + BOT_ESCAPE_TIME;
+        break;
+
+    case BOT_STUCK_JUMP:
+        VectorScale(dir, BOT_MOVEMENT_SPEED, bs->nav.escape_velocity);
+        bs->nav.escape_velocity[2] = BOT_ESCAPE_JUMP_SPEED;
+        bs->nav.escape_until = level.time + BOT_ESCAPE_TIME;
+        break;
+
+    case BOT_STUCK_SKIP:
+        if (index + 1 < BotPath_Length(handle))
+            bs->nav.path_index++;
+        break;
+
+    case BOT_STUCK_BACKOFF:
+        /* Retreat from the waypoint for a moment, keeping the skip */
+        VectorScale(dir, -BOT_MOVEMENT_SPEED, bs->nav.escape_velocity);
+        bs->nav.escape_velocity[2] = 0.0f;
+        bs->nav.escape_until = level.time + BOT_ESCAPE_TIME;
+        break;
+
+    default:
+        /* Local escapes exhausted — pay for a global replan */
+        VectorCopy(bs->nav.goal_origin, goal);
+        BotNav_FindPath(bs, goal);
+        bs->nav.stuck_stage = BOT_STUCK_STRAFE;
+        break;
+    }
+}
+
+/*
+ * BotNav_SampleProgress
+ * Sample the distance to the next waypoint and compare it with the
+ * oldest sample in the window.  Returns true if the bot is stuck.
+ */
+static qboolean BotNav_SampleProgress(bot_state_t *bs, float dist)
+{
+    int   slot;
+    float oldest;
+
+    if (level.time < bs->nav.progress_next_time)
+        return false;
+    bs->nav.progress_next_time = level.time + BOT_STUCK_SAMPLE_INTERVAL;
+
+    slot = bs->nav.progress_count % BOT_STUCK_WINDOW;
+    bs->nav.progress_dist[slot] = dist;
+    bs->nav.progress_count++;
+
+    if (bs->nav.progress_count <= BOT_STUCK_WINDOW)
+        return false;
+
+    oldest = bs->nav.progress_dist[bs->nav.progress_count % BOT_STUCK_WINDOW];
+    return oldest - dist < BOT_STUCK_MIN_PROGRESS;
+}
+
+/*
+ * BotNav_CheckProgress
+ * BotNav_SampleProgress for a graph path.  Returns true if recovery was
+ * triggered.
+ */
+static qboolean BotNav_CheckProgress(bot_state_t *bs, float dist, vec3_t dir)
+{
+    if (!BotNav_SampleProgress(bs, dist))
+        return false;
+
+    BotNav_RecoverStuck(bs, dir);
+    return true;
+}
+
+/*
+ * BotNav_CheckFlyProgress
+ * The octree is traced once per map, so a structure or player placed
+ * since can block a flight leg for good.  A stuck flyer drops the flight
+ * and routes over the graph instead.  Returns true if it did.
+ */
+static qboolean BotNav_CheckFlyProgress(bot_state_t *bs, float dist)
+{
+    vec3_t goal;
+
+    if (!BotNav_SampleProgress(bs, dist))
+        return false;
+
+    BotDebug_Log(BOT_DEBUG_NAV, "%s stuck on flight point %d, using graph\n",
+                 bs->name, bs->nav.fly_index);
+
+    VectorCopy(bs->nav.goal_origin, goal);
+    BotNav_ClearPath(bs);
+    BotNav_ResetProgress(bs);
+    BotNav_FindGraphPath(bs, goal);
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   Lookahead path following
+   ----------------------------------------------------------------------- */
+
+/*
+ * BotNav_EdgeMoveType
+ * Returns the NAV_MOVE_* type of the link from -> to, or NAV_MOVE_WALK
+ * if there is no such link.
+ */
+static int BotNav_EdgeMoveType(int from, int to)
+{
+    int j;
+
+    if (from < 0 || from >= nav_node_count)
+        return NAV_MOVE_WALK;
+
+    for (j = 0; j < nav_nodes[from].num_neighbors; j++) {
+        if (nav_nodes[from].neighbors[j] == to)
+            return nav_nodes[from].movement_required[j];
+    }
+    return NAV_MOVE_WALK;
+}
+
+/*
+ * BotNav_CanCutCorner
+ * True for edges a bot may enter anywhere along their length.  Jumps,
+ * ladders and wall-climbs only work when started from the node itself.
+ */
+static qboolean BotNav_CanCutCorner(int move_type)
+{
+    return (move_type == NAV_MOVE_WALK ||
+            move_type == NAV_MOVE_FLY  ||
+            move_type == NAV_MOVE_SWIM);
+}
+
+/*
+ * BotNav_PathNodeValid
+ * True if path[index] refers to a live nav node.
+ */
+static qboolean BotNav_PathNodeValid(const bot_state_t *bs, int index)
+{
+    int node = BotPath_Node(bs->nav.path_handle, index);
+
+    return (node >= 0 && node < nav_node_count &&
+            nav_nodes[node].id != BOT_INVALID_NODE);
+}
+
+/*
+ * BotNav_LineClear
+ * True if the bot's hull can move in a straight line from where it
+ * stands to point.
+ */
+static qboolean BotNav_LineClear(const bot_state_t *bs, vec3_t point)
+{
+    trace_t tr;
+
+    tr = gi.trace(bs->ent->s.origin, bs->ent->mins, bs->ent->maxs, point,
+                  bs->ent, MASK_PLAYERSOLID);
+    return !tr.startsolid && tr.fraction >= 1.0f;
+}
+
+/*
+ * BotNav_WalkPath
+ * Walks reach units along the path polyline from the bot's position and
+ * returns that point in carrot.  The walk stops early at the start node
+ * of an edge that cannot be cut; in that case the path distance to that
+ * node is returned so the caller can slow down.  Returns FLT_MAX when no
+ * such edge lies within reach.
+ */
+static float BotNav_WalkPath(const bot_state_t *bs, float reach, vec3_t carrot)
+{
+    vec3_t from, seg;
+    float  travelled = 0.0f;
+    float  len;
+    int    handle = bs->nav.path_handle;
+    int    length = BotPath_Length(handle);
+    int    i, node;
+
+    VectorCopy(bs->ent->s.origin, from);
+
+    for (i = bs->nav.path_index; i < length; i++) {
+        if (!BotNav_PathNodeValid(bs, i))
+            break;
+        node = BotPath_Node(handle, i);
+
+        VectorSubtract(nav_nodes[node].origin, from, seg);
+        len = VectorLength(seg);
+        if (len > 0.0f && travelled + len >= reach) {
+            VectorMA(from, (reach - travelled) / len, seg, carrot);
+            return FLT_MAX;
+        }
+        travelled += len;
+        VectorCopy(nav_nodes[node].origin, from);
+
+        if (i + 1 < length &&
+            !BotNav_CanCutCorner(BotNav_EdgeMoveType(node,
+                                                      BotPath_Node(handle, i + 1)))) {
+            VectorCopy(from, carrot);
+            return travelled;
+        }
+    }
+
+    VectorCopy(from, carrot);
+    return FLT_MAX;
+}
+
+/*
+ * BotNav_Lookahead
+ * Picks the carrot BOT_LOOKAHEAD_DIST along the path (BotNav_WalkPath).
+ * Round a tight corner the straight line to it can clip the inside
+ * wall, so the carrot is pulled back towards the next node, halving the
+ * reach down to BOT_LOOKAHEAD_MIN, until the bot's hull can reach it;
+ * failing that it is the next node itself.  Returns the distance to the
+ * next uncuttable edge like BotNav_WalkPath.
+ */
+static float BotNav_Lookahead(const bot_state_t *bs, vec3_t carrot)
+{
+    float reach, hard_dist = FLT_MAX;
+    int   node;
+
+    for (reach = BOT_LOOKAHEAD_DIST; reach >= BOT_LOOKAHEAD_MIN; reach *= 0.5f) {
+        hard_dist = BotNav_WalkPath(bs, reach, carrot);
+        if (BotNav_LineClear(bs, carrot))
+            return hard_dist;
+    }
+
+    node = BotPath_Node(bs->nav.path_handle, bs->nav.path_index);
+    VectorCopy(nav_nodes[node].origin, carrot);
+    return hard_dist;
+}
+
+/*
+ * BotNav_PassedWaypoint
+ * True when the bot is already heading down the segment after
+ * path[path_index] — i.e. it cut the corner — that segment may be
+ * entered anywhere, and the bot can get to its far end in a straight
+ * line.
+ */
+static qboolean BotNav_PassedWaypoint(const bot_state_t *bs, float dist)
+{
+    int    handle = bs->nav.path_handle;
+    int    index  = bs->nav.path_index;
+    int    node, next;
+    vec3_t to_bot, seg;
+
+    if (dist > BOT_LOOKAHEAD_DIST || index + 1 >= BotPath_Length(handle))
+        return false;
+    if (!BotNav_PathNodeValid(bs, index + 1))
+        return false;
+
+    node = BotPath_Node(handle, index);
+    next = BotPath_Node(handle, index + 1);
+    if (!BotNav_CanCutCorner(BotNav_EdgeMoveType(node, next)))
+        return false;
+
+    VectorSubtract(bs->ent->s.origin, nav_nodes[node].origin, to_bot);
+    VectorSubtract(nav_nodes[next].origin, nav_nodes[node].origin, seg);
+    if (DotProduct(to_bot, seg) <= 0.0f)
+        return false;
+    return BotNav_LineClear(bs, nav_nodes[next].origin);
+}
+
 void BotNav_MoveTowardGoal(bot_state_t *bs)
 {
-    vec3_t dir;
-    float  dist;
-    int    next_node;
+    vec3_t dir, carrot;
+    float  dist, hard_dist, speed;
+    int    next_node, length;
 
     if (!bs || !bs->ent || !bs->ent->inuse)
         return;
 
-    /* If we have a valid path, follow the next node in the path */
-    if (bs->nav.path_valid && bs->nav.path_length > 0) {
-        if (bs->nav.path_index >= bs->nav.path_length) {
+    /* Hold an escape move until it expires */
+    if (level.time < bs->nav.escape_until) {
+        VectorCopy(bs->nav.escape_velocity, bs->ent->velocity);
+        return;
+    }
+
+    /* Free-space flight: steer at each octree point in turn */
+    if (bs->nav.fly_index < bs->nav.fly_count) {
+        VectorSubtract(bs->nav.fly_points[bs->nav.fly_index],
+                       bs->ent->s.origin, dir);
+        dist = VectorLength(dir);
+        if (dist < bs->nav.arrived_dist) {
+            bs->nav.current_node = BotNav_NearestNode(bs->ent->s.origin,
+                                                      Bot_CanWallWalk(bs));
+            if (++bs->nav.fly_index >= bs->nav.fly_count)
+                bs->nav.fly_count = bs->nav.fly_index = 0;
+            BotNav_ResetProgress(bs);
+            return;
+        }
+        if (BotNav_CheckFlyProgress(bs, dist))
+            return;
+        VectorScale(dir, BOT_MOVEMENT_SPEED / dist, bs->ent->velocity);
+        return;
+    }
+
+    /* If we have a valid path, follow it */
+    length = BotPath_Length(bs->nav.path_handle);
+    if (bs->nav.path_valid && length > 0) {
+        if (bs->nav.path_index >= length) {
             /* Reached end of path */
             bs->nav.path_valid = false;
             return;
         }
 
-        next_node = bs->nav.path[bs->nav.path_index];
-        if (next_node < 0 || next_node >= nav_node_count ||
-            nav_nodes[next_node].id == BOT_INVALID_NODE) {
+        if (!BotNav_PathNodeValid(bs, bs->nav.path_index)) {
             bs->nav.path_valid = false;
             return;
         }
+        next_node = BotPath_Node(bs->nav.path_handle, bs->nav.path_index);
 
         VectorSubtract(nav_nodes[next_node].origin, bs->ent->s.origin, dir);
         dist = VectorLength(dir);
 
-        /* Advance to next path node when close enough */
-        if (dist < bs->nav.arrived_dist) {
+        /* Advance when close enough, or once the corner has been cut */
+        if (dist < bs->nav.arrived_dist || BotNav_PassedWaypoint(bs, dist)) {
             bs->nav.current_node = next_node;
             bs->nav.path_index++;
+            if (bs->nav.path_index > bs->nav.stuck_index)
+                bs->nav.stuck_stage = BOT_STUCK_STRAFE;
+            BotNav_ResetProgress(bs);
             return;
         }
 
-        /* Move toward the next path node */
-        if (dist > 0.0f) {
+        if (dist > 0.0f)
             VectorNormalize(dir);
-            VectorScale(dir, BOT_MOVEMENT_SPEED, bs->ent->velocity);
+
+        if (BotNav_CheckProgress(bs, dist, dir))
+            return;
+
+        /* Steer at the carrot, braking ahead of jump/ladder/climb edges */
+        hard_dist = BotNav_Lookahead(bs, carrot);
+        speed = BOT_MOVEMENT_SPEED;
+        if (hard_dist < BOT_SLOWDOWN_DIST) {
+            float frac = hard_dist / BOT_SLOWDOWN_DIST;
+            if (frac < BOT_SLOWDOWN_MIN)
+                frac = BOT_SLOWDOWN_MIN;
+            speed *= frac;
         }
+
+        VectorSubtract(carrot, bs->ent->s.origin, dir);
+        if (VectorNormalize(dir) > 0.0f)
+            VectorScale(dir, speed, bs->ent->velocity);
     } else {
         /* No valid path — move directly toward goal origin */
         VectorSubtract(bs->nav.goal_origin, bs->ent->s.origin, dir);
@@ -275,6 +1224,88 @@ void BotNav_MoveTowardGoal(bot_state_t *bs)
     }
 }
 
+/* -----------------------------------------------------------------------
+   Stuck hotspot log
+   ----------------------------------------------------------------------- */
+
+void BotNav_ClearStuckHotspots(void)
+{
+    memset(s_stuck_hits, 0, sizeof(s_stuck_hits));
+}
+
+int BotNav_StuckCount(int from, int to)
+{
+    int j;
+
+    if (from < 0 || from >= nav_node_count)
+        return 0;
+
+    for (j = 0; j < nav_nodes[from].num_neighbors; j++) {
+        if (nav_nodes[from].neighbors[j] == to)
+            return s_stuck_hits[from][j];
+    }
+    return 0;
+}
+
+void BotNav_PrintStuckHotspots(void)
+{
+    int i, j, count = 0;
+
+    gi.dprintf("Stuck hotspots (from -> to: hits):\n");
+    for (i = 0; i < nav_node_count; i++) {
+        for (j = 0; j < nav_nodes[i].num_neighbors; j++) {
+            if (s_stuck_hits[i][j] == 0)
+                continue;
+            gi.dprintf("  %4d -> %4d: %d\n", Node_ExternalId(i),
+                       Node_ExternalId(nav_nodes[i].neighbors[j]),
+                       s_stuck_hits[i][j]);
+            count++;
+        }
+    }
+    if (count == 0)
+        gi.dprintf("  (none)\n");
+}
+
+/*
+ * BotNav_SaveStuckHotspots
+ * Write the tallies to maps/<mapname>.stuck as "<from> <to> <hits>"
+ * lines for offline review of the nav file.  Nodes are given by their
+ * .nav file IDs, not their in-memory slots.
+ */
+qboolean BotNav_SaveStuckHotspots(const char *mapname)
+{
+    char  path[MAX_QPATH];
+    FILE *f;
+    int   i, j;
+
+    if (!mapname || !mapname[0]) {
+        gi.dprintf("BotNav_SaveStuckHotspots: no map name\n");
+        return false;
+    }
+
+    Com_sprintf(path, sizeof(path), "maps/%s.stuck", mapname);
+    f = fopen(path, "w");
+    if (!f) {
+        gi.dprintf("BotNav_SaveStuckHotspots: cannot open '%s' for writing\n",
+                   path);
+        return false;
+    }
+
+    fprintf(f, "# stuck hotspots for %s: <from> <to> <hits>\n", mapname);
+    for (i = 0; i < nav_node_count; i++) {
+        for (j = 0; j < nav_nodes[i].num_neighbors; j++) {
+            if (s_stuck_hits[i][j])
+                fprintf(f, "%d %d %d\n", Node_ExternalId(i),
+                        Node_ExternalId(nav_nodes[i].neighbors[j]),
+                        s_stuck_hits[i][j]);
+        }
+    }
+
+    fclose(f);
+    gi.dprintf("BotNav_SaveStuckHotspots: wrote '%s'\n", path);
+    return true;
+}
+
 int BotNav_NearestNode(vec3_t origin, qboolean allow_wall_nodes)
 {
     /*
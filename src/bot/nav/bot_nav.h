@@ -20,7 +20,9 @@
  *
  * WAYPOINT FILE FORMAT
  * --------------------
- * Navigation data is loaded from maps/<mapname>.nav at map load.
+ * Navigation data is loaded from maps/<mapname>.nav at map load, on a
+ * background thread.  Until BotNav_Frame publishes the new graph bots
+ * have no nodes and steer straight at their goals.
  * (Format TBD — binary node/edge graph with surface-normal annotations.)
  */
 
@@ -32,10 +34,57 @@
 
 void     BotNav_Init(void);
 void     BotNav_LoadMap(const char *mapname);
+void     BotNav_Frame(void);
+qboolean BotNav_WaitLoad(void);
 void     BotNav_FindPath(bot_state_t *bs, vec3_t goal);
+void     BotNav_ClearPath(bot_state_t *bs);
 void     BotNav_MoveTowardGoal(bot_state_t *bs);
 int      BotNav_NearestNode(vec3_t origin, qboolean allow_wall_nodes);
 qboolean BotNav_IsChokePoint(int node_index);
 void     BotNav_UpdateWallWalk(bot_state_t *bs);
 
+/*
+ * A* from start_node to goal_node over edges whose NAV_CAP_* bits are
+ * all in caps, on float costs; fills path[BOT_MAX_PATH_NODES] and returns
+ * its length, or 0.  Routing itself searches the packed graph.
+ */
+int      BotNav_Search(int start_node, int goal_node, unsigned int caps,
+                       int *path);
+
+/* Bidirectional A*; same contract as BotNav_Search.  Used for long queries. */
+int      BotNav_SearchBidir(int start_node, int goal_node, unsigned int caps,
+                            int *path);
+
+/*
+ * Incoming edges of node in the live graph: (*from)[k] is the source
+ * slot and (*slot)[k] its index in that node's neighbor arrays.  Returns
+ * the count.  Valid until the graph changes.
+ */
+int      BotNav_Incoming(int node, const unsigned short **from,
+                         const unsigned char **slot);
+
+/* NAV_CAP_* movement the bot's class allows. */
+unsigned int BotNav_Caps(const bot_state_t *bs);
+
+/*
+ * Shortest travel distance between two nodes for a movement profile,
+ * from hub labels (bot_navdist.h); FLT_MAX if unreachable.  Straight-line
+ * distance when no labels cover the profile or they are being rebuilt.
+ * Cheap enough for scoring loops.
+ */
+float    BotNav_Distance(int a, int b, unsigned int caps);
+
+/* BotNav_Distance between the nodes nearest two points. */
+float    BotNav_PointDistance(vec3_t from, vec3_t to, unsigned int caps);
+
+/* Search counters and sampled bidirectional savings ("sv navstats") */
+void     BotNav_ResetSearchStats(void);
+void     BotNav_PrintSearchStats(void);
+
+/* Stuck hotspot log: per-edge count of stuck events during path following */
+void     BotNav_ClearStuckHotspots(void);
+int      BotNav_StuckCount(int from, int to);
+void     BotNav_PrintStuckHotspots(void);
+qboolean BotNav_SaveStuckHotspots(const char *mapname);
+
 #endif /* BOT_NAV_H */
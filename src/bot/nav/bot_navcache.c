@@ -0,0 +1,331 @@
+/*
+ * bot_navcache.c -- per-map derived nav data and its on-disk cache
+ *
+ * See bot_navcache.h.  The .navc file is a raw nav_derived_t image; it is
+ * only trusted when its size, magic, schema and nav hash all match.  On
+ * POSIX a valid file is mmap'd read-only, on Windows it is read into the
+ * static buffer.  Write-back goes to <file>.tmp and is renamed into place
+ * so a reader never sees a half-written cache.
+ */
+
+#include "bot_navcache.h"
+#include "bot_thread.h"
+#include "bot_upgrade.h"
+#include <stdio.h>
+#include <math.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* -----------------------------------------------------------------------
+   Module state
+   ----------------------------------------------------------------------- */
+static nav_derived_t        s_computed;
+static const nav_derived_t *s_active        = &s_computed;
+static qboolean             s_active_valid  = false;
+static unsigned int         s_active_version;   /* nav_graph_version it matches */
+
+static void                *s_map_base = NULL;  /* mmap'd .navc, if any */
+static size_t               s_map_size = 0;
+
+/* Write-back job; the writer thread owns these until joined */
+static bot_thread_t         s_writer;
+static nav_derived_t        s_write_buf;
+static char                 s_write_path[MAX_QPATH + 16];
+
+/* -----------------------------------------------------------------------
+   Analyses
+   ----------------------------------------------------------------------- */
+
+/*
+ * Determine map openness from nav node distribution:
+ *   - High ratio of NAV_SNIPE nodes  → open sightlines → MAP_TYPE_OPEN
+ *   - High ratio of NAV_WALLCLIMB nodes relative to NAV_GROUND → tight corridors
+ *     that force close-quarters → MAP_TYPE_TIGHT
+ *   - Otherwise → MAP_TYPE_MIXED
+ */
+static int NavCache_MapType(void)
+{
+    int i, snipe = 0, wallclimb = 0, ground = 0, total = 0;
+
+    for (i = 0; i < nav_node_count; i++) {
+        if (nav_nodes[i].id == BOT_INVALID_NODE) continue;
+        total++;
+        if (nav_nodes[i].flags & NAV_SNIPE)     snipe++;
+        if (nav_nodes[i].flags & NAV_WALLCLIMB) wallclimb++;
+        if (nav_nodes[i].flags & NAV_GROUND)    ground++;
+    }
+
+    if (total == 0) return MAP_TYPE_MIXED;
+
+    /* More than 20% of nodes are sniper perches → open */
+    if (snipe * 5 > total) return MAP_TYPE_OPEN;
+
+    /* Wall-climb nodes outnumber ground nodes 2:1 → tight corridor map */
+    if (ground > 0 && wallclimb > ground * 2) return MAP_TYPE_TIGHT;
+
+    return MAP_TYPE_MIXED;
+}
+
+/*
+ * Seed zones from key nodes (camp, ambush, teleporter, egg), skipping any
+ * that fall within NAV_ZONE_RADIUS of an earlier seed.
+ */
+static void NavCache_ZoneSeeds(nav_derived_t *d)
+{
+    int i;
+
+    d->zone_count = 0;
+    for (i = 0; i < nav_node_count && d->zone_count < NAV_ZONE_MAX; i++) {
+        int      j;
+        qboolean too_close = false;
+
+        if (nav_nodes[i].id == BOT_INVALID_NODE) continue;
+        if (!(nav_nodes[i].flags & (NAV_CAMP | NAV_AMBUSH |
+                                    NAV_TELEPORTER | NAV_EGG))) continue;
+
+        for (j = 0; j < d->zone_count; j++) {
+            float dx = d->zone_centers[j][0] - nav_nodes[i].origin[0];
+            float dy = d->zone_centers[j][1] - nav_nodes[i].origin[1];
+            float dz = d->zone_centers[j][2] - nav_nodes[i].origin[2];
+
+            if (dx*dx + dy*dy + dz*dz < NAV_ZONE_RADIUS * NAV_ZONE_RADIUS) {
+                too_close = true;
+                break;
+            }
+        }
+
+        if (!too_close) {
+            d->zone_centers[d->zone_count][0] = nav_nodes[i].origin[0];
+            d->zone_centers[d->zone_count][1] = nav_nodes[i].origin[1];
+            d->zone_centers[d->zone_count][2] = nav_nodes[i].origin[2];
+            d->zone_count++;
+        }
+    }
+}
+
+/* Union-find root with path halving */
+static int NavCache_Root(int *parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/*
+ * Label weakly connected components (edge direction ignored).  Nodes in
+ * different components can never reach each other, which lets A* reject
+ * hopeless queries without searching.
+ */
+static void NavCache_Components(nav_derived_t *d)
+{
+    static int parent[MAX_NAV_NODES];
+    static int label[MAX_NAV_NODES];
+    int i, j;
+
+    for (i = 0; i < MAX_NAV_NODES; i++) {
+        parent[i] = i;
+        label[i]  = -1;
+        d->component[i] = NAV_COMPONENT_NONE;
+    }
+
+    for (i = 0; i < nav_node_count; i++) {
+        if (nav_nodes[i].id == BOT_INVALID_NODE) continue;
+        for (j = 0; j < nav_nodes[i].num_neighbors; j++) {
+            int n = nav_nodes[i].neighbors[j];
+            int a, b;
+
+            if (n < 0 || n >= nav_node_count ||
+                nav_nodes[n].id == BOT_INVALID_NODE) continue;
+            a = NavCache_Root(parent, i);
+            b = NavCache_Root(parent, n);
+            if (a != b)
+                parent[b] = a;
+        }
+    }
+
+    d->component_count = 0;
+    for (i = 0; i < nav_node_count; i++) {
+        int r;
+
+        if (nav_nodes[i].id == BOT_INVALID_NODE) continue;
+        r = NavCache_Root(parent, i);
+        if (label[r] < 0)
+            label[r] = d->component_count++;
+        d->component[i] = (unsigned short)label[r];
+    }
+}
+
+static void NavCache_Compute(nav_derived_t *d)
+{
+    memset(d, 0, sizeof(*d));
+    d->magic      = NAVC_FILE_MAGIC;
+    d->schema     = NAVC_SCHEMA_VERSION;
+    d->nav_hash   = nav_graph_hash;
+    d->node_count = nav_node_count;
+    d->map_type   = NavCache_MapType();
+    NavCache_ZoneSeeds(d);
+    NavCache_Components(d);
+}
+
+/* -----------------------------------------------------------------------
+   Cache file
+   ----------------------------------------------------------------------- */
+static qboolean NavCache_Matches(const nav_derived_t *d)
+{
+    return d->magic == NAVC_FILE_MAGIC &&
+           d->schema == NAVC_SCHEMA_VERSION &&
+           d->nav_hash == nav_graph_hash &&
+           d->node_count == nav_node_count &&
+           d->zone_count >= 0 && d->zone_count <= NAV_ZONE_MAX &&
+           d->component_count >= 0 && d->component_count <= MAX_NAV_NODES;
+}
+
+static void NavCache_Unmap(void)
+{
+#ifndef _WIN32
+    if (s_map_base)
+        munmap(s_map_base, s_map_size);
+#endif
+    s_map_base = NULL;
+    s_map_size = 0;
+    s_active   = &s_computed;
+}
+
+static qboolean NavCache_TryMap(const char *path)
+{
+#ifdef _WIN32
+    FILE    *f = fopen(path, "rb");
+    qboolean ok;
+
+    if (!f)
+        return false;
+    ok = fread(&s_computed, sizeof(s_computed), 1, f) == 1 &&
+         fgetc(f) == EOF && NavCache_Matches(&s_computed);
+    fclose(f);
+    s_active = &s_computed;
+    return ok;
+#else
+    struct stat st;
+    void       *base;
+    int         fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    if (fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(nav_derived_t)) {
+        close(fd);
+        return false;
+    }
+    base = mmap(NULL, sizeof(nav_derived_t), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return false;
+    if (!NavCache_Matches((const nav_derived_t *)base)) {
+        munmap(base, sizeof(nav_derived_t));
+        return false;
+    }
+    s_map_base = base;
+    s_map_size = sizeof(nav_derived_t);
+    s_active   = (const nav_derived_t *)base;
+    return true;
+#endif
+}
+
+/* Writer thread: no gi calls.  A failed write just means a recompute
+ * next time, so errors are dropped. */
+static void NavCache_WriteWorker(void *arg)
+{
+    char  tmp[MAX_QPATH + 24];
+    FILE *f;
+    int   ok;
+
+    (void)arg;
+    Com_sprintf(tmp, sizeof(tmp), "%s.tmp", s_write_path);
+    f = fopen(tmp, "wb");
+    if (!f)
+        return;
+    ok = fwrite(&s_write_buf, sizeof(s_write_buf), 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        remove(tmp);
+        return;
+    }
+#ifdef _WIN32
+    remove(s_write_path);   /* rename() does not replace on Windows */
+#endif
+    if (rename(tmp, s_write_path) != 0)
+        remove(tmp);
+}
+
+static void NavCache_QueueWrite(const char *path)
+{
+    BotThread_Join(&s_writer);
+
+    s_write_buf = s_computed;
+    Com_sprintf(s_write_path, sizeof(s_write_path), "%s", path);
+    if (!BotThread_Start(&s_writer, NavCache_WriteWorker, NULL))
+        NavCache_WriteWorker(NULL);
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+const nav_derived_t *BotNavCache_Get(void)
+{
+    if (!s_active_valid || s_active_version != nav_graph_version) {
+        NavCache_Unmap();
+        NavCache_Compute(&s_computed);
+        s_active_valid   = true;
+        s_active_version = nav_graph_version;
+    }
+    return s_active;
+}
+
+void BotNavCache_Attach(const char *mapname)
+{
+    char path[MAX_QPATH + 16];
+
+    /* A previous write-back may target the same file */
+    BotThread_Join(&s_writer);
+    NavCache_Unmap();
+    s_active_valid   = true;
+    s_active_version = nav_graph_version;
+
+    if (!nav_graph_hash || !mapname || !mapname[0]) {
+        NavCache_Compute(&s_computed);
+        return;
+    }
+
+    Com_sprintf(path, sizeof(path), "maps/%s.navc", mapname);
+    if (NavCache_TryMap(path)) {
+        gi.dprintf("BotNavCache: using '%s'\n", path);
+        return;
+    }
+
+    NavCache_Compute(&s_computed);
+    NavCache_QueueWrite(path);
+}
+
+qboolean BotNavCache_Connected(int a, int b)
+{
+    const nav_derived_t *d = BotNavCache_Get();
+
+    if (a < 0 || a >= MAX_NAV_NODES || b < 0 || b >= MAX_NAV_NODES)
+        return false;
+    return d->component[a] != NAV_COMPONENT_NONE &&
+           d->component[a] == d->component[b];
+}
+
+void BotNavCache_Shutdown(void)
+{
+    BotThread_Join(&s_writer);
+    NavCache_Unmap();
+    s_active_valid = false;
+}
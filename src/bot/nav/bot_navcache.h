@@ -0,0 +1,62 @@
+/*
+ * bot_navcache.h -- per-map derived nav data and its on-disk cache
+ *
+ * Everything the bots work out from the static node graph (zone seeds,
+ * map type, connected components) lives in one flat nav_derived_t.  It
+ * is computed once per published graph and cached in maps/<map>.navc,
+ * keyed by a hash of the .nav file and NAVC_SCHEMA_VERSION.  A matching
+ * cache is mapped read-only instead of being recomputed; a stale or
+ * missing one is recomputed and written back on a worker thread.
+ *
+ * Bump NAVC_SCHEMA_VERSION whenever nav_derived_t or any of the analyses
+ * that fill it change.
+ */
+
+#ifndef BOT_NAVCACHE_H
+#define BOT_NAVCACHE_H
+
+#include "bot_nodes.h"
+
+#define NAVC_FILE_MAGIC      0x4356414E  /* "NAVC" little-endian */
+#define NAVC_SCHEMA_VERSION  2       /* 2: node slots are RCM-renumbered */
+
+#define NAV_ZONE_MAX         32      /* zone seeds kept per map              */
+#define NAV_ZONE_RADIUS      512.0f  /* minimum spacing between zone seeds   */
+
+#define NAV_COMPONENT_NONE   0xFFFF  /* component id of an empty slot        */
+
+/* Flat, pointer-free so the file image can be used in place. */
+typedef struct {
+    unsigned int   magic;
+    unsigned int   schema;
+    unsigned int   nav_hash;            /* nav_graph_hash it was built from  */
+    int            node_count;          /* nav_node_count it was built from  */
+
+    int            map_type;            /* bot_map_type_t                    */
+
+    int            zone_count;
+    float          zone_centers[NAV_ZONE_MAX][3];
+
+    int            component_count;
+    unsigned short component[MAX_NAV_NODES];  /* weakly connected component */
+} nav_derived_t;
+
+/*
+ * Derived data for the live graph.  Recomputed on the spot (no caching)
+ * if the graph has been edited since the last attach.  Never NULL.
+ */
+const nav_derived_t *BotNavCache_Get(void);
+
+/*
+ * Called when a loaded graph goes live: map maps/<mapname>.navc if its
+ * key matches nav_graph_hash, otherwise compute and queue a write-back.
+ */
+void     BotNavCache_Attach(const char *mapname);
+
+/* True if both nodes are valid and in the same connected component. */
+qboolean BotNavCache_Connected(int a, int b);
+
+/* Unmap the cache and wait for any pending write-back. */
+void     BotNavCache_Shutdown(void);
+
+#endif /* BOT_NAVCACHE_H */
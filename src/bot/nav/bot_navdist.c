@@ -0,0 +1,482 @@
+/*
+ * bot_navdist.c -- exact travel distances from 2-hop hub labels
+ *
+ * Pruned landmark labelling on the directed nav graph.  Nodes are ranked
+ * by how many sampled shortest paths cross them (NavDist_Order); each
+ * one in turn runs a pruned Dijkstra forward (filling
+ * the in-labels of the nodes it reaches) and backward over the
+ * incoming-edge index (filling out-labels).  A node is pruned when the
+ * labels built so far already give a distance no longer than the
+ * search's, so later hubs only label what earlier hubs missed.  Hubs are
+ * stored by rank, so every label list is sorted and a query is a merge.
+ *
+ * Rebuilds after an edit run from BotNavDist_Frame, one profile at a
+ * time: a sample tree per frame, then the ranking, then hubs until
+ * BOT_NAVDIST_WORK nodes have been settled.  Early hubs reach most of
+ * the graph and late ones almost nothing, so the budget counts nodes,
+ * not hubs.  The profile being rebuilt answers no lookups until done.
+ */
+
+#include "bot_navdist.h"
+#include "bot_nav.h"
+#include <float.h>
+#include <limits.h>
+
+enum { LABEL_OUT, LABEL_IN };     /* d(node, hub) / d(hub, node) */
+
+typedef enum {
+    NAVDIST_IDLE,
+    NAVDIST_ORDER,                /* sampling shortest-path trees       */
+    NAVDIST_SORT,                 /* ranking by the samples             */
+    NAVDIST_LABELS                /* pruned searches, hub by hub        */
+} navdist_stage_t;
+
+typedef struct {
+    unsigned short hub[MAX_NAV_NODES][BOT_NAVDIST_LABEL_MAX];   /* rank */
+    float          dist[MAX_NAV_NODES][BOT_NAVDIST_LABEL_MAX];
+    unsigned char  count[MAX_NAV_NODES];
+} navdist_labels_t;
+
+typedef struct {
+    qboolean          valid;          /* finished without overflowing     */
+    qboolean          built;          /* built at least once this map     */
+    const nav_node_t *bank;
+    unsigned int      version;
+    int               node_count;
+    float             build_time;     /* level.time of the last build     */
+    navdist_labels_t  labels[2];      /* LABEL_OUT, LABEL_IN              */
+} navdist_profile_t;
+
+static navdist_profile_t s_profiles[BOT_NAVDIST_PROFILES];
+
+/* Capability set of each profile, indexed like s_profiles */
+static const unsigned int s_profile_caps[BOT_NAVDIST_PROFILES] = {
+    0, NAV_CAP_WALL, NAV_CAP_FLY
+};
+
+/* Build scratch */
+static int   s_order[MAX_NAV_NODES];        /* rank -> node               */
+static float s_score[MAX_NAV_NODES];        /* paths through each node    */
+static float s_hub_dist[MAX_NAV_NODES];     /* by rank: current hub label */
+static float s_dist[MAX_NAV_NODES];
+static int   s_touched[MAX_NAV_NODES];
+static int   s_open[MAX_NAV_NODES];
+static qboolean s_closed[MAX_NAV_NODES];
+
+/* Build in progress */
+static navdist_stage_t s_stage;
+static int             s_build_profile;
+static int             s_build_nodes;      /* live nodes being ranked    */
+static int             s_build_next;       /* next sample or hub rank    */
+
+/* -----------------------------------------------------------------------
+   Helpers
+   ----------------------------------------------------------------------- */
+static int NavDist_Profile(unsigned int caps)
+{
+    int p;
+
+    for (p = 0; p < BOT_NAVDIST_PROFILES; p++) {
+        if (s_profile_caps[p] == caps)
+            return p;
+    }
+    return -1;
+}
+
+/*
+ * Take the closest node out of the scratch open set.  s_dist holds the
+ * keys; the set is small because searches are pruned or sampled.
+ */
+static int NavDist_Pop(int *open)
+{
+    int best_idx = 0, i, u;
+
+    for (i = 1; i < *open; i++) {
+        if (s_dist[s_open[i]] < s_dist[s_open[best_idx]])
+            best_idx = i;
+    }
+    u = s_open[best_idx];
+    s_open[best_idx] = s_open[--(*open)];
+    return u;
+}
+
+/*
+ * Rank nodes by how many shortest paths run through them.  A full
+ * Dijkstra from each of BOT_NAVDIST_SAMPLES roots adds every node's
+ * subtree size in the shortest-path tree to its score, so corridor
+ * middles and junctions come first and hubs at the far ends last.
+ * Degree ordering, the textbook choice, gives labels several times
+ * larger on corridor- and grid-like nav graphs.
+ *
+ * NavDist_OrderBegin lists the live nodes, NavDist_OrderSample runs one
+ * root and NavDist_OrderSort ranks them.
+ */
+static int NavDist_OrderBegin(void)
+{
+    int n = 0, i;
+
+    for (i = 0; i < nav_node_count; i++) {
+        if (nav_nodes[i].id != BOT_INVALID_NODE)
+            s_order[n++] = i;
+        s_score[i] = 0.0f;
+    }
+    return n;
+}
+
+static void NavDist_OrderSample(unsigned int denied, int n, int r)
+{
+    static int parent[MAX_NAV_NODES];
+    static int size[MAX_NAV_NODES];
+    static int settled[MAX_NAV_NODES];
+    int root = s_order[(int)((long)r * n / BOT_NAVDIST_SAMPLES)];
+    int open = 0, done = 0, i, k;
+
+    for (i = 0; i < nav_node_count; i++) {
+        s_dist[i] = FLT_MAX;
+        parent[i] = BOT_INVALID_NODE;
+        size[i]   = 1;
+    }
+    s_dist[root] = 0.0f;
+    s_open[open++] = root;
+
+    while (open > 0) {
+        int               u = NavDist_Pop(&open);
+        const nav_node_t *nu = &nav_nodes[u];
+
+        settled[done++] = u;
+        for (k = 0; k < nu->num_neighbors; k++) {
+            int   v = nu->neighbors[k];
+            float d;
+
+            if (nu->edge_caps[k] & denied)
+                continue;
+            if (v < 0 || v >= nav_node_count ||
+                nav_nodes[v].id == BOT_INVALID_NODE)
+                continue;
+            d = s_dist[u] + nu->neighbor_costs[k];
+            if (d >= s_dist[v])
+                continue;
+            if (s_dist[v] == FLT_MAX)
+                s_open[open++] = v;
+            s_dist[v]  = d;
+            parent[v] = u;
+        }
+    }
+
+    /* Settle order is a topological order of the tree */
+    for (i = done - 1; i > 0; i--) {
+        int u = settled[i];
+        size[parent[u]] += size[u];
+    }
+    for (i = 0; i < done; i++)
+        s_score[settled[i]] += (float)size[settled[i]];
+
+    for (i = 0; i < nav_node_count; i++)
+        s_dist[i] = FLT_MAX;
+}
+
+static void NavDist_OrderSort(int n)
+{
+    int i, j;
+
+    /* Insertion sort by score, highest first; ties keep slot order */
+    for (i = 1; i < n; i++) {
+        int node = s_order[i];
+        for (j = i; j > 0 && s_score[s_order[j - 1]] < s_score[node]; j--)
+            s_order[j] = s_order[j - 1];
+        s_order[j] = node;
+    }
+}
+
+/* d via a shared hub, with one side already scattered into s_hub_dist */
+static float NavDist_Covered(const navdist_labels_t *l, int node)
+{
+    float best = FLT_MAX;
+    int   k;
+
+    for (k = 0; k < l->count[node]; k++) {
+        float d = s_hub_dist[l->hub[node][k]];
+
+        if (d < FLT_MAX && d + l->dist[node][k] < best)
+            best = d + l->dist[node][k];
+    }
+    return best;
+}
+
+/*
+ * One pruned Dijkstra from the hub of the given rank.  LABEL_IN walks
+ * outgoing edges and fills in-labels; LABEL_OUT walks incoming edges and
+ * fills out-labels.  Adds the nodes settled to *work.  False if a label
+ * overflowed.
+ */
+static qboolean NavDist_Prune(navdist_profile_t *prof, unsigned int denied,
+                              int rank, int side, int *work)
+{
+    navdist_labels_t       *fill  = &prof->labels[side];
+    const navdist_labels_t *other = &prof->labels[side ^ 1];
+    int  hub = s_order[rank];
+    int  touched = 0, open = 0;
+    int  i, k;
+    qboolean ok = true;
+
+    /* Scatter the hub's own labels on the opposite side */
+    for (k = 0; k < other->count[hub]; k++)
+        s_hub_dist[other->hub[hub][k]] = other->dist[hub][k];
+
+    s_dist[hub] = 0.0f;
+    s_touched[touched++] = hub;
+    s_open[open++] = hub;
+
+    while (open > 0) {
+        int   u  = NavDist_Pop(&open);
+        float du = s_dist[u];
+
+        s_closed[u] = true;
+        (*work)++;
+
+        if (NavDist_Covered(fill, u) <= du)
+            continue;
+
+        if (fill->count[u] >= BOT_NAVDIST_LABEL_MAX) {
+            ok = false;
+            break;
+        }
+        fill->hub[u][fill->count[u]]  = (unsigned short)rank;
+        fill->dist[u][fill->count[u]] = du;
+        fill->count[u]++;
+
+        if (side == LABEL_IN) {
+            const nav_node_t *n = &nav_nodes[u];
+
+            for (k = 0; k < n->num_neighbors; k++) {
+                int v = n->neighbors[k];
+
+                if (n->edge_caps[k] & denied)
+                    continue;
+                if (v < 0 || v >= nav_node_count ||
+                    nav_nodes[v].id == BOT_INVALID_NODE || s_closed[v])
+                    continue;
+                if (s_dist[v] == FLT_MAX) {
+                    s_touched[touched++] = v;
+                    s_open[open++] = v;
+                } else if (du + n->neighbor_costs[k] >= s_dist[v]) {
+                    continue;
+                }
+                s_dist[v] = du + n->neighbor_costs[k];
+            }
+        } else {
+            const unsigned short *from;
+            const unsigned char  *slot;
+            int                   count = BotNav_Incoming(u, &from, &slot);
+
+            for (k = 0; k < count; k++) {
+                const nav_node_t *n = &nav_nodes[from[k]];
+                int               v = from[k];
+
+                if ((n->edge_caps[slot[k]] & denied) || s_closed[v])
+                    continue;
+                if (s_dist[v] == FLT_MAX) {
+                    s_touched[touched++] = v;
+                    s_open[open++] = v;
+                } else if (du + n->neighbor_costs[slot[k]] >= s_dist[v]) {
+                    continue;
+                }
+                s_dist[v] = du + n->neighbor_costs[slot[k]];
+            }
+        }
+    }
+
+    for (i = 0; i < touched; i++) {
+        s_dist[s_touched[i]]   = FLT_MAX;
+        s_closed[s_touched[i]] = false;
+    }
+    for (k = 0; k < other->count[hub]; k++)
+        s_hub_dist[other->hub[hub][k]] = FLT_MAX;
+    return ok;
+}
+
+/* Reset profile p to the live graph and start ranking its nodes */
+static void NavDist_Begin(int p)
+{
+    navdist_profile_t *prof = &s_profiles[p];
+    int                i;
+
+    for (i = 0; i < MAX_NAV_NODES; i++) {
+        s_dist[i]     = FLT_MAX;
+        s_hub_dist[i] = FLT_MAX;
+        s_closed[i]   = false;
+    }
+    memset(prof->labels[LABEL_OUT].count, 0, sizeof(prof->labels[LABEL_OUT].count));
+    memset(prof->labels[LABEL_IN].count,  0, sizeof(prof->labels[LABEL_IN].count));
+
+    prof->bank       = nav_nodes;
+    prof->version    = nav_graph_version;
+    prof->node_count = nav_node_count;
+    prof->build_time = level.time;
+    prof->built      = true;
+    prof->valid      = false;
+
+    s_build_profile = p;
+    s_build_nodes   = NavDist_OrderBegin();
+    s_build_next    = 0;
+    s_stage         = s_build_nodes ? NAVDIST_ORDER : NAVDIST_SORT;
+}
+
+/*
+ * Advance the build in progress by one sample tree, by the ranking, or
+ * by hubs until budget nodes have been settled.  The profile becomes
+ * valid when the last hub is done.
+ */
+static void NavDist_Step(int budget)
+{
+    navdist_profile_t *prof   = &s_profiles[s_build_profile];
+    unsigned int       denied = ~s_profile_caps[s_build_profile];
+    int                n      = s_build_nodes;
+    int                work   = 0;
+
+    switch (s_stage) {
+    case NAVDIST_ORDER:
+        NavDist_OrderSample(denied, n, s_build_next++);
+        if (s_build_next >= BOT_NAVDIST_SAMPLES || s_build_next >= n)
+            s_stage = NAVDIST_SORT;
+        return;
+
+    case NAVDIST_SORT:
+        NavDist_OrderSort(n);
+        s_build_next = 0;
+        s_stage      = NAVDIST_LABELS;
+        return;
+
+    default:
+        break;
+    }
+
+    for (; work < budget && s_build_next < n; s_build_next++) {
+        if (!NavDist_Prune(prof, denied, s_build_next, LABEL_IN, &work) ||
+            !NavDist_Prune(prof, denied, s_build_next, LABEL_OUT, &work)) {
+            gi.dprintf("BotNavDist: more than %d hubs per node for caps %u; "
+                       "distances will be straight-line\n",
+                       BOT_NAVDIST_LABEL_MAX, s_profile_caps[s_build_profile]);
+            s_stage = NAVDIST_IDLE;
+            return;
+        }
+    }
+    if (s_build_next >= n) {
+        prof->valid = true;
+        s_stage     = NAVDIST_IDLE;
+    }
+}
+
+/* True if the profile's labels describe the live graph */
+static qboolean NavDist_Current(const navdist_profile_t *prof)
+{
+    return prof->built && prof->bank == nav_nodes &&
+           prof->version == nav_graph_version &&
+           prof->node_count == nav_node_count;
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+void BotNavDist_Clear(void)
+{
+    int p;
+
+    for (p = 0; p < BOT_NAVDIST_PROFILES; p++) {
+        s_profiles[p].built = false;
+        s_profiles[p].valid = false;
+    }
+    s_stage = NAVDIST_IDLE;
+}
+
+void BotNavDist_BuildAll(void)
+{
+    int p;
+
+    for (p = 0; p < BOT_NAVDIST_PROFILES; p++) {
+        NavDist_Begin(p);
+        while (s_stage != NAVDIST_IDLE)
+            NavDist_Step(INT_MAX);
+    }
+}
+
+void BotNavDist_Frame(void)
+{
+    int p;
+
+    /* Edited mid-build: drop it and start again once the interval is up */
+    if (s_stage != NAVDIST_IDLE &&
+        !NavDist_Current(&s_profiles[s_build_profile]))
+        s_stage = NAVDIST_IDLE;
+
+    for (p = 0; s_stage == NAVDIST_IDLE && p < BOT_NAVDIST_PROFILES; p++) {
+        const navdist_profile_t *prof = &s_profiles[p];
+
+        if (!prof->built || NavDist_Current(prof))
+            continue;
+        if (level.time >= prof->build_time &&
+            level.time - prof->build_time < BOT_NAVDIST_REBUILD)
+            continue;
+        NavDist_Begin(p);
+    }
+
+    if (s_stage != NAVDIST_IDLE)
+        NavDist_Step(BOT_NAVDIST_WORK);
+}
+
+qboolean BotNavDist_Lookup(int a, int b, unsigned int caps, float *out)
+{
+    const navdist_labels_t *lo, *li;
+    navdist_profile_t      *prof;
+    int   p = NavDist_Profile(caps);
+    int   i, j, na, nb;
+    float best = FLT_MAX;
+
+    if (p < 0)
+        return false;
+    prof = &s_profiles[p];
+    if (!NavDist_Current(prof) || !prof->valid)
+        return false;
+
+    lo = &prof->labels[LABEL_OUT];
+    li = &prof->labels[LABEL_IN];
+    na = lo->count[a];
+    nb = li->count[b];
+
+    for (i = j = 0; i < na && j < nb; ) {
+        if (lo->hub[a][i] < li->hub[b][j]) {
+            i++;
+        } else if (lo->hub[a][i] > li->hub[b][j]) {
+            j++;
+        } else {
+            if (lo->dist[a][i] + li->dist[b][j] < best)
+                best = lo->dist[a][i] + li->dist[b][j];
+            i++;
+            j++;
+        }
+    }
+
+    *out = best;
+    return true;
+}
+
+float BotNavDist_MeanLabel(unsigned int caps)
+{
+    const navdist_profile_t *prof;
+    int p = NavDist_Profile(caps);
+    int i, nodes = 0, total = 0;
+
+    if (p < 0)
+        return 0.0f;
+    prof = &s_profiles[p];
+    if (!NavDist_Current(prof) || !prof->valid)
+        return 0.0f;
+
+    for (i = 0; i < nav_node_count; i++) {
+        if (nav_nodes[i].id == BOT_INVALID_NODE)
+            continue;
+        total += prof->labels[LABEL_OUT].count[i] + prof->labels[LABEL_IN].count[i];
+        nodes++;
+    }
+    return nodes ? (float)total / (2 * nodes) : 0.0f;
+}
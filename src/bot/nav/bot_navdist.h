@@ -0,0 +1,50 @@
+/*
+ * bot_navdist.h -- exact travel distances from 2-hop hub labels
+ *
+ * Scoring code (build placement, escorts, zone choice) wants the real
+ * path length between nodes, not the straight-line distance, and cannot
+ * afford a search per candidate.  For each movement profile (ground,
+ * wall-walk, fly) the graph is covered with pruned landmark labels:
+ * every node keeps a short list of (hub, distance) pairs to and from
+ * higher-ranked hubs, such that every shortest path passes through a hub
+ * both ends share.  A query is a merge of two sorted lists, well under a
+ * microsecond on a full graph.
+ *
+ * Labels are built when a graph goes live.  After the graph is edited
+ * they are rebuilt from BotNavDist_Frame, spread over frames and at most
+ * once per BOT_NAVDIST_REBUILD seconds; until then lookups fail.  A node
+ * whose label would exceed BOT_NAVDIST_LABEL_MAX entries disables the
+ * profile until the next edit.
+ */
+
+#ifndef BOT_NAVDIST_H
+#define BOT_NAVDIST_H
+
+#include "bot_nodes.h"
+
+#define BOT_NAVDIST_PROFILES   3        /* ground, wall-walk, fly            */
+#define BOT_NAVDIST_LABEL_MAX  128      /* hubs per node and direction       */
+#define BOT_NAVDIST_REBUILD    1.0f     /* minimum seconds between rebuilds  */
+#define BOT_NAVDIST_SAMPLES    16       /* shortest-path trees for ranking   */
+#define BOT_NAVDIST_WORK       4096     /* rebuild nodes settled per frame   */
+
+/* Drop all labels (map change). */
+void     BotNavDist_Clear(void);
+
+/* Build labels for every profile; called when a graph goes live. */
+void     BotNavDist_BuildAll(void);
+
+/* Rebuild labels the graph has outgrown, a slice per server frame. */
+void     BotNavDist_Frame(void);
+
+/*
+ * Distance from a to b over edges whose NAV_CAP_* bits are all in caps.
+ * Writes FLT_MAX for unreachable pairs.  Returns false, leaving *out
+ * alone, when no current labels cover caps.
+ */
+qboolean BotNavDist_Lookup(int a, int b, unsigned int caps, float *out);
+
+/* Mean entries per label for the profile of caps; 0 if not built. */
+float    BotNavDist_MeanLabel(unsigned int caps);
+
+#endif /* BOT_NAVDIST_H */
@@ -0,0 +1,723 @@
+/*
+ * bot_navfile.c -- reading and writing .nav files
+ *
+ * See bot_navfile.h.  A binary file is built or parsed as one memory
+ * image, so a save is a single write and a load a single read.  The
+ * layout is the packed native-endian record stream described in
+ * bot_nodes.h; version 2 adds a CRC32 of everything but the CRC field.
+ * Text files stream through the same load buffer.
+ */
+
+#include "bot_navfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define NAV_HEADER_V1   (3 * (int)sizeof(int))
+#define NAV_HEADER_V2   (4 * (int)sizeof(int))
+#define NAV_CRC_OFFSET  (3 * (int)sizeof(int))
+#define NAV_RECORD_SIZE ((int)(7 * sizeof(int) + \
+                               MAX_NODE_NEIGHBORS * 3 * sizeof(int)))
+#define NAV_FILE_MAX    (NAV_HEADER_V2 + MAX_NAV_NODES * NAV_RECORD_SIZE)
+
+#define NAV_TEXT_TOKEN  64      /* longest text token                   */
+#define NAV_TEXT_LINE   160     /* longest line the text writer emits   */
+#define NAV_COST_UNSET  (-1.0f) /* text link without a cost: distance   */
+
+static unsigned char s_write_buf[NAV_FILE_MAX];  /* one writer at a time */
+static unsigned char s_read_buf[NAV_FILE_MAX];   /* one reader at a time */
+
+/* -----------------------------------------------------------------------
+   Helpers
+   ----------------------------------------------------------------------- */
+
+/* CRC-32 (IEEE), nibble table: no init step, safe on any thread */
+static unsigned int NavFile_Crc32(unsigned int crc, const unsigned char *p, int len)
+{
+    static const unsigned int t[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    crc = ~crc;
+    while (len-- > 0) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ t[crc & 15];
+        crc = (crc >> 4) ^ t[crc & 15];
+    }
+    return ~crc;
+}
+
+static unsigned int NavFile_Crc(const unsigned char *buf, int len)
+{
+    unsigned int crc = NavFile_Crc32(0, buf, NAV_CRC_OFFSET);
+
+    return NavFile_Crc32(crc, buf + NAV_HEADER_V2, len - NAV_HEADER_V2);
+}
+
+static void NavFile_Put(unsigned char **p, const void *v, int size)
+{
+    memcpy(*p, v, (size_t)size);
+    *p += size;
+}
+
+static void NavFile_Get(const unsigned char **p, void *v, int size)
+{
+    memcpy(v, *p, (size_t)size);
+    *p += size;
+}
+
+/* File ID of slot id in nodes, or BOT_INVALID_NODE */
+static int NavFile_ExtId(const nav_node_t *nodes, int count, int id)
+{
+    if (id < 0 || id >= count || nodes[id].id == BOT_INVALID_NODE)
+        return BOT_INVALID_NODE;
+    return nodes[id].ext_id;
+}
+
+static float NavFile_Distance(const nav_node_t *a, const nav_node_t *b)
+{
+    float dx = a->origin[0] - b->origin[0];
+    float dy = a->origin[1] - b->origin[1];
+    float dz = a->origin[2] - b->origin[2];
+
+    return sqrtf(dx*dx + dy*dy + dz*dz);
+}
+
+static void NavFile_ClearBank(nav_node_t *bank)
+{
+    int i, j;
+
+    for (i = 0; i < MAX_NAV_NODES; i++) {
+        bank[i].id            = BOT_INVALID_NODE;
+        bank[i].num_neighbors = 0;
+        for (j = 0; j < MAX_NODE_NEIGHBORS; j++)
+            bank[i].neighbors[j] = BOT_INVALID_NODE;
+    }
+}
+
+/* -----------------------------------------------------------------------
+   Binary reader
+   ----------------------------------------------------------------------- */
+static qboolean NavFile_ReadBinary(const char *path, int len, nav_node_t *bank,
+                                   int *out_count, int *out_loaded,
+                                   char *err, int errsize)
+{
+    const unsigned char *p = s_read_buf;
+    int          header, magic, version, count, highest, i;
+    unsigned int crc;
+
+    /* Validate header */
+    if (len < NAV_HEADER_V1) {
+        Com_sprintf(err, errsize, "'%s' truncated header", path);
+        return false;
+    }
+    NavFile_Get(&p, &magic,   sizeof(int));
+    NavFile_Get(&p, &version, sizeof(int));
+    NavFile_Get(&p, &count,   sizeof(int));
+
+    if (version == NAV_FILE_VERSION) {
+        if (len < NAV_HEADER_V2) {
+            Com_sprintf(err, errsize, "'%s' truncated header", path);
+            return false;
+        }
+        NavFile_Get(&p, &crc, sizeof(int));
+        if (crc != NavFile_Crc(s_read_buf, len)) {
+            Com_sprintf(err, errsize, "'%s' checksum mismatch", path);
+            return false;
+        }
+        header = NAV_HEADER_V2;
+    } else if (version == 1) {
+        header = NAV_HEADER_V1;
+    } else {
+        Com_sprintf(err, errsize, "'%s' unsupported version %d", path, version);
+        return false;
+    }
+
+    if (count < 0 || count > MAX_NAV_NODES) {
+        Com_sprintf(err, errsize, "'%s' invalid node count %d", path, count);
+        return false;
+    }
+    if (len - header < count * NAV_RECORD_SIZE) {
+        Com_sprintf(err, errsize, "'%s' truncated at node %d", path,
+                    (len - header) / NAV_RECORD_SIZE);
+        return false;
+    }
+
+    NavFile_ClearBank(bank);
+    highest = 0;
+
+    for (i = 0; i < count; i++) {
+        nav_node_t  n;
+        int         j;
+        int         id;
+
+        memset(&n, 0, sizeof(n));
+
+        NavFile_Get(&p, &id,              sizeof(int));
+        NavFile_Get(&p, n.origin,         3 * sizeof(float));
+        NavFile_Get(&p, &n.flags,         sizeof(unsigned int));
+        NavFile_Get(&p, &n.team_access,   sizeof(unsigned int));
+        NavFile_Get(&p, &n.num_neighbors, sizeof(int));
+
+        for (j = 0; j < MAX_NODE_NEIGHBORS; j++) {
+            NavFile_Get(&p, &n.neighbors[j],         sizeof(int));
+            NavFile_Get(&p, &n.neighbor_costs[j],    sizeof(float));
+            NavFile_Get(&p, &n.movement_required[j], sizeof(int));
+            n.edge_caps[j] = Node_MoveCaps(n.movement_required[j]);
+        }
+
+        if (id < 0 || id >= MAX_NAV_NODES) {
+            Com_sprintf(err, errsize, "'%s' node index %d out of range", path, id);
+            return false;
+        }
+
+        if (n.num_neighbors < 0 || n.num_neighbors > MAX_NODE_NEIGHBORS) {
+            Com_sprintf(err, errsize, "'%s' node %d invalid neighbor count %d",
+                        path, id, n.num_neighbors);
+            return false;
+        }
+
+        n.id     = id;
+        n.ext_id = id;
+        bank[id] = n;
+
+        if (id >= highest)
+            highest = id + 1;
+    }
+
+    *out_count  = highest;
+    *out_loaded = count;
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   Text reader
+   The file is consumed a buffer at a time; tokens are copied into a
+   small stack buffer, so a line is never held whole.
+   ----------------------------------------------------------------------- */
+typedef struct {
+    FILE          *f;
+    unsigned char *buf;
+    int            size, pos, len;
+    int            line;
+} navtext_reader_t;
+
+static int Text_Peek(navtext_reader_t *r)
+{
+    if (r->pos >= r->len) {
+        r->len = (int)fread(r->buf, 1, (size_t)r->size, r->f);
+        r->pos = 0;
+        if (r->len <= 0)
+            return EOF;
+    }
+    return r->buf[r->pos];
+}
+
+static void Text_SkipSpace(navtext_reader_t *r)
+{
+    int c;
+
+    while ((c = Text_Peek(r)) == ' ' || c == '\t' || c == '\r')
+        r->pos++;
+}
+
+/* Skip the rest of the line, including the newline */
+static void Text_SkipLine(navtext_reader_t *r)
+{
+    int c;
+
+    while ((c = Text_Peek(r)) != EOF) {
+        r->pos++;
+        if (c == '\n')
+            break;
+    }
+    r->line++;
+}
+
+/*
+ * Next token on this line into tok; false at end of line or at a comment.
+ * Over-long tokens are truncated, which makes them fail to parse.
+ */
+static qboolean Text_Token(navtext_reader_t *r, char *tok)
+{
+    int c, n = 0;
+
+    Text_SkipSpace(r);
+    c = Text_Peek(r);
+    if (c == EOF || c == '\n' || c == '#')
+        return false;
+    if (c == '/') {
+        r->pos++;
+        if (Text_Peek(r) == '/') {
+            /* Comment: run up to the newline so later calls stop too */
+            while ((c = Text_Peek(r)) != EOF && c != '\n')
+                r->pos++;
+            return false;
+        }
+        tok[n++] = '/';
+    }
+
+    while ((c = Text_Peek(r)) != EOF && c != ' ' && c != '\t' &&
+           c != '\r' && c != '\n') {
+        if (n < NAV_TEXT_TOKEN - 1)
+            tok[n++] = (char)c;
+        r->pos++;
+    }
+    tok[n] = '\0';
+    return true;
+}
+
+/* IDs, teams and moves are decimal: "node 010" is node 10, not 8 */
+static qboolean Text_Int(navtext_reader_t *r, long *out)
+{
+    char  tok[NAV_TEXT_TOKEN];
+    char *end;
+
+    if (!Text_Token(r, tok))
+        return false;
+    *out = strtol(tok, &end, 10);
+    return end != tok && *end == '\0';
+}
+
+/* Node flags: decimal, or hex with a 0x prefix */
+static qboolean Text_Flags(navtext_reader_t *r, unsigned long *out)
+{
+    char  tok[NAV_TEXT_TOKEN];
+    char *end;
+    int   hex;
+
+    if (!Text_Token(r, tok))
+        return false;
+    hex = (tok[0] == '0' && (tok[1] == 'x' || tok[1] == 'X'));
+    *out = strtoul(tok, &end, hex ? 16 : 10);
+    return end != tok && *end == '\0';
+}
+
+static qboolean Text_Float(navtext_reader_t *r, float *out)
+{
+    char  tok[NAV_TEXT_TOKEN];
+    char *end;
+
+    if (!Text_Token(r, tok))
+        return false;
+    *out = (float)strtod(tok, &end);
+    return *end == '\0';
+}
+
+/* Append from -> to unless already linked; false if the list is full */
+static qboolean Text_AddLink(nav_node_t *bank, int from, int to,
+                             int move, float cost)
+{
+    nav_node_t *n = &bank[from];
+    int         j;
+
+    for (j = 0; j < n->num_neighbors; j++) {
+        if (n->neighbors[j] == to)
+            return true;
+    }
+    if (n->num_neighbors >= MAX_NODE_NEIGHBORS)
+        return false;
+    n->neighbors[n->num_neighbors]         = to;
+    n->neighbor_costs[n->num_neighbors]    = cost;
+    n->movement_required[n->num_neighbors] = move;
+    n->edge_caps[n->num_neighbors]         = Node_MoveCaps(move);
+    n->num_neighbors++;
+    return true;
+}
+
+/* One "node" line after the keyword */
+static qboolean Text_Node(navtext_reader_t *r, nav_node_t *bank,
+                          char *err, int errsize, const char *path)
+{
+    long          id;
+    unsigned long flags, team = NAV_TEAM_ALL;
+    float         org[3];
+    char          tok[NAV_TEXT_TOKEN];
+    nav_node_t   *n;
+
+    if (!Text_Int(r, &id) || !Text_Float(r, &org[0]) ||
+        !Text_Float(r, &org[1]) || !Text_Float(r, &org[2]) ||
+        !Text_Flags(r, &flags)) {
+        Com_sprintf(err, errsize, "'%s' line %d: expected "
+                    "'node <id> <x> <y> <z> <flags> [team]'", path, r->line);
+        return false;
+    }
+    if (Text_Token(r, tok)) {
+        char *end;
+
+        team = (unsigned long)strtoul(tok, &end, 10);
+        if (*end != '\0') {
+            Com_sprintf(err, errsize, "'%s' line %d: bad node team", path, r->line);
+            return false;
+        }
+    }
+    if (id < 0 || id >= MAX_NAV_NODES) {
+        Com_sprintf(err, errsize, "'%s' line %d: node id %ld out of range",
+                    path, r->line, id);
+        return false;
+    }
+
+    n = &bank[id];
+    if (n->id != BOT_INVALID_NODE) {
+        Com_sprintf(err, errsize, "'%s' line %d: node %ld defined twice",
+                    path, r->line, id);
+        return false;
+    }
+
+    /* Links naming this node may already be in place; keep them */
+    n->id          = (int)id;
+    n->ext_id      = (int)id;
+    n->origin[0]   = org[0];
+    n->origin[1]   = org[1];
+    n->origin[2]   = org[2];
+    n->flags       = (unsigned int)flags;
+    n->team_access = (unsigned int)team;
+    return true;
+}
+
+/* One "link" / "oneway" line after the keyword */
+static qboolean Text_Link(navtext_reader_t *r, nav_node_t *bank, qboolean both,
+                          char *err, int errsize, const char *path)
+{
+    long  from, to, move = NAV_MOVE_WALK;
+    float cost = NAV_COST_UNSET;
+    char  tok[NAV_TEXT_TOKEN];
+    char *end;
+    qboolean ok = true;
+
+    if (!Text_Int(r, &from) || !Text_Int(r, &to)) {
+        Com_sprintf(err, errsize, "'%s' line %d: expected "
+                    "'link <from> <to> [move] [cost]'", path, r->line);
+        return false;
+    }
+    if (Text_Token(r, tok)) {
+        move = strtol(tok, &end, 10);
+        ok = (*end == '\0' && move >= NAV_MOVE_WALK && move <= NAV_MOVE_LADDER);
+        if (ok && Text_Token(r, tok)) {
+            cost = (float)strtod(tok, &end);
+            ok = (*end == '\0' && cost >= 0.0f);
+        }
+    }
+    if (!ok) {
+        Com_sprintf(err, errsize, "'%s' line %d: bad link move or cost",
+                    path, r->line);
+        return false;
+    }
+    if (from < 0 || from >= MAX_NAV_NODES || to < 0 || to >= MAX_NAV_NODES ||
+        from == to) {
+        Com_sprintf(err, errsize, "'%s' line %d: bad link %ld -> %ld",
+                    path, r->line, from, to);
+        return false;
+    }
+
+    if (!Text_AddLink(bank, (int)from, (int)to, (int)move, cost) ||
+        (both && !Text_AddLink(bank, (int)to, (int)from, (int)move, cost))) {
+        Com_sprintf(err, errsize, "'%s' line %d: more than %d links on a node",
+                    path, r->line, MAX_NODE_NEIGHBORS);
+        return false;
+    }
+    return true;
+}
+
+static qboolean NavFile_ReadText(const char *path, FILE *f, int len,
+                                 nav_node_t *bank, int *out_count,
+                                 int *out_loaded, char *err, int errsize)
+{
+    navtext_reader_t r;
+    char     tok[NAV_TEXT_TOKEN];
+    int      i, j, highest = 0, loaded = 0;
+    qboolean ok = true;
+
+    /* The first chunk is already in the buffer */
+    r.f    = f;
+    r.buf  = s_read_buf;
+    r.size = (int)sizeof(s_read_buf);
+    r.pos  = 0;
+    r.len  = len;
+    r.line = 1;
+
+    NavFile_ClearBank(bank);
+
+    while (ok && Text_Peek(&r) != EOF) {
+        if (!Text_Token(&r, tok)) {
+            Text_SkipLine(&r);
+            continue;
+        }
+        if (strcmp(tok, "node") == 0) {
+            ok = Text_Node(&r, bank, err, errsize, path);
+            loaded++;
+        } else if (strcmp(tok, "link") == 0) {
+            ok = Text_Link(&r, bank, true, err, errsize, path);
+        } else if (strcmp(tok, "oneway") == 0) {
+            ok = Text_Link(&r, bank, false, err, errsize, path);
+        } else {
+            Com_sprintf(err, errsize, "'%s' line %d: unknown keyword '%s'",
+                        path, r.line, tok);
+            ok = false;
+        }
+        if (ok && Text_Token(&r, tok)) {
+            Com_sprintf(err, errsize, "'%s' line %d: unexpected '%s'",
+                        path, r.line, tok);
+            ok = false;
+        }
+        Text_SkipLine(&r);
+    }
+    if (!ok)
+        return false;
+
+    /* Every link must land on a defined node; fill in default costs */
+    for (i = 0; i < MAX_NAV_NODES; i++) {
+        nav_node_t *n = &bank[i];
+
+        for (j = 0; j < n->num_neighbors; j++) {
+            nav_node_t *to = &bank[n->neighbors[j]];
+
+            if (n->id == BOT_INVALID_NODE || to->id == BOT_INVALID_NODE) {
+                Com_sprintf(err, errsize, "'%s' link %d -> %d names an undefined node",
+                            path, i, n->neighbors[j]);
+                return false;
+            }
+            if (n->neighbor_costs[j] == NAV_COST_UNSET)
+                n->neighbor_costs[j] = NavFile_Distance(n, to);
+        }
+        if (n->id != BOT_INVALID_NODE)
+            highest = i + 1;
+    }
+
+    *out_count  = highest;
+    *out_loaded = loaded;
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   NavFile_Read
+   ----------------------------------------------------------------------- */
+qboolean NavFile_Read(const char *path, nav_node_t *bank, int *out_count,
+                      int *out_loaded, nav_file_format_t *out_format,
+                      char *err, int errsize)
+{
+    FILE    *f;
+    int      len, magic = 0;
+    qboolean ok;
+
+    f = fopen(path, "rb");
+    if (!f) {
+        Com_sprintf(err, errsize, "no nav file '%s'", path);
+        return false;
+    }
+    len = (int)fread(s_read_buf, 1, sizeof(s_read_buf), f);
+    if (len >= (int)sizeof(int))
+        memcpy(&magic, s_read_buf, sizeof(int));
+
+    if (magic == NAV_FILE_MAGIC) {
+        if (out_format)
+            *out_format = NAV_FORMAT_BINARY;
+        if (len == (int)sizeof(s_read_buf) && fgetc(f) != EOF) {
+            Com_sprintf(err, errsize, "'%s' too large", path);
+            ok = false;
+        } else {
+            ok = NavFile_ReadBinary(path, len, bank, out_count, out_loaded,
+                                    err, errsize);
+        }
+    } else {
+        if (out_format)
+            *out_format = NAV_FORMAT_TEXT;
+        ok = NavFile_ReadText(path, f, len, bank, out_count, out_loaded,
+                              err, errsize);
+    }
+
+    fclose(f);
+    return ok;
+}
+
+/* -----------------------------------------------------------------------
+   Writers
+   Both fill s_write_buf; the binary image always fits, text is flushed
+   whenever the next line might not.
+   ----------------------------------------------------------------------- */
+static int NavFile_BuildBinary(const nav_node_t *nodes, int count,
+                               int *out_written)
+{
+    unsigned char *p = s_write_buf;
+    int            i, valid_count = 0, version = NAV_FILE_VERSION;
+    int            magic = NAV_FILE_MAGIC;
+    unsigned int   crc = 0;
+
+    for (i = 0; i < count; i++) {
+        if (nodes[i].id != BOT_INVALID_NODE)
+            valid_count++;
+    }
+
+    /* Header; the CRC is patched in once the records are written */
+    NavFile_Put(&p, &magic,       sizeof(int));
+    NavFile_Put(&p, &version,     sizeof(int));
+    NavFile_Put(&p, &valid_count, sizeof(int));
+    NavFile_Put(&p, &crc,         sizeof(int));
+
+    /* Node records, under their file IDs */
+    for (i = 0; i < count; i++) {
+        const nav_node_t *n = &nodes[i];
+        int               j, nb;
+
+        if (n->id == BOT_INVALID_NODE)
+            continue;
+
+        NavFile_Put(&p, &n->ext_id,        sizeof(int));
+        NavFile_Put(&p, n->origin,         3 * sizeof(float));
+        NavFile_Put(&p, &n->flags,         sizeof(unsigned int));
+        NavFile_Put(&p, &n->team_access,   sizeof(unsigned int));
+        NavFile_Put(&p, &n->num_neighbors, sizeof(int));
+
+        for (j = 0; j < MAX_NODE_NEIGHBORS; j++) {
+            nb = (j < n->num_neighbors) ? NavFile_ExtId(nodes, count, n->neighbors[j])
+                                        : n->neighbors[j];
+            NavFile_Put(&p, &nb,                      sizeof(int));
+            NavFile_Put(&p, &n->neighbor_costs[j],    sizeof(float));
+            NavFile_Put(&p, &n->movement_required[j], sizeof(int));
+        }
+    }
+
+    i   = (int)(p - s_write_buf);
+    crc = NavFile_Crc(s_write_buf, i);
+    memcpy(s_write_buf + NAV_CRC_OFFSET, &crc, sizeof(crc));
+    *out_written = valid_count;
+    return i;
+}
+
+/* Is the link back from b to a identical, so one "link" line covers both? */
+static qboolean NavFile_Mutual(const nav_node_t *nodes, int a, int j, int b)
+{
+    const nav_node_t *nb = &nodes[b];
+    int k;
+
+    for (k = 0; k < nb->num_neighbors; k++) {
+        if (nb->neighbors[k] == a)
+            return nb->movement_required[k] == nodes[a].movement_required[j] &&
+                   nb->neighbor_costs[k] == nodes[a].neighbor_costs[j];
+    }
+    return false;
+}
+
+static qboolean NavFile_WriteTextTo(FILE *f, const nav_node_t *nodes, int count,
+                                    int *out_written)
+{
+    int  i, j, len = 0, written = 0;
+    qboolean ok = true;
+
+#define TEXT_FLUSH()                                                         \
+    do {                                                                     \
+        if (len > (int)sizeof(s_write_buf) - NAV_TEXT_LINE) {                \
+            ok = ok && fwrite(s_write_buf, 1, (size_t)len, f) == (size_t)len; \
+            len = 0;                                                         \
+        }                                                                    \
+    } while (0)
+
+    len += snprintf((char *)s_write_buf + len, NAV_TEXT_LINE,
+                    "# q2gloombot nav graph\n"
+                    "# node <id> <x> <y> <z> <flags> [team]\n"
+                    "# link|oneway <from> <to> [move] [cost]\n");
+
+    for (i = 0; i < count; i++) {
+        const nav_node_t *n = &nodes[i];
+
+        if (n->id == BOT_INVALID_NODE)
+            continue;
+        TEXT_FLUSH();
+        len += snprintf((char *)s_write_buf + len, NAV_TEXT_LINE,
+                        "node %d %.9g %.9g %.9g 0x%x",
+                        n->ext_id, n->origin[0], n->origin[1], n->origin[2],
+                        n->flags);
+        if (n->team_access != NAV_TEAM_ALL)
+            len += snprintf((char *)s_write_buf + len, 16, " %u", n->team_access);
+        s_write_buf[len++] = '\n';
+        written++;
+    }
+
+    for (i = 0; i < count; i++) {
+        const nav_node_t *n = &nodes[i];
+
+        if (n->id == BOT_INVALID_NODE)
+            continue;
+        for (j = 0; j < n->num_neighbors; j++) {
+            int      b = n->neighbors[j], ext = NavFile_ExtId(nodes, count, b);
+            qboolean mutual;
+
+            if (ext == BOT_INVALID_NODE)
+                continue;
+            mutual = NavFile_Mutual(nodes, i, j, b);
+            if (mutual && ext < n->ext_id)
+                continue;   /* written from the other end */
+            TEXT_FLUSH();
+            len += snprintf((char *)s_write_buf + len, NAV_TEXT_LINE,
+                            "%s %d %d %d %.9g\n", mutual ? "link" : "oneway",
+                            n->ext_id, ext, n->movement_required[j],
+                            n->neighbor_costs[j]);
+        }
+    }
+
+#undef TEXT_FLUSH
+
+    ok = ok && fwrite(s_write_buf, 1, (size_t)len, f) == (size_t)len;
+    *out_written = written;
+    return ok;
+}
+
+/* -----------------------------------------------------------------------
+   NavFile_Write
+   ----------------------------------------------------------------------- */
+int NavFile_Write(const char *path, const nav_node_t *nodes, int count,
+                  nav_file_format_t format, char *err, int errsize)
+{
+    char     tmp[MAX_QPATH + 24];
+    FILE    *f;
+    int      written = 0, len;
+    qboolean ok;
+
+    Com_sprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    f = fopen(tmp, "wb");
+    if (!f) {
+        Com_sprintf(err, errsize, "cannot open '%s' for writing", tmp);
+        return -1;
+    }
+
+    if (format == NAV_FORMAT_TEXT) {
+        ok = NavFile_WriteTextTo(f, nodes, count, &written);
+    } else {
+        len = NavFile_BuildBinary(nodes, count, &written);
+        ok = fwrite(s_write_buf, 1, (size_t)len, f) == (size_t)len;
+    }
+
+    /* Make the data durable before the rename makes it visible */
+    ok = ok && fflush(f) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(f)) == 0;
+#else
+    ok = ok && fsync(fileno(f)) == 0;
+#endif
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        Com_sprintf(err, errsize, "cannot write '%s'", tmp);
+        remove(tmp);
+        return -1;
+    }
+
+#ifdef _WIN32
+    remove(path);   /* rename() does not replace on Windows */
+#endif
+    if (rename(tmp, path) != 0) {
+        Com_sprintf(err, errsize, "cannot replace '%s'", path);
+        remove(tmp);
+        return -1;
+    }
+    return written;
+}
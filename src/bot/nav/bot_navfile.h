@@ -0,0 +1,59 @@
+/*
+ * bot_navfile.h -- reading and writing .nav files
+ *
+ * A .nav file is either the binary format described in bot_nodes.h or
+ * text.  Readers detect which one from the first four bytes, so a
+ * hand-edited text file can be dropped into maps/ as is.
+ *
+ * TEXT FORMAT
+ * -----------
+ *   # comment (also //)
+ *   node   <id> <x> <y> <z> <flags> [<team_access>]
+ *   link   <from> <to> [<move> [<cost>]]      both directions
+ *   oneway <from> <to> [<move> [<cost>]]      from -> to only
+ *
+ * flags are NAV_* bits, team_access NAV_TEAM_* bits (default both),
+ * move a NAV_MOVE_* value (default walk) and cost defaults to the
+ * distance between the nodes.  Integers may be written in hex (0x...).
+ * Links may come before the nodes they name; a link to a node that is
+ * never defined is an error.
+ *
+ * The text reader streams the file through the load buffer in one pass
+ * with no per-line allocation.  Nothing here touches globals or calls
+ * gi, so it runs on the nav loader thread and in tools/navtool.
+ */
+
+#ifndef BOT_NAVFILE_H
+#define BOT_NAVFILE_H
+
+#include "bot_nodes.h"
+
+#define NAV_FILE_MAGIC    0x3156414E  /* "NAV1" little-endian */
+#define NAV_FILE_VERSION  2           /* 2 adds a CRC32; 1 still loads */
+
+typedef enum {
+    NAV_FORMAT_BINARY,
+    NAV_FORMAT_TEXT
+} nav_file_format_t;
+
+/*
+ * Parse path (binary or text) into bank[MAX_NAV_NODES], indexed by file
+ * ID with ext_id set.  *out_count is the highest used slot + 1 and
+ * *out_loaded the number of nodes read; *out_format, if not NULL, says
+ * which format the file was in.  Failures are described in err.  Only one
+ * read may run at a time.
+ */
+qboolean NavFile_Read(const char *path, nav_node_t *bank, int *out_count,
+                      int *out_loaded, nav_file_format_t *out_format,
+                      char *err, int errsize);
+
+/*
+ * Write the first count slots of nodes to path under their ext_id
+ * numbers.  The file goes to <path>.tmp, is synced and is renamed over
+ * path, so a failed write leaves the old file alone.  Returns the number
+ * of nodes written, or -1 with err filled in.
+ */
+int      NavFile_Write(const char *path, const nav_node_t *nodes, int count,
+                       nav_file_format_t format, char *err, int errsize);
+
+#endif /* BOT_NAVFILE_H */
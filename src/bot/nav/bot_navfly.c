@@ -0,0 +1,915 @@
+/*
+ * bot_navfly.c -- free-space flight planning for flying classes
+ *
+ * See bot_navfly.h.  Octree cells and boxes are addressed in voxel units
+ * from s_origin.  A reference is a FLY_* kind in the top two bits and,
+ * for FLY_CELL and FLY_BRICK, an index into s_cells or s_bricks.
+ * Children are numbered x + 2y + 4z, brick voxels x + 4y + 16z, and
+ * s_open bits x + side (y + side z).
+ */
+
+#include "bot_navfly.h"
+#include <float.h>
+#include <math.h>
+
+#define FLY_FREE      0x00000000u
+#define FLY_SOLID     0x40000000u
+#define FLY_CELL      0x80000000u
+#define FLY_BRICK     0xC0000000u
+#define FLY_KIND(r)   ((r) & 0xC0000000u)
+#define FLY_INDEX(r)  ((int)((r) & 0x3FFFFFFFu))
+
+#define FLY_BRICK_SIDE  4            /* voxels on a brick edge              */
+#define FLY_MAX_SIDE    256          /* voxels on the root edge             */
+#define FLY_MAX_DEPTH   8
+#define FLY_BUCKET      16           /* voxels on a box-lookup bucket edge  */
+#define FLY_MAX_BUCKETS ((FLY_MAX_SIDE / FLY_BUCKET) * (FLY_MAX_SIDE / FLY_BUCKET) * \
+                         (FLY_MAX_SIDE / FLY_BUCKET))
+#define FLY_BUCKET_REFS (BOT_NAVFLY_MAX_BOXES * 8)
+#define FLY_MERGE_WORK  65536        /* 64-voxel spans merged per frame     */
+#define FLY_LINK_BOXES  1024         /* boxes linked per frame              */
+#define FLY_HEAP        65536
+#define FLY_LINE_STEPS  4096
+
+#define FLY_BIT(x, y, z) ((unsigned int)(x) + (unsigned int)s_side * \
+                          ((unsigned int)(y) + (unsigned int)s_side * (unsigned int)(z)))
+
+typedef struct {
+    int x, y, z, size;               /* voxels */
+} fly_cell_t;
+
+typedef struct {
+    unsigned short lo[3], hi[3];     /* voxels, hi exclusive */
+} fly_box_t;
+
+typedef enum {
+    FLY_IDLE,
+    FLY_TREE,
+    FLY_BOXES,
+    FLY_LINKS,
+    FLY_READY
+} fly_stage_t;
+
+/* Octree */
+static unsigned int       s_cells[BOT_NAVFLY_MAX_CELLS][8];
+static unsigned long long s_bricks[BOT_NAVFLY_MAX_BRICKS];  /* bit = blocked */
+static int                s_cell_count, s_brick_count;
+static unsigned int       s_root;
+static vec3_t             s_origin;
+static int                s_side;
+static fly_stage_t        s_stage;
+static qboolean           s_overflow;
+
+/* Build: depth-first stack of cells still to classify, then box merging */
+typedef struct {
+    int        parent;               /* -1 for the root */
+    int        child;
+    fly_cell_t cell;
+} fly_work_t;
+
+static fly_work_t         s_work[FLY_MAX_DEPTH * 8 + 1];
+static int                s_work_count;
+static int                s_traces;  /* this build */
+static unsigned long long s_open[FLY_MAX_SIDE * FLY_MAX_SIDE * FLY_MAX_SIDE / 64];
+static unsigned int       s_scan;    /* next s_open word to merge from */
+static int                s_link_next;
+
+/* Boxes, their lookup buckets and face links */
+static fly_box_t          s_boxes[BOT_NAVFLY_MAX_BOXES];
+static int                s_box_count;
+static int                s_buckets;                      /* per axis */
+static int                s_bucket_start[FLY_MAX_BUCKETS + 1];
+static unsigned short     s_bucket_box[FLY_BUCKET_REFS];
+static int                s_link_start[BOT_NAVFLY_MAX_BOXES + 1];
+static unsigned short     s_links[BOT_NAVFLY_MAX_LINKS];
+static int                s_link_count;
+static int                s_link_mark[BOT_NAVFLY_MAX_BOXES];
+
+/* Search, one state per box */
+static float              s_g[BOT_NAVFLY_MAX_BOXES];
+static vec3_t             s_pos[BOT_NAVFLY_MAX_BOXES];    /* point flown through */
+static int                s_parent[BOT_NAVFLY_MAX_BOXES];
+static int                s_via[BOT_NAVFLY_MAX_BOXES];    /* box that set s_pos */
+static unsigned int       s_seen[BOT_NAVFLY_MAX_BOXES];
+static unsigned int       s_done[BOT_NAVFLY_MAX_BOXES];
+static unsigned int       s_gen;
+static int                s_heap_box[FLY_HEAP];
+static float              s_heap_key[FLY_HEAP];
+static int                s_heap_count;
+static vec3_t             s_chain[BOT_NAVFLY_MAX_BOXES + 1];
+
+static struct {
+    unsigned int plans, failed, expanded, lines;
+} s_stats;
+
+/* -----------------------------------------------------------------------
+   Open-voxel bitmap
+   ----------------------------------------------------------------------- */
+
+/* Set or clear bits i .. i + n - 1 of s_open */
+static void NavFly_SetSpan(unsigned int i, int n, qboolean on)
+{
+    while (n > 0) {
+        int bit  = (int)(i & 63);
+        int take = (64 - bit < n) ? 64 - bit : n;
+        unsigned long long m = (take == 64 ? ~0ULL : (1ULL << take) - 1) << bit;
+
+        if (on)
+            s_open[i >> 6] |= m;
+        else
+            s_open[i >> 6] &= ~m;
+        i += (unsigned int)take;
+        n -= take;
+    }
+}
+
+/* True if bits i .. i + n - 1 of s_open are all set */
+static qboolean NavFly_SpanOpen(unsigned int i, int n)
+{
+    while (n > 0) {
+        int bit  = (int)(i & 63);
+        int take = (64 - bit < n) ? 64 - bit : n;
+        unsigned long long m = (take == 64 ? ~0ULL : (1ULL << take) - 1) << bit;
+
+        if ((s_open[i >> 6] & m) != m)
+            return false;
+        i += (unsigned int)take;
+        n -= take;
+    }
+    return true;
+}
+
+static void NavFly_MarkOpen(int x, int y, int z, int size)
+{
+    int vy, vz;
+
+    for (vz = z; vz < z + size; vz++)
+        for (vy = y; vy < y + size; vy++)
+            NavFly_SetSpan(FLY_BIT(x, vy, vz), size, true);
+}
+
+/* -----------------------------------------------------------------------
+   Build: octree
+   ----------------------------------------------------------------------- */
+
+/*
+ * FLY_FREE if the cell, grown by the clearance, touches no brush and is
+ * inside the map; FLY_SOLID if it touches none but lies in the void;
+ * FLY_CELL if it touches a brush and must be looked at more closely.
+ */
+static unsigned int NavFly_Classify(int x, int y, int z, int size)
+{
+    float   half = size * BOT_NAVFLY_VOXEL * 0.5f;
+    vec3_t  center, mins, maxs;
+    trace_t tr;
+    int     i;
+
+    center[0] = s_origin[0] + x * BOT_NAVFLY_VOXEL + half;
+    center[1] = s_origin[1] + y * BOT_NAVFLY_VOXEL + half;
+    center[2] = s_origin[2] + z * BOT_NAVFLY_VOXEL + half;
+    for (i = 0; i < 3; i++) {
+        maxs[i] = half + BOT_NAVFLY_CLEARANCE;
+        mins[i] = -maxs[i];
+    }
+
+    s_traces++;
+    tr = gi.trace(center, mins, maxs, center, NULL, BOT_NAVFLY_MASK);
+    if (tr.startsolid || tr.allsolid)
+        return FLY_CELL;
+    return (gi.pointcontents(center) & CONTENTS_SOLID) ? FLY_SOLID : FLY_FREE;
+}
+
+/* Classify the 64 voxels of a brick, two by two by two where possible */
+static unsigned int NavFly_BuildBrick(const fly_cell_t *c)
+{
+    unsigned long long mask = 0;
+    int b, v;
+
+    for (b = 0; b < 8; b++) {
+        int bx = (b & 1) * 2, by = ((b >> 1) & 1) * 2, bz = (b >> 2) * 2;
+        unsigned int kind = NavFly_Classify(c->x + bx, c->y + by, c->z + bz, 2);
+
+        if (kind == FLY_FREE)
+            continue;
+        for (v = 0; v < 8; v++) {
+            int vx = bx + (v & 1), vy = by + ((v >> 1) & 1), vz = bz + (v >> 2);
+
+            if (kind == FLY_SOLID ||
+                NavFly_Classify(c->x + vx, c->y + vy, c->z + vz, 1) != FLY_FREE)
+                mask |= 1ULL << (vx + 4 * vy + 16 * vz);
+        }
+    }
+
+    if (mask == 0)
+        return FLY_FREE;
+    if (mask == ~0ULL)
+        return FLY_SOLID;
+    if (s_brick_count >= BOT_NAVFLY_MAX_BRICKS) {
+        s_overflow = true;
+        return FLY_SOLID;
+    }
+
+    for (v = 0; v < 64; v++) {
+        if (!(mask >> v & 1))
+            NavFly_SetSpan(FLY_BIT(c->x + (v & 3), c->y + ((v >> 2) & 3),
+                                   c->z + (v >> 4)), 1, true);
+    }
+    s_bricks[s_brick_count] = mask;
+    return FLY_BRICK | (unsigned int)s_brick_count++;
+}
+
+/* Classify one queued cell, queueing its children if it is split */
+static void NavFly_BuildStep(void)
+{
+    fly_work_t   w = s_work[--s_work_count];
+    unsigned int ref;
+
+    if (w.cell.size == FLY_BRICK_SIDE) {
+        ref = NavFly_BuildBrick(&w.cell);
+    } else {
+        ref = NavFly_Classify(w.cell.x, w.cell.y, w.cell.z, w.cell.size);
+        if (ref == FLY_CELL && s_cell_count >= BOT_NAVFLY_MAX_CELLS) {
+            s_overflow = true;
+            ref = FLY_SOLID;
+        }
+        if (ref == FLY_CELL) {
+            int c = s_cell_count++, half = w.cell.size / 2, k;
+
+            ref = FLY_CELL | (unsigned int)c;
+            for (k = 7; k >= 0; k--) {
+                fly_work_t *child = &s_work[s_work_count++];
+
+                s_cells[c][k]    = FLY_SOLID;
+                child->parent    = c;
+                child->child     = k;
+                child->cell.x    = w.cell.x + (k & 1) * half;
+                child->cell.y    = w.cell.y + ((k >> 1) & 1) * half;
+                child->cell.z    = w.cell.z + (k >> 2) * half;
+                child->cell.size = half;
+            }
+        }
+    }
+
+    if (ref == FLY_FREE)
+        NavFly_MarkOpen(w.cell.x, w.cell.y, w.cell.z, w.cell.size);
+    if (w.parent < 0)
+        s_root = ref;
+    else
+        s_cells[w.parent][w.child] = ref;
+}
+
+/* -----------------------------------------------------------------------
+   Build: boxes
+   ----------------------------------------------------------------------- */
+
+/*
+ * Take the first open voxel, grow it greedily along x, then y, then z
+ * while the new face is all open, and close the box it covers.  Adds
+ * the cost to *work.  False when no open voxel is left or s_boxes is full.
+ */
+static qboolean NavFly_MergeStep(int *work)
+{
+    unsigned int words = (unsigned int)(s_side * s_side * s_side / 64);
+    unsigned int i;
+    fly_box_t   *b;
+    int          x, y, z, x1, y1, z1, nx, vy, vz;
+
+    while (s_scan < words && !s_open[s_scan])
+        s_scan++;
+    if (s_scan >= words)
+        return false;
+    if (s_box_count >= BOT_NAVFLY_MAX_BOXES) {
+        s_overflow = true;
+        return false;
+    }
+
+    for (i = s_scan * 64; !(s_open[i >> 6] >> (i & 63) & 1); i++)
+        ;
+    x = (int)(i % (unsigned int)s_side);
+    y = (int)(i / (unsigned int)s_side % (unsigned int)s_side);
+    z = (int)(i / (unsigned int)(s_side * s_side));
+
+    for (x1 = x + 1; x1 < s_side && NavFly_SpanOpen(FLY_BIT(x1, y, z), 1); x1++)
+        ;
+    nx = x1 - x;
+    for (y1 = y + 1; y1 < s_side && NavFly_SpanOpen(FLY_BIT(x, y1, z), nx); y1++)
+        ;
+    for (z1 = z + 1; z1 < s_side; z1++) {
+        for (vy = y; vy < y1; vy++) {
+            if (!NavFly_SpanOpen(FLY_BIT(x, vy, z1), nx))
+                break;
+        }
+        *work += vy - y + 1;
+        if (vy < y1)
+            break;
+    }
+    for (vz = z; vz < z1; vz++)
+        for (vy = y; vy < y1; vy++)
+            NavFly_SetSpan(FLY_BIT(x, vy, vz), nx, false);
+    *work += nx + (y1 - y) * (z1 - z + 1);
+
+    b = &s_boxes[s_box_count++];
+    b->lo[0] = (unsigned short)x;  b->hi[0] = (unsigned short)x1;
+    b->lo[1] = (unsigned short)y;  b->hi[1] = (unsigned short)y1;
+    b->lo[2] = (unsigned short)z;  b->hi[2] = (unsigned short)z1;
+    return true;
+}
+
+/* Bucket range covered by voxels lo .. hi - 1, clipped to the root */
+static void NavFly_BucketRange(const int *lo, const int *hi, int *b0, int *b1)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        b0[i] = (lo[i] > 0 ? lo[i] : 0) / FLY_BUCKET;
+        b1[i] = (hi[i] < s_side ? hi[i] - 1 : s_side - 1) / FLY_BUCKET;
+    }
+}
+
+/*
+ * File every box under each bucket it overlaps.  Boxes that would
+ * overflow s_bucket_box are dropped from the end.
+ */
+static void NavFly_BucketBoxes(void)
+{
+    int b, n, total = 0, i, x, y, z;
+    int lo[3], hi[3], b0[3], b1[3];
+
+    s_buckets = (s_side + FLY_BUCKET - 1) / FLY_BUCKET;
+    n = s_buckets * s_buckets * s_buckets;
+    memset(s_bucket_start, 0, sizeof(s_bucket_start[0]) * (n + 1));
+
+    for (b = 0; b < s_box_count; b++) {
+        int refs;
+
+        for (i = 0; i < 3; i++) {
+            lo[i] = s_boxes[b].lo[i];
+            hi[i] = s_boxes[b].hi[i];
+        }
+        NavFly_BucketRange(lo, hi, b0, b1);
+        refs = (b1[0] - b0[0] + 1) * (b1[1] - b0[1] + 1) * (b1[2] - b0[2] + 1);
+        if (total + refs > FLY_BUCKET_REFS) {
+            s_overflow  = true;
+            s_box_count = b;
+            break;
+        }
+        total += refs;
+        for (z = b0[2]; z <= b1[2]; z++)
+            for (y = b0[1]; y <= b1[1]; y++)
+                for (x = b0[0]; x <= b1[0]; x++)
+                    s_bucket_start[x + s_buckets * (y + s_buckets * z) + 1]++;
+    }
+
+    for (i = 0; i < n; i++)
+        s_bucket_start[i + 1] += s_bucket_start[i];
+
+    /* Fill each bucket back from its end; its end ends up as its start */
+    for (b = s_box_count - 1; b >= 0; b--) {
+        for (i = 0; i < 3; i++) {
+            lo[i] = s_boxes[b].lo[i];
+            hi[i] = s_boxes[b].hi[i];
+        }
+        NavFly_BucketRange(lo, hi, b0, b1);
+        for (z = b0[2]; z <= b1[2]; z++)
+            for (y = b0[1]; y <= b1[1]; y++)
+                for (x = b0[0]; x <= b1[0]; x++) {
+                    int k = x + s_buckets * (y + s_buckets * z);
+
+                    s_bucket_box[--s_bucket_start[k + 1]] = (unsigned short)b;
+                }
+    }
+    for (i = 0; i < n; i++)
+        s_bucket_start[i] = s_bucket_start[i + 1];
+    s_bucket_start[n] = total;
+}
+
+/*
+ * True if boxes a and b share part of a face: they touch along one axis
+ * and overlap, not just meet, along the other two.
+ */
+static qboolean NavFly_Adjacent(const fly_box_t *a, const fly_box_t *b)
+{
+    int touch = 0, i;
+
+    for (i = 0; i < 3; i++) {
+        if (a->hi[i] == b->lo[i] || b->hi[i] == a->lo[i])
+            touch++;
+        else if (a->lo[i] >= b->hi[i] || b->lo[i] >= a->hi[i])
+            return false;
+    }
+    return touch == 1;
+}
+
+/* Link up to count more boxes to their face neighbours */
+static void NavFly_LinkBoxes(int count)
+{
+    for (; count > 0 && s_link_next < s_box_count; count--, s_link_next++) {
+        const fly_box_t *a = &s_boxes[s_link_next];
+        int lo[3], hi[3], b0[3], b1[3], i, x, y, z;
+
+        s_link_start[s_link_next] = s_link_count;
+        for (i = 0; i < 3; i++) {
+            lo[i] = a->lo[i] - 1;
+            hi[i] = a->hi[i] + 1;
+        }
+        NavFly_BucketRange(lo, hi, b0, b1);
+
+        for (z = b0[2]; z <= b1[2]; z++) {
+            for (y = b0[1]; y <= b1[1]; y++) {
+                for (x = b0[0]; x <= b1[0]; x++) {
+                    int k = x + s_buckets * (y + s_buckets * z), e;
+
+                    for (e = s_bucket_start[k]; e < s_bucket_start[k + 1]; e++) {
+                        int b = s_bucket_box[e];
+
+                        if (b == s_link_next || s_link_mark[b] == s_link_next + 1)
+                            continue;
+                        s_link_mark[b] = s_link_next + 1;
+                        if (!NavFly_Adjacent(a, &s_boxes[b]))
+                            continue;
+                        if (s_link_count >= BOT_NAVFLY_MAX_LINKS) {
+                            s_overflow = true;
+                            continue;
+                        }
+                        s_links[s_link_count++] = (unsigned short)b;
+                    }
+                }
+            }
+        }
+    }
+    s_link_start[s_link_next] = s_link_count;
+}
+
+/* -----------------------------------------------------------------------
+   Queries
+   ----------------------------------------------------------------------- */
+
+/* The cell holding voxel (vx, vy, vz); false if blocked or outside */
+static qboolean NavFly_Locate(int vx, int vy, int vz, fly_cell_t *out)
+{
+    unsigned int ref = s_root;
+    int x = 0, y = 0, z = 0, size = s_side;
+
+    if (vx < 0 || vy < 0 || vz < 0 ||
+        vx >= s_side || vy >= s_side || vz >= s_side)
+        return false;
+
+    while (FLY_KIND(ref) == FLY_CELL) {
+        int half = size / 2, k = 0;
+
+        if (vx >= x + half) { k |= 1; x += half; }
+        if (vy >= y + half) { k |= 2; y += half; }
+        if (vz >= z + half) { k |= 4; z += half; }
+        ref  = s_cells[FLY_INDEX(ref)][k];
+        size = half;
+    }
+
+    if (FLY_KIND(ref) == FLY_BRICK) {
+        int bit = (vx - x) + 4 * (vy - y) + 16 * (vz - z);
+
+        out->x = vx;
+        out->y = vy;
+        out->z = vz;
+        out->size = 1;
+        return (s_bricks[FLY_INDEX(ref)] >> bit & 1) ? false : true;
+    }
+
+    out->x = x;
+    out->y = y;
+    out->z = z;
+    out->size = size;
+    return FLY_KIND(ref) == FLY_FREE;
+}
+
+/* The box holding voxel v, or -1 */
+static int NavFly_BoxAt(const int *v)
+{
+    int k, e;
+
+    if (v[0] < 0 || v[1] < 0 || v[2] < 0 ||
+        v[0] >= s_side || v[1] >= s_side || v[2] >= s_side)
+        return -1;
+
+    k = v[0] / FLY_BUCKET + s_buckets * (v[1] / FLY_BUCKET +
+                                         s_buckets * (v[2] / FLY_BUCKET));
+    for (e = s_bucket_start[k]; e < s_bucket_start[k + 1]; e++) {
+        const fly_box_t *b = &s_boxes[s_bucket_box[e]];
+
+        if (v[0] >= b->lo[0] && v[0] < b->hi[0] &&
+            v[1] >= b->lo[1] && v[1] < b->hi[1] &&
+            v[2] >= b->lo[2] && v[2] < b->hi[2])
+            return s_bucket_box[e];
+    }
+    return -1;
+}
+
+static float NavFly_Dist(const vec3_t a, const vec3_t b)
+{
+    float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+/*
+ * The box holding p, with p as the point to fly through; or, if p is
+ * too close to a wall, the box of the nearest free voxel within two,
+ * with its centre.  -1 if there is none.
+ */
+static int NavFly_FindBox(const vec3_t p, vec3_t pos)
+{
+    int   v[3], n[3], i, dx, dy, dz, box = -1;
+    float best = FLT_MAX;
+
+    for (i = 0; i < 3; i++)
+        v[i] = (int)floorf((p[i] - s_origin[i]) / BOT_NAVFLY_VOXEL);
+    box = NavFly_BoxAt(v);
+    if (box >= 0) {
+        VectorCopy(p, pos);
+        return box;
+    }
+
+    for (dz = -2; dz <= 2; dz++) {
+        for (dy = -2; dy <= 2; dy++) {
+            for (dx = -2; dx <= 2; dx++) {
+                float d = (float)(dx * dx + dy * dy + dz * dz);
+                int   b;
+
+                if (d >= best)
+                    continue;
+                n[0] = v[0] + dx;
+                n[1] = v[1] + dy;
+                n[2] = v[2] + dz;
+                if ((b = NavFly_BoxAt(n)) < 0)
+                    continue;
+                best = d;
+                box  = b;
+                for (i = 0; i < 3; i++)
+                    pos[i] = s_origin[i] + (n[i] + 0.5f) * BOT_NAVFLY_VOXEL;
+            }
+        }
+    }
+    return box;
+}
+
+/*
+ * The point on the face shared by boxes a and b nearest to toward, kept
+ * half a voxel in from the edges of the face.
+ */
+static void NavFly_Portal(const fly_box_t *a, const fly_box_t *b,
+                          const vec3_t toward, vec3_t out)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        float v, lo, hi;
+
+        if (a->hi[i] == b->lo[i]) {
+            v = a->hi[i];
+        } else if (b->hi[i] == a->lo[i]) {
+            v = a->lo[i];
+        } else {
+            lo = (a->lo[i] > b->lo[i] ? a->lo[i] : b->lo[i]) + 0.5f;
+            hi = (a->hi[i] < b->hi[i] ? a->hi[i] : b->hi[i]) - 0.5f;
+            v  = (toward[i] - s_origin[i]) / BOT_NAVFLY_VOXEL;
+            if (v < lo)
+                v = lo;
+            else if (v > hi)
+                v = hi;
+        }
+        out[i] = s_origin[i] + v * BOT_NAVFLY_VOXEL;
+    }
+}
+
+/* -----------------------------------------------------------------------
+   Search
+   ----------------------------------------------------------------------- */
+static void NavFly_Push(int box, float key)
+{
+    int i = s_heap_count++;
+
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+
+        if (s_heap_key[parent] <= key)
+            break;
+        s_heap_box[i] = s_heap_box[parent];
+        s_heap_key[i] = s_heap_key[parent];
+        i = parent;
+    }
+    s_heap_box[i] = box;
+    s_heap_key[i] = key;
+}
+
+static int NavFly_Pop(void)
+{
+    int   top = s_heap_box[0];
+    int   box, i = 0;
+    float key;
+
+    box = s_heap_box[--s_heap_count];
+    key = s_heap_key[s_heap_count];
+    for (;;) {
+        int child = 2 * i + 1;
+
+        if (child >= s_heap_count)
+            break;
+        if (child + 1 < s_heap_count && s_heap_key[child + 1] < s_heap_key[child])
+            child++;
+        if (key <= s_heap_key[child])
+            break;
+        s_heap_box[i] = s_heap_box[child];
+        s_heap_key[i] = s_heap_key[child];
+        i = child;
+    }
+    s_heap_box[i] = box;
+    s_heap_key[i] = key;
+    return top;
+}
+
+/*
+ * Write the path from start to goal, ending at gpos, with every point
+ * that the previous kept point can see dropped.  0 if it needs more
+ * than max_points.
+ */
+static int NavFly_Unwind(int start, int goal, const vec3_t gpos,
+                         vec3_t *points, int max_points)
+{
+    int n = 0, b, i, count = 0;
+
+    for (b = goal; b != start; b = s_parent[b])
+        n++;
+    VectorCopy(gpos, s_chain[n + 1]);
+    for (b = goal, i = n; i >= 0; b = s_parent[b], i--)
+        VectorCopy(s_pos[b], s_chain[i]);
+
+    for (i = 0; i <= n; ) {
+        int j = i + 1;
+
+        while (j <= n && BotNavFly_LineFree(s_chain[i], s_chain[j + 1]))
+            j++;
+        if (count >= max_points)
+            return 0;
+        VectorCopy(s_chain[j], points[count]);
+        count++;
+        i = j;
+    }
+    return count;
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+void BotNavFly_Clear(void)
+{
+    s_cell_count  = 0;
+    s_brick_count = 0;
+    s_box_count   = 0;
+    s_link_count  = 0;
+    s_link_next   = 0;
+    s_buckets     = 0;
+    s_root        = FLY_SOLID;
+    s_side        = 0;
+    s_work_count  = 0;
+    s_traces      = 0;
+    s_scan        = 0;
+    s_stage       = FLY_IDLE;
+    s_overflow    = false;
+    BotNavFly_ResetStats();
+}
+
+void BotNavFly_Begin(const vec3_t mins, const vec3_t maxs)
+{
+    float extent = 0.0f;
+    int   i;
+
+    BotNavFly_Clear();
+
+    for (i = 0; i < 3; i++) {
+        s_origin[i] = mins[i] - BOT_NAVFLY_MARGIN;
+        if (maxs[i] + BOT_NAVFLY_MARGIN - s_origin[i] > extent)
+            extent = maxs[i] + BOT_NAVFLY_MARGIN - s_origin[i];
+    }
+    for (s_side = FLY_BRICK_SIDE;
+         s_side * BOT_NAVFLY_VOXEL < extent && s_side < FLY_MAX_SIDE; )
+        s_side *= 2;
+    if (s_side * BOT_NAVFLY_VOXEL < extent)
+        gi.dprintf("BotNavFly: map is wider than %d units; "
+                   "flight planning covers part of it\n",
+                   (int)(FLY_MAX_SIDE * BOT_NAVFLY_VOXEL));
+
+    memset(s_open, 0, sizeof(s_open[0]) * (size_t)(s_side * s_side * s_side / 64));
+    memset(s_link_mark, 0, sizeof(s_link_mark));
+
+    s_work[0].parent    = -1;
+    s_work[0].child     = 0;
+    s_work[0].cell.x    = 0;
+    s_work[0].cell.y    = 0;
+    s_work[0].cell.z    = 0;
+    s_work[0].cell.size = s_side;
+    s_work_count = 1;
+    s_stage      = FLY_TREE;
+}
+
+void BotNavFly_Frame(void)
+{
+    int work = 0;
+
+    switch (s_stage) {
+    case FLY_TREE:
+        work = s_traces + BOT_NAVFLY_TRACES;
+        while (s_work_count > 0 && s_traces < work)
+            NavFly_BuildStep();
+        if (s_work_count == 0)
+            s_stage = FLY_BOXES;
+        break;
+
+    case FLY_BOXES:
+        while (work < FLY_MERGE_WORK) {
+            if (!NavFly_MergeStep(&work)) {
+                NavFly_BucketBoxes();
+                s_stage = FLY_LINKS;
+                break;
+            }
+        }
+        break;
+
+    case FLY_LINKS:
+        NavFly_LinkBoxes(FLY_LINK_BOXES);
+        if (s_link_next < s_box_count)
+            break;
+        s_stage = FLY_READY;
+        if (s_overflow)
+            gi.dprintf("BotNavFly: flight space too detailed (%d cells, "
+                       "%d bricks, %d boxes, %d links); the rest is "
+                       "treated as solid\n",
+                       BOT_NAVFLY_MAX_CELLS, BOT_NAVFLY_MAX_BRICKS,
+                       BOT_NAVFLY_MAX_BOXES, BOT_NAVFLY_MAX_LINKS);
+        break;
+
+    default:
+        break;
+    }
+}
+
+qboolean BotNavFly_Ready(void)
+{
+    return s_stage == FLY_READY;
+}
+
+qboolean BotNavFly_LineFree(const vec3_t a, const vec3_t b)
+{
+    float p[3], d[3], t = 0.0f, len = 0.0f, eps;
+    int   i, steps;
+
+    if (s_stage != FLY_READY)
+        return false;
+    s_stats.lines++;
+
+    for (i = 0; i < 3; i++) {
+        p[i] = (a[i] - s_origin[i]) / BOT_NAVFLY_VOXEL;
+        d[i] = (b[i] - a[i]) / BOT_NAVFLY_VOXEL;
+        len += d[i] * d[i];
+    }
+    len = sqrtf(len);
+    eps = (len > 1.0f) ? 1e-3f / len : 1e-3f;
+
+    /* Hop from the cell holding p + t d to wherever the segment leaves it */
+    for (steps = 0; steps < FLY_LINE_STEPS; steps++) {
+        fly_cell_t c;
+        float      exit = FLT_MAX;
+        int        lo[3];
+
+        for (i = 0; i < 3; i++)
+            lo[i] = (int)floorf(p[i] + t * d[i]);
+        if (!NavFly_Locate(lo[0], lo[1], lo[2], &c))
+            return false;
+
+        lo[0] = c.x;
+        lo[1] = c.y;
+        lo[2] = c.z;
+        for (i = 0; i < 3; i++) {
+            float te;
+
+            if (d[i] > 0.0f)
+                te = (lo[i] + c.size - p[i]) / d[i];
+            else if (d[i] < 0.0f)
+                te = (lo[i] - p[i]) / d[i];
+            else
+                continue;
+            if (te < exit)
+                exit = te;
+        }
+        if (exit >= 1.0f)
+            return true;
+        t = (exit > t) ? exit + eps : t + eps;
+    }
+    return false;
+}
+
+int BotNavFly_Plan(const vec3_t from, const vec3_t to,
+                   vec3_t *points, int max_points)
+{
+    vec3_t spos, gpos;
+    int    s, g;
+
+    if (s_stage != FLY_READY || max_points < 1)
+        return 0;
+    if ((s = NavFly_FindBox(from, spos)) < 0 || (g = NavFly_FindBox(to, gpos)) < 0)
+        return 0;
+
+    s_stats.plans++;
+    if (s == g) {
+        VectorCopy(gpos, points[0]);
+        return 1;
+    }
+
+    s_gen++;
+    s_heap_count = 0;
+    s_seen[s]    = s_gen;
+    s_g[s]       = 0.0f;
+    s_parent[s]  = s;
+    s_via[s]     = s;
+    VectorCopy(spos, s_pos[s]);
+    NavFly_Push(s, NavFly_Dist(spos, gpos));
+
+    while (s_heap_count > 0) {
+        int u = NavFly_Pop(), pp, e;
+
+        if (s_done[u] == s_gen)
+            continue;
+        s_done[u] = s_gen;
+        s_stats.expanded++;
+
+        /*
+         * Lazy Theta*: u was queued assuming its parent could see it.
+         * Check now, once per box; if not, fall back to the box whose
+         * face u's point lies on, which can always see it.
+         */
+        if (s_parent[u] != s_via[u] &&
+            !BotNavFly_LineFree(s_pos[s_parent[u]], s_pos[u])) {
+            s_parent[u] = s_via[u];
+            s_g[u] = s_g[s_via[u]] + NavFly_Dist(s_pos[s_via[u]], s_pos[u]);
+        }
+
+        if (u == g) {
+            int count = NavFly_Unwind(s, g, gpos, points, max_points);
+
+            if (!count)
+                s_stats.failed++;
+            return count;
+        }
+
+        /* Queue neighbours as if u's parent could see them */
+        pp = s_parent[u];
+        for (e = s_link_start[u]; e < s_link_start[u + 1]; e++) {
+            int    w = s_links[e];
+            vec3_t p;
+            float  cost;
+
+            if (s_done[w] == s_gen)
+                continue;
+            NavFly_Portal(&s_boxes[u], &s_boxes[w], s_pos[pp], p);
+            cost = s_g[pp] + NavFly_Dist(s_pos[pp], p);
+            if (s_seen[w] == s_gen && cost >= s_g[w])
+                continue;
+            if (s_heap_count >= FLY_HEAP) {
+                s_stats.failed++;
+                return 0;
+            }
+            s_seen[w]   = s_gen;
+            s_g[w]      = cost;
+            s_parent[w] = pp;
+            s_via[w]    = u;
+            VectorCopy(p, s_pos[w]);
+            NavFly_Push(w, cost + BOT_NAVFLY_GREED * NavFly_Dist(p, gpos));
+        }
+    }
+
+    s_stats.failed++;
+    return 0;
+}
+
+void BotNavFly_PrintStats(void)
+{
+    int bytes = s_cell_count * (int)sizeof(s_cells[0]) +
+                s_brick_count * (int)sizeof(s_bricks[0]) +
+                s_box_count * (int)(sizeof(s_boxes[0]) + sizeof(s_link_start[0])) +
+                s_link_count * (int)sizeof(s_links[0]);
+
+    gi.dprintf("Fly octree: %s, %d voxels a side, %d cells, %d bricks, "
+               "%d boxes, %d links, %d KB, %d traces\n",
+               s_stage == FLY_READY ? "ready" :
+               (s_stage == FLY_IDLE ? "none" : "building"),
+               s_side, s_cell_count, s_brick_count, s_box_count,
+               s_link_count, (bytes + 1023) / 1024, s_traces);
+    gi.dprintf("Flight plans: %u (%u failed), %.1f boxes expanded, "
+               "%.1f line tests per plan\n",
+               s_stats.plans, s_stats.failed,
+               s_stats.plans ? (float)s_stats.expanded / s_stats.plans : 0.0f,
+               s_stats.plans ? (float)s_stats.lines / s_stats.plans : 0.0f);
+}
+
+void BotNavFly_ResetStats(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+}
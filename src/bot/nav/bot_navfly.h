@@ -0,0 +1,95 @@
+/*
+ * bot_navfly.h -- free-space flight planning for flying classes
+ *
+ * Hand-placed NAV_FLY links leave Wraiths flying like ground units.
+ * This module keeps a sparse voxel octree of the space around the nav
+ * graph and plans any-angle paths through it.
+ *
+ * OCTREE
+ * ------
+ * The root is a cube of BOT_NAVFLY_VOXEL voxels, a power of two on a
+ * side, covering the nav graph plus BOT_NAVFLY_MARGIN.  A cell is free
+ * when a box BOT_NAVFLY_CLEARANCE larger than it touches no solid
+ * brush, so any point in a free cell has room for the hull.  Free cells
+ * and solid cells are stored as a tagged reference in their parent.
+ * Only mixed cells are split, down to bricks of 4x4x4 voxels kept as one
+ * 64-bit mask.  Open rooms therefore cost a handful of cells, and
+ * memory follows surface area, not volume.
+ *
+ * Cells are classified with zero-length box traces.  gi.pointcontents
+ * at the centre of a clear box catches the void outside the map, which
+ * has no brushes to hit.  Traces are not thread-safe, so the build runs
+ * on the server thread and is spread over frames, BOT_NAVFLY_TRACES per
+ * frame.  Flyers use the nav graph until it is done.
+ *
+ * BOXES
+ * -----
+ * Searching the octree itself is slow near walls, where every slanted
+ * surface leaves a fringe of one-voxel cells.  Once the tree is done the
+ * free voxels are merged greedily into axis-aligned boxes (grow along x,
+ * then y, then z), and boxes sharing part of a face are linked.  A room
+ * is then a handful of boxes whatever its shape at the edges.  Merging
+ * and linking are spread over frames too.
+ *
+ * PLANNING
+ * --------
+ * Lazy Theta* over boxes.  Each box is entered through a point on the
+ * face it shares with the box before it; a box is convex, so two points
+ * on its faces can always see each other.  A box is linked straight to
+ * its grandparent whenever the octree line test between them passes;
+ * the test hops from cell to cell, so it is cheap across open space.
+ * The heuristic is weighted by BOT_NAVFLY_GREED, which trades a little
+ * path length (the final pass drops every point the one before can see
+ * past) for far fewer boxes expanded.  Paths come back as a few points.
+ */
+
+#ifndef BOT_NAVFLY_H
+#define BOT_NAVFLY_H
+
+#include "bot.h"
+
+#define BOT_NAVFLY_VOXEL       32.0f    /* voxel edge, world units            */
+#define BOT_NAVFLY_CLEARANCE   16.0f    /* hull half-width kept clear         */
+#define BOT_NAVFLY_MARGIN      256.0f   /* space kept around the nav graph    */
+#define BOT_NAVFLY_MAX_CELLS   16384    /* interior octree cells              */
+#define BOT_NAVFLY_MAX_BRICKS  32768    /* 4x4x4 voxel leaf masks             */
+#define BOT_NAVFLY_TRACES      2048     /* build traces per server frame      */
+#define BOT_NAVFLY_MAX_BOXES   16384    /* merged free boxes                  */
+#define BOT_NAVFLY_MAX_LINKS   131072   /* box face links                     */
+#define BOT_NAVFLY_GREED       1.5f     /* heuristic weight (weighted A*)     */
+#define BOT_NAVFLY_MASK        (CONTENTS_SOLID | CONTENTS_PLAYERCLIP | \
+                                CONTENTS_WINDOW)
+
+/* Drop the octree (map change). */
+void     BotNavFly_Clear(void);
+
+/*
+ * Start building an octree over the box mins..maxs, padded by
+ * BOT_NAVFLY_MARGIN and at most 8192 units a side.  Any previous tree
+ * is dropped.
+ */
+void     BotNavFly_Begin(const vec3_t mins, const vec3_t maxs);
+
+/* Continue a build; called every server frame. */
+void     BotNavFly_Frame(void);
+
+/* True once the octree and its boxes are complete. */
+qboolean BotNavFly_Ready(void);
+
+/*
+ * Plan a flight from from to to.  Writes up to max_points world points
+ * to points, ending at to (from itself is not included).  Returns the
+ * number written, or 0 if there is no tree, either end is enclosed,
+ * there is no way through, or it needs more points.
+ */
+int      BotNavFly_Plan(const vec3_t from, const vec3_t to,
+                        vec3_t *points, int max_points);
+
+/* True if the segment a-b stays in free cells. */
+qboolean BotNavFly_LineFree(const vec3_t a, const vec3_t b);
+
+/* Octree size and planner counters, for "sv navstats". */
+void     BotNavFly_PrintStats(void);
+void     BotNavFly_ResetStats(void);
+
+#endif /* BOT_NAVFLY_H */
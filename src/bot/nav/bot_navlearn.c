@@ -0,0 +1,302 @@
+/*
+ * bot_navlearn.c -- learning nav nodes and edges from human movement
+ *
+ * See bot_navlearn.h.  Sampling only reads the graph; every edit happens
+ * in BotNavLearn_Frame on the server thread, where nav_nodes is owned.
+ */
+
+#include "bot_navlearn.h"
+#include "bot_cvars.h"
+#include <math.h>
+
+/* Per-client trip since the last anchor */
+typedef struct {
+    qboolean active;
+    vec3_t   anchor;        /* where the trip started                     */
+    int      anchor_node;   /* node at anchor, or BOT_INVALID_NODE        */
+    float    start_time;
+    int      move;          /* first non-walk NAV_MOVE_* seen on the trip */
+} navlearn_track_t;
+
+/* A trip waiting for confirmation */
+typedef struct {
+    vec3_t from, to;
+    int    move;
+    int    hits;
+} navlearn_cand_t;
+
+static navlearn_track_t s_tracks[MAX_CLIENTS + 1];
+static navlearn_cand_t  s_cands[NAVLEARN_MAX_CANDIDATES];
+static int              s_cand_count;
+static int              s_merged_edges;
+static int              s_merged_nodes;
+
+/* -----------------------------------------------------------------------
+   Helpers
+   ----------------------------------------------------------------------- */
+static float NavLearn_Dist(const vec3_t a, const vec3_t b)
+{
+    float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return sqrtf(dx*dx + dy*dy + dz*dz);
+}
+
+static float NavLearn_Spacing(void)
+{
+    float d = bot_nav_density ? bot_nav_density->value : 128.0f;
+
+    if (d < 64.0f)  d = 64.0f;
+    if (d > 256.0f) d = 256.0f;
+    return d;
+}
+
+static qboolean NavLearn_Linked(int a, int b)
+{
+    int i;
+
+    for (i = 0; i < nav_nodes[a].num_neighbors; i++) {
+        if (nav_nodes[a].neighbors[i] == b)
+            return true;
+    }
+    return false;
+}
+
+static void NavLearn_Anchor(navlearn_track_t *t, const vec3_t pos, int node)
+{
+    t->active      = true;
+    t->anchor_node = node;
+    t->start_time  = level.time;
+    t->move        = NAV_MOVE_WALK;
+    if (node != BOT_INVALID_NODE)
+        VectorCopy(nav_nodes[node].origin, t->anchor);
+    else
+        VectorCopy(pos, t->anchor);
+}
+
+/* Movement the player is using right now */
+static int NavLearn_MoveMode(edict_t *ent, usercmd_t *cmd)
+{
+    vec3_t probe;
+    float  yaw;
+
+    if (ent->waterlevel >= 2)
+        return NAV_MOVE_SWIM;
+    if (ent->groundentity)
+        return NAV_MOVE_WALK;
+
+    /* Q2 ladders are brushes in front of the player, not at the origin */
+    yaw = ent->s.angles[YAW] * ((float)M_PI / 180.0f);
+    probe[0] = ent->s.origin[0] + cosf(yaw) * 16.0f;
+    probe[1] = ent->s.origin[1] + sinf(yaw) * 16.0f;
+    probe[2] = ent->s.origin[2];
+    if (gi.pointcontents(probe) & CONTENTS_LADDER)
+        return NAV_MOVE_LADDER;
+
+    if (cmd->upmove > 0)
+        return NAV_MOVE_JUMP;
+    return NAV_MOVE_WALK;
+}
+
+/*
+ * Record a trip.  Trips between two nodes that are already linked teach
+ * us nothing; otherwise bump a matching candidate or start a new one.
+ * Candidates are directional: a drop seen once each way is two
+ * candidates with one sighting each, not one with two.
+ */
+static void NavLearn_Propose(const navlearn_track_t *t, const vec3_t to,
+                             int to_node, int team)
+{
+    int   i, move = t->move;
+    float horiz, dz;
+
+    if (t->anchor_node != BOT_INVALID_NODE && to_node != BOT_INVALID_NODE &&
+        NavLearn_Linked(t->anchor_node, to_node))
+        return;
+
+    /* Steeper than 45 degrees without leaving the surface: wall-walk */
+    dz    = fabsf(to[2] - t->anchor[2]);
+    horiz = sqrtf((to[0] - t->anchor[0]) * (to[0] - t->anchor[0]) +
+                  (to[1] - t->anchor[1]) * (to[1] - t->anchor[1]));
+    if (move == NAV_MOVE_WALK && team == TEAM_ALIEN && dz > 64.0f && dz > horiz)
+        move = NAV_MOVE_CLIMB;
+
+    for (i = 0; i < s_cand_count; i++) {
+        navlearn_cand_t *c = &s_cands[i];
+
+        if (c->move != move)
+            continue;
+        if (NavLearn_Dist(c->from, t->anchor) < NAVLEARN_SNAP &&
+            NavLearn_Dist(c->to, to) < NAVLEARN_SNAP) {
+            c->hits++;
+            return;
+        }
+    }
+
+    if (s_cand_count >= NAVLEARN_MAX_CANDIDATES)
+        return;
+
+    VectorCopy(t->anchor, s_cands[s_cand_count].from);
+    VectorCopy(to, s_cands[s_cand_count].to);
+    s_cands[s_cand_count].move = move;
+    s_cands[s_cand_count].hits = 1;
+    s_cand_count++;
+}
+
+/* Node flags implied by the movement used to reach a learned point */
+static unsigned int NavLearn_NodeFlags(int move)
+{
+    switch (move) {
+    case NAV_MOVE_JUMP:   return NAV_GROUND | NAV_JUMP;
+    case NAV_MOVE_CLIMB:  return NAV_WALLCLIMB;
+    case NAV_MOVE_SWIM:   return NAV_WATER;
+    case NAV_MOVE_LADDER: return NAV_LADDER;
+    default:              return NAV_GROUND;
+    }
+}
+
+/* Existing node at pos, or a new one; BOT_INVALID_NODE if the graph is full */
+static int NavLearn_Resolve(vec3_t pos, int move)
+{
+    int id = Node_FindNearest(pos, 0, NAVLEARN_SNAP);
+
+    if (id != BOT_INVALID_NODE)
+        return id;
+
+    id = Node_Add(pos, NavLearn_NodeFlags(move));
+    if (id != BOT_INVALID_NODE) {
+        if (move == NAV_MOVE_CLIMB)
+            nav_nodes[id].team_access = NAV_TEAM_ALIEN;
+        s_merged_nodes++;
+    }
+    return id;
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+void BotNavLearn_Clear(void)
+{
+    memset(s_tracks, 0, sizeof(s_tracks));
+    s_cand_count   = 0;
+    s_merged_edges = 0;
+    s_merged_nodes = 0;
+}
+
+void BotNavLearn_Sample(edict_t *ent, usercmd_t *cmd)
+{
+    navlearn_track_t *t;
+    int   node, move;
+    float dist, elapsed;
+
+    if (!bot_nav_learn || bot_nav_learn->value == 0.0f || !ent || !cmd)
+        return;
+    if (ent->s.number < 1 || ent->s.number > MAX_CLIENTS)
+        return;
+
+    t = &s_tracks[ent->s.number];
+    if (!ent->inuse || !ent->client || ent->client->is_bot ||
+        ent->health <= 0 || Node_LoadPending()) {
+        t->active = false;
+        return;
+    }
+
+    move = NavLearn_MoveMode(ent, cmd);
+    node = Node_FindNearest(ent->s.origin, 0, NAVLEARN_SNAP);
+
+    if (!t->active) {
+        NavLearn_Anchor(t, ent->s.origin, node);
+        return;
+    }
+
+    if (t->move == NAV_MOVE_WALK)
+        t->move = move;
+
+    /* Mid-air: wait for the landing before judging the trip */
+    if (move == NAV_MOVE_JUMP || (!ent->groundentity && move == NAV_MOVE_WALK))
+        return;
+
+    dist    = NavLearn_Dist(t->anchor, ent->s.origin);
+    elapsed = level.time - t->start_time;
+
+    /* Respawned, teleported, or dawdled: start over from here */
+    if (elapsed < 0.0f || elapsed > NAVLEARN_MAX_TRIP_TIME ||
+        dist > NAVLEARN_MAX_TRIP_DIST) {
+        NavLearn_Anchor(t, ent->s.origin, node);
+        return;
+    }
+
+    if (node != BOT_INVALID_NODE) {
+        if (node != t->anchor_node) {
+            NavLearn_Propose(t, nav_nodes[node].origin, node, ent->client->team);
+            NavLearn_Anchor(t, ent->s.origin, node);
+        } else if (move == NAV_MOVE_WALK) {
+            NavLearn_Anchor(t, ent->s.origin, node);    /* still home */
+        }
+        return;
+    }
+
+    if (dist >= NavLearn_Spacing()) {
+        NavLearn_Propose(t, ent->s.origin, BOT_INVALID_NODE, ent->client->team);
+        NavLearn_Anchor(t, ent->s.origin, BOT_INVALID_NODE);
+    }
+}
+
+void BotNavLearn_Frame(void)
+{
+    int i, merged = 0;
+
+    if (s_cand_count == 0 || Node_LoadPending())
+        return;
+
+    for (i = 0; i < s_cand_count && merged < NAVLEARN_BATCH; ) {
+        navlearn_cand_t *c = &s_cands[i];
+        int a, b;
+
+        if (c->hits < NAVLEARN_CONFIRM) {
+            i++;
+            continue;
+        }
+
+        a = NavLearn_Resolve(c->from, NAV_MOVE_WALK);
+        b = NavLearn_Resolve(c->to, c->move);
+        if (a != BOT_INVALID_NODE && b != BOT_INVALID_NODE && a != b &&
+            !NavLearn_Linked(a, b)) {
+            /* Only the way it was travelled: drops and jumps may not go back */
+            Node_ConnectOneWay(a, b, NavLearn_Dist(c->from, c->to), c->move);
+            s_merged_edges++;
+        }
+        merged++;
+
+        /* Unordered removal; the slot now holds an unvisited candidate */
+        s_cands[i] = s_cands[--s_cand_count];
+    }
+}
+
+int BotNavLearn_Pending(void)
+{
+    return s_cand_count;
+}
+
+int BotNavLearn_Merged(void)
+{
+    return s_merged_edges;
+}
+
+void BotNavLearn_Print(void)
+{
+    static const char *move_names[] = {
+        "walk", "jump", "climb", "fly", "swim", "ladder"
+    };
+    int i;
+
+    gi.dprintf("navlearn: %d pending, %d edges and %d nodes merged%s\n",
+               s_cand_count, s_merged_edges, s_merged_nodes,
+               (bot_nav_learn && bot_nav_learn->value) ? "" : " (bot_nav_learn 0)");
+    for (i = 0; i < s_cand_count; i++) {
+        const navlearn_cand_t *c = &s_cands[i];
+
+        gi.dprintf("  (%.0f %.0f %.0f) -> (%.0f %.0f %.0f)  %-6s  seen %d\n",
+                   c->from[0], c->from[1], c->from[2],
+                   c->to[0], c->to[1], c->to[2],
+                   move_names[c->move], c->hits);
+    }
+}
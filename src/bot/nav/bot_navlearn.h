@@ -0,0 +1,50 @@
+/*
+ * bot_navlearn.h -- learning nav nodes and edges from human movement
+ *
+ * When bot_nav_learn is set, every human usercmd passes through
+ * BotNavLearn_Sample.  Each player carries an anchor: the last node (or
+ * learned point) they stood on.  When they reach another node, or get
+ * bot_nav_density units away from any node, the trip since the anchor
+ * becomes a candidate edge tagged with the movement it took (walk, jump,
+ * ladder, wall-climb, swim).
+ *
+ * Candidates are batched and only merged into the graph once a trip has
+ * been seen NAVLEARN_CONFIRM times, so one odd rocket jump does not add
+ * an edge.  Edges are one-way, in the direction travelled; a path
+ * walked both ways is confirmed separately each way.  BotNavLearn_Frame
+ * merges a few per server frame with Node_Add / Node_ConnectOneWay,
+ * never while a nav load is in flight.
+ * "sv navlearn save" writes the grown graph back to the .nav file.
+ */
+
+#ifndef BOT_NAVLEARN_H
+#define BOT_NAVLEARN_H
+
+#include "bot_nodes.h"
+
+#define NAVLEARN_MAX_CANDIDATES  64     /* pending trips                       */
+#define NAVLEARN_CONFIRM         2      /* sightings before a trip is merged   */
+#define NAVLEARN_BATCH           4      /* merges per server frame             */
+#define NAVLEARN_SNAP            48.0f  /* "standing on a node" radius         */
+#define NAVLEARN_MAX_TRIP_TIME   5.0f   /* longer trips are discarded (s)      */
+#define NAVLEARN_MAX_TRIP_DIST   512.0f /* longer hops are teleports           */
+
+/* Drop trackers and pending candidates (map change). */
+void BotNavLearn_Clear(void);
+
+/* Record one usercmd from a human client; ignores bots and the dead. */
+void BotNavLearn_Sample(edict_t *ent, usercmd_t *cmd);
+
+/* Merge up to NAVLEARN_BATCH confirmed candidates into the graph. */
+void BotNavLearn_Frame(void);
+
+/* Candidates waiting for confirmation or merge. */
+int  BotNavLearn_Pending(void);
+
+/* Edges merged since the last BotNavLearn_Clear. */
+int  BotNavLearn_Merged(void);
+
+/* Print pending candidates and merge totals to the console. */
+void BotNavLearn_Print(void);
+
+#endif /* BOT_NAVLEARN_H */
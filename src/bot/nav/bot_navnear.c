@@ -0,0 +1,447 @@
+/*
+ * bot_navnear.c -- nearest structure of each type by travel distance
+ *
+ * See bot_navnear.h.  Every type keeps owner[] (source slot) and dist[]
+ * per node.  All three updates are the same Dijkstra over incoming edges
+ * that only lowers labels (NavNear_Settle); they differ in the seeds:
+ * every source for a rebuild, the new source for an add, and, for a
+ * removal, the cleared nodes priced through their still-labelled
+ * neighbours.  Labels outside a removed source's region stay optimal,
+ * since their own nearest structure is still there.
+ */
+
+#include "bot_navnear.h"
+#include "bot_nav.h"
+#include <float.h>
+
+#define NAVNEAR_NONE  0xFF     /* owner[] of a node no structure reaches */
+
+typedef struct {
+    edict_t *ent;
+    vec3_t   origin;           /* where it was when added                */
+    int      node;             /* BOT_INVALID_NODE if off the graph      */
+    qboolean in_use;
+    qboolean seen;             /* found by the current scan              */
+} navnear_source_t;
+
+typedef struct {
+    navnear_source_t src[BOT_NAVNEAR_SOURCES];
+    int              count;
+    unsigned char    owner[MAX_NAV_NODES];
+    float            dist[MAX_NAV_NODES];
+} navnear_type_t;
+
+static navnear_type_t    s_types[STRUCT_MAX];
+
+/* The graph the labels describe */
+static const nav_node_t *s_bank;
+static unsigned int      s_version;
+static int               s_node_count;
+static float             s_scan_time;
+
+/* Binary heap with lazy deletion: stale entries are skipped on pop */
+#define NAVNEAR_HEAP  (MAX_NAV_NODES * (MAX_NODE_NEIGHBORS + 1) + BOT_NAVNEAR_SOURCES)
+static int   s_heap_node[NAVNEAR_HEAP];
+static float s_heap_key[NAVNEAR_HEAP];
+static int   s_heap_count;
+
+static int   s_cleared[MAX_NAV_NODES];
+
+static const struct {
+    const char          *classname;
+    gloom_struct_type_t  type;
+} s_classnames[] = {
+    { "struct_teleporter",    STRUCT_TELEPORTER    },
+    { "struct_turret_mg",     STRUCT_TURRET_MG     },
+    { "struct_turret_rocket", STRUCT_TURRET_ROCKET },
+    { "struct_ammo_depot",    STRUCT_AMMO_DEPOT    },
+    { "struct_camera",        STRUCT_CAMERA        },
+    { "struct_reactor",       STRUCT_REACTOR       },
+    { "struct_egg",           STRUCT_EGG           },
+    { "struct_spiker",        STRUCT_SPIKER        },
+    { "struct_cocoon",        STRUCT_COCOON        },
+    { "struct_obstacle",      STRUCT_OBSTACLE      },
+    { "struct_overmind",      STRUCT_OVERMIND      }
+};
+
+/* -----------------------------------------------------------------------
+   Heap
+   ----------------------------------------------------------------------- */
+static void NavNear_Push(int node, float key)
+{
+    int i = s_heap_count++;
+
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+
+        if (s_heap_key[parent] <= key)
+            break;
+        s_heap_node[i] = s_heap_node[parent];
+        s_heap_key[i]  = s_heap_key[parent];
+        i = parent;
+    }
+    s_heap_node[i] = node;
+    s_heap_key[i]  = key;
+}
+
+static int NavNear_Pop(float *key)
+{
+    int   top = s_heap_node[0];
+    int   node, i = 0;
+    float k;
+
+    *key = s_heap_key[0];
+    node = s_heap_node[--s_heap_count];
+    k    = s_heap_key[s_heap_count];
+
+    for (;;) {
+        int child = 2 * i + 1;
+
+        if (child >= s_heap_count)
+            break;
+        if (child + 1 < s_heap_count && s_heap_key[child + 1] < s_heap_key[child])
+            child++;
+        if (k <= s_heap_key[child])
+            break;
+        s_heap_node[i] = s_heap_node[child];
+        s_heap_key[i]  = s_heap_key[child];
+        i = child;
+    }
+    s_heap_node[i] = node;
+    s_heap_key[i]  = k;
+    return top;
+}
+
+/* -----------------------------------------------------------------------
+   Labelling
+   ----------------------------------------------------------------------- */
+
+/* Give node to slot at distance d if that beats its label, and queue it */
+static void NavNear_Offer(navnear_type_t *t, int node, int slot, float d)
+{
+    if (d >= t->dist[node])
+        return;
+    t->dist[node]  = d;
+    t->owner[node] = (unsigned char)slot;
+    NavNear_Push(node, d);
+}
+
+/*
+ * Drain the heap.  A settled node passes its owner on to every node with
+ * a walk edge into it, if that shortens the other node's label.
+ */
+static void NavNear_Settle(navnear_type_t *t)
+{
+    while (s_heap_count > 0) {
+        const unsigned short *from;
+        const unsigned char  *slot;
+        float du;
+        int   u = NavNear_Pop(&du);
+        int   count, k;
+
+        if (du > t->dist[u])
+            continue;       /* superseded */
+
+        count = BotNav_Incoming(u, &from, &slot);
+        for (k = 0; k < count; k++) {
+            const nav_node_t *n = &nav_nodes[from[k]];
+
+            if (n->edge_caps[slot[k]])
+                continue;
+            NavNear_Offer(t, from[k], t->owner[u],
+                          du + n->neighbor_costs[slot[k]]);
+        }
+    }
+}
+
+static qboolean NavNear_ValidNode(int node)
+{
+    return node >= 0 && node < nav_node_count &&
+           nav_nodes[node].id != BOT_INVALID_NODE;
+}
+
+static void NavNear_Reset(navnear_type_t *t)
+{
+    int i;
+
+    for (i = 0; i < MAX_NAV_NODES; i++) {
+        t->owner[i] = NAVNEAR_NONE;
+        t->dist[i]  = FLT_MAX;
+    }
+}
+
+/* Relabel one type from scratch, re-snapping its structures to nodes */
+static void NavNear_Rebuild(navnear_type_t *t)
+{
+    int s;
+
+    NavNear_Reset(t);
+    if (!t->count)
+        return;
+
+    s_heap_count = 0;
+    for (s = 0; s < BOT_NAVNEAR_SOURCES; s++) {
+        navnear_source_t *src = &t->src[s];
+
+        if (!src->in_use)
+            continue;
+        src->node = nav_nodes ? Node_FindNearest(src->origin, 0, 0.0f)
+                              : BOT_INVALID_NODE;
+        if (NavNear_ValidNode(src->node))
+            NavNear_Offer(t, src->node, s, 0.0f);
+    }
+    NavNear_Settle(t);
+}
+
+/* Bring every type up to date with the live graph */
+static void NavNear_Sync(void)
+{
+    int type;
+
+    if (s_bank == nav_nodes && s_version == nav_graph_version &&
+        s_node_count == nav_node_count)
+        return;
+
+    s_bank       = nav_nodes;
+    s_version    = nav_graph_version;
+    s_node_count = nav_node_count;
+    for (type = 0; type < STRUCT_MAX; type++)
+        NavNear_Rebuild(&s_types[type]);
+}
+
+/* Clear the region of slot and refill it from its border */
+static void NavNear_Repair(navnear_type_t *t, int slot)
+{
+    int cleared = 0, i, k, s;
+
+    for (i = 0; i < nav_node_count; i++) {
+        if (t->owner[i] != slot)
+            continue;
+        t->owner[i] = NAVNEAR_NONE;
+        t->dist[i]  = FLT_MAX;
+        s_cleared[cleared++] = i;
+    }
+
+    s_heap_count = 0;
+
+    /* Structures that shared a node with the removed one */
+    for (s = 0; s < BOT_NAVNEAR_SOURCES; s++) {
+        if (t->src[s].in_use && NavNear_ValidNode(t->src[s].node))
+            NavNear_Offer(t, t->src[s].node, s, 0.0f);
+    }
+
+    /* Each cleared node, priced through its best labelled neighbour */
+    for (i = 0; i < cleared; i++) {
+        const nav_node_t *n = &nav_nodes[s_cleared[i]];
+        float best = FLT_MAX;
+        int   owner = NAVNEAR_NONE;
+
+        for (k = 0; k < n->num_neighbors; k++) {
+            int v = n->neighbors[k];
+
+            if (n->edge_caps[k] || !NavNear_ValidNode(v) ||
+                t->owner[v] == NAVNEAR_NONE)
+                continue;
+            if (t->dist[v] + n->neighbor_costs[k] < best) {
+                best  = t->dist[v] + n->neighbor_costs[k];
+                owner = t->owner[v];
+            }
+        }
+        if (owner != NAVNEAR_NONE)
+            NavNear_Offer(t, s_cleared[i], owner, best);
+    }
+    NavNear_Settle(t);
+}
+
+static gloom_struct_type_t NavNear_TypeOf(const edict_t *ent)
+{
+    int i;
+
+    if (!ent->classname)
+        return STRUCT_NONE;
+    for (i = 0; i < (int)(sizeof(s_classnames) / sizeof(s_classnames[0])); i++) {
+        if (Q_stricmp(ent->classname, s_classnames[i].classname) == 0)
+            return s_classnames[i].type;
+    }
+    return STRUCT_NONE;
+}
+
+/* Still the structure that was added: alive, same type, same place */
+static qboolean NavNear_Live(const navnear_source_t *src,
+                             gloom_struct_type_t type)
+{
+    const edict_t *ent = src->ent;
+
+    return ent->inuse && ent->health > 0 && NavNear_TypeOf(ent) == type &&
+           ent->s.origin[0] == src->origin[0] &&
+           ent->s.origin[1] == src->origin[1] &&
+           ent->s.origin[2] == src->origin[2];
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+void BotNavNear_Clear(void)
+{
+    int type;
+
+    for (type = 0; type < STRUCT_MAX; type++) {
+        memset(s_types[type].src, 0, sizeof(s_types[type].src));
+        s_types[type].count = 0;
+        NavNear_Reset(&s_types[type]);
+    }
+    s_bank       = NULL;
+    s_version    = 0;
+    s_node_count = 0;
+    s_scan_time  = 0.0f;
+}
+
+qboolean BotNavNear_Add(edict_t *ent, gloom_struct_type_t type)
+{
+    navnear_type_t   *t;
+    navnear_source_t *src = NULL;
+    int s;
+
+    if (!ent || type <= STRUCT_NONE || type >= STRUCT_MAX)
+        return false;
+    NavNear_Sync();
+    t = &s_types[type];
+
+    for (s = 0; s < BOT_NAVNEAR_SOURCES; s++) {
+        if (t->src[s].in_use && t->src[s].ent == ent)
+            return true;
+        if (!src && !t->src[s].in_use)
+            src = &t->src[s];
+    }
+    if (!src)
+        return false;
+
+    s = (int)(src - t->src);
+    src->ent    = ent;
+    src->in_use = true;
+    src->seen   = true;
+    VectorCopy(ent->s.origin, src->origin);
+    src->node   = nav_nodes ? Node_FindNearest(src->origin, 0, 0.0f)
+                            : BOT_INVALID_NODE;
+    t->count++;
+
+    if (NavNear_ValidNode(src->node)) {
+        s_heap_count = 0;
+        NavNear_Offer(t, src->node, s, 0.0f);
+        NavNear_Settle(t);
+    }
+    return true;
+}
+
+void BotNavNear_Remove(edict_t *ent)
+{
+    int type, s;
+
+    NavNear_Sync();
+    for (type = 0; type < STRUCT_MAX; type++) {
+        navnear_type_t *t = &s_types[type];
+
+        for (s = 0; s < BOT_NAVNEAR_SOURCES; s++) {
+            if (!t->src[s].in_use || t->src[s].ent != ent)
+                continue;
+            t->src[s].in_use = false;
+            t->src[s].ent    = NULL;
+            t->count--;
+            NavNear_Repair(t, s);
+        }
+    }
+}
+
+void BotNavNear_Frame(void)
+{
+    int type, s, i;
+
+    NavNear_Sync();
+
+    /* A level change winds level.time back; scan straight away */
+    if (level.time >= s_scan_time &&
+        level.time - s_scan_time < BOT_NAVNEAR_SCAN)
+        return;
+    s_scan_time = level.time;
+
+    for (type = 0; type < STRUCT_MAX; type++) {
+        for (s = 0; s < BOT_NAVNEAR_SOURCES; s++)
+            s_types[type].src[s].seen = false;
+    }
+
+    for (i = 0; i < globals.max_edicts; i++) {
+        edict_t             *ent = &g_edicts[i];
+        gloom_struct_type_t  t;
+        navnear_source_t    *src = NULL;
+
+        if (!ent->inuse || ent->health <= 0)
+            continue;
+        t = NavNear_TypeOf(ent);
+        if (t == STRUCT_NONE)
+            continue;
+
+        for (s = 0; s < BOT_NAVNEAR_SOURCES; s++) {
+            if (s_types[t].src[s].in_use && s_types[t].src[s].ent == ent) {
+                src = &s_types[t].src[s];
+                break;
+            }
+        }
+        /* A freed edict reused for a new structure elsewhere is a new one */
+        if (src && (src->origin[0] != ent->s.origin[0] ||
+                    src->origin[1] != ent->s.origin[1] ||
+                    src->origin[2] != ent->s.origin[2])) {
+            BotNavNear_Remove(ent);
+            src = NULL;
+        }
+        if (src)
+            src->seen = true;
+        else
+            BotNavNear_Add(ent, t);
+    }
+
+    for (type = 0; type < STRUCT_MAX; type++) {
+        for (s = 0; s < BOT_NAVNEAR_SOURCES; s++) {
+            navnear_source_t *src = &s_types[type].src[s];
+
+            if (src->in_use && !src->seen)
+                BotNavNear_Remove(src->ent);
+        }
+    }
+}
+
+edict_t *BotNavNear_Find(int node, gloom_struct_type_t type,
+                         int *out_node, float *out_dist)
+{
+    const navnear_source_t *src;
+    navnear_type_t         *t;
+
+    if (type <= STRUCT_NONE || type >= STRUCT_MAX)
+        return NULL;
+    NavNear_Sync();
+    if (!NavNear_ValidNode(node))
+        return NULL;
+
+    /* Drop a structure that died or was freed since the last scan */
+    t = &s_types[type];
+    for (;;) {
+        if (t->owner[node] == NAVNEAR_NONE)
+            return NULL;
+        src = &t->src[t->owner[node]];
+        if (NavNear_Live(src, type))
+            break;
+        BotNavNear_Remove(src->ent);
+    }
+
+    if (out_node)
+        *out_node = src->node;
+    if (out_dist)
+        *out_dist = t->dist[node];
+    return src->ent;
+}
+
+int BotNavNear_Count(gloom_struct_type_t type)
+{
+    if (type <= STRUCT_NONE || type >= STRUCT_MAX)
+        return 0;
+    return s_types[type].count;
+}
@@ -0,0 +1,59 @@
+/*
+ * bot_navnear.h -- nearest structure of each type by travel distance
+ *
+ * Evolving (Overmind), fleeing (Cocoon, Egg, Reactor) and escorting all
+ * ask which structure of a type is closest by path, and how far.  For
+ * every structure type the nav graph carries a graph-Voronoi labelling:
+ * each node stores the structure it reaches first on foot and the
+ * distance to it, from one multi-source Dijkstra over incoming edges.
+ * Answering the question is then one array read at the bot's node.
+ *
+ * Labels are repaired, not rebuilt, when a structure appears (a Dijkstra
+ * from the new source that only touches nodes it now wins) or is
+ * destroyed (its region is cleared and refilled from the surrounding
+ * nodes).  An edited or reloaded graph rebuilds every type from scratch.
+ *
+ * Distances are over walk edges only (NAV_CAP_* of 0), which every class
+ * can use; wall-walkers and fliers may have a shorter way.
+ */
+
+#ifndef BOT_NAVNEAR_H
+#define BOT_NAVNEAR_H
+
+#include "bot.h"
+#include "bot_nodes.h"
+
+#define BOT_NAVNEAR_SOURCES  32      /* structures tracked per type          */
+#define BOT_NAVNEAR_SCAN     1.0f    /* seconds between structure scans      */
+
+/* Forget every structure and label (map change). */
+void     BotNavNear_Clear(void);
+
+/*
+ * Scan the edicts for live structures, add the new ones and drop the
+ * destroyed ones.  Runs at most once per BOT_NAVNEAR_SCAN seconds.
+ */
+void     BotNavNear_Frame(void);
+
+/*
+ * Track ent as a structure of type, or stop tracking it.  Frame calls
+ * these itself; they are public for spawn code and tests.  Add returns
+ * false when the type already has BOT_NAVNEAR_SOURCES structures.
+ */
+qboolean BotNavNear_Add(edict_t *ent, gloom_struct_type_t type);
+void     BotNavNear_Remove(edict_t *ent);
+
+/*
+ * Nearest tracked structure of type by travel distance from node.
+ * Returns it, with its nav node in *out_node and the distance in
+ * *out_dist (either may be NULL), or NULL if none can be reached.
+ * A structure that has died, been freed or been reused since the last
+ * scan is dropped first, so the result is always live.
+ */
+edict_t *BotNavNear_Find(int node, gloom_struct_type_t type,
+                         int *out_node, float *out_dist);
+
+/* Number of structures of type being tracked. */
+int      BotNavNear_Count(gloom_struct_type_t type);
+
+#endif /* BOT_NAVNEAR_H */
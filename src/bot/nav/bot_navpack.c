@@ -0,0 +1,303 @@
+/*
+ * bot_navpack.c -- compact fixed-point copy of the nav graph for A*
+ *
+ * See bot_navpack.h.  Costs are rounded to the nearest step and the
+ * heuristic is rounded down, so a search on the packed graph finds a
+ * route within cost_scale / 2 per edge of the float search's.
+ */
+
+#include "bot_navpack.h"
+#include <math.h>
+
+#if MAX_NAV_NODES > (1 << NAVPACK_ID_BITS)
+#error "MAX_NAV_NODES does not fit in NAVPACK_ID_BITS"
+#endif
+
+#define NAVPACK_STEP_MIN  (1.0f / 64.0f)   /* finest scale either may use */
+#define NAVPACK_NOT_OPEN  0xFFFF
+
+static navpack_t          s_pack;
+static const nav_node_t  *s_pack_bank;
+static unsigned int       s_pack_version;
+
+/* Smallest power-of-two step at which max fits in 16 bits */
+static float NavPack_Scale(float max)
+{
+    float step = NAVPACK_STEP_MIN;
+
+    while (max / step > 65535.0f)
+        step *= 2.0f;
+    return step;
+}
+
+static unsigned short NavPack_Quantize(float v, float step)
+{
+    float q = v / step + 0.5f;
+
+    if (q <= 0.0f)
+        return 0;
+    if (q >= 65535.0f)
+        return 65535;
+    return (unsigned short)q;
+}
+
+static void NavPack_Build(void)
+{
+    vec3_t maxs;
+    float  range = 0.0f, max_cost = 0.0f;
+    int    i, j, k, edges = 0, live = 0;
+
+    VectorClear(s_pack.base);
+    VectorClear(maxs);
+    for (i = 0; i < nav_node_count; i++) {
+        const nav_node_t *n = &nav_nodes[i];
+
+        if (n->id == BOT_INVALID_NODE)
+            continue;
+        for (k = 0; k < 3; k++) {
+            if (!live || n->origin[k] < s_pack.base[k])
+                s_pack.base[k] = n->origin[k];
+            if (!live || n->origin[k] > maxs[k])
+                maxs[k] = n->origin[k];
+        }
+        for (j = 0; j < n->num_neighbors; j++)
+            if (n->neighbor_costs[j] > max_cost)
+                max_cost = n->neighbor_costs[j];
+        live++;
+    }
+    for (k = 0; k < 3; k++)
+        if (maxs[k] - s_pack.base[k] > range)
+            range = maxs[k] - s_pack.base[k];
+    s_pack.origin_scale = NavPack_Scale(range);
+    s_pack.cost_scale   = NavPack_Scale(max_cost);
+
+    for (i = 0; i < nav_node_count; i++) {
+        const nav_node_t *n  = &nav_nodes[i];
+        navpack_node_t   *pn = &s_pack.nodes[i];
+
+        pn->first_edge = (unsigned short)edges;
+        if (n->id == BOT_INVALID_NODE) {
+            pn->origin[0] = pn->origin[1] = pn->origin[2] = 0;
+            continue;
+        }
+        for (k = 0; k < 3; k++)
+            pn->origin[k] = NavPack_Quantize(n->origin[k] - s_pack.base[k],
+                                             s_pack.origin_scale);
+
+        for (j = 0; j < n->num_neighbors; j++) {
+            int to = n->neighbors[j];
+
+            if (to < 0 || to >= nav_node_count ||
+                nav_nodes[to].id == BOT_INVALID_NODE)
+                continue;
+            s_pack.edges[edges].link = (unsigned short)
+                (to | (n->movement_required[j] & 0xF) << NAVPACK_ID_BITS);
+            s_pack.edges[edges].cost =
+                NavPack_Quantize(n->neighbor_costs[j], s_pack.cost_scale);
+            edges++;
+        }
+    }
+    s_pack.nodes[nav_node_count].first_edge = (unsigned short)edges;
+    s_pack.count = nav_node_count;
+
+    s_pack_bank    = nav_nodes;
+    s_pack_version = nav_graph_version;
+}
+
+const navpack_t *BotNavPack_Get(void)
+{
+    if (s_pack_bank != nav_nodes || s_pack_version != nav_graph_version)
+        NavPack_Build();
+    return &s_pack;
+}
+
+void BotNavPack_Origin(const navpack_t *pack, int node, vec3_t out)
+{
+    int k;
+
+    for (k = 0; k < 3; k++)
+        out[k] = pack->base[k] + pack->nodes[node].origin[k] * pack->origin_scale;
+}
+
+float BotNavPack_Cost(const navpack_t *pack, const navpack_edge_t *edge)
+{
+    return edge->cost * pack->cost_scale;
+}
+
+/* Straight-line distance in cost steps, rounded down */
+static unsigned int NavPack_Heuristic(const navpack_node_t *a,
+                                      const navpack_node_t *b, float to_cost)
+{
+    float dx = (float)a->origin[0] - b->origin[0];
+    float dy = (float)a->origin[1] - b->origin[1];
+    float dz = (float)a->origin[2] - b->origin[2];
+
+    return (unsigned int)(sqrtf(dx * dx + dy * dy + dz * dz) * to_cost);
+}
+
+/* Search scratch, shared by every variant */
+static unsigned int   s_g_cost[MAX_NAV_NODES];
+static unsigned short s_came_from[MAX_NAV_NODES];
+static unsigned short s_open_pos[MAX_NAV_NODES];
+static unsigned char  s_closed[MAX_NAV_NODES];
+static unsigned short s_open_node[MAX_NAV_NODES];
+static unsigned int   s_open_f[MAX_NAV_NODES];
+
+/* Walk came_from back from goal_node and write the path start-first */
+static int NavPack_BuildPath(int start_node, int goal_node, int *path)
+{
+    int buf[BOT_MAX_PATH_NODES];
+    int len = 0, node = goal_node, i;
+
+    while (len < BOT_MAX_PATH_NODES) {
+        buf[len++] = node;
+        if (node == start_node)
+            break;
+        node = s_came_from[node];
+    }
+    for (i = 0; i < len; i++)
+        path[i] = buf[len - 1 - i];
+    return len;
+}
+
+/*
+ * NAV_MOVE_* types whose edges need a capability outside caps, as a bit
+ * mask; the constant-caps form of the loop in NavPack_DeniedMoves.
+ */
+#define NAVPACK_DENIED(caps)                                        \
+    ((((caps) & NAV_CAP_WALL) ? 0u : 1u << NAV_MOVE_CLIMB) |        \
+     (((caps) & NAV_CAP_FLY)  ? 0u : 1u << NAV_MOVE_FLY))
+
+static unsigned int NavPack_DeniedMoves(unsigned int caps)
+{
+    unsigned int denied = 0;
+    int          m;
+
+    for (m = 0; m < 16; m++)
+        if (Node_MoveCaps(m) & ~caps)
+            denied |= 1u << m;
+    return denied;
+}
+
+/*
+ * A* search core, stamped out once per movement profile.
+ *
+ * DENIED is the NAVPACK_DENIED mask of the profile.  For the fixed
+ * profiles below it is a compile-time constant, so the per-edge
+ * capability check tests one bit of an immediate; the generic variant
+ * takes the mask at run time for combinations no class has today.
+ */
+#define BOT_NAVPACK_SEARCH(name, DENIED)                                      \
+static int name(int start_node, int goal_node, unsigned int denied_moves,     \
+                int *path, unsigned int *expanded)                            \
+{                                                                             \
+    const navpack_t      *pack = BotNavPack_Get();                            \
+    const navpack_node_t *goal = &pack->nodes[goal_node];                     \
+    const unsigned int    denied = (DENIED);                                  \
+    float        to_cost = pack->origin_scale / pack->cost_scale;             \
+    unsigned int count = 0;                                                   \
+    int          open_count, i;                                               \
+                                                                              \
+    (void)denied_moves;                                                       \
+                                                                              \
+    for (i = 0; i < pack->count; i++) {                                       \
+        s_g_cost[i]    = 0xFFFFFFFFu;                                         \
+        s_came_from[i] = NAVPACK_NOT_OPEN;                                    \
+        s_open_pos[i]  = NAVPACK_NOT_OPEN;                                    \
+        s_closed[i]    = 0;                                                   \
+    }                                                                         \
+                                                                              \
+    s_g_cost[start_node]   = 0;                                               \
+    s_open_node[0]         = (unsigned short)start_node;                      \
+    s_open_f[0]            = NavPack_Heuristic(&pack->nodes[start_node],      \
+                                               goal, to_cost);                \
+    s_open_pos[start_node] = 0;                                               \
+    open_count             = 1;                                               \
+                                                                              \
+    while (open_count > 0) {                                                  \
+        const navpack_edge_t *e, *end;                                        \
+        int current, best = 0;                                                \
+                                                                              \
+        for (i = 1; i < open_count; i++)                                      \
+            if (s_open_f[i] < s_open_f[best])                                 \
+                best = i;                                                     \
+        current = s_open_node[best];                                          \
+                                                                              \
+        /* Swap the last entry into the hole */                               \
+        open_count--;                                                         \
+        s_open_node[best] = s_open_node[open_count];                          \
+        s_open_f[best]    = s_open_f[open_count];                             \
+        s_open_pos[s_open_node[best]] = (unsigned short)best;                 \
+        s_open_pos[current] = NAVPACK_NOT_OPEN;                               \
+                                                                              \
+        if (current == goal_node) {                                           \
+            if (expanded)                                                     \
+                *expanded += count;                                           \
+            return NavPack_BuildPath(start_node, goal_node, path);            \
+        }                                                                     \
+                                                                              \
+        s_closed[current] = 1;                                                \
+        count++;                                                              \
+                                                                              \
+        e   = &pack->edges[pack->nodes[current].first_edge];                  \
+        end = &pack->edges[pack->nodes[current + 1].first_edge];              \
+        for (; e < end; e++) {                                                \
+            int          to = e->link & NAVPACK_ID_MASK;                      \
+            unsigned int g;                                                   \
+                                                                              \
+            if ((denied >> (e->link >> NAVPACK_ID_BITS)) & 1)                 \
+                continue;                                                     \
+            if (s_closed[to])                                                 \
+                continue;                                                     \
+            g = s_g_cost[current] + e->cost;                                  \
+            if (g >= s_g_cost[to])                                            \
+                continue;                                                     \
+                                                                              \
+            s_g_cost[to]    = g;                                              \
+            s_came_from[to] = (unsigned short)current;                        \
+            i = s_open_pos[to];                                               \
+            if (i == NAVPACK_NOT_OPEN) {                                      \
+                i = open_count++;                                             \
+                s_open_node[i] = (unsigned short)to;                          \
+                s_open_pos[to] = (unsigned short)i;                           \
+            }                                                                 \
+            s_open_f[i] = g + NavPack_Heuristic(&pack->nodes[to], goal,       \
+                                                to_cost);                     \
+        }                                                                     \
+    }                                                                         \
+                                                                              \
+    if (expanded)                                                             \
+        *expanded += count;                                                   \
+    return 0;                                                                 \
+}
+
+BOT_NAVPACK_SEARCH(NavPack_SearchGround,  NAVPACK_DENIED(0))
+BOT_NAVPACK_SEARCH(NavPack_SearchWall,    NAVPACK_DENIED(NAV_CAP_WALL))
+BOT_NAVPACK_SEARCH(NavPack_SearchFly,     NAVPACK_DENIED(NAV_CAP_FLY))
+BOT_NAVPACK_SEARCH(NavPack_SearchGeneric, denied_moves)
+
+int BotNavPack_Search(int start_node, int goal_node, unsigned int caps,
+                      qboolean generic, int *path, unsigned int *expanded)
+{
+    const navpack_t *pack = BotNavPack_Get();
+
+    if (start_node < 0 || start_node >= pack->count ||
+        goal_node < 0 || goal_node >= pack->count)
+        return 0;
+
+    if (generic)
+        return NavPack_SearchGeneric(start_node, goal_node,
+                                     NavPack_DeniedMoves(caps), path, expanded);
+
+    switch (caps) {
+    case 0:
+        return NavPack_SearchGround(start_node, goal_node, 0, path, expanded);
+    case NAV_CAP_WALL:
+        return NavPack_SearchWall(start_node, goal_node, 0, path, expanded);
+    case NAV_CAP_FLY:
+        return NavPack_SearchFly(start_node, goal_node, 0, path, expanded);
+    default:
+        return NavPack_SearchGeneric(start_node, goal_node,
+                                     NavPack_DeniedMoves(caps), path, expanded);
+    }
+}
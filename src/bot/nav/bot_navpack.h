@@ -0,0 +1,75 @@
+/*
+ * bot_navpack.h -- compact fixed-point copy of the nav graph for A*
+ *
+ * nav_node_t is built for editing and saving: float origin, eight int
+ * neighbour IDs, float costs and int move types, 136 bytes a node.  A*
+ * only needs the position, the edges, their costs and the capability
+ * each edge needs.  The packed graph holds exactly that:
+ *
+ *   - origins as three uint16 offsets from the graph's bounding box, in
+ *     steps of origin_scale units (1/8 unit on maps under 8192 wide)
+ *   - edges in one CSR array, 4 bytes each: a uint16 of target slot
+ *     (low NAVPACK_ID_BITS bits) and NAV_MOVE_* type (the bits above),
+ *     and a uint16 cost in steps of cost_scale
+ *
+ * Both scales are powers of two picked per graph so the largest offset
+ * and the largest cost fit.  A full 1024-node graph with eight links a
+ * node is 40 KB and the search's own arrays add 15 bytes a node, so a
+ * query runs out of L2; at 4096 nodes the total would still be about
+ * 220 KB.  Free slots and links to them are left out.
+ *
+ * The packed copy is rebuilt on first use after the graph changes, like
+ * the incoming-edge index.  Node slots are the same as in nav_nodes[].
+ */
+
+#ifndef BOT_NAVPACK_H
+#define BOT_NAVPACK_H
+
+#include "bot.h"
+#include "bot_nodes.h"
+
+#define NAVPACK_ID_BITS   12
+#define NAVPACK_ID_MASK   ((1 << NAVPACK_ID_BITS) - 1)
+#define NAVPACK_MAX_EDGES (MAX_NAV_NODES * MAX_NODE_NEIGHBORS)
+
+typedef struct {
+    unsigned short link;        /* target slot | move type << ID_BITS */
+    unsigned short cost;        /* cost / cost_scale, rounded         */
+} navpack_edge_t;
+
+typedef struct {
+    unsigned short origin[3];   /* (origin - base) / origin_scale     */
+    unsigned short first_edge;  /* edges first_edge .. next node's - 1 */
+} navpack_node_t;
+
+typedef struct {
+    navpack_node_t nodes[MAX_NAV_NODES + 1];   /* one past count: end */
+    navpack_edge_t edges[NAVPACK_MAX_EDGES];
+    int            count;       /* == nav_node_count when built       */
+    vec3_t         base;        /* bounds minimum of the live nodes   */
+    float          origin_scale;
+    float          cost_scale;
+} navpack_t;
+
+/* The packed live graph, rebuilt first if the graph has changed. */
+const navpack_t *BotNavPack_Get(void);
+
+/* Decoded position of a packed node. */
+void  BotNavPack_Origin(const navpack_t *pack, int node, vec3_t out);
+
+/* Decoded cost of a packed edge. */
+float BotNavPack_Cost(const navpack_t *pack, const navpack_edge_t *edge);
+
+/*
+ * A* over the packed graph with integer costs.  Same contract as
+ * BotNav_Search: edges needing NAV_CAP_* bits outside caps are skipped,
+ * path[BOT_MAX_PATH_NODES] gets the route start-first, and the length
+ * (0 if unreachable) is returned.  Adds the nodes it expanded to
+ * *expanded if that is not NULL.  Ground, wall-walk and fly each have a
+ * variant with the capability test fixed at compile time; generic
+ * forces the run-time-mask variant the other combinations use.
+ */
+int   BotNavPack_Search(int start_node, int goal_node, unsigned int caps,
+                        qboolean generic, int *path, unsigned int *expanded);
+
+#endif /* BOT_NAVPACK_H */
@@ -0,0 +1,267 @@
+/*
+ * bot_navshm.c -- cross-process shared, read-only nav node banks
+ *
+ * See bot_navshm.h.  Segment layout: a nav_shm_header_t followed by a
+ * full MAX_NAV_NODES node bank.  No gi calls, so these functions may run
+ * on the nav loader thread.
+ */
+
+#include "bot_navshm.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define NAV_SHM_MAGIC  0x4D48534E  /* "NSHM" little-endian */
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int node_size;     /* sizeof(nav_node_t) of the creator      */
+    unsigned int max_nodes;     /* MAX_NAV_NODES of the creator           */
+    unsigned int hash;          /* nav_graph_hash of the source file      */
+    int          count;         /* nav_node_count                         */
+    int          pad[2];        /* keep the node bank 8-byte aligned      */
+} nav_shm_header_t;
+
+#define NAV_SHM_SIZE  (sizeof(nav_shm_header_t) + \
+                       sizeof(nav_node_t) * MAX_NAV_NODES)
+
+void BotNavShm_Init(nav_shm_t *shm)
+{
+    memset(shm, 0, sizeof(*shm));
+    shm->fd = -1;
+}
+
+const nav_node_t *BotNavShm_Nodes(const nav_shm_t *shm)
+{
+    if (!shm->base)
+        return NULL;
+    return (const nav_node_t *)((const char *)shm->base +
+                                sizeof(nav_shm_header_t));
+}
+
+int BotNavShm_Count(const nav_shm_t *shm)
+{
+    if (!shm->base)
+        return 0;
+    return ((const nav_shm_header_t *)shm->base)->count;
+}
+
+#ifdef _WIN32
+
+qboolean BotNavShm_Open(nav_shm_t *shm, unsigned int hash)
+{
+    (void)hash;
+    BotNavShm_Init(shm);
+    return false;
+}
+
+qboolean BotNavShm_Create(nav_shm_t *shm, unsigned int hash,
+                          const nav_node_t *nodes, int count)
+{
+    (void)hash; (void)nodes; (void)count;
+    BotNavShm_Init(shm);
+    return false;
+}
+
+void BotNavShm_Close(nav_shm_t *shm)
+{
+    BotNavShm_Init(shm);
+}
+
+#else
+
+static void NavShm_Name(nav_shm_t *shm, unsigned int hash)
+{
+    Com_sprintf(shm->name, sizeof(shm->name), "/q2gloombot-nav%d-%08x",
+                NAV_SHM_VERSION, hash);
+}
+
+static qboolean NavShm_HeaderValid(const nav_shm_header_t *h,
+                                   unsigned int hash)
+{
+    return h->magic == NAV_SHM_MAGIC &&
+           h->version == NAV_SHM_VERSION &&
+           h->node_size == sizeof(nav_node_t) &&
+           h->max_nodes == MAX_NAV_NODES &&
+           h->hash == hash &&
+           h->count >= 0 && h->count <= MAX_NAV_NODES;
+}
+
+/*
+ * The bank is indexed straight from the segment, so a stray or hostile
+ * writer must not be able to send a search out of bounds: every slot is
+ * its own id or free, and every link stays inside the graph.
+ */
+static qboolean NavShm_BankValid(const nav_node_t *bank, int count)
+{
+    int i, j;
+
+    for (i = 0; i < count; i++) {
+        const nav_node_t *n = &bank[i];
+
+        if (n->id != i && n->id != BOT_INVALID_NODE)
+            return false;
+        if (n->num_neighbors < 0 || n->num_neighbors > MAX_NODE_NEIGHBORS)
+            return false;
+        for (j = 0; j < n->num_neighbors; j++) {
+            if (n->neighbors[j] < 0 || n->neighbors[j] >= count)
+                return false;
+        }
+    }
+    return true;
+}
+
+qboolean BotNavShm_Open(nav_shm_t *shm, unsigned int hash)
+{
+    const nav_shm_header_t *h;
+    struct stat             st;
+    void                   *base;
+
+    BotNavShm_Init(shm);
+    NavShm_Name(shm, hash);
+
+    shm->fd = shm_open(shm->name, O_RDONLY, 0);
+    if (shm->fd < 0)
+        return false;
+
+    /* Blocks while a creator is still filling the segment */
+    if (flock(shm->fd, LOCK_SH) != 0 ||
+        fstat(shm->fd, &st) != 0 || st.st_size != (off_t)NAV_SHM_SIZE) {
+        close(shm->fd);
+        BotNavShm_Init(shm);
+        return false;
+    }
+
+    base = mmap(NULL, NAV_SHM_SIZE, PROT_READ, MAP_SHARED, shm->fd, 0);
+    if (base == MAP_FAILED) {
+        close(shm->fd);
+        BotNavShm_Init(shm);
+        return false;
+    }
+
+    h = (const nav_shm_header_t *)base;
+    if (!NavShm_HeaderValid(h, hash) ||
+        !NavShm_BankValid((const nav_node_t *)(h + 1), h->count)) {
+        munmap(base, NAV_SHM_SIZE);
+        close(shm->fd);
+        BotNavShm_Init(shm);
+        return false;
+    }
+
+    shm->base = base;
+    shm->size = NAV_SHM_SIZE;
+    return true;
+}
+
+/*
+ * A creator that died before writing the header, or an older build with
+ * a different node layout, leaves a segment no opener will accept and
+ * that blocks every later create.  If nobody holds it (the exclusive
+ * lock is free) and it is not a valid bank, unlink it.
+ */
+static qboolean NavShm_Reclaim(const char *name, unsigned int hash)
+{
+    const nav_shm_header_t *h;
+    struct stat             st;
+    void                   *base;
+    qboolean                stale = true;
+    int                     fd;
+
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return false;
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return false;
+    }
+
+    if (fstat(fd, &st) == 0 && st.st_size == (off_t)NAV_SHM_SIZE) {
+        base = mmap(NULL, NAV_SHM_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+        if (base != MAP_FAILED) {
+            h = (const nav_shm_header_t *)base;
+            stale = !NavShm_HeaderValid(h, hash) ||
+                    !NavShm_BankValid((const nav_node_t *)(h + 1), h->count);
+            munmap(base, NAV_SHM_SIZE);
+        }
+    }
+
+    if (stale)
+        shm_unlink(name);
+    close(fd);
+    return stale;
+}
+
+qboolean BotNavShm_Create(nav_shm_t *shm, unsigned int hash,
+                          const nav_node_t *nodes, int count)
+{
+    nav_shm_header_t *h;
+    void             *base;
+
+    BotNavShm_Init(shm);
+    NavShm_Name(shm, hash);
+
+    /* Owner only: another user's server must not feed us its graph */
+    shm->fd = shm_open(shm->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (shm->fd < 0 && errno == EEXIST && NavShm_Reclaim(shm->name, hash))
+        shm->fd = shm_open(shm->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (shm->fd < 0)
+        return false;
+
+    if (flock(shm->fd, LOCK_EX) != 0 ||
+        ftruncate(shm->fd, (off_t)NAV_SHM_SIZE) != 0) {
+        shm_unlink(shm->name);
+        close(shm->fd);
+        BotNavShm_Init(shm);
+        return false;
+    }
+
+    base = mmap(NULL, NAV_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                shm->fd, 0);
+    if (base == MAP_FAILED) {
+        shm_unlink(shm->name);
+        close(shm->fd);
+        BotNavShm_Init(shm);
+        return false;
+    }
+
+    memcpy((char *)base + sizeof(nav_shm_header_t), nodes,
+           sizeof(nav_node_t) * MAX_NAV_NODES);
+    h = (nav_shm_header_t *)base;
+    memset(h, 0, sizeof(*h));
+    h->version   = NAV_SHM_VERSION;
+    h->node_size = sizeof(nav_node_t);
+    h->max_nodes = MAX_NAV_NODES;
+    h->hash      = hash;
+    h->count     = count;
+    h->magic     = NAV_SHM_MAGIC;
+
+    /* From here on the bank is immutable for everyone, us included */
+    mprotect(base, NAV_SHM_SIZE, PROT_READ);
+    flock(shm->fd, LOCK_SH);
+
+    shm->base = base;
+    shm->size = NAV_SHM_SIZE;
+    return true;
+}
+
+void BotNavShm_Close(nav_shm_t *shm)
+{
+    if (shm->base)
+        munmap(shm->base, shm->size);
+    if (shm->fd >= 0) {
+        /* Only succeeds if nobody else still holds a shared lock */
+        if (flock(shm->fd, LOCK_EX | LOCK_NB) == 0)
+            shm_unlink(shm->name);
+        close(shm->fd);
+    }
+    BotNavShm_Init(shm);
+}
+
+#endif
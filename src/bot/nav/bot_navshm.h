@@ -0,0 +1,60 @@
+/*
+ * bot_navshm.h -- cross-process shared, read-only nav node banks
+ *
+ * Several Gloom servers on one box usually run the same map rotation.
+ * Rather than each holding a private copy of the node graph, the first
+ * process to load a .nav file publishes its node bank in a POSIX shared
+ * memory segment named after the file's content hash; later processes
+ * map the same segment read-only and skip parsing entirely.
+ *
+ * Segments are created mode 0600, so only servers running as the same
+ * user share them, and an opener rejects a segment whose links point
+ * outside its graph.
+ *
+ * Every user holds a shared flock() on the segment.  The last one to
+ * close it (i.e. the one that can upgrade to an exclusive lock) unlinks
+ * the name.  The creator holds an exclusive lock while filling it, so
+ * openers never see a half-written bank.
+ *
+ * On platforms without shm_open every call fails and callers keep using
+ * private memory.
+ */
+
+#ifndef BOT_NAVSHM_H
+#define BOT_NAVSHM_H
+
+#include "bot_nodes.h"
+
+#define NAV_SHM_VERSION  3      /* bump if nav_node_t or the header changes */
+
+typedef struct {
+    int          fd;            /* -1 when not attached                   */
+    void        *base;          /* read-only mapping, NULL when detached  */
+    size_t       size;
+    char         name[64];
+} nav_shm_t;
+
+/* Mark a handle detached; call before first use. */
+void              BotNavShm_Init(nav_shm_t *shm);
+
+/* Attach to an existing segment for this hash; false if none is usable. */
+qboolean          BotNavShm_Open(nav_shm_t *shm, unsigned int hash);
+
+/*
+ * Create the segment for this hash from a private bank.  An existing
+ * segment that nobody holds and that fails validation (a crashed creator,
+ * an older build) is unlinked and the create retried once.  Fails (false)
+ * if a usable or in-use segment already exists, or shared memory is
+ * unavailable.
+ */
+qboolean          BotNavShm_Create(nav_shm_t *shm, unsigned int hash,
+                                   const nav_node_t *nodes, int count);
+
+/* Node bank and count of an attached segment. */
+const nav_node_t *BotNavShm_Nodes(const nav_shm_t *shm);
+int               BotNavShm_Count(const nav_shm_t *shm);
+
+/* Detach; unlinks the segment if no other process still holds it. */
+void              BotNavShm_Close(nav_shm_t *shm);
+
+#endif /* BOT_NAVSHM_H */
@@ -8,22 +8,113 @@
  *
  * File I/O uses standard C fopen/fwrite/fread so that nav files can be
  * saved and loaded without depending on the engine's limited game import
- * filesystem API.
+ * filesystem API.  The file formats live in bot_navfile.c.
  */
 
 #include "bot_nodes.h"
+#include "bot_navfile.h"
+#include "bot_thread.h"
+#include "bot_navshm.h"
+#include "bot_cvars.h"
+#include "bot_log.h"
 #include <float.h>
 #include <math.h>
+#include <sys/stat.h>
 
 /* -----------------------------------------------------------------------
    Module globals
    ----------------------------------------------------------------------- */
-nav_node_t nav_nodes[MAX_NAV_NODES];
+/*
+ * Two node banks: nav_nodes points at the live one, the other is the
+ * target of the next load.  Loads are published by swapping the pointer
+ * on the server thread, so readers never see a half-parsed graph.
+ */
+static nav_node_t s_node_banks[2][MAX_NAV_NODES];
+
+nav_node_t *nav_nodes      = s_node_banks[0];
 int        nav_node_count = 0;   /* highest used slot + 1 */
+unsigned int nav_graph_version = 0;  /* bumped on every graph edit */
+unsigned int nav_graph_hash    = 0;  /* content hash of the loaded file */
+
+/*
+ * Load job.  Filled on the server thread, run by Node_RunLoad on either
+ * thread, published by Node_Publish on the server thread.
+ */
+typedef struct {
+    char         path[MAX_QPATH + 16];
+    char         error[128];
+    nav_node_t  *bank;          /* private bank to parse into              */
+    qboolean     shared;        /* try cross-process shared memory         */
+    nav_shm_t    shm;           /* result lives here when attached         */
+    int          count;
+    int          loaded;        /* node records parsed; -1 if attached     */
+    unsigned int hash;
+    long         file_size;     /* stat() of the file when the load began  */
+    long         file_mtime;
+    qboolean     ok;
+    qboolean     done;          /* guarded by s_load_lock                  */
+} node_load_job_t;
+
+static bot_thread_t    s_load_thread;
+static bot_mutex_t     s_load_lock;
+static qboolean        s_load_lock_ready = false;
+static qboolean        s_load_pending    = false;
+static node_load_job_t s_load_job;
+
+/* Shared segment nav_nodes currently points into, if any */
+static nav_shm_t       s_live_shm = { -1 };
+
+/* File the live graph came from, for Node_FileUnchanged */
+static char            s_live_path[MAX_QPATH + 16];
+static long            s_live_size;
+static long            s_live_mtime;
+
+static nav_node_t *Node_BackBank(void)
+{
+    return (nav_nodes == s_node_banks[0]) ? s_node_banks[1] : s_node_banks[0];
+}
+
+/*
+ * A shared bank is read-only.  Before modifying the graph, move it into
+ * a private bank (one the loader is not writing), copying the contents
+ * unless the caller is about to wipe them anyway.
+ */
+static void Node_Privatize(qboolean copy)
+{
+    nav_node_t *bank;
+
+    if (!s_live_shm.base)
+        return;
+
+    bank = s_node_banks[0];
+    if (s_load_pending && s_load_job.bank == bank)
+        bank = s_node_banks[1];
+    if (copy)
+        memcpy(bank, nav_nodes, sizeof(nav_node_t) * MAX_NAV_NODES);
+    nav_nodes = bank;
+    BotNavShm_Close(&s_live_shm);
+}
+
+/*
+ * Lowest file ID not used by a live node.  There are never more live
+ * nodes than MAX_NAV_NODES, so the result always fits a .nav record.
+ */
+static int Node_FreeExternalId(void)
+{
+    static qboolean used[MAX_NAV_NODES];
+    int i;
 
-/* Binary file format magic and version */
-#define NAV_FILE_MAGIC   0x3156414E  /* "NAV1" little-endian */
-#define NAV_FILE_VERSION 1
+    memset(used, 0, sizeof(used));
+    for (i = 0; i < nav_node_count; i++) {
+        int ext = nav_nodes[i].ext_id;
+
+        if (nav_nodes[i].id != BOT_INVALID_NODE && ext >= 0 && ext < MAX_NAV_NODES)
+            used[ext] = true;
+    }
+    for (i = 0; i < MAX_NAV_NODES && used[i]; i++)
+        ;
+    return i;
+}
 
 /* -----------------------------------------------------------------------
    Node_Clear
@@ -33,11 +124,15 @@ void Node_Clear(void)
 {
     int i;
 
+    Node_Privatize(false);
+
     for (i = 0; i < MAX_NAV_NODES; i++) {
         nav_nodes[i].id           = BOT_INVALID_NODE;
         nav_nodes[i].num_neighbors = 0;
     }
     nav_node_count = 0;
+    nav_graph_version++;
+    nav_graph_hash = 0;
 }
 
 /* -----------------------------------------------------------------------
@@ -50,6 +145,8 @@ int Node_Add(vec3_t origin, unsigned int flags)
 {
     int i;
 
+    Node_Privatize(true);
+
     /* Search for a free slot (previously removed node or unused tail). */
     for (i = 0; i < MAX_NAV_NODES; i++) {
         if (nav_nodes[i].id == BOT_INVALID_NODE)
@@ -57,10 +154,11 @@ int Node_Add(vec3_t origin, unsigned int flags)
     }
 
     if (i >= MAX_NAV_NODES) {
-        gi.dprintf("Node_Add: node graph full (%d nodes)\n", MAX_NAV_NODES);
+        BotLog_Warn("Node_Add: node graph full (%d nodes)\n", MAX_NAV_NODES);
         return BOT_INVALID_NODE;
     }
 
+    nav_nodes[i].ext_id        = Node_FreeExternalId();
     nav_nodes[i].id            = i;
     VectorCopy(origin, nav_nodes[i].origin);
     nav_nodes[i].flags         = flags;
@@ -74,12 +172,15 @@ int Node_Add(vec3_t origin, unsigned int flags)
             nav_nodes[i].neighbors[j]         = BOT_INVALID_NODE;
             nav_nodes[i].neighbor_costs[j]    = 0.0f;
             nav_nodes[i].movement_required[j] = NAV_MOVE_WALK;
+            nav_nodes[i].edge_caps[j]         = 0;
         }
     }
 
     if (i >= nav_node_count)
         nav_node_count = i + 1;
 
+    nav_graph_version++;
+    nav_graph_hash = 0;
     return i;
 }
 
@@ -96,6 +197,8 @@ void Node_Remove(int id)
     if (nav_nodes[id].id == BOT_INVALID_NODE)
         return;   /* already removed */
 
+    Node_Privatize(true);
+
     /* Scrub all references to this node from other nodes' neighbor lists. */
     for (i = 0; i < nav_node_count; i++) {
         nav_node_t *n = &nav_nodes[i];
@@ -112,6 +215,7 @@ void Node_Remove(int id)
                 n->neighbors[k]         = n->neighbors[k + 1];
                 n->neighbor_costs[k]    = n->neighbor_costs[k + 1];
                 n->movement_required[k] = n->movement_required[k + 1];
+                n->edge_caps[k]         = n->edge_caps[k + 1];
             }
             n->num_neighbors--;
 
@@ -119,6 +223,7 @@ void Node_Remove(int id)
             n->neighbors[n->num_neighbors]         = BOT_INVALID_NODE;
             n->neighbor_costs[n->num_neighbors]    = 0.0f;
             n->movement_required[n->num_neighbors] = NAV_MOVE_WALK;
+            n->edge_caps[n->num_neighbors]         = 0;
 
             /* Restart scan for this node in case of duplicates. */
             j--;
@@ -128,46 +233,102 @@ void Node_Remove(int id)
     /* Mark the slot as free. */
     nav_nodes[id].id           = BOT_INVALID_NODE;
     nav_nodes[id].num_neighbors = 0;
+    nav_graph_version++;
+    nav_graph_hash = 0;
 }
 
-/* -----------------------------------------------------------------------
-   Node_FindNearest
-   Return the ID of the nearest valid node that:
-     - has ALL bits in required_flags set (pass 0 to accept any node), and
-     - lies within max_range world units (pass 0.0f for unlimited range).
-   Returns BOT_INVALID_NODE if no qualifying node is found.
-   ----------------------------------------------------------------------- */
-int Node_FindNearest(vec3_t origin, unsigned int required_flags,
-                     float max_range)
+/*
+ * Node_FindNearest scans a structure-of-arrays copy of the live node
+ * origins, one per required_flags value in recent use, so the distance
+ * tests run four nodes at a time (VectorBatch_Nearest).  Copies are
+ * rebuilt on first use after the graph changes; a stale one is reused
+ * before the oldest current one is evicted.
+ */
+#define NODE_NEAR_SETS  4
+
+typedef struct {
+    const nav_node_t *bank;
+    unsigned int      version;
+    unsigned int      flags;
+    int               count;
+    float             x[MAX_NAV_NODES];
+    float             y[MAX_NAV_NODES];
+    float             z[MAX_NAV_NODES];
+    short             id[MAX_NAV_NODES];
+} node_near_set_t;
+
+static node_near_set_t s_near_sets[NODE_NEAR_SETS];
+static int             s_near_next;     /* round-robin eviction */
+
+static const node_near_set_t *Node_NearSet(unsigned int required_flags)
 {
-    int   best_id   = BOT_INVALID_NODE;
-    float best_dist = (max_range > 0.0f) ? (max_range * max_range)
-                                          : FLT_MAX;
-    int   i;
+    node_near_set_t *set = NULL;
+    int              i;
+
+    for (i = 0; i < NODE_NEAR_SETS; i++) {
+        node_near_set_t *s = &s_near_sets[i];
+
+        if (s->bank == nav_nodes && s->version == nav_graph_version) {
+            if (s->flags == required_flags)
+                return s;
+        } else if (!set) {
+            set = s;
+        }
+    }
+    if (!set)
+        set = &s_near_sets[s_near_next++ % NODE_NEAR_SETS];
 
+    set->count = 0;
     for (i = 0; i < nav_node_count; i++) {
-        vec3_t delta;
-        float  dist_sq;
         const nav_node_t *n = &nav_nodes[i];
 
         if (n->id == BOT_INVALID_NODE)
             continue;
-
-        /* Must satisfy all required flags. */
         if (required_flags != 0 &&
             (n->flags & required_flags) != required_flags)
             continue;
-
-        VectorSubtract(origin, n->origin, delta);
-        dist_sq = DotProduct(delta, delta);
-
-        if (dist_sq < best_dist) {
-            best_dist = dist_sq;
-            best_id   = n->id;
-        }
+        set->x[set->count]  = n->origin[0];
+        set->y[set->count]  = n->origin[1];
+        set->z[set->count]  = n->origin[2];
+        set->id[set->count] = (short)n->id;
+        set->count++;
     }
+    set->bank    = nav_nodes;
+    set->version = nav_graph_version;
+    set->flags   = required_flags;
+    return set;
+}
 
-    return best_id;
+/* -----------------------------------------------------------------------
+   Node_FindNearest
+   Return the ID of the nearest valid node that:
+     - has ALL bits in required_flags set (pass 0 to accept any node), and
+     - lies within max_range world units (pass 0.0f for unlimited range).
+   Returns BOT_INVALID_NODE if no qualifying node is found.  Of equally
+   near nodes the lowest ID wins.
+   ----------------------------------------------------------------------- */
+int Node_FindNearest(vec3_t origin, unsigned int required_flags,
+                     float max_range)
+{
+    const node_near_set_t *set = Node_NearSet(required_flags);
+    float max_dist = (max_range > 0.0f) ? (max_range * max_range)
+                                        : FLT_MAX;
+    int   best;
+
+    best = VectorBatch_Nearest(origin, set->x, set->y, set->z, set->count,
+                               max_dist, NULL);
+    return (best < 0) ? BOT_INVALID_NODE : set->id[best];
+}
+
+/* -----------------------------------------------------------------------
+   Internal helper: the ID to print for a slot.  Console output uses file
+   IDs; a removed slot keeps its ext_id, an out-of-range one prints -1.
+   ----------------------------------------------------------------------- */
+static int Node_LogId(int id)
+{
+    if (id < 0 || id >= nav_node_count)
+        return BOT_INVALID_NODE;
+    return nav_nodes[id].ext_id;
 }
 
 /* -----------------------------------------------------------------------
@@ -180,7 +341,7 @@ static qboolean Node_AddLink(int from_id, int to_id, float cost, int move_type)
     int         j;
 
     if (n->num_neighbors >= MAX_NODE_NEIGHBORS) {
-        gi.dprintf("Node_Connect: node %d neighbor list full\n", from_id);
+        BotLog_Warn("Node_Connect: node %d neighbor list full\n", n->ext_id);
         return false;
     }
 
@@ -194,7 +355,10 @@ static qboolean Node_AddLink(int from_id, int to_id, float cost, int move_type)
     n->neighbors[j]         = to_id;
     n->neighbor_costs[j]    = cost;
     n->movement_required[j] = move_type;
+    n->edge_caps[j]         = Node_MoveCaps(move_type);
     n->num_neighbors++;
+    nav_graph_version++;
+    nav_graph_hash = 0;
     return true;
 }
 
@@ -205,193 +369,545 @@ static qboolean Node_AddLink(int from_id, int to_id, float cost, int move_type)
 void Node_Connect(int id1, int id2, float cost, int move_type)
 {
     if (id1 < 0 || id1 >= nav_node_count || nav_nodes[id1].id == BOT_INVALID_NODE) {
-        gi.dprintf("Node_Connect: invalid node id1=%d\n", id1);
+        BotLog_Warn("Node_Connect: invalid node id1=%d\n", Node_LogId(id1));
         return;
     }
     if (id2 < 0 || id2 >= nav_node_count || nav_nodes[id2].id == BOT_INVALID_NODE) {
-        gi.dprintf("Node_Connect: invalid node id2=%d\n", id2);
+        BotLog_Warn("Node_Connect: invalid node id2=%d\n", Node_LogId(id2));
         return;
     }
     if (id1 == id2)
         return;
 
+    Node_Privatize(true);
     Node_AddLink(id1, id2, cost, move_type);
     Node_AddLink(id2, id1, cost, move_type);
 }
 
 /* -----------------------------------------------------------------------
-   Node_Save
-   Serialize the node graph to  maps/<mapname>.nav  in binary form.
-   Returns true on success.
+   Node_ConnectOneWay
+   Create a link from from_id to to_id only (drops, jumps, ladders down).
    ----------------------------------------------------------------------- */
-qboolean Node_Save(const char *mapname)
+void Node_ConnectOneWay(int from_id, int to_id, float cost, int move_type)
 {
-    char     path[MAX_QPATH + 16];
-    FILE    *f;
-    int      i, valid_count, version, magic;
+    if (from_id < 0 || from_id >= nav_node_count ||
+        nav_nodes[from_id].id == BOT_INVALID_NODE) {
+        BotLog_Warn("Node_ConnectOneWay: invalid node from=%d\n",
+                    Node_LogId(from_id));
+        return;
+    }
+    if (to_id < 0 || to_id >= nav_node_count ||
+        nav_nodes[to_id].id == BOT_INVALID_NODE) {
+        BotLog_Warn("Node_ConnectOneWay: invalid node to=%d\n",
+                    Node_LogId(to_id));
+        return;
+    }
+    if (from_id == to_id)
+        return;
+
+    Node_Privatize(true);
+    Node_AddLink(from_id, to_id, cost, move_type);
+}
+
+static qboolean Node_Write(const char *caller, const char *mapname,
+                           nav_file_format_t format)
+{
+    char path[MAX_QPATH + 16];
+    char err[128];
+    int  written;
 
     if (!mapname || !mapname[0]) {
-        gi.dprintf("Node_Save: empty mapname\n");
+        gi.dprintf("%s: empty mapname\n", caller);
         return false;
     }
 
     Com_sprintf(path, sizeof(path), "maps/%s.nav", mapname);
-
-    f = fopen(path, "wb");
-    if (!f) {
-        gi.dprintf("Node_Save: cannot open '%s' for writing\n", path);
+    written = NavFile_Write(path, nav_nodes, nav_node_count, format,
+                            err, sizeof(err));
+    if (written < 0) {
+        gi.dprintf("%s: %s\n", caller, err);
         return false;
     }
 
-    /* Count valid nodes. */
-    valid_count = 0;
-    for (i = 0; i < nav_node_count; i++) {
-        if (nav_nodes[i].id != BOT_INVALID_NODE)
-            valid_count++;
+    gi.dprintf("%s: saved %d nodes to '%s'\n", caller, written, path);
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   Node_Save
+   Serialize the node graph to  maps/<mapname>.nav  in binary form (see
+   bot_navfile.c); a crash mid-save leaves the previous file intact.
+   Returns true on success.
+   ----------------------------------------------------------------------- */
+qboolean Node_Save(const char *mapname)
+{
+    return Node_Write("Node_Save", mapname, NAV_FORMAT_BINARY);
+}
+
+/* -----------------------------------------------------------------------
+   Node_SaveText
+   As Node_Save, but in the hand-editable text format.
+   ----------------------------------------------------------------------- */
+qboolean Node_SaveText(const char *mapname)
+{
+    return Node_Write("Node_SaveText", mapname, NAV_FORMAT_TEXT);
+}
+
+/* -----------------------------------------------------------------------
+   Node_Renumber
+   Reorder a freshly parsed bank in Reverse Cuthill-McKee order and
+   compact it to slots 0..n-1.  Each component is walked breadth-first
+   from a pseudo-peripheral node, visiting neighbours by increasing
+   degree; reversing that order keeps linked nodes in nearby slots.
+   Links to missing nodes are dropped.  Same thread rules as
+   NavFile_Read; returns the new node count.
+   ----------------------------------------------------------------------- */
+#define RCM_FREE   (-1)
+#define RCM_TRIAL  (-2)
+#define RCM_DONE   (-3)
+
+static int        s_rcm_order[MAX_NAV_NODES];   /* new slot -> old slot */
+static int        s_rcm_new[MAX_NAV_NODES];     /* RCM_* marks, then old -> new */
+static nav_node_t s_rcm_bank[MAX_NAV_NODES];
+
+static int Node_Degree(const nav_node_t *bank, int count, int id)
+{
+    const nav_node_t *n = &bank[id];
+    int j, deg = 0;
+
+    for (j = 0; j < n->num_neighbors; j++) {
+        int nb = n->neighbors[j];
+
+        if (nb >= 0 && nb < count && bank[nb].id != BOT_INVALID_NODE)
+            deg++;
     }
+    return deg;
+}
 
-    /* Header */
-    magic   = NAV_FILE_MAGIC;
-    version = NAV_FILE_VERSION;
-    fwrite(&magic,       sizeof(int), 1, f);
-    fwrite(&version,     sizeof(int), 1, f);
-    fwrite(&valid_count, sizeof(int), 1, f);
+/*
+ * Breadth-first from start, appending to s_rcm_order[base..]; neighbours
+ * are queued lowest degree first and marked with mark; only RCM_FREE
+ * nodes are entered.  Returns the slot of the last node reached.
+ */
+static int Node_RcmWalk(const nav_node_t *bank, int count, int start,
+                        int base, int *out_end, int mark)
+{
+    int head = base, tail = base;
 
-    /* Node records */
-    for (i = 0; i < nav_node_count; i++) {
-        const nav_node_t *n = &nav_nodes[i];
-        int               j;
-        int               neighbor_id;
-        float             neighbor_cost;
-        int               move_req;
+    s_rcm_order[tail++] = start;
+    s_rcm_new[start]    = mark;
 
-        if (n->id == BOT_INVALID_NODE)
+    while (head < tail) {
+        const nav_node_t *n = &bank[s_rcm_order[head++]];
+        int adj[MAX_NODE_NEIGHBORS], deg[MAX_NODE_NEIGHBORS];
+        int j, k, m = 0;
+
+        for (j = 0; j < n->num_neighbors; j++) {
+            int nb = n->neighbors[j], d;
+
+            if (nb < 0 || nb >= count || bank[nb].id == BOT_INVALID_NODE ||
+                s_rcm_new[nb] != RCM_FREE)
+                continue;
+            s_rcm_new[nb] = mark;
+
+            /* Insertion sort by degree, stable for equal degrees */
+            d = Node_Degree(bank, count, nb);
+            for (k = m; k > 0 && deg[k - 1] > d; k--) {
+                adj[k] = adj[k - 1];
+                deg[k] = deg[k - 1];
+            }
+            adj[k] = nb;
+            deg[k] = d;
+            m++;
+        }
+        for (k = 0; k < m; k++)
+            s_rcm_order[tail++] = adj[k];
+    }
+
+    *out_end = tail;
+    return s_rcm_order[tail - 1];
+}
+
+static int Node_Renumber(nav_node_t *bank, int count)
+{
+    int i, j, n = 0;
+
+    for (i = 0; i < count; i++)
+        s_rcm_new[i] = RCM_FREE;
+
+    for (i = 0; i < count; i++) {
+        int start = i, end, k, best;
+
+        if (bank[i].id == BOT_INVALID_NODE || s_rcm_new[i] != RCM_FREE)
             continue;
 
-        fwrite(&n->id,           sizeof(int),   1, f);
-        fwrite(n->origin,        sizeof(float),  3, f);
-        fwrite(&n->flags,        sizeof(unsigned int), 1, f);
-        fwrite(&n->team_access,  sizeof(unsigned int), 1, f);
-        fwrite(&n->num_neighbors,sizeof(int),   1, f);
+        /* Lowest-degree node of the component, found by a trial walk */
+        Node_RcmWalk(bank, count, i, n, &end, RCM_TRIAL);
+        for (k = n; k < end; k++) {
+            if (Node_Degree(bank, count, s_rcm_order[k]) <
+                Node_Degree(bank, count, start))
+                start = s_rcm_order[k];
+        }
 
-        for (j = 0; j < MAX_NODE_NEIGHBORS; j++) {
-            neighbor_id   = n->neighbors[j];
-            neighbor_cost = n->neighbor_costs[j];
-            move_req      = n->movement_required[j];
-            fwrite(&neighbor_id,   sizeof(int),   1, f);
-            fwrite(&neighbor_cost, sizeof(float), 1, f);
-            fwrite(&move_req,      sizeof(int),   1, f);
+        /* One George-Liu step: restart from the far end of that walk */
+        for (k = n; k < end; k++)
+            s_rcm_new[s_rcm_order[k]] = RCM_FREE;
+        best = Node_RcmWalk(bank, count, start, n, &end, RCM_TRIAL);
+        for (k = n; k < end; k++)
+            s_rcm_new[s_rcm_order[k]] = RCM_FREE;
+
+        Node_RcmWalk(bank, count, best, n, &end, RCM_DONE);
+        n = end;
+    }
+
+    /* Reverse, then record old -> new */
+    for (i = 0; i < n / 2; i++) {
+        int t = s_rcm_order[i];
+        s_rcm_order[i] = s_rcm_order[n - 1 - i];
+        s_rcm_order[n - 1 - i] = t;
+    }
+    for (i = 0; i < count; i++)
+        s_rcm_new[i] = BOT_INVALID_NODE;
+    for (i = 0; i < n; i++)
+        s_rcm_new[s_rcm_order[i]] = i;
+
+    for (i = 0; i < n; i++) {
+        nav_node_t *dst = &s_rcm_bank[i];
+        int         m = 0;
+
+        *dst    = bank[s_rcm_order[i]];
+        dst->id = i;
+        for (j = 0; j < dst->num_neighbors; j++) {
+            int nb = dst->neighbors[j];
+
+            if (nb < 0 || nb >= count || s_rcm_new[nb] == BOT_INVALID_NODE)
+                continue;
+            dst->neighbors[m]         = s_rcm_new[nb];
+            dst->neighbor_costs[m]    = dst->neighbor_costs[j];
+            dst->movement_required[m] = dst->movement_required[j];
+            dst->edge_caps[m]         = dst->edge_caps[j];
+            m++;
         }
+        for (j = m; j < MAX_NODE_NEIGHBORS; j++)
+            dst->neighbors[j] = BOT_INVALID_NODE;
+        dst->num_neighbors = m;
     }
 
+    memcpy(bank, s_rcm_bank, sizeof(nav_node_t) * (size_t)n);
+    for (i = n; i < count; i++) {
+        bank[i].id            = BOT_INVALID_NODE;
+        bank[i].num_neighbors = 0;
+    }
+    return n;
+}
+
+/* -----------------------------------------------------------------------
+   Node_HashFile
+   FNV-1a over the raw file.  Keys the derived-data cache and the shared
+   memory segment; never 0, which means "no file identity".
+   ----------------------------------------------------------------------- */
+static qboolean Node_HashFile(const char *path, unsigned int *out_hash,
+                              char *err, int errsize)
+{
+    unsigned char buf[4096];
+    unsigned int  hash = 2166136261u;
+    size_t        got, k;
+    FILE         *f;
+
+    f = fopen(path, "rb");
+    if (!f) {
+        Com_sprintf(err, errsize, "no nav file '%s'", path);
+        return false;
+    }
+    while ((got = fread(buf, 1, sizeof(buf), f)) > 0) {
+        for (k = 0; k < got; k++)
+            hash = (hash ^ buf[k]) * 16777619u;
+    }
     fclose(f);
-    gi.dprintf("Node_Save: saved %d nodes to '%s'\n", valid_count, path);
+
+    *out_hash = hash ? hash : 1;
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   Node_RunLoad
+   Produce a loaded graph for job->path, either by attaching to another
+   server's shared copy or by parsing into job->bank (and then offering
+   that to other servers).  Runs on either thread; no gi calls.
+   ----------------------------------------------------------------------- */
+static qboolean Node_RunLoad(node_load_job_t *job)
+{
+    BotNavShm_Init(&job->shm);
+
+    if (!Node_HashFile(job->path, &job->hash, job->error, sizeof(job->error)))
+        return false;
+
+    if (job->shared && BotNavShm_Open(&job->shm, job->hash)) {
+        job->count  = BotNavShm_Count(&job->shm);
+        job->loaded = -1;
+        return true;
+    }
+
+    if (!NavFile_Read(job->path, job->bank, &job->count, &job->loaded,
+                      NULL, job->error, sizeof(job->error)))
+        return false;
+    job->count = Node_Renumber(job->bank, job->count);
+
+    /* Lost a creation race?  Then share the winner's identical copy */
+    if (job->shared && !BotNavShm_Create(&job->shm, job->hash,
+                                         job->bank, job->count))
+        BotNavShm_Open(&job->shm, job->hash);
     return true;
 }
 
+/* -----------------------------------------------------------------------
+   Node_Publish
+   Make a finished load live.  Server thread only.  A private result
+   swaps banks; a shared one points nav_nodes into the segment.  The old
+   live bank becomes the next load target and any old segment is let go.
+   ----------------------------------------------------------------------- */
+static void Node_Publish(node_load_job_t *job)
+{
+    nav_shm_t old = s_live_shm;
+
+    if (job->shm.base) {
+        /* Read-only: mutators go through Node_Privatize first */
+        nav_nodes  = (nav_node_t *)BotNavShm_Nodes(&job->shm);
+        s_live_shm = job->shm;
+    } else {
+        nav_nodes  = job->bank;
+        BotNavShm_Init(&s_live_shm);
+    }
+    BotNavShm_Init(&job->shm);
+    BotNavShm_Close(&old);
+
+    nav_node_count = job->count;
+    nav_graph_version++;
+    nav_graph_hash = job->hash;
+
+    Com_sprintf(s_live_path, sizeof(s_live_path), "%s", job->path);
+    s_live_size  = job->file_size;
+    s_live_mtime = job->file_mtime;
+}
+
+static void Node_LogLoaded(const node_load_job_t *job)
+{
+    if (job->loaded < 0)
+        gi.dprintf("Node_Load: '%s' mapped from shared memory (%d slots)\n",
+                   job->path, job->count);
+    else
+        gi.dprintf("Node_Load: loaded %d nodes from '%s'\n",
+                   job->loaded, job->path);
+}
+
+static void Node_InitJob(node_load_job_t *job, const char *mapname)
+{
+    struct stat st;
+
+    memset(job, 0, sizeof(*job));
+    Com_sprintf(job->path, sizeof(job->path), "maps/%s.nav", mapname);
+    if (stat(job->path, &st) == 0) {
+        job->file_size  = (long)st.st_size;
+        job->file_mtime = (long)st.st_mtime;
+    }
+    job->bank   = Node_BackBank();
+    job->shared = bot_nav_shared && (int)bot_nav_shared->value != 0;
+    BotNavShm_Init(&job->shm);
+}
+
 /* -----------------------------------------------------------------------
    Node_Load
-   Deserialize the node graph from  maps/<mapname>.nav .
-   Clears the existing graph before loading.
+   Deserialize the node graph from  maps/<mapname>.nav  synchronously.
+   The file is parsed into the back bank, so the live graph is only
+   replaced when the whole file is valid.
    Returns true on success.
    ----------------------------------------------------------------------- */
 qboolean Node_Load(const char *mapname)
 {
-    char  path[MAX_QPATH + 16];
-    FILE *f;
-    int   magic, version, count, i;
+    static node_load_job_t job;
 
     if (!mapname || !mapname[0]) {
         gi.dprintf("Node_Load: empty mapname\n");
         return false;
     }
 
-    Com_sprintf(path, sizeof(path), "maps/%s.nav", mapname);
+    Node_CancelLoad();
 
-    f = fopen(path, "rb");
-    if (!f) {
-        gi.dprintf("Node_Load: no nav file '%s'\n", path);
+    Node_InitJob(&job, mapname);
+    if (!Node_RunLoad(&job)) {
+        gi.dprintf("Node_Load: %s\n", job.error);
         return false;
     }
 
-    /* Validate header */
-    if (fread(&magic,   sizeof(int), 1, f) != 1 ||
-        fread(&version, sizeof(int), 1, f) != 1 ||
-        fread(&count,   sizeof(int), 1, f) != 1) {
-        gi.dprintf("Node_Load: '%s' truncated header\n", path);
-        fclose(f);
-        return false;
-    }
+    Node_Publish(&job);
+    Node_LogLoaded(&job);
+    return true;
+}
 
-    if (magic != NAV_FILE_MAGIC) {
-        gi.dprintf("Node_Load: '%s' bad magic\n", path);
-        fclose(f);
+/* -----------------------------------------------------------------------
+   Asynchronous loading
+   The loader thread owns the job record and its bank until it sets
+   job.done; the server thread then joins it and publishes from
+   Node_PollLoad.  Nothing else touches the back bank in the meantime.
+   ----------------------------------------------------------------------- */
+static void Node_LoadWorker(void *arg)
+{
+    node_load_job_t *job = (node_load_job_t *)arg;
+    qboolean ok;
+
+    ok = Node_RunLoad(job);
+
+    BotMutex_Lock(&s_load_lock);
+    job->ok   = ok;
+    job->done = true;
+    BotMutex_Unlock(&s_load_lock);
+}
+
+/* -----------------------------------------------------------------------
+   Node_LoadAsync
+   ----------------------------------------------------------------------- */
+qboolean Node_LoadAsync(const char *mapname)
+{
+    if (!mapname || !mapname[0]) {
+        gi.dprintf("Node_LoadAsync: empty mapname\n");
         return false;
     }
 
-    if (version != NAV_FILE_VERSION) {
-        gi.dprintf("Node_Load: '%s' unsupported version %d\n", path, version);
-        fclose(f);
-        return false;
+    Node_CancelLoad();
+
+    if (!s_load_lock_ready) {
+        BotMutex_Init(&s_load_lock);
+        s_load_lock_ready = true;
     }
 
-    if (count < 0 || count > MAX_NAV_NODES) {
-        gi.dprintf("Node_Load: '%s' invalid node count %d\n", path, count);
-        fclose(f);
-        return false;
+    Node_InitJob(&s_load_job, mapname);
+
+    if (!BotThread_Start(&s_load_thread, Node_LoadWorker, &s_load_job)) {
+        gi.dprintf("Node_LoadAsync: cannot start loader thread, "
+                   "loading synchronously\n");
+        return Node_Load(mapname);
     }
 
-    Node_Clear();
+    s_load_pending = true;
+    return true;
+}
 
-    for (i = 0; i < count; i++) {
-        nav_node_t  n;
-        int         j;
-        int         id;
-
-        memset(&n, 0, sizeof(n));
-
-        if (fread(&id,            sizeof(int),          1, f) != 1 ||
-            fread(n.origin,       sizeof(float),         3, f) != 3 ||
-            fread(&n.flags,       sizeof(unsigned int),  1, f) != 1 ||
-            fread(&n.team_access, sizeof(unsigned int),  1, f) != 1 ||
-            fread(&n.num_neighbors, sizeof(int),         1, f) != 1) {
-            gi.dprintf("Node_Load: '%s' truncated at node %d\n", path, i);
-            fclose(f);
-            return false;
-        }
+/* -----------------------------------------------------------------------
+   Node_PollLoad
+   ----------------------------------------------------------------------- */
+node_load_status_t Node_PollLoad(void)
+{
+    qboolean done;
 
-        for (j = 0; j < MAX_NODE_NEIGHBORS; j++) {
-            if (fread(&n.neighbors[j],         sizeof(int),   1, f) != 1 ||
-                fread(&n.neighbor_costs[j],    sizeof(float), 1, f) != 1 ||
-                fread(&n.movement_required[j], sizeof(int),   1, f) != 1) {
-                gi.dprintf("Node_Load: '%s' truncated at node %d neighbor %d\n",
-                           path, i, j);
-                fclose(f);
-                return false;
-            }
-        }
+    if (!s_load_pending)
+        return NODE_LOAD_IDLE;
 
-        if (id < 0 || id >= MAX_NAV_NODES) {
-            gi.dprintf("Node_Load: '%s' node index %d out of range\n", path, id);
-            fclose(f);
-            return false;
-        }
+    BotMutex_Lock(&s_load_lock);
+    done = s_load_job.done;
+    BotMutex_Unlock(&s_load_lock);
 
-        if (n.num_neighbors < 0 || n.num_neighbors > MAX_NODE_NEIGHBORS) {
-            gi.dprintf("Node_Load: '%s' node %d invalid neighbor count %d\n",
-                       path, id, n.num_neighbors);
-            fclose(f);
-            return false;
-        }
+    if (!done)
+        return NODE_LOAD_PENDING;
 
-        n.id = id;
-        nav_nodes[id] = n;
+    BotThread_Join(&s_load_thread);
+    s_load_pending = false;
 
-        if (id >= nav_node_count)
-            nav_node_count = id + 1;
+    if (!s_load_job.ok) {
+        gi.dprintf("Node_Load: %s\n", s_load_job.error);
+        return NODE_LOAD_FAILED;
     }
 
-    fclose(f);
-    gi.dprintf("Node_Load: loaded %d nodes from '%s'\n", count, path);
-    return true;
+    Node_Publish(&s_load_job);
+    Node_LogLoaded(&s_load_job);
+    return NODE_LOAD_PUBLISHED;
+}
+
+/* -----------------------------------------------------------------------
+   Node_WaitLoad
+   ----------------------------------------------------------------------- */
+node_load_status_t Node_WaitLoad(void)
+{
+    if (!s_load_pending)
+        return NODE_LOAD_IDLE;
+
+    BotThread_Join(&s_load_thread);
+    return Node_PollLoad();
+}
+
+/* -----------------------------------------------------------------------
+   Node_CancelLoad
+   Wait out any in-flight load and drop its result.
+   ----------------------------------------------------------------------- */
+void Node_CancelLoad(void)
+{
+    if (!s_load_pending)
+        return;
+
+    BotThread_Join(&s_load_thread);
+    BotNavShm_Close(&s_load_job.shm);
+    s_load_pending = false;
+}
+
+/* -----------------------------------------------------------------------
+   Node_LoadPending
+   ----------------------------------------------------------------------- */
+qboolean Node_LoadPending(void)
+{
+    return s_load_pending;
+}
+
+/* -----------------------------------------------------------------------
+   Node_FileUnchanged
+   ----------------------------------------------------------------------- */
+qboolean Node_FileUnchanged(const char *mapname)
+{
+    char        path[MAX_QPATH + 16];
+    struct stat st;
+
+    if (!nav_graph_hash || s_load_pending || !mapname || !mapname[0])
+        return false;
+
+    Com_sprintf(path, sizeof(path), "maps/%s.nav", mapname);
+    if (strcmp(path, s_live_path) != 0 || stat(path, &st) != 0)
+        return false;
+    return (long)st.st_size == s_live_size && (long)st.st_mtime == s_live_mtime;
+}
+
+/* -----------------------------------------------------------------------
+   Node_IsShared
+   ----------------------------------------------------------------------- */
+qboolean Node_IsShared(void)
+{
+    return s_live_shm.base != NULL;
+}
+
+/* -----------------------------------------------------------------------
+   Node_Shutdown
+   Stop the loader and detach from shared memory.
+   ----------------------------------------------------------------------- */
+void Node_Shutdown(void)
+{
+    Node_CancelLoad();
+    Node_Clear();
+}
+
+/* -----------------------------------------------------------------------
+   Node_ExternalId / Node_FromExternalId
+   ----------------------------------------------------------------------- */
+int Node_ExternalId(int id)
+{
+    if (id < 0 || id >= nav_node_count || nav_nodes[id].id == BOT_INVALID_NODE)
+        return BOT_INVALID_NODE;
+    return nav_nodes[id].ext_id;
+}
+
+int Node_FromExternalId(int ext_id)
+{
+    int i;
+
+    for (i = 0; i < nav_node_count; i++) {
+        if (nav_nodes[i].id != BOT_INVALID_NODE && nav_nodes[i].ext_id == ext_id)
+            return i;
+    }
+    return BOT_INVALID_NODE;
 }
@@ -13,16 +13,19 @@
  * MOVEMENT TYPES
  * ---------------
  * Each edge (neighbor link) records which movement capability a bot
- * must have to traverse it (NAV_MOVE_*).  BotNav_FindPath filters
- * edges that require capabilities the bot lacks (e.g. wall-climb
- * edges are skipped for non-wall-walking classes).
+ * must have to traverse it (NAV_MOVE_*).  The capability that move type
+ * needs is cached beside it in edge_caps (NAV_CAP_*), so BotNav_FindPath
+ * filters edges the bot cannot use (e.g. wall-climb edges for
+ * non-wall-walking classes) with a single mask test.
  *
  * FILE FORMAT (maps/<mapname>.nav)
  * ---------------------------------
+ * Binary as below, or the text format described in bot_navfile.h.
  * Binary, little-endian:
  *   4 bytes  magic   "NAV1"
- *   4 bytes  version 1
+ *   4 bytes  version 2
  *   4 bytes  node count
+ *   4 bytes  CRC32 of the whole file minus this field (absent in version 1)
  *   Per node:
  *     4 bytes  id
  *     12 bytes origin (3 × float)
@@ -30,6 +33,18 @@
  *     4 bytes  team_access
  *     4 bytes  num_neighbors
  *     MAX_NODE_NEIGHBORS × (4+4+4) bytes  (neighbor_id, cost, move_type)
+ *
+ * Node_Save builds the file in memory, writes it to <file>.tmp in one
+ * write, syncs it and renames it into place.  Version 1 files still load.
+ *
+ * NODE NUMBERING
+ * --------------
+ * IDs in a .nav file follow authoring order, which scatters graph
+ * neighbours across nav_nodes[].  Loading renumbers the graph in Reverse
+ * Cuthill-McKee order so that linked nodes sit in nearby slots, and the
+ * A* and flood-fill loops stay in cache.  The file ID is kept in ext_id:
+ * saves, console output and the .stuck heatmap use it, so IDs seen
+ * outside the game stay the same across loads.
  */
 
 #ifndef BOT_NODES_H
@@ -63,6 +78,12 @@
 #define NAV_MOVE_SWIM   4   /* swimming                                      */
 #define NAV_MOVE_LADDER 5   /* ladder traverse                               */
 
+/* -----------------------------------------------------------------------
+   Edge capability bits (edge_caps[]); same values as BOT_PATH_CAP_*
+   ----------------------------------------------------------------------- */
+#define NAV_CAP_WALL    0x01    /* needs Bot_CanWallWalk                     */
+#define NAV_CAP_FLY     0x02    /* needs Gloom_ClassCanFly                   */
+
 /* -----------------------------------------------------------------------
    Team/capability access flags (team_access bitmask)
    ----------------------------------------------------------------------- */
@@ -88,14 +109,40 @@ typedef struct {
     int          num_neighbors;                         /* number of active neighbor links                    */
     unsigned int team_access;                           /* NAV_TEAM_* bitmask                                 */
     int          movement_required[MAX_NODE_NEIGHBORS]; /* NAV_MOVE_* for each neighbor edge                  */
+    unsigned char edge_caps[MAX_NODE_NEIGHBORS];        /* NAV_CAP_* each edge needs (Node_MoveCaps)          */
+    int          ext_id;                                /* stable ID in the .nav file (see Node_ExternalId)   */
 } nav_node_t;
 
+/* Capabilities a NAV_MOVE_* edge requires; unknown types need none. */
+static inline unsigned char Node_MoveCaps(int move_type)
+{
+    switch (move_type) {
+    case NAV_MOVE_CLIMB: return NAV_CAP_WALL;
+    case NAV_MOVE_FLY:   return NAV_CAP_FLY;
+    default:             return 0;
+    }
+}
+
 /* -----------------------------------------------------------------------
    Global node graph (defined in bot_nodes.c)
    ----------------------------------------------------------------------- */
-extern nav_node_t nav_nodes[MAX_NAV_NODES];
+/*
+ * nav_nodes points at the live bank of MAX_NAV_NODES entries.  Loads are
+ * parsed into a second bank and swapped in by the server thread, so do
+ * not hold &nav_nodes[i] across frames.
+ */
+extern nav_node_t *nav_nodes;
 extern int        nav_node_count;   /* highest allocated slot index + 1 */
 
+/* Incremented by every graph edit; lets caches detect stale data. */
+extern unsigned int nav_graph_version;
+
+/*
+ * Hash of the .nav file the live graph was loaded from; 0 once the graph
+ * has been edited in memory (or was never loaded from a file).
+ */
+extern unsigned int nav_graph_hash;
+
 /* -----------------------------------------------------------------------
    Node operations
    ----------------------------------------------------------------------- */
@@ -120,13 +167,71 @@ int      Node_FindNearest(vec3_t origin, unsigned int required_flags,
  */
 void     Node_Connect(int id1, int id2, float cost, int move_type);
 
+/* As Node_Connect, but only from_id -> to_id. */
+void     Node_ConnectOneWay(int from_id, int to_id, float cost, int move_type);
+
+/* Stable file ID of a node, or BOT_INVALID_NODE. */
+int      Node_ExternalId(int id);
+
+/* Live node with the given file ID, or BOT_INVALID_NODE. */
+int      Node_FromExternalId(int ext_id);
+
 /* Serialize the node graph to maps/<mapname>.nav; returns true on success. */
 qboolean Node_Save(const char *mapname);
 
-/* Deserialize the node graph from maps/<mapname>.nav; returns true on success. */
+/* As Node_Save, in the text format of bot_navfile.h. */
+qboolean Node_SaveText(const char *mapname);
+
+/* Deserialize the node graph from maps/<mapname>.nav (binary or text);
+ * returns true on success. */
 qboolean Node_Load(const char *mapname);
 
 /* Reset the node graph (called on map change). */
 void     Node_Clear(void);
 
+/* -----------------------------------------------------------------------
+   Background loading
+   Node_LoadAsync parses maps/<mapname>.nav on a worker thread while the
+   current graph stays live; Node_PollLoad (server thread, once a frame)
+   publishes it when ready.  Edits made to the live graph while a load
+   is pending are discarded when the new graph is published.
+   ----------------------------------------------------------------------- */
+typedef enum {
+    NODE_LOAD_IDLE,         /* no load in flight                      */
+    NODE_LOAD_PENDING,      /* worker still parsing                   */
+    NODE_LOAD_PUBLISHED,    /* new graph went live during this call   */
+    NODE_LOAD_FAILED        /* worker finished with an error (logged) */
+} node_load_status_t;
+
+/* Start a background load; falls back to Node_Load if no thread can be
+ * created.  Any load already in flight is waited out and dropped. */
+qboolean Node_LoadAsync(const char *mapname);
+
+/* Publish a finished background load; never blocks. */
+node_load_status_t Node_PollLoad(void);
+
+/* Block until the background load finishes, then publish it. */
+node_load_status_t Node_WaitLoad(void);
+
+/* Wait out and drop any background load. */
+void     Node_CancelLoad(void);
+
+qboolean Node_LoadPending(void);
+
+/*
+ * True if the live graph was loaded unedited from maps/<mapname>.nav and
+ * the file has not changed since (same size and mtime).
+ */
+qboolean Node_FileUnchanged(const char *mapname);
+
+/*
+ * True if the live graph is mapped from another server's shared memory
+ * segment (see bot_navshm.h).  Edits transparently copy it into private
+ * memory first.
+ */
+qboolean Node_IsShared(void);
+
+/* Stop the loader and detach from shared memory (DLL shutdown). */
+void     Node_Shutdown(void);
+
 #endif /* BOT_NODES_H */
@@ -0,0 +1,263 @@
+/*
+ * bot_path.c -- shared path storage for q2gloombot
+ *
+ * See bot_path.h for the design.  Handles are 1-based indices into
+ * s_paths[] so that a zeroed bot_state_t holds BOT_PATH_NONE, with the
+ * pool's epoch in the bits above.  BotPath_Clear bumps the epoch, so a
+ * handle a bot kept across a clear no longer resolves and cannot touch
+ * whatever path has since been stored in its slot.
+ */
+
+#include "bot_path.h"
+#include "bot_nodes.h"
+#include "bot_log.h"
+
+typedef struct {
+    qboolean     in_use;
+    int          refs;       /* bots currently following this path      */
+    int          offset;     /* first node in s_arena                   */
+    int          length;     /* number of nodes                         */
+    unsigned int caps;       /* BOT_PATH_CAP_* the search was run with  */
+    unsigned int version;    /* nav_graph_version at search time        */
+    float        last_used;  /* level.time of last store/share (LRU)    */
+} bot_path_t;
+
+#define PATH_SLOT_BITS   8
+#define PATH_SLOT_MASK   ((1 << PATH_SLOT_BITS) - 1)
+#define PATH_EPOCH_MASK  0x7FFFFF
+
+#if BOT_PATH_POOL_SIZE > PATH_SLOT_MASK
+#error "BOT_PATH_POOL_SIZE does not fit in PATH_SLOT_BITS"
+#endif
+
+/* One live path per bot, and as many again kept as a sharing cache */
+#if BOT_PATH_POOL_SIZE < 2 * MAX_BOTS
+#error "BOT_PATH_POOL_SIZE leaves no cache headroom over MAX_BOTS"
+#endif
+
+static bot_path_t     s_paths[BOT_PATH_POOL_SIZE];
+static int            s_path_epoch;
+static unsigned short s_arena[BOT_PATH_ARENA_NODES];
+static int            s_arena_top;
+
+/* -----------------------------------------------------------------------
+   Internal helpers
+   ----------------------------------------------------------------------- */
+static int BotPath_Handle(int slot)
+{
+    return (s_path_epoch << PATH_SLOT_BITS) | (slot + 1);
+}
+
+static bot_path_t *BotPath_Get(int handle)
+{
+    int slot = (handle & PATH_SLOT_MASK) - 1;
+
+    if (handle <= 0 || (handle >> PATH_SLOT_BITS) != s_path_epoch)
+        return NULL;
+    if (slot < 0 || slot >= BOT_PATH_POOL_SIZE)
+        return NULL;
+    if (!s_paths[slot].in_use)
+        return NULL;
+    return &s_paths[slot];
+}
+
+/*
+ * BotPath_Compact
+ * Slide every path down to the bottom of the arena, closing the gaps
+ * left by evicted paths.
+ */
+static void BotPath_Compact(void)
+{
+    int order[BOT_PATH_POOL_SIZE];
+    int count = 0;
+    int i, j, top = 0;
+
+    /* Insertion-sort the in-use records by arena offset */
+    for (i = 0; i < BOT_PATH_POOL_SIZE; i++) {
+        if (!s_paths[i].in_use)
+            continue;
+        for (j = count; j > 0 && s_paths[order[j - 1]].offset > s_paths[i].offset; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+        count++;
+    }
+
+    for (i = 0; i < count; i++) {
+        bot_path_t *p = &s_paths[order[i]];
+        if (p->offset != top)
+            memmove(&s_arena[top], &s_arena[p->offset],
+                    (size_t)p->length * sizeof(s_arena[0]));
+        p->offset = top;
+        top += p->length;
+    }
+    s_arena_top = top;
+}
+
+/*
+ * BotPath_EvictOne
+ * Drop the least recently used unreferenced path.  Paths computed on an
+ * older graph go first.  Returns false if every path is referenced.
+ */
+static qboolean BotPath_EvictOne(void)
+{
+    int i, best = -1;
+
+    for (i = 0; i < BOT_PATH_POOL_SIZE; i++) {
+        bot_path_t *p = &s_paths[i];
+        if (!p->in_use || p->refs > 0)
+            continue;
+        if (p->version != nav_graph_version) {
+            best = i;
+            break;
+        }
+        if (best < 0 || p->last_used < s_paths[best].last_used)
+            best = i;
+    }
+
+    if (best < 0)
+        return false;
+    s_paths[best].in_use = false;
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+void BotPath_Clear(void)
+{
+    memset(s_paths, 0, sizeof(s_paths));
+    s_arena_top  = 0;
+    s_path_epoch = (s_path_epoch + 1) & PATH_EPOCH_MASK;
+}
+
+int BotPath_Find(int start, int goal, unsigned int caps, int *cursor)
+{
+    int i, k;
+
+    for (i = 0; i < BOT_PATH_POOL_SIZE; i++) {
+        bot_path_t *p = &s_paths[i];
+
+        if (!p->in_use || p->caps != caps || p->version != nav_graph_version)
+            continue;
+        if (s_arena[p->offset + p->length - 1] != goal)
+            continue;
+
+        for (k = 0; k < p->length; k++) {
+            if (s_arena[p->offset + k] == start) {
+                p->refs++;
+                p->last_used = level.time;
+                if (cursor)
+                    *cursor = k;
+                return BotPath_Handle(i);
+            }
+        }
+    }
+    return BOT_PATH_NONE;
+}
+
+int BotPath_Store(const int *nodes, int length, unsigned int caps)
+{
+    bot_path_t *p;
+    int         i, slot;
+
+    if (!nodes || length <= 0 || length > BOT_MAX_PATH_NODES)
+        return BOT_PATH_NONE;
+
+    /* Find a record, evicting a cached path if necessary */
+    for (slot = 0; slot < BOT_PATH_POOL_SIZE; slot++) {
+        if (!s_paths[slot].in_use)
+            break;
+    }
+    if (slot >= BOT_PATH_POOL_SIZE) {
+        if (!BotPath_EvictOne()) {
+            BotLog_Warn("BotPath_Store: path pool full (%d paths)\n",
+                        BOT_PATH_POOL_SIZE);
+            return BOT_PATH_NONE;
+        }
+        for (slot = 0; slot < BOT_PATH_POOL_SIZE; slot++) {
+            if (!s_paths[slot].in_use)
+                break;
+        }
+    }
+
+    /* Make room in the arena */
+    if (s_arena_top + length > BOT_PATH_ARENA_NODES) {
+        BotPath_Compact();
+        while (s_arena_top + length > BOT_PATH_ARENA_NODES) {
+            if (!BotPath_EvictOne()) {
+                BotLog_Warn("BotPath_Store: path arena full (%d nodes)\n",
+                            BOT_PATH_ARENA_NODES);
+                return BOT_PATH_NONE;
+            }
+            BotPath_Compact();
+        }
+    }
+
+    p = &s_paths[slot];
+    p->in_use    = true;
+    p->refs      = 1;
+    p->offset    = s_arena_top;
+    p->length    = length;
+    p->caps      = caps;
+    p->version   = nav_graph_version;
+    p->last_used = level.time;
+
+    for (i = 0; i < length; i++)
+        s_arena[s_arena_top + i] = (unsigned short)nodes[i];
+    s_arena_top += length;
+
+    return BotPath_Handle(slot);
+}
+
+void BotPath_Retain(int handle)
+{
+    bot_path_t *p = BotPath_Get(handle);
+
+    if (p)
+        p->refs++;
+}
+
+void BotPath_Release(int handle)
+{
+    bot_path_t *p = BotPath_Get(handle);
+
+    if (!p || p->refs <= 0)
+        return;
+
+    /* Keep it cached for sharing unless the graph has moved on */
+    if (--p->refs == 0 && p->version != nav_graph_version)
+        p->in_use = false;
+}
+
+int BotPath_Length(int handle)
+{
+    bot_path_t *p = BotPath_Get(handle);
+
+    return p ? p->length : 0;
+}
+
+int BotPath_Node(int handle, int index)
+{
+    bot_path_t *p = BotPath_Get(handle);
+
+    if (!p || index < 0 || index >= p->length)
+        return BOT_INVALID_NODE;
+    return s_arena[p->offset + index];
+}
+
+void BotPath_Stats(int *live_paths, int *cached_paths, int *arena_used)
+{
+    int i, live = 0, cached = 0;
+
+    for (i = 0; i < BOT_PATH_POOL_SIZE; i++) {
+        if (!s_paths[i].in_use)
+            continue;
+        if (s_paths[i].refs > 0)
+            live++;
+        else
+            cached++;
+    }
+    if (live_paths)   *live_paths   = live;
+    if (cached_paths) *cached_paths = cached;
+    if (arena_used)   *arena_used   = s_arena_top;
+}
@@ -0,0 +1,69 @@
+/*
+ * bot_path.h -- shared path storage for q2gloombot
+ *
+ * Computed A* paths live in one shared, ref-counted pool instead of a
+ * fixed int[256] array inside every bot_state_t.  A bot holds only a
+ * path handle plus its own cursor (nav.path_index).
+ *
+ * Node IDs are stored as 16-bit values (MAX_NAV_NODES fits easily), so
+ * a 40-node path costs 80 bytes of arena instead of 1 KB per bot.
+ *
+ * SHARING
+ * -------
+ * Any suffix of a shortest path is itself a shortest path.  When a bot
+ * asks for start -> goal and a live path to the same goal (for the same
+ * movement capabilities and graph version) already passes through
+ * start, the bot simply takes a reference to it and starts its cursor
+ * part-way along.  Squads heading for the same objective therefore run
+ * A* once between them.
+ *
+ * Released paths stay in the pool as a cache until their space is
+ * needed; the arena is compacted in place when it fills up, which is
+ * safe because bots refer to paths by handle rather than by pointer.
+ */
+
+#ifndef BOT_PATH_H
+#define BOT_PATH_H
+
+#include "bot.h"
+
+#define BOT_PATH_NONE        0      /* handle meaning "no path"            */
+/* Path records (live + cached): 64, or two per bot in a big-MAX_BOTS build */
+#define BOT_PATH_POOL_SIZE   (MAX_BOTS > 32 ? 2 * MAX_BOTS : 64)
+#define BOT_PATH_ARENA_NODES (BOT_PATH_POOL_SIZE * 128) /* 16-bit node slots */
+
+/* Capability bits that make two searches interchangeable (= NAV_CAP_*) */
+#define BOT_PATH_CAP_WALL    0x01   /* wall-climb edges allowed            */
+#define BOT_PATH_CAP_FLY     0x02   /* fly edges allowed                   */
+
+/*
+ * Drop every path (map change).  Handles issued before the clear are
+ * invalid afterwards: lookups on them fail and releasing them is a no-op.
+ */
+void BotPath_Clear(void);
+
+/*
+ * Look for a live path to goal that passes through start.  On success a
+ * reference is taken, *cursor is set to start's position in the path,
+ * and the handle is returned; otherwise BOT_PATH_NONE.
+ */
+int  BotPath_Find(int start, int goal, unsigned int caps, int *cursor);
+
+/*
+ * Store a freshly computed path (node IDs, start first) and return a
+ * handle holding one reference, or BOT_PATH_NONE if the pool is full.
+ */
+int  BotPath_Store(const int *nodes, int length, unsigned int caps);
+
+/* Reference counting; BOT_PATH_NONE is ignored. */
+void BotPath_Retain(int handle);
+void BotPath_Release(int handle);
+
+/* Accessors; out-of-range requests return 0 / BOT_INVALID_NODE. */
+int  BotPath_Length(int handle);
+int  BotPath_Node(int handle, int index);
+
+/* Number of live (referenced) paths and arena slots in use. */
+void BotPath_Stats(int *live_paths, int *cached_paths, int *arena_used);
+
+#endif /* BOT_PATH_H */
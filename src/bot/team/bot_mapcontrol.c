@@ -27,15 +27,15 @@
 
 #include "bot_team.h"
 #include "bot_strategy.h"
-#include "../nav/bot_nodes.h"
+#include "../nav/bot_nav.h"
+#include "../nav/bot_navcache.h"
+#include "../bot_mapprofile.h"
 
 /* -----------------------------------------------------------------------
    Constants
    ----------------------------------------------------------------------- */
-#define MAPCTRL_MAX_ZONES      32     /* maximum tracked map sectors        */
-#define MAPCTRL_ZONE_RADIUS    512.0f /* radius of a single zone            */
-#define MAPCTRL_UPDATE_INTERVAL 5.0f  /* seconds between zone updates       */
-#define MAPCTRL_CONTROL_BOTS   2      /* bots needed to claim zone control  */
+#define MAPCTRL_MAX_ZONES      NAV_ZONE_MAX    /* maximum tracked map sectors */
+#define MAPCTRL_ZONE_RADIUS    NAV_ZONE_RADIUS /* radius of a single zone     */
 
 /* -----------------------------------------------------------------------
    Zone state enum
@@ -52,6 +52,7 @@ typedef enum {
    ----------------------------------------------------------------------- */
 typedef struct {
     vec3_t         center;       /* centre point of the zone               */
+    int            node;         /* nav node nearest the centre            */
     zone_control_t control;      /* current control state                  */
     int            human_count;  /* humans present in zone                 */
     int            alien_count;  /* aliens present in zone                 */
@@ -67,51 +68,38 @@ static map_zone_t  s_zones[MAPCTRL_MAX_ZONES];
 static int         s_zone_count  = 0;
 static float       s_next_update = 0.0f;
 
+/* Zone centres again as separate x/y/z arrays, for VectorBatch_Nearest */
+static float       s_zone_x[MAPCTRL_MAX_ZONES];
+static float       s_zone_y[MAPCTRL_MAX_ZONES];
+static float       s_zone_z[MAPCTRL_MAX_ZONES];
+
 /* -----------------------------------------------------------------------
    BotMapControl_Init
-   Seed initial zones from nav node positions (cluster around NAV_CAMP
-   and NAV_AMBUSH nodes as zone centres).
+   Seed zones from the nav graph's derived zone centres (clustered around
+   NAV_CAMP / NAV_AMBUSH / teleporter / egg nodes; see bot_navcache.c).
    ----------------------------------------------------------------------- */
 void BotMapControl_Init(void)
 {
+    const nav_derived_t *d = BotNavCache_Get();
     int i;
+
     s_zone_count  = 0;
     s_next_update = 0.0f;
 
     memset(s_zones, 0, sizeof(s_zones));
 
-    for (i = 0; i < nav_node_count && s_zone_count < MAPCTRL_MAX_ZONES; i++) {
-        int j;
-        qboolean too_close = false;
-
-        if (nav_nodes[i].id == BOT_INVALID_NODE) continue;
-
-        /* Only seed zones from key nodes */
-        if (!(nav_nodes[i].flags & (NAV_CAMP | NAV_AMBUSH |
-                                    NAV_TELEPORTER | NAV_EGG))) continue;
-
-        /* Don't create zones too close to existing ones */
-        for (j = 0; j < s_zone_count; j++) {
-            vec3_t delta;
-            float  dist;
-
-            delta[0] = s_zones[j].center[0] - nav_nodes[i].origin[0];
-            delta[1] = s_zones[j].center[1] - nav_nodes[i].origin[1];
-            delta[2] = s_zones[j].center[2] - nav_nodes[i].origin[2];
-            dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
-                                        delta[2]*delta[2]));
-
-            if (dist < MAPCTRL_ZONE_RADIUS) { too_close = true; break; }
-        }
-
-        if (!too_close) {
-            s_zones[s_zone_count].center[0] = nav_nodes[i].origin[0];
-            s_zones[s_zone_count].center[1] = nav_nodes[i].origin[1];
-            s_zones[s_zone_count].center[2] = nav_nodes[i].origin[2];
-            s_zones[s_zone_count].control   = ZONE_NEUTRAL;
-            s_zones[s_zone_count].in_use    = true;
-            s_zone_count++;
-        }
+    for (i = 0; i < d->zone_count && s_zone_count < MAPCTRL_MAX_ZONES; i++) {
+        s_zones[s_zone_count].center[0] = d->zone_centers[i][0];
+        s_zones[s_zone_count].center[1] = d->zone_centers[i][1];
+        s_zones[s_zone_count].center[2] = d->zone_centers[i][2];
+        s_zones[s_zone_count].node      =
+            Node_FindNearest(s_zones[s_zone_count].center, 0, 0.0f);
+        s_zones[s_zone_count].control   = ZONE_NEUTRAL;
+        s_zones[s_zone_count].in_use    = true;
+        s_zone_x[s_zone_count]          = d->zone_centers[i][0];
+        s_zone_y[s_zone_count]          = d->zone_centers[i][1];
+        s_zone_z[s_zone_count]          = d->zone_centers[i][2];
+        s_zone_count++;
     }
 }
 
@@ -122,28 +110,11 @@ void BotMapControl_Init(void)
    ----------------------------------------------------------------------- */
 static int GetZoneForPos(vec3_t pos)
 {
-    int   i;
-    int   best    = -1;
-    float best_d  = MAPCTRL_ZONE_RADIUS;
-
-    for (i = 0; i < s_zone_count; i++) {
-        vec3_t delta;
-        float  dist;
-
-        if (!s_zones[i].in_use) continue;
-
-        delta[0] = s_zones[i].center[0] - pos[0];
-        delta[1] = s_zones[i].center[1] - pos[1];
-        delta[2] = s_zones[i].center[2] - pos[2];
-        dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
-                                    delta[2]*delta[2]));
-
-        if (dist < best_d) {
-            best_d = dist;
-            best   = i;
-        }
-    }
-    return best;
+    /* Zones are only ever added, so 0 .. s_zone_count-1 are all in use */
+    return VectorBatch_Nearest(pos, s_zone_x, s_zone_y, s_zone_z,
+                               s_zone_count,
+                               MAPCTRL_ZONE_RADIUS * MAPCTRL_ZONE_RADIUS,
+                               NULL);
 }
 
 /* -----------------------------------------------------------------------
@@ -185,9 +156,9 @@ static void UpdateZones(void)
 
         if (h == 0 && a == 0)
             s_zones[i].control = ZONE_NEUTRAL;
-        else if (h >= MAPCTRL_CONTROL_BOTS && a == 0)
+        else if (h >= bot_map_profile.mapctrl_control_bots && a == 0)
             s_zones[i].control = ZONE_HUMAN;
-        else if (a >= MAPCTRL_CONTROL_BOTS && h == 0)
+        else if (a >= bot_map_profile.mapctrl_control_bots && h == 0)
             s_zones[i].control = ZONE_ALIEN;
         else if (h > 0 && a > 0)
             s_zones[i].control = ZONE_CONTESTED;
@@ -203,7 +174,7 @@ static void UpdateZones(void)
 void BotMapControl_Frame(void)
 {
     if (level.time < s_next_update) return;
-    s_next_update = level.time + MAPCTRL_UPDATE_INTERVAL;
+    s_next_update = level.time + bot_map_profile.mapctrl_update_interval;
     UpdateZones();
 }
 
@@ -220,7 +191,8 @@ qboolean BotMapControl_IsZoneContested(vec3_t pos)
 
 /* -----------------------------------------------------------------------
    BotMapControl_GetEnemyControlledZone
-   Return the centre of the nearest enemy-controlled zone.
+   Return the centre of the nearest enemy-controlled zone, by ground
+   travel distance along the nav graph.
    team = the calling bot's team (1=HUMAN, 2=ALIEN).
    Returns true on success, fills *out_pos.
    ----------------------------------------------------------------------- */
@@ -230,6 +202,7 @@ qboolean BotMapControl_GetEnemyControlledZone(int team, vec3_t from,
     int   i;
     int   best   = -1;
     float best_d = 9999999.0f;
+    int   from_node = Node_FindNearest(from, 0, 0.0f);
     zone_control_t enemy_control = (team == TEAM_HUMAN) ? ZONE_ALIEN : ZONE_HUMAN;
 
     for (i = 0; i < s_zone_count; i++) {
@@ -239,11 +212,16 @@ qboolean BotMapControl_GetEnemyControlledZone(int team, vec3_t from,
         if (!s_zones[i].in_use) continue;
         if (s_zones[i].control != enemy_control) continue;
 
-        delta[0] = s_zones[i].center[0] - from[0];
-        delta[1] = s_zones[i].center[1] - from[1];
-        delta[2] = s_zones[i].center[2] - from[2];
-        dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
-                                    delta[2]*delta[2]));
+        if (from_node != BOT_INVALID_NODE &&
+            s_zones[i].node != BOT_INVALID_NODE) {
+            dist = BotNav_Distance(from_node, s_zones[i].node, 0);
+        } else {
+            delta[0] = s_zones[i].center[0] - from[0];
+            delta[1] = s_zones[i].center[1] - from[1];
+            delta[2] = s_zones[i].center[2] - from[2];
+            dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
+                                        delta[2]*delta[2]));
+        }
 
         if (dist < best_d) {
             best_d = dist;
@@ -1,19 +1,13 @@
 /*
  * bot_strategy.c -- team strategy system implementation for q2gloombot
  *
- * Evaluates game state every BOT_STRATEGY_INTERVAL seconds and selects
- * the appropriate team strategy.  Assigns roles to individual bots.
+ * Evaluates game state every strategy_interval seconds (see
+ * bot_mapprofile.h) and selects the appropriate team strategy.  Assigns roles to individual bots.
  */
 
 #include "bot_strategy.h"
 #include "bot_team.h"
-
-/* -----------------------------------------------------------------------
-   Constants
-   ----------------------------------------------------------------------- */
-#define BOT_STRATEGY_INTERVAL   3.0f   /* reassess strategy every 3 seconds */
-#define PHASE_EARLY_TIME        120.0f /* first 2 minutes = early phase     */
-#define PHASE_DESPERATE_SPAWNS  1      /* <= this many spawns = desperate   */
+#include "../bot_mapprofile.h"
 
 /* -----------------------------------------------------------------------
    Module state
@@ -100,9 +94,9 @@ static team_snapshot_t BuildTeamSnapshot(int team)
                               snap.avg_hp_pct * 100.0f);
 
     /* Game phase */
-    if (level.time < PHASE_EARLY_TIME) {
+    if (level.time < bot_map_profile.phase_early_time) {
         snap.phase = PHASE_EARLY;
-    } else if (snap.spawn_count <= PHASE_DESPERATE_SPAWNS) {
+    } else if (snap.spawn_count <= bot_map_profile.phase_desperate_spawns) {
         snap.phase = PHASE_DESPERATE;
     } else if (snap.avg_class_tier >= 2 && snap.spawn_count >= 2) {
         snap.phase = PHASE_MID;
@@ -214,7 +208,7 @@ void BotStrategy_Frame(void)
     team_snapshot_t human_snap, alien_snap;
 
     if (level.time < s_next_assess) return;
-    s_next_assess = level.time + BOT_STRATEGY_INTERVAL;
+    s_next_assess = level.time + bot_map_profile.strategy_interval;
 
     human_snap = BuildTeamSnapshot(TEAM_HUMAN);
     alien_snap = BuildTeamSnapshot(TEAM_ALIEN);
@@ -254,3 +248,35 @@ bot_game_phase_t BotStrategy_GetPhase(int team)
     if (team < 1 || team > 2) return PHASE_EARLY;
     return s_phase[team];
 }
+
+/* -----------------------------------------------------------------------
+   BotStrategy_Save / BotStrategy_Restore
+   ----------------------------------------------------------------------- */
+void BotStrategy_Save(bot_strategy_snapshot_t *out)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        out->strategy[i] = (unsigned char)s_strategy[i];
+        out->phase[i]    = (unsigned char)s_phase[i];
+    }
+    for (i = 0; i < MAX_BOTS; i++)
+        out->roles[i] = (unsigned char)s_roles[i];
+}
+
+void BotStrategy_Restore(const bot_strategy_snapshot_t *in)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (in->strategy[i] < STRATEGY_MAX)
+            s_strategy[i] = (bot_strategy_t)in->strategy[i];
+        if (in->phase[i] <= PHASE_DESPERATE)
+            s_phase[i] = (bot_game_phase_t)in->phase[i];
+    }
+    for (i = 0; i < MAX_BOTS; i++) {
+        if (in->roles[i] < ROLE_MAX)
+            s_roles[i] = (bot_role_t)in->roles[i];
+    }
+    s_next_assess = 0.0f;
+}
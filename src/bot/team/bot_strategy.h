@@ -97,4 +97,18 @@ void BotStrategy_SetStrategy(int team, bot_strategy_t strat);
 /* Get the current game phase for a team. */
 bot_game_phase_t BotStrategy_GetPhase(int team);
 
+/*
+ * Persistent strategy state, carried across level restarts by the bot
+ * snapshot (bot_snapshot.c).  Restoring forces a re-assessment on the
+ * next frame.
+ */
+typedef struct {
+    unsigned char strategy[3];  /* bot_strategy_t per team   */
+    unsigned char phase[3];     /* bot_game_phase_t per team */
+    unsigned char roles[MAX_BOTS];
+} bot_strategy_snapshot_t;
+
+void BotStrategy_Save(bot_strategy_snapshot_t *out);
+void BotStrategy_Restore(const bot_strategy_snapshot_t *in);
+
 #endif /* BOT_STRATEGY_H */
@@ -11,6 +11,7 @@
  */
 
 #include "bot_team.h"
+#include "../bot_log.h"
 
 void BotTeam_Init(void)
 {
@@ -146,6 +147,6 @@ void BotTeam_AssignRoles(int team)
     g_bots[lowest_skill_idx].gloom_class =
         (team == TEAM_HUMAN) ? GLOOM_CLASS_BUILDER : GLOOM_CLASS_GRANGER;
 
-    gi.dprintf("BotTeam_AssignRoles: '%s' reassigned to builder role\n",
-               g_bots[lowest_skill_idx].name);
+    BotLog_Info("BotTeam_AssignRoles: '%s' reassigned to builder role\n",
+                g_bots[lowest_skill_idx].name);
 }
@@ -15,4 +15,7 @@ qboolean BotTeam_ReactorAlive(void);
 qboolean BotTeam_OvmindAlive(void);
 int      BotTeam_CountSpawnPoints(int team);
 
+/* Zone control (bot_mapcontrol.c); re-seed whenever a nav graph goes live */
+void     BotMapControl_Init(void);
+
 #endif /* BOT_TEAM_H */
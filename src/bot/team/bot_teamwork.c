@@ -23,15 +23,47 @@
 
 #include "bot_team.h"
 #include "bot_strategy.h"
+#include "../nav/bot_nav.h"
+#include "../bot_mapprofile.h"
 
-/* -----------------------------------------------------------------------
-   Constants
-   ----------------------------------------------------------------------- */
-#define TEAMWORK_SHARE_ENEMY_RANGE   800.0f  /* broadcast enemy pos to allies */
-#define TEAMWORK_HELP_REQUEST_RANGE  600.0f  /* send help request within this */
-#define TEAMWORK_RALLY_RADIUS        300.0f  /* rally point clustering radius  */
-#define TEAMWORK_RUSH_TRIGGER        3       /* aliens to trigger group rush   */
-#define TEAMWORK_ALIEN_CLUSTER_RANGE 400.0f  /* range for rush detection       */
+/* Ranges and the rush size come from bot_map_profile (bot_mapprofile.h) */
+
+/*
+ * Live bots of one team with their origins split into x/y/z arrays, so
+ * the range checks below measure every teammate in one
+ * VectorBatch_DistSq call.  Bots keep g_bots[] order.
+ */
+typedef struct {
+    bot_state_t *bot[MAX_BOTS];
+    float        x[MAX_BOTS];
+    float        y[MAX_BOTS];
+    float        z[MAX_BOTS];
+    float        dist_sq[MAX_BOTS];
+    int          count;
+} team_set_t;
+
+static team_set_t s_team_set;
+
+static team_set_t *Teamwork_Gather(int team)
+{
+    team_set_t *set = &s_team_set;
+    int         i;
+
+    set->count = 0;
+    for (i = 0; i < MAX_BOTS; i++) {
+        bot_state_t *bs = &g_bots[i];
+
+        if (!bs->in_use || bs->team != team) continue;
+        if (!bs->ent || !bs->ent->inuse) continue;
+
+        set->bot[set->count] = bs;
+        set->x[set->count]   = bs->ent->s.origin[0];
+        set->y[set->count]   = bs->ent->s.origin[1];
+        set->z[set->count]   = bs->ent->s.origin[2];
+        set->count++;
+    }
+    return set;
+}
 
 /* -----------------------------------------------------------------------
    BotTeamwork_ShareEnemyPos
@@ -41,25 +73,19 @@
 void BotTeamwork_ShareEnemyPos(bot_state_t *reporter, edict_t *enemy,
                                 vec3_t enemy_pos)
 {
-    int i;
-    vec3_t delta;
-    float  dist;
+    team_set_t *set;
+    int         i;
 
     if (!reporter || !enemy) return;
 
-    for (i = 0; i < MAX_BOTS; i++) {
-        bot_state_t *ally = &g_bots[i];
-        if (!ally->in_use || ally == reporter) continue;
-        if (ally->team != reporter->team) continue;
-        if (!ally->ent || !ally->ent->inuse) continue;
-
-        delta[0] = ally->ent->s.origin[0] - reporter->ent->s.origin[0];
-        delta[1] = ally->ent->s.origin[1] - reporter->ent->s.origin[1];
-        delta[2] = ally->ent->s.origin[2] - reporter->ent->s.origin[2];
-        dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
-                                    delta[2]*delta[2]));
+    set = Teamwork_Gather(reporter->team);
+    VectorBatch_DistSq(reporter->ent->s.origin, set->x, set->y, set->z,
+                       set->count, set->dist_sq);
 
-        if (dist > TEAMWORK_SHARE_ENEMY_RANGE) continue;
+    for (i = 0; i < set->count; i++) {
+        bot_state_t *ally = set->bot[i];
+        if (ally == reporter) continue;
+        if (set->dist_sq[i] > bot_map_profile.share_enemy_range_sq) continue;
 
         /* Insert into ally's enemy memory if not already there */
         if (ally->enemy_memory_count < BOT_MAX_REMEMBERED_ENEMIES) {
@@ -94,26 +120,20 @@ void BotTeamwork_ShareEnemyPos(bot_state_t *reporter, edict_t *enemy,
    ----------------------------------------------------------------------- */
 void BotTeamwork_RequestHelp(bot_state_t *caller)
 {
-    int    i;
-    vec3_t delta;
-    float  dist;
+    team_set_t *set;
+    int         i;
 
     if (!caller || !caller->ent) return;
 
-    for (i = 0; i < MAX_BOTS; i++) {
-        bot_state_t *ally = &g_bots[i];
-        if (!ally->in_use || ally == caller) continue;
-        if (ally->team != caller->team) continue;
-        if (!ally->ent || !ally->ent->inuse) continue;
-        if (ally->ai_state == BOTSTATE_COMBAT) continue; /* already fighting */
-
-        delta[0] = ally->ent->s.origin[0] - caller->ent->s.origin[0];
-        delta[1] = ally->ent->s.origin[1] - caller->ent->s.origin[1];
-        delta[2] = ally->ent->s.origin[2] - caller->ent->s.origin[2];
-        dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
-                                    delta[2]*delta[2]));
+    set = Teamwork_Gather(caller->team);
+    VectorBatch_DistSq(caller->ent->s.origin, set->x, set->y, set->z,
+                       set->count, set->dist_sq);
 
-        if (dist > TEAMWORK_HELP_REQUEST_RANGE) continue;
+    for (i = 0; i < set->count; i++) {
+        bot_state_t *ally = set->bot[i];
+        if (ally == caller) continue;
+        if (ally->ai_state == BOTSTATE_COMBAT) continue; /* already fighting */
+        if (set->dist_sq[i] > bot_map_profile.help_request_range_sq) continue;
 
         /* Guide ally toward caller's position */
         ally->nav.goal_origin[0] = caller->ent->s.origin[0];
@@ -130,50 +150,29 @@ void BotTeamwork_RequestHelp(bot_state_t *caller)
    ----------------------------------------------------------------------- */
 void BotTeamwork_CheckAlienRush(void)
 {
+    team_set_t *set = Teamwork_Gather(TEAM_ALIEN);
     int i, j;
 
-    for (i = 0; i < MAX_BOTS; i++) {
-        bot_state_t *bs = &g_bots[i];
-        if (!bs->in_use || bs->team != TEAM_ALIEN) continue;
-        if (!bs->ent || !bs->ent->inuse) continue;
+    for (i = 0; i < set->count; i++) {
+        bot_state_t *bs = set->bot[i];
         if (!bs->combat.target_visible) continue;
 
         /* Count how many aliens are near this bot */
+        VectorBatch_DistSq(bs->ent->s.origin, set->x, set->y, set->z,
+                           set->count, set->dist_sq);
         int cluster = 1;
-        for (j = 0; j < MAX_BOTS; j++) {
-            bot_state_t *other = &g_bots[j];
-            vec3_t delta;
-            float dist;
-
+        for (j = 0; j < set->count; j++) {
             if (j == i) continue;
-            if (!other->in_use || other->team != TEAM_ALIEN) continue;
-            if (!other->ent || !other->ent->inuse) continue;
-
-            delta[0] = other->ent->s.origin[0] - bs->ent->s.origin[0];
-            delta[1] = other->ent->s.origin[1] - bs->ent->s.origin[1];
-            delta[2] = other->ent->s.origin[2] - bs->ent->s.origin[2];
-            dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
-                                        delta[2]*delta[2]));
-            if (dist < TEAMWORK_ALIEN_CLUSTER_RANGE) cluster++;
+            if (set->dist_sq[j] < bot_map_profile.alien_cluster_range_sq)
+                cluster++;
         }
 
         /* Rush trigger: enough aliens clustered */
-        if (cluster >= TEAMWORK_RUSH_TRIGGER) {
-            for (j = 0; j < MAX_BOTS; j++) {
-                bot_state_t *other = &g_bots[j];
-                vec3_t delta;
-                float dist;
-
-                if (!other->in_use || other->team != TEAM_ALIEN) continue;
-                if (!other->ent || !other->ent->inuse) continue;
-
-                delta[0] = other->ent->s.origin[0] - bs->ent->s.origin[0];
-                delta[1] = other->ent->s.origin[1] - bs->ent->s.origin[1];
-                delta[2] = other->ent->s.origin[2] - bs->ent->s.origin[2];
-                dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
-                                            delta[2]*delta[2]));
-
-                if (dist < TEAMWORK_ALIEN_CLUSTER_RANGE &&
+        if (cluster >= bot_map_profile.rush_trigger) {
+            for (j = 0; j < set->count; j++) {
+                bot_state_t *other = set->bot[j];
+
+                if (set->dist_sq[j] < bot_map_profile.alien_cluster_range_sq &&
                     other->ai_state != BOTSTATE_COMBAT &&
                     !Gloom_ClassCanBuild(other->gloom_class)) {
                     /* Join the rush */
@@ -225,7 +224,6 @@ void BotTeamwork_EnsureBreederEscort(void)
     /* Find the nearest idle/patrolling alien to assign as escort */
     for (j = 0; j < MAX_BOTS; j++) {
         bot_state_t *cand = &g_bots[j];
-        vec3_t delta;
         float dist;
 
         if (!cand->in_use || cand->team != TEAM_ALIEN) continue;
@@ -234,11 +232,10 @@ void BotTeamwork_EnsureBreederEscort(void)
         if (!cand->ent || !cand->ent->inuse) continue;
         if (cand->ai_state == BOTSTATE_COMBAT) continue;
 
-        delta[0] = cand->ent->s.origin[0] - breeder->ent->s.origin[0];
-        delta[1] = cand->ent->s.origin[1] - breeder->ent->s.origin[1];
-        delta[2] = cand->ent->s.origin[2] - breeder->ent->s.origin[2];
-        dist = (float)sqrt((double)(delta[0]*delta[0] + delta[1]*delta[1] +
-                                    delta[2]*delta[2]));
+        /* Travel distance: a drone one floor up is not close */
+        dist = BotNav_PointDistance(cand->ent->s.origin,
+                                    breeder->ent->s.origin,
+                                    BotNav_Caps(cand));
 
         if (dist < best_dist) {
             best_dist  = dist;
@@ -275,5 +275,7 @@ extern cvar_t *sv_gravity;
 void G_InitEdict(edict_t *e);
 edict_t *G_Spawn(void);
 void G_FreeEdict(edict_t *e);
+edict_t *G_AllocClientSlot(void);
+void G_FreeClientSlot(edict_t *e);
 
 #endif /* G_LOCAL_H */
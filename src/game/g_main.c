@@ -29,6 +29,75 @@ cvar_t *sv_gravity  = NULL;
 /* -----------------------------------------------------------------------
    Edict management helpers
    ----------------------------------------------------------------------- */
+
+/*
+ * Free edict queue.  Edicts beyond the client slots are queued FIFO as
+ * they are freed, so G_Spawn never scans the edict array.  The oldest
+ * free edict is only reused once it has been free long enough that
+ * clients will not interpolate the new entity from the old one's
+ * position (the stock game's rule: freed during the first two seconds
+ * of the level, or more than EDICT_REUSE_DELAY seconds ago).
+ */
+#define EDICT_REUSE_DELAY 0.5f
+
+static int *s_free_edicts = NULL;   /* globals.max_edicts entries, G_Init */
+static int  s_free_size  = 0;
+static int  s_free_head  = 0;
+static int  s_free_count = 0;
+
+/*
+ * Client slot stack for bots.  The engine hands client slots to human
+ * players from the bottom up, so bots are given slots from the top down
+ * (maxclients first) to keep out of its way.  Entries are checked on
+ * pop, so a slot a human took in the meantime is simply skipped.
+ */
+static int      s_client_slots[MAX_CLIENTS];
+static int      s_client_slot_count = 0;
+static qboolean s_client_slot_queued[MAX_CLIENTS + 1];
+
+/*
+ * A human owns its slot from ClientConnect, but the edict is only marked
+ * in use by ClientBegin, after the map and any downloads.  Until then
+ * the slot is reserved (level.time it is held until) so a bot cannot be
+ * put in it.  The engine does not call ClientDisconnect for a client
+ * dropped before ClientBegin, so reservations expire.
+ */
+#define CLIENT_RESERVE_TIME 90.0f
+
+static float    s_client_slot_reserved[MAX_CLIENTS + 1];
+
+static qboolean G_ClientSlotReserved(int index)
+{
+    return level.time < s_client_slot_reserved[index];
+}
+
+static void G_ReserveClientSlot(edict_t *ent, qboolean reserve)
+{
+    int index = (int)(ent - g_edicts);
+
+    if (index < 1 || index > MAX_CLIENTS)
+        return;
+    s_client_slot_reserved[index] = reserve ? level.time + CLIENT_RESERVE_TIME
+                                            : 0.0f;
+}
+
+static void G_ResetEdictLists(void)
+{
+    int i;
+
+    s_free_head  = 0;
+    s_free_count = 0;
+
+    s_client_slot_count = 0;
+    memset(s_client_slot_queued, 0, sizeof(s_client_slot_queued));
+    for (i = 1; i <= (int)maxclients->value && i <= MAX_CLIENTS; i++) {
+        if (!g_edicts[i].inuse) {
+            s_client_slots[s_client_slot_count++] = i;
+            s_client_slot_queued[i] = true;
+        }
+    }
+}
+
 void G_InitEdict(edict_t *e)
 {
     e->inuse     = true;
@@ -39,14 +108,21 @@ void G_InitEdict(edict_t *e)
 
 edict_t *G_Spawn(void)
 {
-    int     i;
     edict_t *e;
 
-    /* Try to reuse an existing free edict beyond the clients */
-    e = &g_edicts[maxclients ? (int)maxclients->value + 1 : 1];
-    for (i = (maxclients ? (int)maxclients->value + 1 : 1);
-         i < globals.num_edicts; i++, e++) {
-        if (!e->inuse) {
+    /* Drop queue entries that were brought back into use elsewhere */
+    while (s_free_count > 0 && g_edicts[s_free_edicts[s_free_head]].inuse) {
+        s_free_head = (s_free_head + 1) % s_free_size;
+        s_free_count--;
+    }
+
+    if (s_free_count > 0) {
+        e = &g_edicts[s_free_edicts[s_free_head]];
+        if (e->freetime < 2.0f ||
+            level.time - e->freetime > EDICT_REUSE_DELAY ||
+            globals.num_edicts == globals.max_edicts) {
+            s_free_head = (s_free_head + 1) % s_free_size;
+            s_free_count--;
             G_InitEdict(e);
             return e;
         }
@@ -63,11 +139,77 @@ edict_t *G_Spawn(void)
 
 void G_FreeEdict(edict_t *e)
 {
+    int index = (int)(e - g_edicts);
+
+    if (index >= 1 && index <= (int)maxclients->value) {
+        G_FreeClientSlot(e);
+        return;
+    }
+
     gi.unlinkentity(e);
     memset(e, 0, globals.edict_size);
     e->classname = "freed";
     e->freetime  = level.time;
     e->inuse     = false;
+
+    if (s_free_count < s_free_size) {
+        s_free_edicts[(s_free_head + s_free_count) % s_free_size] = index;
+        s_free_count++;
+    }
+}
+
+/*
+ * G_AllocClientSlot
+ * Claim a free client slot edict for a bot, highest slot first.  Slots
+ * reserved by a connecting human stay queued and are passed over.
+ * Returns an initialised edict (client pointer left to the caller), or
+ * NULL if every slot is taken.
+ */
+edict_t *G_AllocClientSlot(void)
+{
+    edict_t *e;
+    int      i, index;
+
+    for (i = s_client_slot_count - 1; i >= 0; i--) {
+        index = s_client_slots[i];
+        if (G_ClientSlotReserved(index))
+            continue;
+
+        memmove(&s_client_slots[i], &s_client_slots[i + 1],
+                (size_t)(s_client_slot_count - i - 1) * sizeof(s_client_slots[0]));
+        s_client_slot_count--;
+        s_client_slot_queued[index] = false;
+
+        e = &g_edicts[index];
+        if (e->inuse)
+            continue;   /* taken by a human since it was queued */
+
+        G_InitEdict(e);
+        return e;
+    }
+    return NULL;
+}
+
+/*
+ * G_FreeClientSlot
+ * Release a client slot edict and give it back its own gclient_t.
+ */
+void G_FreeClientSlot(edict_t *e)
+{
+    int index = (int)(e - g_edicts);
+
+    if (index < 1 || index > (int)maxclients->value || index > MAX_CLIENTS)
+        return;
+
+    gi.unlinkentity(e);
+    e->inuse     = false;
+    e->classname = "disconnected";
+    e->client    = &g_clients[index - 1];
+
+    if (!s_client_slot_queued[index]) {
+        s_client_slots[s_client_slot_count++] = index;
+        s_client_slot_queued[index] = true;
+    }
 }
 
 /* -----------------------------------------------------------------------
@@ -95,9 +237,14 @@ static void G_Init(void)
     g_edicts           = globals.edicts;
     memset(g_edicts, 0, globals.max_edicts * globals.edict_size);
 
+    /* maxentities may exceed MAX_EDICTS; the free queue must hold them all */
+    s_free_size   = globals.max_edicts;
+    s_free_edicts = gi.TagMalloc(s_free_size * (int)sizeof(int), TAG_GAME);
+
     /* Allocate client array */
     g_clients = gi.TagMalloc((int)maxclients->value * sizeof(gclient_t), TAG_GAME);
     memset(g_clients, 0, (int)maxclients->value * sizeof(gclient_t));
+    G_ResetEdictLists();
 
     /* Initialise bot subsystem */
     Bot_Init();
@@ -112,6 +259,9 @@ static void G_Shutdown(void)
     Bot_Shutdown();
     gi.FreeTags(TAG_LEVEL);
     gi.FreeTags(TAG_GAME);
+    s_free_edicts = NULL;
+    s_free_size   = 0;
+    s_free_count  = 0;
 }
 
 static void G_SpawnEntities(char *mapname, char *entstring, char *spawnpoint)
@@ -127,42 +277,75 @@ static void G_SpawnEntities(char *mapname, char *entstring, char *spawnpoint)
     /* Free level-scoped memory and re-init client edicts */
     gi.FreeTags(TAG_LEVEL);
 
+    /*
+     * Human clients are put back in the game by ClientBegin; bots keep
+     * their slots across the map change.
+     */
+    memset(s_client_slot_reserved, 0, sizeof(s_client_slot_reserved));
     for (i = 0; i < (int)maxclients->value; i++) {
-        g_edicts[i + 1].client = &g_clients[i];
-        G_InitEdict(&g_edicts[i + 1]);
+        edict_t *ent = &g_edicts[i + 1];
+
+        if (ent->inuse && ent->client && ent->client->is_bot)
+            continue;
+        if (ent->inuse)
+            G_ReserveClientSlot(ent, true);     /* human reloading the map */
+        ent->client   = &g_clients[i];
+        ent->inuse    = false;
+        ent->s.number = i + 1;
     }
     globals.num_edicts = (int)maxclients->value + 1;
+
+    G_ResetEdictLists();
+
+    strncpy(level.mapname, mapname, sizeof(level.mapname) - 1);
+    Bot_MapStart(level.mapname);
 }
 
+/*
+ * The only state this DLL carries across a save or level change is the
+ * bots'; game and level files both hold a bot snapshot.
+ */
 static void G_WriteGame(char *filename, qboolean autosave)
 {
-    (void)filename; (void)autosave;
+    (void)autosave;
+    Bot_WriteSnapshot(filename);
 }
 
 static void G_ReadGame(char *filename)
 {
-    (void)filename;
+    Bot_ReadSnapshot(filename);
 }
 
 static void G_WriteLevel(char *filename)
 {
-    (void)filename;
+    Bot_WriteSnapshot(filename);
 }
 
 static void G_ReadLevel(char *filename)
 {
-    (void)filename;
+    Bot_ReadSnapshot(filename);
 }
 
 static qboolean G_ClientConnect(edict_t *ent, char *userinfo)
 {
-    (void)ent; (void)userinfo;
+    (void)userinfo;
+
+    /*
+     * The engine picks client slots itself.  If it chose one a bot is
+     * sitting in, the bot yields; autofill will re-add it elsewhere.
+     */
+    if (Bot_GetState(ent))
+        Bot_Disconnect(ent);
+    ent->client = &g_clients[ent - g_edicts - 1];
+    G_ReserveClientSlot(ent, true);
     return true;
 }
 
 static void G_ClientBegin(edict_t *ent)
 {
-    (void)ent;
+    ent->client = &g_clients[ent - g_edicts - 1];
+    G_InitEdict(ent);
+    G_ReserveClientSlot(ent, false);
 }
 
 static void G_ClientUserinfoChanged(edict_t *ent, char *userinfo)
@@ -175,6 +358,9 @@ static void G_ClientDisconnect(edict_t *ent)
     bot_state_t *bs = Bot_GetState(ent);
     if (bs)
         Bot_Disconnect(ent);
+    else
+        G_FreeClientSlot(ent);
+    G_ReserveClientSlot(ent, false);
 }
 
 static void G_ClientCommand(edict_t *ent)
@@ -184,7 +370,7 @@ static void G_ClientCommand(edict_t *ent)
 
 static void G_ClientThink(edict_t *ent, usercmd_t *cmd)
 {
-    (void)ent; (void)cmd;
+    Bot_ClientThink(ent, cmd);
 }
 
 /*
@@ -0,0 +1,229 @@
+/*
+ * q_batch.c -- batch geometry kernels over structure-of-arrays points
+ *
+ * Bot code asks the same question of every node or every bot in turn:
+ * which is nearest, which are within range, which are in view.  Done one
+ * vec3_t at a time through VectorLength that is a call and a sqrt per
+ * point.  These kernels take the points as separate x, y and z arrays,
+ * so SSE can load four of each coordinate at once, and answer for the
+ * whole set in one call.  See q_shared.h for the contracts.
+ *
+ * The SSE and scalar paths do the same float operations in the same
+ * order, so they agree exactly; the scalar path handles the tail and
+ * targets without SSE2.  Kept out of q_shared.c so the test harness,
+ * which mocks q_shared, can link it.
+ */
+
+#include "q_shared.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Q_BATCH_SSE
+#include <emmintrin.h>
+#endif
+
+/* =========================================================================
+   Distances
+   ========================================================================= */
+
+void VectorBatch_DistSq(const vec3_t p, const float *x, const float *y,
+                        const float *z, int count, float *out)
+{
+    int i = 0;
+
+#ifdef Q_BATCH_SSE
+    __m128 px = _mm_set1_ps(p[0]);
+    __m128 py = _mm_set1_ps(p[1]);
+    __m128 pz = _mm_set1_ps(p[2]);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), px);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), py);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), pz);
+
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx),
+                                                     _mm_mul_ps(dy, dy)),
+                                          _mm_mul_ps(dz, dz)));
+    }
+#endif
+    for (; i < count; i++) {
+        float dx = x[i] - p[0];
+        float dy = y[i] - p[1];
+        float dz = z[i] - p[2];
+
+        out[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+/* =========================================================================
+   Range and view tests
+   ========================================================================= */
+
+int VectorBatch_InSphere(const vec3_t center, float radius, const float *x,
+                         const float *y, const float *z, int count,
+                         byte *inside)
+{
+    float r2 = radius * radius;
+    int   i = 0, n = 0;
+
+#ifdef Q_BATCH_SSE
+    __m128 cx  = _mm_set1_ps(center[0]);
+    __m128 cy  = _mm_set1_ps(center[1]);
+    __m128 cz  = _mm_set1_ps(center[2]);
+    __m128 lim = _mm_set1_ps(r2);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), cx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), cy);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), cz);
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx),
+                                          _mm_mul_ps(dy, dy)),
+                               _mm_mul_ps(dz, dz));
+        int    m  = _mm_movemask_ps(_mm_cmple_ps(d2, lim));
+
+        inside[i]     = (byte)(m & 1);
+        inside[i + 1] = (byte)((m >> 1) & 1);
+        inside[i + 2] = (byte)((m >> 2) & 1);
+        inside[i + 3] = (byte)((m >> 3) & 1);
+        n += inside[i] + inside[i + 1] + inside[i + 2] + inside[i + 3];
+    }
+#endif
+    for (; i < count; i++) {
+        float dx = x[i] - center[0];
+        float dy = y[i] - center[1];
+        float dz = z[i] - center[2];
+
+        inside[i] = (byte)(dx * dx + dy * dy + dz * dz <= r2);
+        n += inside[i];
+    }
+    return n;
+}
+
+/*
+ * A point is in the cone when it is within range of the apex and its
+ * offset v from the apex satisfies dot(v, dir) >= cos_half * |v|.  The
+ * apex itself counts as inside.
+ */
+int VectorBatch_InCone(const vec3_t apex, const vec3_t dir, float cos_half,
+                       float range, const float *x, const float *y,
+                       const float *z, int count, byte *inside)
+{
+    float r2 = range * range;
+    int   i = 0, n = 0;
+
+#ifdef Q_BATCH_SSE
+    __m128 ax  = _mm_set1_ps(apex[0]);
+    __m128 ay  = _mm_set1_ps(apex[1]);
+    __m128 az  = _mm_set1_ps(apex[2]);
+    __m128 fx  = _mm_set1_ps(dir[0]);
+    __m128 fy  = _mm_set1_ps(dir[1]);
+    __m128 fz  = _mm_set1_ps(dir[2]);
+    __m128 cs  = _mm_set1_ps(cos_half);
+    __m128 lim = _mm_set1_ps(r2);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_sub_ps(_mm_loadu_ps(x + i), ax);
+        __m128 vy = _mm_sub_ps(_mm_loadu_ps(y + i), ay);
+        __m128 vz = _mm_sub_ps(_mm_loadu_ps(z + i), az);
+        __m128 l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx),
+                                          _mm_mul_ps(vy, vy)),
+                               _mm_mul_ps(vz, vz));
+        __m128 d  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, fx),
+                                          _mm_mul_ps(vy, fy)),
+                               _mm_mul_ps(vz, fz));
+        __m128 in = _mm_and_ps(_mm_cmple_ps(l2, lim),
+                               _mm_cmpge_ps(d, _mm_mul_ps(cs, _mm_sqrt_ps(l2))));
+        int    m  = _mm_movemask_ps(in);
+
+        inside[i]     = (byte)(m & 1);
+        inside[i + 1] = (byte)((m >> 1) & 1);
+        inside[i + 2] = (byte)((m >> 2) & 1);
+        inside[i + 3] = (byte)((m >> 3) & 1);
+        n += inside[i] + inside[i + 1] + inside[i + 2] + inside[i + 3];
+    }
+#endif
+    for (; i < count; i++) {
+        float vx = x[i] - apex[0];
+        float vy = y[i] - apex[1];
+        float vz = z[i] - apex[2];
+        float l2 = vx * vx + vy * vy + vz * vz;
+        float d  = vx * dir[0] + vy * dir[1] + vz * dir[2];
+
+        inside[i] = (byte)(l2 <= r2 && d >= cos_half * sqrtf(l2));
+        n += inside[i];
+    }
+    return n;
+}
+
+/* =========================================================================
+   Nearest point
+   ========================================================================= */
+
+int VectorBatch_Nearest(const vec3_t p, const float *x, const float *y,
+                        const float *z, int count, float max_dist_sq,
+                        float *dist_sq)
+{
+    float best_d = max_dist_sq;
+    int   best_i = -1;
+    int   i = 0;
+
+#ifdef Q_BATCH_SSE
+    if (count >= 4) {
+        __m128  px   = _mm_set1_ps(p[0]);
+        __m128  py   = _mm_set1_ps(p[1]);
+        __m128  pz   = _mm_set1_ps(p[2]);
+        __m128  best = _mm_set1_ps(max_dist_sq);
+        __m128i bidx = _mm_set1_epi32(-1);
+        __m128i idx  = _mm_setr_epi32(0, 1, 2, 3);
+        __m128i step = _mm_set1_epi32(4);
+        float   lane_d[4];
+        int     lane_i[4], k;
+
+        /* Each lane keeps the first strict minimum it sees */
+        for (; i + 4 <= count; i += 4) {
+            __m128  dx = _mm_sub_ps(_mm_loadu_ps(x + i), px);
+            __m128  dy = _mm_sub_ps(_mm_loadu_ps(y + i), py);
+            __m128  dz = _mm_sub_ps(_mm_loadu_ps(z + i), pz);
+            __m128  d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx),
+                                               _mm_mul_ps(dy, dy)),
+                                    _mm_mul_ps(dz, dz));
+            __m128  lt = _mm_cmplt_ps(d2, best);
+            __m128i li = _mm_castps_si128(lt);
+
+            best = _mm_or_ps(_mm_and_ps(lt, d2), _mm_andnot_ps(lt, best));
+            bidx = _mm_or_si128(_mm_and_si128(li, idx),
+                                _mm_andnot_si128(li, bidx));
+            idx  = _mm_add_epi32(idx, step);
+        }
+
+        _mm_storeu_ps(lane_d, best);
+        _mm_storeu_si128((__m128i *)lane_i, bidx);
+        for (k = 0; k < 4; k++) {
+            if (lane_i[k] < 0)
+                continue;
+            if (best_i < 0 || lane_d[k] < best_d ||
+                (lane_d[k] == best_d && lane_i[k] < best_i)) {
+                best_d = lane_d[k];
+                best_i = lane_i[k];
+            }
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        float dx = x[i] - p[0];
+        float dy = y[i] - p[1];
+        float dz = z[i] - p[2];
+        float d2 = dx * dx + dy * dy + dz * dz;
+
+        if (d2 < best_d) {
+            best_d = d2;
+            best_i = i;
+        }
+    }
+
+    if (dist_sq && best_i >= 0)
+        *dist_sq = best_d;
+    return best_i;
+}
@@ -156,6 +156,37 @@ int    BoxOnPlaneSide(vec3_t emins, vec3_t emaxs, struct cplane_s *plane);
 float  anglemod(float a);
 float  LerpAngle(float a1, float a2, float frac);
 
+/*
+ * Batch geometry (q_batch.c) over points stored as separate x[], y[] and
+ * z[] arrays of count floats.  SSE does four points per step where the
+ * compiler targets SSE2 (x86_64, or i386 with -msse2); elsewhere, and
+ * for the last count % 4 points, a scalar loop gives the same answers.
+ */
+
+/* out[i] = squared distance from p to point i */
+void   VectorBatch_DistSq(const vec3_t p, const float *x, const float *y,
+                          const float *z, int count, float *out);
+
+/* inside[i] = 1 if point i is within radius of center, else 0; returns
+ * the number inside */
+int    VectorBatch_InSphere(const vec3_t center, float radius,
+                            const float *x, const float *y, const float *z,
+                            int count, byte *inside);
+
+/* As InSphere, for the cone from apex along unit dir out to range whose
+ * half-angle has cosine cos_half (cos(fov / 2)) */
+int    VectorBatch_InCone(const vec3_t apex, const vec3_t dir,
+                          float cos_half, float range, const float *x,
+                          const float *y, const float *z, int count,
+                          byte *inside);
+
+/* Index of the nearest point strictly closer than sqrt(max_dist_sq)
+ * (lowest index on ties), or -1; its squared distance goes to *dist_sq
+ * if that is not NULL */
+int    VectorBatch_Nearest(const vec3_t p, const float *x, const float *y,
+                           const float *z, int count, float max_dist_sq,
+                           float *dist_sq);
+
 void ProjectPointOnPlane(vec3_t dst, const vec3_t p, const vec3_t normal);
 void PerpendicularVector(vec3_t dst, const vec3_t src);
 void RotatePointAroundVector(vec3_t dst, const vec3_t dir, const vec3_t point, float degrees);
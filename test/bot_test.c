@@ -10,11 +10,20 @@
  * Run:    ./bot_test
  */
 
+#include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 #include <math.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 /* -----------------------------------------------------------------------
    Minimal test framework
@@ -52,6 +61,9 @@ static int tests_failed = 0;
 /* Forward declare what we need from bot headers */
 #include "g_local.h"
 
+/* Mod directory ("game" cvar) under the working directory */
+#define TEST_GAMEDIR "test_gamedir"
+
 /* Global mocks */
 static char mock_print_buf[4096];
 static int  mock_print_len = 0;
@@ -118,12 +130,16 @@ static char *mock_argv(int n)
 
 static cvar_t mock_maxclients_cvar  = { "maxclients",  "8",    NULL, 0, false, 8.0f,  NULL };
 static cvar_t mock_maxentities_cvar = { "maxentities", "1024", NULL, 0, false, 1024.0f, NULL };
+static cvar_t mock_basedir_cvar     = { "basedir",     ".",    NULL, 0, false, 0.0f,  NULL };
+static cvar_t mock_game_cvar        = { "game",        TEST_GAMEDIR, NULL, 0, false, 0.0f, NULL };
 
 static cvar_t *mock_cvar(char *var_name, char *value, int flags)
 {
     (void)flags; (void)value;
     if (strcmp(var_name, "maxclients") == 0) return &mock_maxclients_cvar;
     if (strcmp(var_name, "maxentities") == 0) return &mock_maxentities_cvar;
+    if (strcmp(var_name, "basedir") == 0) return &mock_basedir_cvar;
+    if (strcmp(var_name, "game") == 0) return &mock_game_cvar;
     return &mock_maxclients_cvar;
 }
 
@@ -212,6 +228,16 @@ void G_FreeEdict(edict_t *e)
     (void)e;
 }
 
+edict_t *G_AllocClientSlot(void)
+{
+    return NULL;
+}
+
+void G_FreeClientSlot(edict_t *e)
+{
+    (void)e;
+}
+
 /* -----------------------------------------------------------------------
    Shared math stubs needed by bot code
    ----------------------------------------------------------------------- */
@@ -347,6 +373,9 @@ static void test_setup(void)
 #include "bot_personality.h"
 #include "bot_humanize.h"
 #include "bot_chat.h"
+#include "bot_snapshot.h"
+#include "bot_config.h"
+#include "bot_nav.h"
 
 /* =======================================================================
    TEST CASES
@@ -374,10 +403,10 @@ TEST(test_bot_connect_disconnect)
     test_setup();
     Bot_Init();
 
-    /* Create a fake edict with a heap-allocated client
-     * (Bot_Disconnect calls gi.TagFree on the client) */
+    /* Create a fake edict with a client from the bot client pool
+     * (Bot_Disconnect returns it to the pool) */
     edict_t ent;
-    gclient_t *client = (gclient_t *)calloc(1, sizeof(gclient_t));
+    gclient_t *client = Bot_AllocClient();
     memset(&ent, 0, sizeof(ent));
     ent.inuse = true;
     ent.client = client;
@@ -396,7 +425,7 @@ TEST(test_bot_connect_disconnect)
     ASSERT_EQ(bs->nav.goal_node, BOT_INVALID_NODE);
     ASSERT_FALSE(bs->nav.path_valid);
 
-    /* Disconnect (frees the client via gi.TagFree) */
+    /* Disconnect (returns the client to the pool) */
     Bot_Disconnect(&ent);
     ASSERT_EQ(num_bots, 0);
     ASSERT_FALSE(bs->in_use);
@@ -404,6 +433,116 @@ TEST(test_bot_connect_disconnect)
     Bot_Shutdown();
 }
 
+/* ----------------------------------------------------------------------- */
+TEST(test_bot_snapshot_file_roundtrip)
+{
+    const char *path = "bot_test.snap";
+    edict_t ent;
+    bot_state_t *bs;
+
+    test_setup();
+    Bot_Init();
+
+    memset(&ent, 0, sizeof(ent));
+    ent.inuse  = true;
+    ent.client = Bot_AllocClient();
+    bs = Bot_Connect(&ent, TEAM_ALIEN, 0.7f);
+    ASSERT_NOT_NULL(bs);
+    Com_sprintf(bs->name, sizeof(bs->name), "Snapper");
+    bs->credits = 7;
+    bs->evos    = 11;
+    bs->personality.aggression = 0.25f;
+    BotStrategy_SetStrategy(TEAM_ALIEN, STRATEGY_HARASS);
+    ASSERT_TRUE(Bot_WriteSnapshot(path));
+
+    /* Scribble over everything the snapshot should bring back */
+    Com_sprintf(bs->name, sizeof(bs->name), "Other");
+    bs->credits = 0;
+    bs->evos    = 0;
+    bs->personality.aggression = 0.9f;
+    bs->ai_state        = BOTSTATE_COMBAT;
+    bs->next_think_time = 999.0f;
+    BotStrategy_SetStrategy(TEAM_ALIEN, STRATEGY_DEFEND);
+
+    ASSERT_TRUE(Bot_ReadSnapshot(path));
+    ASSERT_EQ(num_bots, 1);
+    ASSERT_TRUE(strcmp(bs->name, "Snapper") == 0);
+    ASSERT_EQ(bs->team, TEAM_ALIEN);
+    ASSERT_EQ(bs->credits, 7);
+    ASSERT_EQ(bs->evos, 11);
+    ASSERT_TRUE(bs->personality.aggression > 0.24f &&
+                bs->personality.aggression < 0.26f);
+    ASSERT_EQ(BotStrategy_GetStrategy(TEAM_ALIEN), STRATEGY_HARASS);
+
+    /* Level-scoped state starts fresh */
+    ASSERT_EQ(bs->ai_state, BOTSTATE_IDLE);
+    ASSERT_TRUE(bs->next_think_time == 0.0f);
+    ASSERT_TRUE(bs->ent == &ent);
+
+    Bot_Disconnect(&ent);
+    Bot_Shutdown();
+    remove(path);
+}
+
+/* ----------------------------------------------------------------------- */
+TEST(test_bot_snapshot_rejects_bad_header)
+{
+    const char *path = "bot_test.snap";
+    int   header[4];
+    FILE *f;
+
+    test_setup();
+    Bot_Init();
+    ASSERT_TRUE(Bot_WriteSnapshot(path));
+
+    f = fopen(path, "r+b");
+    ASSERT_TRUE(f != NULL);
+    if (f) {
+        ASSERT_EQ((int)fread(header, sizeof(header), 1, f), 1);
+        header[1] = BOT_SNAPSHOT_VERSION + 1;
+        fseek(f, 0, SEEK_SET);
+        fwrite(header, sizeof(header), 1, f);
+        fclose(f);
+    }
+    ASSERT_FALSE(Bot_ReadSnapshot(path));
+    ASSERT_FALSE(Bot_ReadSnapshot("bot_test_missing.snap"));
+
+    Bot_Shutdown();
+    remove(path);
+}
+
+/* ----------------------------------------------------------------------- */
+TEST(test_bot_mapstart_keeps_bots)
+{
+    edict_t ent;
+    bot_state_t *bs;
+
+    test_setup();
+    Bot_Init();
+
+    memset(&ent, 0, sizeof(ent));
+    ent.inuse  = true;
+    ent.client = Bot_AllocClient();
+    bs = Bot_Connect(&ent, TEAM_HUMAN, 0.5f);
+    ASSERT_NOT_NULL(bs);
+    bs->credits         = 5;
+    bs->ai_state        = BOTSTATE_HUNT;
+    bs->next_think_time = 1234.0f;   /* keyed to the old level.time */
+
+    level.time = 0.0f;
+    Bot_MapStart("bot_test_no_such_map");
+    BotNav_WaitLoad();
+
+    ASSERT_EQ(num_bots, 1);
+    ASSERT_TRUE(bs->in_use);
+    ASSERT_EQ(bs->credits, 5);
+    ASSERT_EQ(bs->ai_state, BOTSTATE_IDLE);
+    ASSERT_TRUE(bs->next_think_time == 0.0f);
+
+    Bot_Disconnect(&ent);
+    Bot_Shutdown();
+}
+
 /* ----------------------------------------------------------------------- */
 TEST(test_bot_connect_alien)
 {
@@ -512,6 +651,41 @@ TEST(test_bot_skill_clamping)
     Bot_Shutdown();
 }
 
+/* ----------------------------------------------------------------------- */
+TEST(test_bot_client_pool)
+{
+    gclient_t *clients[MAX_BOTS];
+    gclient_t *cl;
+    int i, distinct = 1;
+
+    test_setup();
+    Bot_Init();
+
+    for (i = 0; i < MAX_BOTS; i++) {
+        clients[i] = Bot_AllocClient();
+        ASSERT_NOT_NULL(clients[i]);
+        if (i > 0 && clients[i] == clients[i - 1])
+            distinct = 0;
+    }
+    ASSERT_TRUE(distinct);
+    ASSERT_NULL(Bot_AllocClient());
+
+    /* A returned client comes back zeroed */
+    clients[3]->is_bot = true;
+    clients[3]->team   = TEAM_ALIEN;
+    Bot_FreeClient(clients[3]);
+    cl = Bot_AllocClient();
+    ASSERT_TRUE(cl == clients[3]);
+    ASSERT_FALSE(cl->is_bot);
+    ASSERT_EQ(cl->team, 0);
+
+    /* Foreign clients are ignored */
+    Bot_FreeClient(&test_clients[0]);
+    ASSERT_NULL(Bot_AllocClient());
+
+    Bot_Shutdown();
+}
+
 /* ----------------------------------------------------------------------- */
 TEST(test_bot_think_null_safety)
 {
@@ -1319,6 +1493,146 @@ TEST(test_config_name_cycling)
     ASSERT_STR_EQ(name, first_name);
 }
 
+/* Path of a file in TEST_GAMEDIR, creating the directory (and maps/) */
+static const char *test_game_file(const char *relative)
+{
+    static char path[4][MAX_OSPATH];
+    static int  next;
+    char       *out = path[next++ & 3];
+
+#ifdef _WIN32
+    _mkdir(TEST_GAMEDIR);
+    _mkdir(TEST_GAMEDIR "/maps");
+#else
+    mkdir(TEST_GAMEDIR, 0755);
+    mkdir(TEST_GAMEDIR "/maps", 0755);
+#endif
+    Com_sprintf(out, MAX_OSPATH, "./%s/%s", TEST_GAMEDIR, relative);
+    return out;
+}
+
+static void test_write_text(const char *path, const char *text)
+{
+    FILE *f = fopen(path, "w");
+
+    if (f) {
+        fputs(text, f);
+        fclose(f);
+    }
+}
+
+TEST(test_config_roster_file_and_reload)
+{
+    test_setup();
+    BotCvars_Init();
+    test_write_text(test_game_file("bot_names_alien.txt"),
+                    "# comment\n\nSkulker\n\"Big Maw\"  // trailing\n");
+    BotConfig_Init();
+
+    ASSERT_STR_EQ(BotConfig_NextName(TEAM_ALIEN), "Skulker");
+    ASSERT_STR_EQ(BotConfig_NextName(TEAM_ALIEN), "Big Maw");
+    ASSERT_STR_EQ(BotConfig_NextName(TEAM_ALIEN), "Skulker");
+
+    /* Unchanged files are not re-parsed */
+    ASSERT_EQ(BotConfig_Poll(), 0);
+
+    /* A changed file is picked up by the next poll */
+    test_write_text(test_game_file("bot_names_alien.txt"), "Gnawer\n");
+    ASSERT_EQ(BotConfig_Poll(), 1);
+    ASSERT_STR_EQ(BotConfig_NextName(TEAM_ALIEN), "Gnawer");
+
+    /* Removing it restores the built-in roster */
+    remove(test_game_file("bot_names_alien.txt"));
+    ASSERT_EQ(BotConfig_Poll(), 1);
+    ASSERT_STR_EQ(BotConfig_NextName(TEAM_ALIEN), "Xenomorph");
+
+    /* Files are looked up in the mod directory, then baseq2/ */
+    {
+        char path[MAX_OSPATH];
+
+        BotConfig_GamePath(path, sizeof(path), "bot_test_only.cfg");
+        ASSERT_STR_EQ(path, "./" TEST_GAMEDIR "/bot_test_only.cfg");
+#ifdef _WIN32
+        _mkdir(BOT_BASEDIRNAME);
+#else
+        mkdir(BOT_BASEDIRNAME, 0755);
+#endif
+        test_write_text("./" BOT_BASEDIRNAME "/bot_test_only.cfg", "\n");
+        BotConfig_GamePath(path, sizeof(path), "bot_test_only.cfg");
+        ASSERT_STR_EQ(path, "./" BOT_BASEDIRNAME "/bot_test_only.cfg");
+        remove(path);
+    }
+}
+
+TEST(test_config_skill_profile_and_class_tuning)
+{
+    const bot_skill_profile_t *p;
+
+    test_setup();
+    BotCvars_Init();
+    test_write_text(test_game_file("skill_hard.cfg"),
+                    "# hard\nset bot_skill 0.8\nset bot_fov 200\n");
+    test_write_text(test_game_file("bot_classes.cfg"),
+                    "stinger preferred_range 333\nnosuchclass preferred_range 1\n");
+    BotConfig_Init();
+
+    p = BotConfig_SkillProfile("hard");
+    ASSERT_NOT_NULL(p);
+    ASSERT_EQ(p->set, BOT_SKILL_SET_SKILL | BOT_SKILL_SET_FOV);
+    ASSERT_TRUE(p->skill > 0.79f && p->skill < 0.81f);
+    ASSERT_TRUE(p->fov == 200.0f);
+    ASSERT_TRUE(BotConfig_ApplySkill("hard"));
+    ASSERT_FALSE(BotConfig_ApplySkill("easy"));   /* no file */
+
+    ASSERT_TRUE(BotConfig_ClassRange(GLOOM_CLASS_STINGER) == 333.0f);
+    ASSERT_TRUE(BotConfig_ClassRange(GLOOM_CLASS_GRUNT) ==
+                gloom_class_info[GLOOM_CLASS_GRUNT].preferred_range);
+
+    remove(test_game_file("skill_hard.cfg"));
+    remove(test_game_file("bot_classes.cfg"));
+    BotConfig_Poll();
+    ASSERT_TRUE(BotConfig_SkillProfile("hard") == NULL);
+    ASSERT_TRUE(BotConfig_ClassRange(GLOOM_CLASS_STINGER) ==
+                gloom_class_info[GLOOM_CLASS_STINGER].preferred_range);
+}
+
+static char test_cfg_cvars[256];
+static char test_cfg_console[256];
+
+static cvar_t *test_cfg_cvar_set(char *n, char *v)
+{
+    size_t len = strlen(test_cfg_cvars);
+    snprintf(test_cfg_cvars + len, sizeof(test_cfg_cvars) - len, "%s=%s;", n, v);
+    return NULL;
+}
+
+static void test_cfg_command(char *text)
+{
+    size_t len = strlen(test_cfg_console);
+    snprintf(test_cfg_console + len, sizeof(test_cfg_console) - len, "%s", text);
+}
+
+TEST(test_config_cvar_file_routes_commands_to_console)
+{
+    test_setup();
+    BotCvars_Init();
+    test_cfg_cvars[0] = test_cfg_console[0] = '\0';
+    gi.cvar_set         = test_cfg_cvar_set;
+    gi.AddCommandString = test_cfg_command;
+    test_write_text(test_game_file("bot_config.cfg"),
+                    "set bot_skill 0.7\nseta bot_fov 90\n"
+                    "sv addbot\nmap gloom1\nbot_chat 0\nexec other.cfg\n");
+    BotConfig_Init();
+
+    /* Only set/seta are applied natively; the rest reach the console */
+    ASSERT_STR_EQ(test_cfg_cvars, "bot_skill=0.7;bot_fov=90;");
+    ASSERT_STR_EQ(test_cfg_console,
+                  "sv addbot\nmap gloom1\nbot_chat 0\nexec other.cfg\n");
+
+    remove(test_game_file("bot_config.cfg"));
+    BotConfig_Poll();
+}
+
 /* =======================================================================
    Autofill System Tests
    ======================================================================= */
@@ -1342,6 +1656,2051 @@ TEST(test_autofill_frame_no_crash)
     Bot_Shutdown();
 }
 
+/* =======================================================================
+   Navigation Tests
+   ======================================================================= */
+
+#include "bot_nav.h"
+#include "bot_path.h"
+#include "bot_navcache.h"
+#include "bot_navshm.h"
+#include "bot_navlearn.h"
+#include "bot_navdist.h"
+#include "bot_navnear.h"
+#include "bot_navpack.h"
+#include "bot_navfly.h"
+#include "bot_log.h"
+
+/* Build a straight corridor of `count` ground nodes spaced 128 units apart */
+static void test_nav_corridor(int count)
+{
+    int    i;
+    vec3_t org;
+
+    Node_Clear();
+    BotNav_ClearStuckHotspots();
+    BotPath_Clear();
+    for (i = 0; i < count; i++) {
+        VectorSet(org, i * 128.0f, 0, 0);
+        Node_Add(org, NAV_GROUND);
+        if (i > 0)
+            Node_Connect(i - 1, i, 128.0f, NAV_MOVE_WALK);
+    }
+}
+
+/* Set up a stationary human bot on test edict 1 */
+static bot_state_t *test_nav_bot(void)
+{
+    bot_state_t *bs = &g_bots[0];
+
+    memset(bs, 0, sizeof(*bs));
+    bs->in_use      = true;
+    bs->team        = TEAM_HUMAN;
+    bs->gloom_class = GLOOM_CLASS_GRUNT;
+    bs->ent         = &test_edicts[1];
+    bs->ent->inuse  = true;
+    bs->nav.current_node = BOT_INVALID_NODE;
+    bs->nav.goal_node    = BOT_INVALID_NODE;
+    bs->nav.arrived_dist = 32.0f;
+    return bs;
+}
+
+/* Run path following without moving the bot until it tries a recovery */
+static void test_nav_run_until_recovery(bot_state_t *bs)
+{
+    int stage = bs->nav.stuck_stage;
+    int i;
+
+    for (i = 0; i < 100 && bs->nav.stuck_stage == stage; i++) {
+        BotNav_MoveTowardGoal(bs);
+        level.time += 0.1f;
+    }
+}
+
+TEST(test_nav_find_path_corridor)
+{
+    bot_state_t *bs;
+    vec3_t goal;
+
+    test_setup();
+    test_nav_corridor(4);
+    bs = test_nav_bot();
+
+    VectorSet(goal, 3 * 128.0f, 0, 0);
+    BotNav_FindPath(bs, goal);
+    ASSERT_TRUE(bs->nav.path_valid);
+    ASSERT_EQ(BotPath_Length(bs->nav.path_handle), 4);
+    ASSERT_EQ(BotPath_Node(bs->nav.path_handle, 0), 0);
+    ASSERT_EQ(BotPath_Node(bs->nav.path_handle, 3), 3);
+    ASSERT_EQ(bs->nav.goal_node, 3);
+    Node_Clear();
+}
+
+TEST(test_nav_stuck_local_escapes)
+{
+    bot_state_t *bs;
+    vec3_t goal;
+
+    test_setup();
+    test_nav_corridor(4);
+    bs = test_nav_bot();
+
+    VectorSet(goal, 3 * 128.0f, 0, 0);
+    BotNav_FindPath(bs, goal);
+
+    /* Reach node 0, then sit still short of node 1 */
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.path_index, 1);
+    ASSERT_EQ(bs->nav.current_node, 0);
+
+    /* First stuck window triggers a strafe, not a replan */
+    test_nav_run_until_recovery(bs);
+    ASSERT_EQ(bs->nav.stuck_stage, 1);
+    ASSERT_TRUE(bs->nav.escape_until > level.time);
+    ASSERT_TRUE(bs->nav.escape_velocity[2] == 0.0f);
+    ASSERT_EQ(BotNav_StuckCount(0, 1), 1);
+
+    /* Second window: jump */
+    test_nav_run_until_recovery(bs);
+    ASSERT_EQ(bs->nav.stuck_stage, 2);
+    ASSERT_TRUE(bs->nav.escape_velocity[2] > 0.0f);
+
+    /* Third window: skip ahead one waypoint */
+    test_nav_run_until_recovery(bs);
+    ASSERT_EQ(bs->nav.stuck_stage, 3);
+    ASSERT_EQ(bs->nav.path_index, 2);
+    ASSERT_TRUE(bs->nav.path_valid);
+    ASSERT_EQ(BotNav_StuckCount(0, 1), 3);
+    ASSERT_EQ(BotNav_StuckCount(1, 2), 0);
+
+    Node_Clear();
+}
+
+TEST(test_nav_stuck_replan_last_resort)
+{
+    bot_state_t *bs;
+    vec3_t goal;
+    int i;
+
+    test_setup();
+    test_nav_corridor(4);
+    bs = test_nav_bot();
+
+    VectorSet(goal, 3 * 128.0f, 0, 0);
+    BotNav_FindPath(bs, goal);
+    BotNav_MoveTowardGoal(bs);
+
+    /* Strafe, jump, skip */
+    for (i = 0; i < 3; i++)
+        test_nav_run_until_recovery(bs);
+    ASSERT_EQ(bs->nav.path_index, 2);
+
+    /* Back off: retreat from the waypoint without undoing the skip */
+    test_nav_run_until_recovery(bs);
+    ASSERT_EQ(bs->nav.stuck_stage, 4);
+    ASSERT_EQ(bs->nav.path_index, 2);
+    ASSERT_TRUE(bs->nav.escape_until > level.time);
+    ASSERT_TRUE(bs->nav.escape_velocity[0] < 0.0f);
+
+    /* Then replan from scratch */
+    test_nav_run_until_recovery(bs);
+    ASSERT_EQ(bs->nav.stuck_stage, 0);
+    ASSERT_TRUE(bs->nav.path_valid);
+    ASSERT_EQ(bs->nav.path_index, 0);
+    ASSERT_TRUE(BotNav_StuckCount(0, 1) + BotNav_StuckCount(1, 2) == 5);
+
+    /* A new path starts the ladder again */
+    test_nav_run_until_recovery(bs);
+    ASSERT_EQ(bs->nav.stuck_stage, 1);
+    BotNav_FindPath(bs, goal);
+    ASSERT_EQ(bs->nav.stuck_stage, 0);
+
+    BotNav_ClearStuckHotspots();
+    ASSERT_EQ(BotNav_StuckCount(0, 1), 0);
+    Node_Clear();
+}
+
+TEST(test_nav_progress_resets_stuck)
+{
+    bot_state_t *bs;
+    vec3_t goal;
+
+    test_setup();
+    test_nav_corridor(3);
+    bs = test_nav_bot();
+
+    VectorSet(goal, 2 * 128.0f, 0, 0);
+    BotNav_FindPath(bs, goal);
+    BotNav_MoveTowardGoal(bs);
+    test_nav_run_until_recovery(bs);
+    ASSERT_EQ(bs->nav.stuck_stage, 1);
+
+    /* Arriving at the blocked waypoint clears the ladder */
+    level.time += 1.0f;
+    VectorSet(bs->ent->s.origin, 128.0f, 0, 0);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.path_index, 2);
+    ASSERT_EQ(bs->nav.stuck_stage, 0);
+    ASSERT_EQ(bs->nav.progress_count, 0);
+    Node_Clear();
+}
+
+/* Build an L-shaped route 0 -> 1 -> 2 with the given move type on 1 -> 2 */
+static void test_nav_corner(int corner_move)
+{
+    vec3_t org;
+
+    Node_Clear();
+    BotPath_Clear();
+    VectorSet(org, 0, 0, 0);     Node_Add(org, NAV_GROUND);
+    VectorSet(org, 256, 0, 0);   Node_Add(org, NAV_GROUND);
+    VectorSet(org, 256, 256, 0); Node_Add(org, NAV_GROUND);
+    Node_Connect(0, 1, 256.0f, NAV_MOVE_WALK);
+    Node_Connect(1, 2, 256.0f, corner_move);
+}
+
+TEST(test_nav_lookahead_cuts_walk_corner)
+{
+    bot_state_t *bs;
+    vec3_t goal;
+
+    test_setup();
+    test_nav_corner(NAV_MOVE_WALK);
+    bs = test_nav_bot();
+
+    VectorSet(goal, 256, 256, 0);
+    BotNav_FindPath(bs, goal);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.path_index, 1);
+
+    /* 64 units short of the corner the carrot is already round it */
+    VectorSet(bs->ent->s.origin, 192, 0, 0);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_TRUE(bs->ent->velocity[1] > 0.0f);
+    ASSERT_TRUE(VectorLength(bs->ent->velocity) > 299.0f);
+
+    /* Having cut the corner, the waypoint counts as passed */
+    VectorSet(bs->ent->s.origin, 220, 40, 0);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.path_index, 2);
+    ASSERT_EQ(bs->nav.current_node, 1);
+    Node_Clear();
+}
+
+/* Pillar filling the inside of test_nav_corner's bend */
+static const float test_corner_wall[6] = { 200, 24, -64, 232, 300, 64 };
+
+/* Swept hull against test_corner_wall, sampled every 4 units */
+static trace_t test_corner_trace(vec3_t start, vec3_t mins, vec3_t maxs,
+                                 vec3_t end, edict_t *passent, int contentmask)
+{
+    const float *b = test_corner_wall;
+    trace_t t;
+    vec3_t  d, p;
+    int     i, k, steps;
+
+    (void)passent; (void)contentmask;
+    memset(&t, 0, sizeof(t));
+    VectorSubtract(end, start, d);
+    steps = (int)(VectorLength(d) / 4.0f) + 1;
+    t.fraction = 1.0f;
+    VectorCopy(end, t.endpos);
+
+    for (i = 0; i <= steps; i++) {
+        for (k = 0; k < 3; k++)
+            p[k] = start[k] + d[k] * i / steps;
+        if (p[0] + mins[0] < b[3] && p[0] + maxs[0] > b[0] &&
+            p[1] + mins[1] < b[4] && p[1] + maxs[1] > b[1] &&
+            p[2] + mins[2] < b[5] && p[2] + maxs[2] > b[2]) {
+            t.startsolid = (i == 0);
+            t.fraction   = (float)i / steps;
+            return t;
+        }
+    }
+    return t;
+}
+
+TEST(test_nav_lookahead_stays_off_inner_wall)
+{
+    bot_state_t *bs;
+    vec3_t goal;
+
+    test_setup();
+    test_nav_corner(NAV_MOVE_WALK);
+    bs = test_nav_bot();
+    VectorSet(bs->ent->mins, -16, -16, -24);
+    VectorSet(bs->ent->maxs,  16,  16,  32);
+    gi.trace = test_corner_trace;
+
+    VectorSet(goal, 256, 256, 0);
+    BotNav_FindPath(bs, goal);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.path_index, 1);
+
+    /* The cut round the corner runs into the pillar: aim down the corridor */
+    VectorSet(bs->ent->s.origin, 192, 0, 0);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_TRUE(bs->ent->velocity[0] > 0.0f);
+    ASSERT_TRUE(fabsf(bs->ent->velocity[1]) < 0.01f);
+
+    /* Past the node's plane but still behind the pillar: not passed */
+    VectorSet(bs->ent->s.origin, 222, 8, 0);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.path_index, 1);
+
+    /* Clear of it, the waypoint counts as passed */
+    VectorSet(bs->ent->s.origin, 250, 34, 0);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.path_index, 2);
+
+    gi.trace = mock_trace;
+    VectorClear(bs->ent->mins);
+    VectorClear(bs->ent->maxs);
+    Node_Clear();
+}
+
+TEST(test_nav_lookahead_respects_jump_edge)
+{
+    bot_state_t *bs;
+    vec3_t goal;
+
+    test_setup();
+    test_nav_corner(NAV_MOVE_JUMP);
+    bs = test_nav_bot();
+
+    VectorSet(goal, 256, 256, 0);
+    BotNav_FindPath(bs, goal);
+    BotNav_MoveTowardGoal(bs);
+
+    /* Carrot stops at the jump node and the bot brakes */
+    VectorSet(bs->ent->s.origin, 192, 0, 0);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_TRUE(bs->ent->velocity[1] == 0.0f);
+    ASSERT_TRUE(bs->ent->velocity[0] > 0.0f);
+    ASSERT_TRUE(VectorLength(bs->ent->velocity) < 299.0f);
+
+    /* The jump node must actually be reached */
+    VectorSet(bs->ent->s.origin, 220, 40, 0);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.path_index, 1);
+    Node_Clear();
+}
+
+TEST(test_nav_path_shared_suffix)
+{
+    bot_state_t *a, *b;
+    vec3_t goal;
+    int live, cached;
+
+    test_setup();
+    test_nav_corridor(4);
+    a = test_nav_bot();
+    b = &g_bots[1];
+    memcpy(b, a, sizeof(*b));
+    b->bot_index = 1;
+    b->ent = &test_edicts[2];
+    b->ent->inuse = true;
+    VectorSet(b->ent->s.origin, 128, 0, 0);
+
+    VectorSet(goal, 3 * 128.0f, 0, 0);
+    BotNav_FindPath(a, goal);
+    BotNav_FindPath(b, goal);
+
+    /* B starts on A's route, so it shares the path with a later cursor */
+    ASSERT_TRUE(b->nav.path_valid);
+    ASSERT_EQ(b->nav.path_handle, a->nav.path_handle);
+    ASSERT_EQ(b->nav.path_index, 1);
+    BotPath_Stats(&live, &cached, NULL);
+    ASSERT_EQ(live, 1);
+
+    /* Released paths stay cached for the next bot */
+    BotNav_ClearPath(a);
+    BotNav_ClearPath(b);
+    BotPath_Stats(&live, &cached, NULL);
+    ASSERT_EQ(live, 0);
+    ASSERT_EQ(cached, 1);
+
+    /* A graph edit makes the cached path unshareable */
+    Node_Connect(0, 3, 100.0f, NAV_MOVE_WALK);
+    BotNav_FindPath(a, goal);
+    ASSERT_EQ(BotPath_Length(a->nav.path_handle), 2);
+    BotNav_ClearPath(a);
+    Node_Clear();
+}
+
+TEST(test_nav_path_pool_compaction)
+{
+    int nodes[BOT_MAX_PATH_NODES];
+    int keep, h, i, used, failed = 0;
+
+    test_setup();
+    BotPath_Clear();
+    for (i = 0; i < BOT_MAX_PATH_NODES; i++)
+        nodes[i] = i;
+
+    /* One long-lived path, then churn enough to wrap the arena */
+    keep = BotPath_Store(nodes, 10, 0);
+    ASSERT_NE(keep, BOT_PATH_NONE);
+    for (i = 0; i < 200; i++) {
+        h = BotPath_Store(nodes, BOT_MAX_PATH_NODES, 0);
+        if (h == BOT_PATH_NONE)
+            failed++;
+        BotPath_Release(h);
+    }
+    ASSERT_EQ(failed, 0);
+
+    /* The retained path survived compaction intact */
+    ASSERT_EQ(BotPath_Length(keep), 10);
+    ASSERT_EQ(BotPath_Node(keep, 9), 9);
+    BotPath_Stats(NULL, NULL, &used);
+    ASSERT_TRUE(used <= BOT_PATH_ARENA_NODES);
+    ASSERT_EQ(BotPath_Node(keep, 10), BOT_INVALID_NODE);
+
+    /* A handle held across a clear cannot reach the slot's new path */
+    BotPath_Clear();
+    h = BotPath_Store(nodes, 5, 0);
+    ASSERT_NE(h, BOT_PATH_NONE);
+    ASSERT_NE(h, keep);
+    ASSERT_EQ(BotPath_Length(keep), 0);
+    BotPath_Release(keep);
+    BotPath_Release(keep);
+    BotPath_Stats(&used, NULL, NULL);
+    ASSERT_EQ(used, 1);
+    ASSERT_EQ(BotPath_Length(h), 5);
+    BotPath_Release(h);
+}
+
+/* Nav files live under maps/ relative to the working directory */
+static void test_nav_make_maps_dir(void)
+{
+#ifdef _WIN32
+    _mkdir("maps");
+#else
+    mkdir("maps", 0755);
+#endif
+}
+
+TEST(test_nav_save_atomic_checksummed)
+{
+    static unsigned char buf[65536];
+    FILE *f;
+    int   len, version = 1;
+
+    test_setup();
+    test_nav_make_maps_dir();
+    test_nav_corridor(3);
+    ASSERT_TRUE(Node_Save("bot_test_crc"));
+    ASSERT_TRUE(fopen("maps/bot_test_crc.nav.tmp", "rb") == NULL);
+
+    f = fopen("maps/bot_test_crc.nav", "rb");
+    ASSERT_NOT_NULL(f);
+    len = (int)fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    ASSERT_TRUE(Node_Load("bot_test_crc"));
+    ASSERT_EQ(nav_node_count, 3);
+
+    /* A flipped bit anywhere in the records is caught */
+    buf[len - 20] ^= 0x10;
+    f = fopen("maps/bot_test_crc.nav", "wb");
+    fwrite(buf, 1, (size_t)len, f);
+    fclose(f);
+    ASSERT_FALSE(Node_Load("bot_test_crc"));
+    ASSERT_EQ(nav_node_count, 3);
+
+    /* Version 1 files (no CRC field) still load */
+    buf[len - 20] ^= 0x10;
+    memcpy(buf + 4, &version, sizeof(int));
+    f = fopen("maps/bot_test_crc.nav", "wb");
+    fwrite(buf, 1, 12, f);
+    fwrite(buf + 16, 1, (size_t)(len - 16), f);
+    fclose(f);
+    nav_node_count = 0;
+    ASSERT_TRUE(Node_Load("bot_test_crc"));
+    ASSERT_EQ(nav_node_count, 3);
+    ASSERT_EQ(nav_nodes[1].num_neighbors, 2);
+
+    remove("maps/bot_test_crc.nav");
+}
+
+TEST(test_nav_load_renumbers_for_locality)
+{
+    static const int chain[8] = { 5, 2, 7, 0, 3, 6, 1, 4 };
+    vec3_t org;
+    int    i, j, id, ext;
+
+    test_setup();
+    test_nav_make_maps_dir();
+    Node_Clear();
+    for (i = 0; i < 8; i++) {
+        VectorSet(org, (float)(i * 100), 0.0f, 0.0f);
+        Node_Add(org, NAV_GROUND);
+    }
+    /* A path whose authoring IDs jump all over the array */
+    for (i = 0; i < 7; i++)
+        Node_Connect(chain[i], chain[i + 1], 100.0f, NAV_MOVE_WALK);
+    ASSERT_TRUE(Node_Save("bot_test_rcm"));
+
+    ASSERT_TRUE(Node_Load("bot_test_rcm"));
+    ASSERT_EQ(nav_node_count, 8);
+
+    /* Every link now joins adjacent slots */
+    for (i = 0; i < nav_node_count; i++) {
+        for (j = 0; j < nav_nodes[i].num_neighbors; j++)
+            ASSERT_EQ(abs(nav_nodes[i].neighbors[j] - i), 1);
+    }
+
+    /* File IDs survive: the chain still runs 5-2-7-0-3-6-1-4 */
+    for (i = 0; i < 7; i++) {
+        id = Node_FromExternalId(chain[i]);
+        ASSERT_NE(id, BOT_INVALID_NODE);
+        ASSERT_TRUE(nav_nodes[id].origin[0] == (float)(chain[i] * 100));
+        ext = BOT_INVALID_NODE;
+        for (j = 0; j < nav_nodes[id].num_neighbors; j++) {
+            if (Node_ExternalId(nav_nodes[id].neighbors[j]) == chain[i + 1])
+                ext = chain[i + 1];
+        }
+        ASSERT_EQ(ext, chain[i + 1]);
+    }
+
+    /* ...and a save after the renumbering writes the same IDs back */
+    ASSERT_TRUE(Node_Save("bot_test_rcm"));
+    ASSERT_TRUE(Node_Load("bot_test_rcm"));
+    ASSERT_EQ(Node_ExternalId(Node_FromExternalId(7)), 7);
+    ASSERT_TRUE(nav_nodes[Node_FromExternalId(7)].origin[0] == 700.0f);
+
+    /* New nodes take the lowest free file ID */
+    Node_Remove(Node_FromExternalId(3));
+    VectorSet(org, 0.0f, 500.0f, 0.0f);
+    ASSERT_EQ(Node_ExternalId(Node_Add(org, NAV_GROUND)), 3);
+
+    /* Warnings name nodes by file ID, not slot */
+    id = Node_FromExternalId(6);
+    ASSERT_NE(id, 6);
+    Node_Remove(id);
+    mock_print_len = 0;
+    memset(mock_print_buf, 0, sizeof(mock_print_buf));
+    Node_Connect(id, Node_FromExternalId(1), 100.0f, NAV_MOVE_WALK);
+    BotLog_Flush();
+    ASSERT_NOT_NULL(strstr(mock_print_buf, "invalid node id1=6\n"));
+
+    remove("maps/bot_test_rcm.nav");
+}
+
+TEST(test_nav_text_format_loads_and_roundtrips)
+{
+    int a, b, c;
+
+    test_setup();
+    test_nav_make_maps_dir();
+    test_write_text("maps/bot_test_text.nav",
+                    "# hand-written graph\n"
+                    "link 10 20            // links may come first\n"
+                    "oneway 20 30 1 50\n"
+                    "node 10 0 0 0 1\n"
+                    "node 20 300 400 0 0x3 1\n"
+                    "\n"
+                    "node 30 300 400 64 1   # ledge\n");
+    ASSERT_TRUE(Node_Load("bot_test_text"));
+    ASSERT_EQ(nav_node_count, 3);
+
+    a = Node_FromExternalId(10);
+    b = Node_FromExternalId(20);
+    c = Node_FromExternalId(30);
+    ASSERT_NE(a, BOT_INVALID_NODE);
+    ASSERT_NE(c, BOT_INVALID_NODE);
+    ASSERT_EQ(nav_nodes[b].flags, NAV_GROUND | NAV_JUMP);
+    ASSERT_EQ(nav_nodes[b].team_access, NAV_TEAM_HUMAN);
+    ASSERT_EQ(nav_nodes[a].team_access, NAV_TEAM_ALL);
+    ASSERT_EQ(nav_nodes[a].num_neighbors, 1);
+    ASSERT_TRUE(nav_nodes[a].neighbor_costs[0] == 500.0f);   /* distance */
+    ASSERT_EQ(nav_nodes[b].num_neighbors, 2);                /* a and c  */
+    ASSERT_EQ(nav_nodes[c].num_neighbors, 0);                /* one-way  */
+
+    /* Text out, binary back in: same graph, same file IDs */
+    ASSERT_TRUE(Node_SaveText("bot_test_text"));
+    ASSERT_TRUE(Node_Load("bot_test_text"));
+    ASSERT_TRUE(Node_Save("bot_test_text"));
+    ASSERT_TRUE(Node_Load("bot_test_text"));
+    b = Node_FromExternalId(20);
+    ASSERT_EQ(nav_nodes[b].num_neighbors, 2);
+    ASSERT_EQ(nav_nodes[Node_FromExternalId(30)].num_neighbors, 0);
+    ASSERT_EQ(nav_nodes[b].movement_required[
+                  nav_nodes[b].neighbors[0] == Node_FromExternalId(30) ? 0 : 1],
+              NAV_MOVE_JUMP);
+
+    /* Mistakes are reported, not silently loaded as an empty graph */
+    test_write_text("maps/bot_test_text.nav",
+                    "node 0 0 0 0 1\nlink 0 7\n");
+    ASSERT_FALSE(Node_Load("bot_test_text"));
+    test_write_text("maps/bot_test_text.nav",
+                    "node 0 0 0 0 1\nnode 1 0 0 oops 1\n");
+    ASSERT_FALSE(Node_Load("bot_test_text"));
+
+    /* Zero-padded IDs are decimal, not octal; only flags take hex */
+    test_write_text("maps/bot_test_text.nav",
+                    "node 010 0 0 0 010\nnode 011 64 0 0 0x10\n"
+                    "link 010 011 01\n");
+    ASSERT_TRUE(Node_Load("bot_test_text"));
+    a = Node_FromExternalId(10);
+    b = Node_FromExternalId(11);
+    ASSERT_NE(a, BOT_INVALID_NODE);
+    ASSERT_NE(b, BOT_INVALID_NODE);
+    ASSERT_EQ(Node_FromExternalId(8), BOT_INVALID_NODE);
+    ASSERT_EQ(nav_nodes[a].flags, 10);
+    ASSERT_EQ(nav_nodes[b].flags, NAV_WATER);
+    ASSERT_EQ(nav_nodes[a].movement_required[0], NAV_MOVE_JUMP);
+    test_write_text("maps/bot_test_text.nav", "node 0x1 0 0 0 1\n");
+    ASSERT_FALSE(Node_Load("bot_test_text"));
+
+    remove("maps/bot_test_text.nav");
+}
+
+TEST(test_nav_search_profiles_match_generic)
+{
+    int          path[BOT_MAX_PATH_NODES];
+    int          generic[BOT_MAX_PATH_NODES];
+    unsigned int caps;
+    int          len, glen, i;
+
+    /* 0 -climb- 1 -fly- 2 is the short way; 0 - 3 - 4 - 5 - 2 walks */
+    test_nav_corridor(6);
+    Node_Remove(1);
+    Node_Remove(2);
+    Node_Add(nav_nodes[0].origin, NAV_WALLCLIMB);
+    Node_Add(nav_nodes[0].origin, NAV_FLY);
+    Node_Connect(0, 1, 10.0f, NAV_MOVE_CLIMB);
+    Node_Connect(1, 2, 10.0f, NAV_MOVE_FLY);
+    Node_Connect(0, 3, 128.0f, NAV_MOVE_WALK);
+    Node_Connect(5, 2, 128.0f, NAV_MOVE_WALK);
+    ASSERT_EQ(nav_nodes[0].edge_caps[0], NAV_CAP_WALL);
+    ASSERT_EQ(nav_nodes[1].edge_caps[1], NAV_CAP_FLY);
+
+    for (caps = 0; caps <= (NAV_CAP_WALL | NAV_CAP_FLY); caps++) {
+        len  = BotNavPack_Search(0, 2, caps, false, path, NULL);
+        glen = BotNavPack_Search(0, 2, caps, true, generic, NULL);
+        ASSERT_EQ(len, glen);
+        for (i = 0; i < len; i++)
+            ASSERT_EQ(path[i], generic[i]);
+        ASSERT_EQ(len, caps == (NAV_CAP_WALL | NAV_CAP_FLY) ? 3 : 5);
+        ASSERT_EQ(BotNav_Search(0, 2, caps, generic), len);
+    }
+
+    /* Removing a node keeps the cached caps aligned with the edges */
+    Node_Remove(3);
+    ASSERT_EQ(nav_nodes[0].num_neighbors, 1);
+    ASSERT_EQ(nav_nodes[0].neighbors[0], 1);
+    ASSERT_EQ(nav_nodes[0].edge_caps[0], NAV_CAP_WALL);
+    ASSERT_EQ(BotNavPack_Search(0, 2, 0, false, path, NULL), 0);
+    ASSERT_EQ(BotNav_Search(0, 2, 0, path), 0);
+}
+
+/* Cost of path[] over edges allowed by caps; -1 if a hop is not an edge */
+static float test_nav_path_cost(const int *path, int len, unsigned int caps)
+{
+    float cost = 0.0f;
+    int   i, j;
+
+    for (i = 0; i + 1 < len; i++) {
+        const nav_node_t *n = &nav_nodes[path[i]];
+
+        for (j = 0; j < n->num_neighbors; j++) {
+            if (n->neighbors[j] == path[i + 1] && !(n->edge_caps[j] & ~caps))
+                break;
+        }
+        if (j == n->num_neighbors)
+            return -1.0f;
+        cost += n->neighbor_costs[j];
+    }
+    return cost;
+}
+
+/* 24x24 grid with climb and fly edges and one-way drops going +y */
+static void test_nav_mixed_grid(void)
+{
+    int    x, y;
+    vec3_t org;
+
+    Node_Clear();
+    BotPath_Clear();
+    for (y = 0; y < 24; y++) {
+        for (x = 0; x < 24; x++) {
+            VectorSet(org, x * 128.0f, y * 128.0f, 0);
+            Node_Add(org, NAV_GROUND);
+        }
+    }
+    for (y = 0; y < 24; y++) {
+        for (x = 0; x < 24; x++) {
+            int i = y * 24 + x;
+            if (x < 23)
+                Node_Connect(i, i + 1, 128.0f + (x * 7 + y * 3) % 50,
+                             (x % 5 == 2 && y % 4) ? NAV_MOVE_CLIMB : NAV_MOVE_WALK);
+            if (y < 23) {
+                Node_Connect(i, i + 24, 128.0f + (x * 5 + y) % 40,
+                             (y % 7 == 3 && x % 6) ? NAV_MOVE_FLY : NAV_MOVE_WALK);
+                if (x % 3 == 1)
+                    nav_nodes[i + 24].num_neighbors--;   /* drop: i -> i+24 only */
+            }
+        }
+    }
+    nav_graph_version++;
+}
+
+TEST(test_nav_bidir_search_matches_astar)
+{
+    int          path[BOT_MAX_PATH_NODES];
+    int          bipath[BOT_MAX_PATH_NODES];
+    unsigned int caps;
+    int          q, len, bilen;
+    bot_state_t *bs;
+    vec3_t       goal;
+
+    test_nav_mixed_grid();
+
+    for (caps = 0; caps <= (NAV_CAP_WALL | NAV_CAP_FLY); caps++) {
+        for (q = 0; q < 40; q++) {
+            int s = (q * 131) % 576, t = (q * 277 + 101) % 576;
+
+            len   = BotNav_Search(s, t, caps, path);
+            bilen = BotNav_SearchBidir(s, t, caps, bipath);
+            ASSERT_EQ(bilen > 0, len > 0);
+            if (!len || !bilen)
+                continue;
+            ASSERT_EQ(bipath[0], s);
+            ASSERT_EQ(bipath[bilen - 1], t);
+            ASSERT_TRUE(fabsf(test_nav_path_cost(bipath, bilen, caps) -
+                              test_nav_path_cost(path, len, caps)) < 0.01f);
+        }
+    }
+
+    /* A corner-to-corner query from a bot is long, so it goes bidirectional */
+    bs = test_nav_bot();
+    VectorSet(goal, 23 * 128.0f, 23 * 128.0f, 0);
+    BotNav_ResetSearchStats();
+    BotNav_FindPath(bs, goal);
+    ASSERT_TRUE(bs->nav.path_valid);
+    mock_print_len = 0;
+    memset(mock_print_buf, 0, sizeof(mock_print_buf));
+    BotNav_PrintSearchStats();
+    ASSERT_NOT_NULL(strstr(mock_print_buf, "0 A*, 1 bidirectional"));
+    ASSERT_NOT_NULL(strstr(mock_print_buf, "1 long queries sampled"));
+    BotNav_ClearPath(bs);
+}
+
+TEST(test_nav_distance_labels_are_exact)
+{
+    int          path[BOT_MAX_PATH_NODES];
+    unsigned int caps;
+    int          q, len;
+    float        d, expect;
+    vec3_t       a, b;
+
+    test_nav_mixed_grid();
+    BotNavDist_BuildAll();
+    ASSERT_TRUE(BotNavDist_MeanLabel(0) > 0.0f);
+
+    for (caps = 0; caps <= NAV_CAP_FLY; caps++) {
+        for (q = 0; q < 60; q++) {
+            int s = (q * 97) % 576, t = (q * 313 + 57) % 576;
+
+            ASSERT_TRUE(BotNavDist_Lookup(s, t, caps, &d));
+            len    = BotNav_Search(s, t, caps, path);
+            expect = len ? test_nav_path_cost(path, len, caps) : FLT_MAX;
+            if (expect == FLT_MAX)
+                ASSERT_TRUE(d == FLT_MAX);
+            else
+                ASSERT_TRUE(fabsf(d - expect) < 0.01f);
+            ASSERT_TRUE(fabsf(BotNav_Distance(s, t, caps) - d) < 0.01f);
+        }
+    }
+
+    /* Drops are one-way: back up the column is a detour */
+    ASSERT_TRUE(BotNav_Distance(1, 25, 0) < BotNav_Distance(25, 1, 0));
+
+    /* No labels for a combined profile: straight-line, not a search */
+    VectorSubtract(nav_nodes[575].origin, nav_nodes[0].origin, a);
+    ASSERT_FALSE(BotNavDist_Lookup(0, 575, NAV_CAP_WALL | NAV_CAP_FLY, &d));
+    ASSERT_TRUE(fabsf(BotNav_Distance(0, 575, NAV_CAP_WALL | NAV_CAP_FLY) -
+                      VectorLength(a)) < 0.01f);
+
+    /* An edit invalidates the labels; lookups fail until frames rebuild them */
+    Node_Remove(300);
+    ASSERT_FALSE(BotNavDist_Lookup(0, 575, 0, &d));
+    ASSERT_TRUE(fabsf(BotNav_Distance(0, 575, 0) - VectorLength(a)) < 0.01f);
+    BotNavDist_Frame();
+    ASSERT_FALSE(BotNavDist_Lookup(0, 575, 0, &d));     /* within the interval */
+
+    level.time += BOT_NAVDIST_REBUILD + 1.0f;
+    for (q = 0; q < 100 && !BotNavDist_Lookup(0, 575, 0, &d); q++)
+        BotNavDist_Frame();
+    ASSERT_TRUE(q > BOT_NAVDIST_SAMPLES);               /* spread over frames */
+    ASSERT_TRUE(BotNavDist_Lookup(0, 575, 0, &d));
+    len = BotNav_Search(0, 575, 0, path);
+    ASSERT_TRUE(len > 0);
+    ASSERT_TRUE(fabsf(d - test_nav_path_cost(path, len, 0)) < 0.01f);
+    ASSERT_EQ(BotNav_Distance(0, 300, 0), FLT_MAX);
+
+    /* An edit mid-rebuild drops the partial labels and starts again */
+    Node_Remove(301);
+    level.time += BOT_NAVDIST_REBUILD + 1.0f;
+    BotNavDist_Frame();
+    Node_Remove(302);
+    for (q = 0; q < 100 && !BotNavDist_Lookup(0, 575, 0, &d); q++)
+        BotNavDist_Frame();
+    ASSERT_FALSE(BotNavDist_Lookup(0, 575, 0, &d));     /* throttled */
+    level.time += BOT_NAVDIST_REBUILD + 1.0f;
+    for (q = 0; q < 100 && !BotNavDist_Lookup(0, 575, 0, &d); q++)
+        BotNavDist_Frame();
+    ASSERT_TRUE(BotNavDist_Lookup(0, 575, 0, &d));
+    len = BotNav_Search(0, 575, 0, path);
+    ASSERT_TRUE(fabsf(d - test_nav_path_cost(path, len, 0)) < 0.01f);
+
+    VectorSet(a, 0, 0, 0);
+    VectorSet(b, 3 * 128.0f, 0, 0);
+    ASSERT_TRUE(BotNav_PointDistance(a, b, 0) >= 3 * 128.0f);
+    BotNavDist_Clear();
+}
+
+/* Travel distance from node to the nearest of the nodes in goals, by search */
+static float test_nav_nearest_cost(int node, const int *goals, int count)
+{
+    int   path[BOT_MAX_PATH_NODES];
+    float best = FLT_MAX;
+    int   i, len;
+
+    for (i = 0; i < count; i++) {
+        len = BotNav_Search(node, goals[i], 0, path);
+        if (len && test_nav_path_cost(path, len, 0) < best)
+            best = test_nav_path_cost(path, len, 0);
+    }
+    return best;
+}
+
+TEST(test_nav_nearest_structure_labels_track_changes)
+{
+    static const int egg_nodes[4] = { 30, 300, 500, 287 };
+    edict_t *eggs[4];
+    edict_t *found;
+    int      i, node, n;
+    float    d;
+
+    test_nav_mixed_grid();
+    BotNavNear_Clear();
+    for (i = 0; i < 4; i++) {
+        eggs[i] = &test_edicts[20 + i];
+        eggs[i]->inuse     = true;
+        eggs[i]->health    = 100;
+        eggs[i]->classname = (i < 3) ? "struct_egg" : "struct_cocoon";
+        VectorCopy(nav_nodes[egg_nodes[i]].origin, eggs[i]->s.origin);
+    }
+
+    /* The first scan picks up every structure */
+    BotNavNear_Frame();
+    ASSERT_EQ(BotNavNear_Count(STRUCT_EGG), 3);
+    ASSERT_EQ(BotNavNear_Count(STRUCT_COCOON), 1);
+    for (n = 0; n < 576; n += 7) {
+        float expect = test_nav_nearest_cost(n, egg_nodes, 3);
+
+        found = BotNavNear_Find(n, STRUCT_EGG, &node, &d);
+        if (expect == FLT_MAX) {
+            ASSERT_TRUE(found == NULL);
+            continue;
+        }
+        ASSERT_NOT_NULL(found);
+        ASSERT_TRUE(fabsf(d - expect) < 0.01f);
+        ASSERT_TRUE(fabsf(test_nav_nearest_cost(n, &node, 1) - expect) < 0.01f);
+    }
+    ASSERT_TRUE(BotNavNear_Find(300, STRUCT_EGG, NULL, &d) == eggs[1]);
+    ASSERT_TRUE(d == 0.0f);
+    ASSERT_TRUE(BotNavNear_Find(0, STRUCT_COCOON, NULL, NULL) == eggs[3]);
+    ASSERT_TRUE(BotNavNear_Find(0, STRUCT_OVERMIND, NULL, NULL) == NULL);
+
+    /* A destroyed egg's region is refilled from the two that remain */
+    eggs[1]->health = 0;
+    BotNavNear_Frame();                         /* too soon: no scan */
+    ASSERT_EQ(BotNavNear_Count(STRUCT_EGG), 3);
+    ASSERT_TRUE(BotNavNear_Find(300, STRUCT_EGG, NULL, NULL) != eggs[1]);
+    ASSERT_EQ(BotNavNear_Count(STRUCT_EGG), 2);  /* dropped by Find */
+    level.time += BOT_NAVNEAR_SCAN;
+    BotNavNear_Frame();
+    ASSERT_EQ(BotNavNear_Count(STRUCT_EGG), 2);
+    {
+        static const int left[2] = { 30, 500 };
+
+        for (n = 0; n < 576; n += 5) {
+            float expect = test_nav_nearest_cost(n, left, 2);
+
+            found = BotNavNear_Find(n, STRUCT_EGG, NULL, &d);
+            ASSERT_TRUE(found != eggs[1]);
+            if (expect == FLT_MAX)
+                ASSERT_TRUE(found == NULL);
+            else
+                ASSERT_TRUE(found && fabsf(d - expect) < 0.01f);
+        }
+    }
+
+    /* Adding one back only relabels the nodes it now wins */
+    ASSERT_TRUE(BotNavNear_Add(eggs[1], STRUCT_EGG));
+    eggs[1]->health = 100;
+    for (n = 0; n < 576; n += 5) {
+        float expect = test_nav_nearest_cost(n, egg_nodes, 3);
+
+        found = BotNavNear_Find(n, STRUCT_EGG, NULL, &d);
+        if (expect != FLT_MAX)
+            ASSERT_TRUE(found && fabsf(d - expect) < 0.01f);
+    }
+
+    /* An edited graph relabels from scratch */
+    Node_Remove(301);
+    ASSERT_TRUE(BotNavNear_Find(300, STRUCT_EGG, NULL, &d) == eggs[1]);
+    ASSERT_TRUE(BotNavNear_Find(301, STRUCT_EGG, NULL, NULL) == NULL);
+
+    /* A freed edict reused as another structure type is not returned */
+    eggs[1]->classname = "struct_spiker";
+    found = BotNavNear_Find(300, STRUCT_EGG, NULL, NULL);
+    ASSERT_TRUE(found != eggs[1]);
+    ASSERT_TRUE(found == NULL || found->inuse);
+    eggs[0]->inuse = false;
+    found = BotNavNear_Find(30, STRUCT_EGG, NULL, NULL);
+    ASSERT_TRUE(found == eggs[2] || found == NULL);
+
+    BotNavNear_Clear();
+    for (i = 0; i < 4; i++)
+        memset(eggs[i], 0, sizeof(*eggs[i]));
+}
+
+/*
+ * A closed 1024-unit room split by a wall at x 496..528 with one hole
+ * low in the corner, for the flight octree.  Outside the shell is void.
+ */
+static const float test_fly_brushes[][6] = {
+    {  -32,  -32,  -32,    0, 1056, 1056 },
+    { 1024,  -32,  -32, 1056, 1056, 1056 },
+    {  -32,  -32,  -32, 1056,    0, 1056 },
+    {  -32, 1024,  -32, 1056, 1056, 1056 },
+    {  -32,  -32,  -32, 1056, 1056,    0 },
+    {  -32,  -32, 1024, 1056, 1056, 1056 },
+    {  496,    0,    0,  528,   96, 1024 },      /* wall, below the hole y */
+    {  496,  288,    0,  528, 1024, 1024 },      /* wall, above the hole y */
+    {  496,   96,    0,  528,  288,   96 },      /* under the hole         */
+    {  496,   96,  288,  528,  288, 1024 }       /* over the hole          */
+};
+
+static qboolean test_fly_box_solid(const vec3_t lo, const vec3_t hi)
+{
+    int i;
+
+    for (i = 0; i < (int)(sizeof(test_fly_brushes) / sizeof(test_fly_brushes[0])); i++) {
+        const float *b = test_fly_brushes[i];
+
+        if (lo[0] < b[3] && hi[0] > b[0] && lo[1] < b[4] && hi[1] > b[1] &&
+            lo[2] < b[5] && hi[2] > b[2])
+            return true;
+    }
+    return false;
+}
+
+static trace_t test_fly_trace(vec3_t start, vec3_t mins, vec3_t maxs,
+                              vec3_t end, edict_t *passent, int contentmask)
+{
+    trace_t t;
+    vec3_t  lo, hi;
+
+    (void)end; (void)passent; (void)contentmask;
+    memset(&t, 0, sizeof(t));
+    VectorAdd(start, mins, lo);
+    VectorAdd(start, maxs, hi);
+    t.startsolid = t.allsolid = test_fly_box_solid(lo, hi);
+    t.fraction = t.startsolid ? 0.0f : 1.0f;
+    VectorCopy(start, t.endpos);
+    return t;
+}
+
+static int test_fly_pointcontents(vec3_t p)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (p[i] < -32.0f || p[i] > 1056.0f)
+            return CONTENTS_SOLID;
+    }
+    return test_fly_box_solid(p, p) ? CONTENTS_SOLID : 0;
+}
+
+/* True if a hull of half-width 15 fits everywhere along a-b */
+static qboolean test_fly_segment_clear(const vec3_t a, const vec3_t b)
+{
+    vec3_t p, lo, hi, half = { 15.0f, 15.0f, 15.0f };
+    int    i, steps;
+
+    VectorSubtract(b, a, p);
+    steps = (int)(VectorLength(p) / 4.0f) + 1;
+
+    for (i = 0; i <= steps; i++) {
+        p[0] = a[0] + (b[0] - a[0]) * i / steps;
+        p[1] = a[1] + (b[1] - a[1]) * i / steps;
+        p[2] = a[2] + (b[2] - a[2]) * i / steps;
+        VectorSubtract(p, half, lo);
+        VectorAdd(p, half, hi);
+        if (test_fly_box_solid(lo, hi))
+            return false;
+    }
+    return true;
+}
+
+TEST(test_nav_fly_octree_plans_around_walls)
+{
+    vec3_t       mins = { 0, 0, 0 }, maxs = { 1024, 1024, 1024 };
+    vec3_t       from = { 200, 800, 800 }, to = { 800, 800, 800 };
+    vec3_t       far_away = { 5000, 800, 800 }, low = { 400, 200, 300 };
+    vec3_t       points[BOT_FLY_MAX_POINTS], prev;
+    bot_state_t *bs;
+    float        len = 0.0f;
+    int          i, n, frames;
+    qboolean     through_hole = false;
+
+    gi.trace         = test_fly_trace;
+    gi.pointcontents = test_fly_pointcontents;
+
+    BotNavFly_Begin(mins, maxs);
+    ASSERT_FALSE(BotNavFly_Ready());
+    ASSERT_EQ(BotNavFly_Plan(from, to, points, BOT_FLY_MAX_POINTS), 0);
+    for (frames = 0; frames < 1000 && !BotNavFly_Ready(); frames++)
+        BotNavFly_Frame();
+    ASSERT_TRUE(BotNavFly_Ready());
+    ASSERT_TRUE(frames > 1);                    /* spread over frames */
+
+    ASSERT_TRUE(BotNavFly_LineFree(from, low));
+    ASSERT_FALSE(BotNavFly_LineFree(from, to));
+
+    n = BotNavFly_Plan(from, to, points, BOT_FLY_MAX_POINTS);
+    ASSERT_TRUE(n >= 2);
+    ASSERT_TRUE(points[n - 1][0] == to[0] && points[n - 1][1] == to[1] &&
+                points[n - 1][2] == to[2]);
+    VectorCopy(from, prev);
+    for (i = 0; i < n; i++) {
+        ASSERT_TRUE(test_fly_segment_clear(prev, points[i]));
+        if ((prev[0] < 512.0f) != (points[i][0] < 512.0f)) {
+            float f = (512.0f - prev[0]) / (points[i][0] - prev[0]);
+            float y = prev[1] + f * (points[i][1] - prev[1]);
+            float z = prev[2] + f * (points[i][2] - prev[2]);
+
+            through_hole = y > 96.0f && y < 288.0f && z > 96.0f && z < 288.0f;
+        }
+        VectorSubtract(points[i], prev, prev);
+        len += VectorLength(prev);
+        VectorCopy(points[i], prev);
+    }
+    ASSERT_TRUE(through_hole);
+    /* Any-angle: close to the two straight legs through the hole (~1650) */
+    ASSERT_TRUE(len < 1900.0f);
+
+    /* Nothing to plan to outside the map */
+    ASSERT_EQ(BotNavFly_Plan(from, far_away, points, BOT_FLY_MAX_POINTS), 0);
+
+    /* A Wraith follows the octree instead of the graph */
+    bs = test_nav_bot();
+    bs->team        = TEAM_ALIEN;
+    bs->gloom_class = GLOOM_CLASS_WRAITH;
+    VectorCopy(from, bs->ent->s.origin);
+    BotNav_FindPath(bs, to);
+    ASSERT_EQ(bs->nav.fly_count, n);
+    ASSERT_FALSE(bs->nav.path_valid);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_TRUE(DotProduct(bs->ent->velocity, points[0]) -
+                DotProduct(bs->ent->velocity, from) > 0.0f);
+    VectorCopy(points[0], bs->ent->s.origin);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.fly_index, 1);
+    BotNav_ClearPath(bs);
+    ASSERT_EQ(bs->nav.fly_count, 0);
+
+    /* Blocked in flight by something the octree never saw: take the graph */
+    Node_Clear();
+    i = Node_Add(from, NAV_GROUND);
+    n = Node_Add(to, NAV_GROUND);
+    Node_Connect(i, n, 600.0f, NAV_MOVE_FLY);
+    VectorCopy(from, bs->ent->s.origin);
+    BotNav_FindPath(bs, to);
+    ASSERT_TRUE(bs->nav.fly_count > 0);
+    VectorCopy(bs->nav.fly_points[0], bs->ent->s.origin);
+    BotNav_MoveTowardGoal(bs);
+    ASSERT_EQ(bs->nav.current_node, i);             /* tracked in flight */
+    for (frames = 0; frames < 100 && bs->nav.fly_count > 0; frames++) {
+        BotNav_MoveTowardGoal(bs);
+        level.time += 0.1f;
+    }
+    ASSERT_EQ(bs->nav.fly_count, 0);
+    ASSERT_TRUE(bs->nav.path_valid);
+    ASSERT_EQ(BotPath_Node(bs->nav.path_handle, 1), n);
+    BotNav_ClearPath(bs);
+    Node_Clear();
+
+    mock_print_len = 0;
+    memset(mock_print_buf, 0, sizeof(mock_print_buf));
+    BotNavFly_PrintStats();
+    ASSERT_NOT_NULL(strstr(mock_print_buf, "Fly octree: ready"));
+
+    BotNavFly_Clear();
+    gi.trace         = mock_trace;
+    gi.pointcontents = mock_pointcontents;
+}
+
+#include "bot_bsp.h"
+#include "bot_pool.h"
+
+/*
+ * A minimal IBSP v38 file: one solid brush x 0..64, y and z -64..64,
+ * under two nodes on x = 0 and x = 64.
+ */
+static int test_bsp_put(byte *buf, int at, int v)
+{
+    buf[at]     = (byte)v;
+    buf[at + 1] = (byte)(v >> 8);
+    buf[at + 2] = (byte)(v >> 16);
+    buf[at + 3] = (byte)(v >> 24);
+    return at + 4;
+}
+
+static int test_bsp_putf(byte *buf, int at, float f)
+{
+    union { float f; int i; } u;
+
+    u.f = f;
+    return test_bsp_put(buf, at, u.i);
+}
+
+static int test_bsp_put16(byte *buf, int at, int v)
+{
+    buf[at]     = (byte)v;
+    buf[at + 1] = (byte)(v >> 8);
+    return at + 2;
+}
+
+#define TEST_BSP_ENTITIES "{\n\"classname\" \"worldspawn\"\n}\n"
+
+static qboolean test_bsp_write(const char *path, int version)
+{
+    static const float planes[7][5] = {
+        {  1, 0, 0,  0, 0 }, {  1, 0, 0, 64, 0 }, { -1, 0, 0,  0, 3 },
+        {  0, 1, 0, 64, 1 }, {  0, -1, 0, 64, 4 },
+        {  0, 0, 1, 64, 2 }, {  0, 0, -1, 64, 5 }
+    };
+    byte  buf[1024];
+    int   lump_at[19], lump_len[19], at = 8 + 19 * 8, i, start;
+    FILE *f;
+
+    memset(buf, 0, sizeof(buf));
+    memset(lump_at, 0, sizeof(lump_at));
+    memset(lump_len, 0, sizeof(lump_len));
+
+    start = at;                                      /* 1: planes */
+    for (i = 0; i < 7; i++) {
+        at = test_bsp_putf(buf, at, planes[i][0]);
+        at = test_bsp_putf(buf, at, planes[i][1]);
+        at = test_bsp_putf(buf, at, planes[i][2]);
+        at = test_bsp_putf(buf, at, planes[i][3]);
+        at = test_bsp_put(buf, at, (int)planes[i][4]);
+    }
+    lump_at[1] = start; lump_len[1] = at - start;
+
+    start = at;                                      /* 4: nodes */
+    at = test_bsp_put(buf, at, 0);
+    at = test_bsp_put(buf, at, 1);
+    at = test_bsp_put(buf, at, -1);
+    at += 16;
+    at = test_bsp_put(buf, at, 1);
+    at = test_bsp_put(buf, at, -2);
+    at = test_bsp_put(buf, at, -3);
+    at += 16;
+    lump_at[4] = start; lump_len[4] = at - start;
+
+    start = at;                                      /* 5: texinfo */
+    at += 32;
+    at = test_bsp_put(buf, at, 0);
+    at = test_bsp_put(buf, at, 0);
+    memcpy(buf + at, "test/wall", 9);
+    at += 36;
+    lump_at[5] = start; lump_len[5] = at - start;
+
+    start = at;                                      /* 8: leafs */
+    for (i = 0; i < 3; i++) {
+        at = test_bsp_put(buf, at, i == 2 ? CONTENTS_SOLID : 0);
+        at += 20;
+        at = test_bsp_put16(buf, at, 0);
+        at = test_bsp_put16(buf, at, i == 2 ? 1 : 0);
+    }
+    lump_at[8] = start; lump_len[8] = at - start;
+
+    start = at;                                      /* 10: leaf brushes */
+    at = test_bsp_put16(buf, at, 0);
+    lump_at[10] = start; lump_len[10] = at - start;
+
+    start = at;                                      /* 13: models */
+    for (i = 0; i < 3; i++)
+        at = test_bsp_putf(buf, at, -512.0f);
+    for (i = 0; i < 3; i++)
+        at = test_bsp_putf(buf, at, 512.0f);
+    at += 12;
+    at = test_bsp_put(buf, at, 0);
+    at += 8;
+    lump_at[13] = start; lump_len[13] = at - start;
+
+    start = at;                                      /* 14: brushes */
+    at = test_bsp_put(buf, at, 0);
+    at = test_bsp_put(buf, at, 6);
+    at = test_bsp_put(buf, at, CONTENTS_SOLID);
+    lump_at[14] = start; lump_len[14] = at - start;
+
+    start = at;                                      /* 15: brush sides */
+    for (i = 1; i < 7; i++) {
+        at = test_bsp_put16(buf, at, i);
+        at = test_bsp_put16(buf, at, 0);
+    }
+    lump_at[15] = start; lump_len[15] = at - start;
+
+    start = at;                                      /* 0: entities */
+    memcpy(buf + at, TEST_BSP_ENTITIES, sizeof(TEST_BSP_ENTITIES) - 1);
+    at += (int)sizeof(TEST_BSP_ENTITIES) - 1;
+    lump_at[0] = start; lump_len[0] = at - start;
+
+    test_bsp_put(buf, 0, BSP_IDENT);
+    test_bsp_put(buf, 4, version);
+    for (i = 0; i < 19; i++) {
+        test_bsp_put(buf, 8 + i * 8, lump_len[i] ? lump_at[i] : at);
+        test_bsp_put(buf, 12 + i * 8, lump_len[i]);
+    }
+
+    f = fopen(path, "wb");
+    if (!f)
+        return false;
+    fwrite(buf, 1, (size_t)at, f);
+    fclose(f);
+    return true;
+}
+
+TEST(test_bsp_trace_clips_brushes)
+{
+    static const vec3_t zero = { 0, 0, 0 };
+    vec3_t       lo = { -16, -16, -16 }, hi = { 16, 16, 16 };
+    vec3_t       a = { -100, 0, 0 }, b = { 100, 0, 0 }, p;
+    bsp_map_t    map;
+    bsp_tracer_t t;
+    trace_t      tr;
+    char         err[256];
+
+    ASSERT_TRUE(test_bsp_write("bot_test.bsp", 37));
+    ASSERT_FALSE(Bsp_Load("bot_test.bsp", &map, err, sizeof(err)));
+    ASSERT_NOT_NULL(strstr(err, "version 37"));
+    ASSERT_FALSE(Bsp_Load("bot_test_missing.bsp", &map, err, sizeof(err)));
+
+    ASSERT_TRUE(test_bsp_write("bot_test.bsp", BSP_VERSION));
+    ASSERT_TRUE(Bsp_Load("bot_test.bsp", &map, err, sizeof(err)));
+    ASSERT_EQ(map.num_brushes, 1);
+    ASSERT_STR_EQ(map.entities, TEST_BSP_ENTITIES);
+    ASSERT_TRUE(Bsp_TracerInit(&t, &map));
+
+    /* A point stops just short of the x = 0 face */
+    tr = Bsp_Trace(&t, a, zero, zero, b, MASK_SOLID);
+    ASSERT_TRUE(tr.fraction < 0.5f && tr.fraction > 0.499f);
+    ASSERT_TRUE(tr.plane.normal[0] == -1.0f);
+    ASSERT_STR_EQ(tr.surface->name, "test/wall");
+    ASSERT_EQ(tr.contents, CONTENTS_SOLID);
+
+    /* A box stops its half-width earlier */
+    tr = Bsp_Trace(&t, a, lo, hi, b, MASK_SOLID);
+    ASSERT_TRUE(tr.endpos[0] < -16.0f && tr.endpos[0] > -16.1f);
+    ASSERT_FALSE(tr.startsolid);
+
+    /* Past the brush's side: clear for a point, clipped for a box */
+    a[1] = b[1] = 72.0f;
+    tr = Bsp_Trace(&t, a, zero, zero, b, MASK_SOLID);
+    ASSERT_TRUE(tr.fraction == 1.0f);
+    ASSERT_TRUE(tr.surface != NULL);
+    tr = Bsp_Trace(&t, a, lo, hi, b, MASK_SOLID);
+    ASSERT_TRUE(tr.fraction < 0.5f);
+
+    /* Masks and position tests */
+    a[1] = b[1] = 0.0f;
+    tr = Bsp_Trace(&t, a, zero, zero, b, MASK_WATER);
+    ASSERT_TRUE(tr.fraction == 1.0f);
+    VectorSet(p, 32, 0, 0);
+    tr = Bsp_Trace(&t, p, lo, hi, p, MASK_SOLID);
+    ASSERT_TRUE(tr.startsolid && tr.allsolid);
+    VectorSet(p, -17, 0, 0);
+    tr = Bsp_Trace(&t, p, lo, hi, p, MASK_SOLID);
+    ASSERT_FALSE(tr.startsolid);
+    VectorSet(p, -15, 0, 0);
+    tr = Bsp_Trace(&t, p, lo, hi, p, MASK_SOLID);
+    ASSERT_TRUE(tr.startsolid);
+
+    VectorSet(p, 32, 0, 0);
+    ASSERT_EQ(Bsp_PointContents(&map, p), CONTENTS_SOLID);
+    VectorSet(p, -32, 0, 0);
+    ASSERT_EQ(Bsp_PointContents(&map, p), 0);
+
+    Bsp_TracerFree(&t);
+    Bsp_Free(&map);
+    remove("bot_test.bsp");
+}
+
+static int s_pool_hits[10000];
+static int s_pool_largest[4];
+
+/* Runs on pool threads: record only, assert afterwards */
+static void test_pool_job(void *ctx, int worker, int begin, int end)
+{
+    int i;
+
+    (void)ctx;
+    if (end - begin > s_pool_largest[worker])
+        s_pool_largest[worker] = end - begin;
+    for (i = begin; i < end; i++)
+        s_pool_hits[i]++;
+}
+
+TEST(test_pool_runs_every_index_once)
+{
+    int i, bad = 0;
+
+    memset(s_pool_hits, 0, sizeof(s_pool_hits));
+    memset(s_pool_largest, 0, sizeof(s_pool_largest));
+    BotPool_Run(10000, 4, 7, test_pool_job, NULL);
+    for (i = 0; i < 10000; i++)
+        bad += s_pool_hits[i] != 1;
+    ASSERT_EQ(bad, 0);
+    for (i = 0; i < 4; i++)
+        ASSERT_TRUE(s_pool_largest[i] <= 7);
+
+    /* More workers than indices, and a single worker */
+    memset(s_pool_hits, 0, sizeof(s_pool_hits));
+    BotPool_Run(3, 4, 7, test_pool_job, NULL);
+    BotPool_Run(5, 1, 7, test_pool_job, NULL);
+    ASSERT_EQ(s_pool_hits[0], 2);
+    ASSERT_EQ(s_pool_hits[4], 1);
+    ASSERT_EQ(s_pool_hits[5], 0);
+    ASSERT_TRUE(BotPool_DefaultWorkers() >= 1);
+}
+TEST(test_nav_packed_graph_matches_float)
+{
+    int              path[BOT_MAX_PATH_NODES];
+    int              packed[BOT_MAX_PATH_NODES];
+    int              generic[BOT_MAX_PATH_NODES];
+    const navpack_t *pack;
+    unsigned int     caps, expanded = 0;
+    vec3_t           org;
+    int              i, j, k, q, len, plen, edges;
+
+    ASSERT_EQ((int)sizeof(navpack_node_t), 8);
+    ASSERT_EQ((int)sizeof(navpack_edge_t), 4);
+
+    test_nav_mixed_grid();
+    for (i = 0; i < 576; i++)
+        nav_nodes[i].origin[2] = (i * 37 % 97) * 0.77f;
+    nav_graph_version++;
+
+    /* Every origin, link, move type and cost decodes to within half a step */
+    pack = BotNavPack_Get();
+    ASSERT_EQ(pack->count, nav_node_count);
+    for (i = 0; i < 576; i++) {
+        const nav_node_t *n = &nav_nodes[i];
+
+        BotNavPack_Origin(pack, i, org);
+        for (k = 0; k < 3; k++)
+            ASSERT_TRUE(fabsf(org[k] - n->origin[k]) <=
+                        pack->origin_scale * 0.5f + 0.001f);
+        edges = pack->nodes[i + 1].first_edge - pack->nodes[i].first_edge;
+        ASSERT_EQ(edges, n->num_neighbors);
+        for (j = 0; j < edges; j++) {
+            const navpack_edge_t *e = &pack->edges[pack->nodes[i].first_edge + j];
+
+            ASSERT_EQ(e->link & NAVPACK_ID_MASK, n->neighbors[j]);
+            ASSERT_EQ(e->link >> NAVPACK_ID_BITS, n->movement_required[j]);
+            ASSERT_TRUE(fabsf(BotNavPack_Cost(pack, e) - n->neighbor_costs[j]) <=
+                        pack->cost_scale * 0.5f);
+        }
+    }
+
+    /* Same reachability, and routes cost what the float search's do */
+    for (caps = 0; caps <= (NAV_CAP_WALL | NAV_CAP_FLY); caps++) {
+        for (q = 0; q < 40; q++) {
+            int s = (q * 131) % 576, t = (q * 277 + 101) % 576;
+
+            len  = BotNav_Search(s, t, caps, path);
+            plen = BotNavPack_Search(s, t, caps, false, packed, &expanded);
+            ASSERT_EQ(plen > 0, len > 0);
+            ASSERT_EQ(BotNavPack_Search(s, t, caps, true, generic, NULL), plen);
+            ASSERT_EQ(memcmp(generic, packed, sizeof(int) * plen), 0);
+            if (!len || !plen)
+                continue;
+            ASSERT_EQ(packed[0], s);
+            ASSERT_EQ(packed[plen - 1], t);
+            ASSERT_TRUE(test_nav_path_cost(packed, plen, caps) >= 0.0f);
+            ASSERT_TRUE(test_nav_path_cost(packed, plen, caps) <=
+                        test_nav_path_cost(path, len, caps) +
+                        plen * pack->cost_scale + 0.01f);
+        }
+    }
+    ASSERT_TRUE(expanded > 0);
+
+    /* A removed node loses its links and the packed copy follows */
+    Node_Remove(300);
+    pack = BotNavPack_Get();
+    ASSERT_EQ(pack->nodes[301].first_edge, pack->nodes[300].first_edge);
+    for (j = 0; j < pack->nodes[576].first_edge; j++)
+        ASSERT_TRUE((pack->edges[j].link & NAVPACK_ID_MASK) != 300);
+    ASSERT_EQ(BotNavPack_Search(0, 300, 0, false, packed, NULL), 0);
+    ASSERT_TRUE(BotNavPack_Search(0, 575, 0, false, packed, NULL) > 0);
+}
+
+TEST(test_batch_kernels_match_scalar)
+{
+    static float x[103], y[103], z[103], d2[103];
+    static byte  in[103];
+    vec3_t p = { 10.0f, -20.0f, 5.0f };
+    vec3_t dir = { 1.0f, 0.0f, 0.0f };
+    float  cosines[3] = { 0.7071f, 0.0f, -0.5f };   /* 90, 180, 240 deg */
+    float  best_d = 0.0f, got_d = -1.0f;
+    int    count, i, c, n, want;
+
+    for (i = 0; i < 103; i++) {
+        x[i] = (float)((i * 73) % 101) * 7.0f - 350.0f;
+        y[i] = (float)((i * 31) % 89) * 9.0f - 400.0f;
+        z[i] = (float)((i * 17) % 23) * 3.0f;
+    }
+    /* The apex itself is in every cone */
+    x[41] = p[0]; y[41] = p[1]; z[41] = p[2];
+
+    /* Counts on and off the four-wide step */
+    for (count = 0; count <= 103; count += 7) {
+        VectorBatch_DistSq(p, x, y, z, count, d2);
+        want = -1;
+        for (i = 0; i < count; i++) {
+            float dx = x[i] - p[0], dy = y[i] - p[1], dz = z[i] - p[2];
+
+            ASSERT_TRUE(d2[i] == dx * dx + dy * dy + dz * dz);
+            if (want < 0 || d2[i] < best_d) {
+                want   = i;
+                best_d = d2[i];
+            }
+        }
+
+        ASSERT_EQ(VectorBatch_Nearest(p, x, y, z, count, FLT_MAX, &got_d),
+                  want);
+        if (want >= 0)
+            ASSERT_TRUE(got_d == best_d);
+
+        n = VectorBatch_InSphere(p, 200.0f, x, y, z, count, in);
+        for (i = 0, c = 0; i < count; i++) {
+            ASSERT_EQ(in[i], d2[i] <= 200.0f * 200.0f);
+            c += in[i];
+        }
+        ASSERT_EQ(n, c);
+
+        for (c = 0; c < 3; c++) {
+            int k;
+
+            n = VectorBatch_InCone(p, dir, cosines[c], 300.0f, x, y, z,
+                                   count, in);
+            for (i = 0, k = 0; i < count; i++) {
+                float dot = (x[i] - p[0]) * dir[0];
+
+                ASSERT_EQ(in[i], d2[i] <= 300.0f * 300.0f &&
+                                 dot >= cosines[c] * sqrtf(d2[i]));
+                k += in[i];
+            }
+            ASSERT_EQ(n, k);
+            if (count > 41)
+                ASSERT_EQ(in[41], 1);
+        }
+    }
+
+    /* Ties go to the lowest index, even across SSE lanes */
+    for (i = 0; i < 12; i++) {
+        x[i] = (i == 6 || i == 9) ? 1.0f : 50.0f;
+        y[i] = z[i] = 0.0f;
+    }
+    VectorClear(p);
+    ASSERT_EQ(VectorBatch_Nearest(p, x, y, z, 12, FLT_MAX, NULL), 6);
+    x[6] = -1.0f;
+    x[9] = 1.0f;
+    ASSERT_EQ(VectorBatch_Nearest(p, x, y, z, 12, FLT_MAX, NULL), 6);
+
+    /* Only points strictly inside max_dist_sq count */
+    ASSERT_EQ(VectorBatch_Nearest(p, x, y, z, 12, 1.0f, NULL), -1);
+    ASSERT_EQ(VectorBatch_Nearest(p, x, y, z, 12, 1.01f, NULL), 6);
+
+    /* Node_FindNearest through its cached copies: flags, range, edits */
+    test_nav_mixed_grid();
+    {
+        vec3_t q = { 300.0f, 500.0f, 0.0f };
+        int    id = Node_FindNearest(q, 0, 0.0f), id2;
+
+        ASSERT_TRUE(id != BOT_INVALID_NODE);
+        ASSERT_EQ(Node_FindNearest(q, NAV_SNIPE, 0.0f), BOT_INVALID_NODE);
+        ASSERT_EQ(Node_FindNearest(q, 0, 1.0f), BOT_INVALID_NODE);
+
+        id2 = Node_Add(q, NAV_SNIPE);
+        ASSERT_EQ(Node_FindNearest(q, 0, 0.0f), id2);
+        ASSERT_EQ(Node_FindNearest(q, NAV_SNIPE, 1.0f), id2);
+        Node_Remove(id2);
+        ASSERT_EQ(Node_FindNearest(q, 0, 0.0f), id);
+        ASSERT_EQ(Node_FindNearest(q, NAV_SNIPE, 0.0f), BOT_INVALID_NODE);
+    }
+    Node_Clear();
+}
+
+TEST(test_nav_async_load_publishes)
+{
+    test_setup();
+    test_nav_make_maps_dir();
+    test_nav_corridor(3);
+    ASSERT_TRUE(Node_Save("bot_test_async"));
+
+    /* The old graph is dropped at once; the new one appears on poll */
+    BotNav_LoadMap("bot_test_async");
+    ASSERT_EQ(nav_node_count, 0);
+    ASSERT_TRUE(BotNav_WaitLoad());
+    ASSERT_EQ(nav_node_count, 3);
+    ASSERT_EQ(nav_nodes[1].num_neighbors, 2);
+    ASSERT_EQ(Node_PollLoad(), NODE_LOAD_IDLE);
+
+    BotNavCache_Shutdown();
+    remove("maps/bot_test_async.nav");
+    remove("maps/bot_test_async.navc");
+}
+
+TEST(test_nav_async_load_missing_file)
+{
+    test_setup();
+    test_nav_corridor(3);
+
+    BotNav_LoadMap("bot_test_no_such_map");
+    ASSERT_FALSE(BotNav_WaitLoad());
+    ASSERT_EQ(nav_node_count, 0);
+    ASSERT_FALSE(Node_LoadPending());
+}
+
+TEST(test_navcache_components)
+{
+    vec3_t org;
+    int    lone;
+
+    test_setup();
+    test_nav_corridor(3);
+    VectorSet(org, 0, 4096, 0);
+    lone = Node_Add(org, NAV_GROUND);
+
+    ASSERT_TRUE(BotNavCache_Connected(0, 2));
+    ASSERT_FALSE(BotNavCache_Connected(0, lone));
+    ASSERT_EQ(BotNavCache_Get()->component_count, 2);
+
+    /* Linking the islands is picked up without a reload */
+    Node_Connect(2, lone, 128.0f, NAV_MOVE_WALK);
+    ASSERT_TRUE(BotNavCache_Connected(0, lone));
+}
+
+/* Rewrite one field of a .navc file in place */
+static void test_navcache_patch(const char *path, int map_type,
+                                unsigned int schema)
+{
+    nav_derived_t d;
+    FILE *f = fopen(path, "r+b");
+
+    if (!f)
+        return;
+    if (fread(&d, sizeof(d), 1, f) == 1) {
+        d.map_type = map_type;
+        d.schema   = schema;
+        rewind(f);
+        fwrite(&d, sizeof(d), 1, f);
+    }
+    fclose(f);
+}
+
+TEST(test_navcache_sidecar_roundtrip)
+{
+    const char *navc = "maps/bot_test_navc.navc";
+    FILE *f;
+    long  size = 0;
+
+    test_setup();
+    test_nav_make_maps_dir();
+    remove(navc);
+    test_nav_corridor(4);
+    nav_nodes[0].flags |= NAV_CAMP;
+    ASSERT_TRUE(Node_Save("bot_test_navc"));
+
+    /* First load computes and writes the sidecar back */
+    BotNav_LoadMap("bot_test_navc");
+    ASSERT_TRUE(BotNav_WaitLoad());
+    ASSERT_EQ(BotNavCache_Get()->zone_count, 1);
+    ASSERT_EQ(BotNavCache_Get()->nav_hash, nav_graph_hash);
+    BotNavCache_Shutdown();
+    f = fopen(navc, "rb");
+    ASSERT_TRUE(f != NULL);
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        size = ftell(f);
+        fclose(f);
+    }
+    ASSERT_EQ(size, (long)sizeof(nav_derived_t));
+
+    /* A matching key is trusted as-is */
+    test_navcache_patch(navc, MAP_TYPE_TIGHT, NAVC_SCHEMA_VERSION);
+    BotNav_LoadMap("bot_test_navc");
+    ASSERT_TRUE(BotNav_WaitLoad());
+    ASSERT_EQ(BotNavCache_Get()->map_type, MAP_TYPE_TIGHT);
+
+    /* A schema mismatch forces a recompute */
+    BotNavCache_Shutdown();
+    test_navcache_patch(navc, MAP_TYPE_TIGHT, NAVC_SCHEMA_VERSION + 1);
+    BotNav_LoadMap("bot_test_navc");
+    ASSERT_TRUE(BotNav_WaitLoad());
+    ASSERT_EQ(BotNavCache_Get()->map_type, MAP_TYPE_MIXED);
+
+    BotNavCache_Shutdown();
+    Node_Clear();
+    remove(navc);
+    remove("maps/bot_test_navc.nav");
+}
+
+TEST(test_nav_file_unchanged)
+{
+    vec3_t org = { 0, 0, 0 };
+
+    test_setup();
+    test_nav_make_maps_dir();
+    test_nav_corridor(3);
+    ASSERT_TRUE(Node_Save("bot_test_warm"));
+    ASSERT_FALSE(Node_FileUnchanged("bot_test_warm"));   /* not loaded yet */
+
+    BotNav_LoadMap("bot_test_warm");
+    ASSERT_TRUE(BotNav_WaitLoad());
+    ASSERT_TRUE(Node_FileUnchanged("bot_test_warm"));
+    ASSERT_FALSE(Node_FileUnchanged("bot_test_other"));
+
+    /* An in-game edit means the live graph no longer matches the file */
+    Node_Add(org, NAV_GROUND);
+    ASSERT_FALSE(Node_FileUnchanged("bot_test_warm"));
+
+    BotNavCache_Shutdown();
+    Node_Clear();
+    remove("maps/bot_test_warm.nav");
+    remove("maps/bot_test_warm.navc");
+}
+
+/* A grounded human on test edict 1, for feeding the nav learner */
+static edict_t *test_navlearn_human(usercmd_t *cmd)
+{
+    static gclient_t client;
+    edict_t *ent = &test_edicts[1];
+
+    memset(ent, 0, sizeof(*ent));
+    memset(&client, 0, sizeof(client));
+    memset(cmd, 0, sizeof(*cmd));
+    ent->inuse        = true;
+    ent->client       = &client;
+    ent->health       = 100;
+    ent->s.number     = 1;
+    ent->groundentity = &test_edicts[0];
+    client.team       = TEAM_HUMAN;
+    return ent;
+}
+
+static void test_navlearn_step(edict_t *ent, usercmd_t *cmd,
+                               float x, float y, float z)
+{
+    VectorSet(ent->s.origin, x, y, z);
+    level.time += 0.1f;
+    BotNavLearn_Sample(ent, cmd);
+}
+
+TEST(test_navlearn_walk_edge_needs_confirmation)
+{
+    usercmd_t cmd;
+    edict_t  *ent;
+    vec3_t    org;
+
+    test_setup();
+    BotCvars_Init();
+    BotNavLearn_Clear();
+    Node_Clear();
+    VectorSet(org, 0, 0, 0);   Node_Add(org, NAV_GROUND);
+    VectorSet(org, 100, 0, 0); Node_Add(org, NAV_GROUND);
+    ent = test_navlearn_human(&cmd);
+
+    /* There: one sighting is not enough */
+    test_navlearn_step(ent, &cmd, 0, 0, 0);
+    test_navlearn_step(ent, &cmd, 30, 0, 0);
+    test_navlearn_step(ent, &cmd, 100, 0, 0);
+    ASSERT_EQ(BotNavLearn_Pending(), 1);
+    BotNavLearn_Frame();
+    ASSERT_EQ(nav_nodes[0].num_neighbors, 0);
+
+    /* Back is its own candidate, not a second sighting */
+    test_navlearn_step(ent, &cmd, 60, 0, 0);
+    test_navlearn_step(ent, &cmd, 0, 0, 0);
+    ASSERT_EQ(BotNavLearn_Pending(), 2);
+    BotNavLearn_Frame();
+    ASSERT_EQ(nav_nodes[0].num_neighbors, 0);
+
+    /* There again confirms the forward link only */
+    test_navlearn_step(ent, &cmd, 100, 0, 0);
+    BotNavLearn_Frame();
+    ASSERT_EQ(BotNavLearn_Pending(), 1);
+    ASSERT_EQ(BotNavLearn_Merged(), 1);
+    ASSERT_EQ(nav_nodes[0].num_neighbors, 1);
+    ASSERT_EQ(nav_nodes[0].neighbors[0], 1);
+    ASSERT_EQ(nav_nodes[0].movement_required[0], NAV_MOVE_WALK);
+    ASSERT_EQ(nav_nodes[1].num_neighbors, 0);
+
+    /* ...and back again confirms the return */
+    test_navlearn_step(ent, &cmd, 60, 0, 0);
+    test_navlearn_step(ent, &cmd, 0, 0, 0);
+    BotNavLearn_Frame();
+    ASSERT_EQ(BotNavLearn_Pending(), 0);
+    ASSERT_EQ(BotNavLearn_Merged(), 2);
+    ASSERT_EQ(nav_nodes[1].num_neighbors, 1);
+    ASSERT_EQ(nav_nodes[1].neighbors[0], 0);
+
+    /* A known edge is not proposed again */
+    test_navlearn_step(ent, &cmd, 100, 0, 0);
+    ASSERT_EQ(BotNavLearn_Pending(), 0);
+
+    Node_Clear();
+    BotNavLearn_Clear();
+}
+
+TEST(test_navlearn_jump_and_new_nodes)
+{
+    usercmd_t cmd;
+    edict_t  *ent;
+    vec3_t    org;
+    int       pass, i, linked = 0;
+
+    test_setup();
+    BotCvars_Init();
+    BotNavLearn_Clear();
+    Node_Clear();
+    VectorSet(org, 0, 0, 0);   Node_Add(org, NAV_GROUND);
+    VectorSet(org, 200, 0, 0); Node_Add(org, NAV_GROUND);
+    ent = test_navlearn_human(&cmd);
+
+    /* Jump the gap twice; the return trips are walks and stay pending */
+    for (pass = 0; pass < 2; pass++) {
+        test_navlearn_step(ent, &cmd, 0, 0, 0);
+        ent->groundentity = NULL;
+        cmd.upmove = 200;
+        test_navlearn_step(ent, &cmd, 100, 0, 40);
+        ent->groundentity = &test_edicts[0];
+        cmd.upmove = 0;
+        test_navlearn_step(ent, &cmd, 200, 0, 0);
+    }
+    BotNavLearn_Frame();
+    ASSERT_EQ(nav_nodes[0].num_neighbors, 1);
+    ASSERT_EQ(nav_nodes[0].neighbors[0], 1);
+    ASSERT_EQ(nav_nodes[0].movement_required[0], NAV_MOVE_JUMP);
+    ASSERT_EQ(nav_nodes[1].num_neighbors, 0);      /* no jumping back up */
+
+    /* Walking off the graph twice grows new nodes along the way */
+    BotNavLearn_Clear();
+    for (pass = 0; pass < 2; pass++) {
+        test_navlearn_step(ent, &cmd, 200, 0, 0);
+        for (i = 1; i <= 4; i++)
+            test_navlearn_step(ent, &cmd, 200, i * 40.0f, 0);
+    }
+    BotNavLearn_Frame();
+    ASSERT_TRUE(BotNavLearn_Merged() >= 1);
+    ASSERT_TRUE(nav_node_count > 2);
+    for (i = 0; i < nav_nodes[1].num_neighbors; i++) {
+        if (nav_nodes[1].neighbors[i] >= 2)
+            linked++;
+    }
+    ASSERT_EQ(linked, 1);
+
+    Node_Clear();
+    BotNavLearn_Clear();
+}
+
+TEST(test_navlearn_ignores_bots)
+{
+    usercmd_t cmd;
+    edict_t  *ent;
+
+    test_setup();
+    BotCvars_Init();
+    BotNavLearn_Clear();
+    Node_Clear();
+    ent = test_navlearn_human(&cmd);
+    ent->client->is_bot = true;
+
+    test_navlearn_step(ent, &cmd, 0, 0, 0);
+    test_navlearn_step(ent, &cmd, 200, 0, 0);
+    ASSERT_EQ(BotNavLearn_Pending(), 0);
+
+    BotNavLearn_Clear();
+}
+
+#ifndef _WIN32
+TEST(test_navshm_shared_copy_on_write)
+{
+    static nav_node_t bank[MAX_NAV_NODES];
+    nav_shm_t    other, probe;
+    unsigned int hash;
+    struct stat  st;
+
+    test_setup();
+    test_nav_make_maps_dir();
+    test_nav_corridor(3);
+    ASSERT_TRUE(Node_Save("bot_test_shm"));
+
+    ASSERT_TRUE(Node_Load("bot_test_shm"));
+    ASSERT_TRUE(Node_IsShared());
+    hash = nav_graph_hash;
+
+    /* A second server maps the same bank */
+    ASSERT_TRUE(BotNavShm_Open(&other, hash));
+    ASSERT_EQ(BotNavShm_Count(&other), 3);
+    ASSERT_EQ(BotNavShm_Nodes(&other)[1].num_neighbors, 2);
+
+    /* Editing privatizes; the shared bank is untouched */
+    Node_Connect(0, 2, 256.0f, NAV_MOVE_WALK);
+    ASSERT_FALSE(Node_IsShared());
+    ASSERT_EQ(nav_nodes[0].num_neighbors, 2);
+    ASSERT_EQ(BotNavShm_Nodes(&other)[0].num_neighbors, 1);
+
+    /* Only the owner may open it */
+    ASSERT_EQ(fstat(other.fd, &st), 0);
+    ASSERT_EQ((int)(st.st_mode & 0777), 0600);
+
+    /* The last holder unlinks the segment */
+    BotNavShm_Close(&other);
+    ASSERT_FALSE(BotNavShm_Open(&probe, hash));
+
+    /* A segment with a link outside its graph is refused */
+    memcpy(bank, nav_nodes, sizeof(bank));
+    bank[1].neighbors[0] = 3;
+    ASSERT_TRUE(BotNavShm_Create(&other, hash + 1, bank, 3));
+    ASSERT_FALSE(BotNavShm_Open(&probe, hash + 1));
+    bank[1].neighbors[0] = -2;
+    BotNavShm_Close(&other);
+    ASSERT_TRUE(BotNavShm_Create(&other, hash + 1, bank, 3));
+    ASSERT_FALSE(BotNavShm_Open(&probe, hash + 1));
+    BotNavShm_Close(&other);
+
+    Node_Clear();
+    remove("maps/bot_test_shm.nav");
+}
+
+TEST(test_navshm_create_reclaims_stale_segment)
+{
+    static nav_node_t bank[MAX_NAV_NODES];
+    nav_shm_t    owner, probe;
+    unsigned int hash = 0x5ca1ab1e;
+    char         name[64];
+    int          fd;
+
+    test_setup();
+    test_nav_corridor(3);
+    memcpy(bank, nav_nodes, sizeof(bank));
+
+    /* A creator that died right after ftruncate leaves a short segment */
+    Com_sprintf(name, sizeof(name), "/q2gloombot-nav%d-%08x",
+                NAV_SHM_VERSION, hash);
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_TRUE(fd >= 0);
+    ASSERT_EQ(ftruncate(fd, 16), 0);
+    close(fd);
+    ASSERT_FALSE(BotNavShm_Open(&probe, hash));
+
+    /* Nobody holds it, so the next create replaces it */
+    ASSERT_TRUE(BotNavShm_Create(&owner, hash, bank, 3));
+    ASSERT_TRUE(BotNavShm_Open(&probe, hash));
+    ASSERT_EQ(BotNavShm_Count(&probe), 3);
+    BotNavShm_Close(&probe);
+
+    /* A valid segment still held by a server is left alone */
+    ASSERT_FALSE(BotNavShm_Create(&probe, hash, bank, 3));
+    ASSERT_TRUE(BotNavShm_Open(&probe, hash));
+    BotNavShm_Close(&probe);
+    BotNavShm_Close(&owner);
+
+    /* Full size but never given a header: also reclaimed */
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_TRUE(fd >= 0);
+    ASSERT_EQ(ftruncate(fd, (off_t)(sizeof(nav_node_t) * MAX_NAV_NODES + 32)), 0);
+    close(fd);
+    ASSERT_TRUE(BotNavShm_Create(&owner, hash, bank, 3));
+    BotNavShm_Close(&owner);
+    ASSERT_FALSE(BotNavShm_Open(&probe, hash));
+
+    Node_Clear();
+}
+#endif
+
+/* =======================================================================
+   Map Profile Tests
+   ======================================================================= */
+#include "bot_mapprofile.h"
+#include "bot_build.h"
+
+TEST(test_mapprofile_defaults_without_file)
+{
+    test_setup();
+    BotMapProfile_Reset();
+    ASSERT_FALSE(BotMapProfile_Load("bot_test_no_profile"));
+    ASSERT_TRUE(bot_map_profile.strategy_interval == 3.0f);
+    ASSERT_TRUE(bot_map_profile.share_enemy_range_sq == 800.0f * 800.0f);
+    ASSERT_EQ(bot_map_profile.build_len[TEAM_HUMAN], 6);
+    ASSERT_EQ(bot_map_profile.build_len[TEAM_ALIEN], 7);
+    ASSERT_TRUE(bot_map_profile.think_rate == BOT_THINK_RATE);
+}
+
+TEST(test_mapprofile_compiles_file)
+{
+    const char *path = test_game_file("maps/bot_test_aip.aip");
+    bot_state_t bs;
+
+    test_setup();
+    test_write_text(path,
+        "# tight map\n"
+        "strategy_interval 6\n"
+        "help_request_range 1000   // squared on load\n"
+        "rush_trigger 2\n"
+        "class_range stinger 150\n"
+        "build human turret_rocket 2 defense\n"
+        "build human teleporter 1 spawns\n"
+        "rush_trigger 99\n"
+        "nonsense 1\n");
+
+    ASSERT_TRUE(BotMapProfile_Load("bot_test_aip"));
+    ASSERT_TRUE(bot_map_profile.strategy_interval == 6.0f);
+    ASSERT_TRUE(bot_map_profile.help_request_range_sq == 1000.0f * 1000.0f);
+    ASSERT_EQ(bot_map_profile.rush_trigger, 2);     /* 99 is out of range */
+    ASSERT_TRUE(BotConfig_ClassRange(GLOOM_CLASS_STINGER) == 150.0f);
+
+    /* The human order was replaced; the alien default is untouched */
+    ASSERT_EQ(bot_map_profile.build_len[TEAM_HUMAN], 2);
+    ASSERT_EQ(bot_map_profile.build_order[TEAM_HUMAN][0].type, STRUCT_TURRET_ROCKET);
+    ASSERT_EQ(bot_map_profile.build_order[TEAM_HUMAN][0].priority, BUILD_PRIORITY_DEFENSE);
+    ASSERT_EQ(bot_map_profile.build_len[TEAM_ALIEN], 7);
+
+    BotBuild_Init();
+    memset(&bs, 0, sizeof(bs));
+    bs.team = TEAM_HUMAN;
+    BotBuild_ChooseNext(&bs);
+    ASSERT_EQ(bs.build.what_to_build, STRUCT_TURRET_ROCKET);
+
+    /* Loading a map without a profile restores the defaults */
+    ASSERT_FALSE(BotMapProfile_Load("bot_test_no_profile"));
+    ASSERT_EQ(bot_map_profile.build_len[TEAM_HUMAN], 6);
+    ASSERT_TRUE(BotConfig_ClassRange(GLOOM_CLASS_STINGER) ==
+                gloom_class_info[GLOOM_CLASS_STINGER].preferred_range);
+
+    remove(path);
+}
+
+/* =======================================================================
+   Log Tests
+   ======================================================================= */
+static int test_count_lines(const char *s, const char *needle)
+{
+    int n = 0;
+
+    while ((s = strstr(s, needle)) != NULL) {
+        n++;
+        s += strlen(needle);
+    }
+    return n;
+}
+
+TEST(test_log_rate_limits_and_folds)
+{
+    int i;
+
+    test_setup();
+    level.time = 10.0f;
+    BotLog_Init();
+
+    /* Identical messages: printed once, then folded */
+    for (i = 0; i < 512; i++)
+        BotLog_Warn("graph full\n");
+    /* Distinct messages: a burst gets through, the rest are dropped */
+    for (i = 0; i < 100; i++)
+        BotLog_Warn("node %d full\n", i);
+
+    ASSERT_EQ(BotLog_Queued(), 1 + (int)BOT_LOG_BURST);
+    ASSERT_EQ(BotLog_Suppressed(), 511 + 100 - (int)BOT_LOG_BURST);
+
+    /* Nothing reaches the console until the frame flush */
+    mock_print_len = 0;
+    memset(mock_print_buf, 0, sizeof(mock_print_buf));
+    BotLog_Flush();
+    ASSERT_EQ(test_count_lines(mock_print_buf, "graph full\n"), 1);
+    ASSERT_EQ(test_count_lines(mock_print_buf, "repeated"), 0);
+
+    /* Summaries come out once the fold window has passed */
+    level.time += BOT_LOG_FOLD_TIME;
+    BotLog_Flush();
+    ASSERT_NOT_NULL(strstr(mock_print_buf, "graph full (repeated 511 times)"));
+    ASSERT_NOT_NULL(strstr(mock_print_buf, "(95 similar messages suppressed)"));
+    ASSERT_EQ(BotLog_Queued(), 0);
+
+    /* The bucket has refilled */
+    BotLog_Warn("node %d full\n", 1000);
+    ASSERT_EQ(BotLog_Queued(), 1);
+    BotLog_Shutdown();
+    ASSERT_NOT_NULL(strstr(mock_print_buf, "node 1000 full"));
+}
+
+TEST(test_log_flush_is_bounded)
+{
+    static bot_log_site_t sites[BOT_LOG_QUEUE + 8];
+    int i;
+
+    test_setup();
+    level.time = 1.0f;
+    BotLog_Init();
+
+    /* Separate sites each get their own bucket */
+    for (i = 0; i < BOT_LOG_QUEUE + 8; i++)
+        BotLog_Site(&sites[i], BOT_LOG_WARN, "site %d\n", i);
+    ASSERT_EQ(BotLog_Queued(), BOT_LOG_QUEUE);
+
+    mock_print_len = 0;
+    memset(mock_print_buf, 0, sizeof(mock_print_buf));
+    BotLog_Flush();
+    ASSERT_EQ(test_count_lines(mock_print_buf, "site "), BOT_LOG_FLUSH_LINES);
+    ASSERT_EQ(BotLog_Queued(), BOT_LOG_QUEUE - BOT_LOG_FLUSH_LINES);
+
+    BotLog_Init();
+}
+
+TEST(test_log_info_leaves_room_for_warnings)
+{
+    static bot_log_site_t sites[BOT_LOG_QUEUE + 8];
+    int i;
+
+    test_setup();
+    level.time = 1.0f;
+    BotLog_Init();
+
+    /* A connect storm fills only the info share of the queue */
+    for (i = 0; i < BOT_LOG_QUEUE + 8; i++)
+        BotLog_Site(&sites[i], BOT_LOG_INFO, "Bot_Connect: 'bot%d'\n", i);
+    ASSERT_EQ(BotLog_Queued(), BOT_LOG_INFO_QUEUE);
+
+    BotLog_Warn("path pool full\n");
+    ASSERT_EQ(BotLog_Queued(), BOT_LOG_INFO_QUEUE + 1);
+
+    mock_print_len = 0;
+    memset(mock_print_buf, 0, sizeof(mock_print_buf));
+    BotLog_Shutdown();
+    ASSERT_NOT_NULL(strstr(mock_print_buf, "path pool full"));
+    BotLog_Init();
+}
+
 /* =======================================================================
    Main
    ======================================================================= */
@@ -1357,6 +3716,10 @@ int main(void)
     RUN_TEST(test_bot_connect_null_entity);
     RUN_TEST(test_bot_connect_max_bots);
     RUN_TEST(test_bot_skill_clamping);
+    RUN_TEST(test_bot_client_pool);
+    RUN_TEST(test_bot_snapshot_file_roundtrip);
+    RUN_TEST(test_bot_snapshot_rejects_bad_header);
+    RUN_TEST(test_bot_mapstart_keeps_bots);
     RUN_TEST(test_bot_think_null_safety);
     RUN_TEST(test_bot_frame_paused);
 
@@ -1414,11 +3777,58 @@ int main(void)
     printf("\nConfig System Tests:\n");
     RUN_TEST(test_config_init_names);
     RUN_TEST(test_config_name_cycling);
+    RUN_TEST(test_config_roster_file_and_reload);
+    RUN_TEST(test_config_skill_profile_and_class_tuning);
+    RUN_TEST(test_config_cvar_file_routes_commands_to_console);
 
     printf("\nAutofill System Tests:\n");
     RUN_TEST(test_autofill_init);
     RUN_TEST(test_autofill_frame_no_crash);
 
+    printf("\nNavigation Tests:\n");
+    RUN_TEST(test_nav_find_path_corridor);
+    RUN_TEST(test_nav_stuck_local_escapes);
+    RUN_TEST(test_nav_stuck_replan_last_resort);
+    RUN_TEST(test_nav_progress_resets_stuck);
+    RUN_TEST(test_nav_lookahead_cuts_walk_corner);
+    RUN_TEST(test_nav_lookahead_stays_off_inner_wall);
+    RUN_TEST(test_nav_lookahead_respects_jump_edge);
+    RUN_TEST(test_nav_path_shared_suffix);
+    RUN_TEST(test_nav_path_pool_compaction);
+    RUN_TEST(test_nav_save_atomic_checksummed);
+    RUN_TEST(test_nav_load_renumbers_for_locality);
+    RUN_TEST(test_nav_text_format_loads_and_roundtrips);
+    RUN_TEST(test_nav_search_profiles_match_generic);
+    RUN_TEST(test_nav_bidir_search_matches_astar);
+    RUN_TEST(test_nav_distance_labels_are_exact);
+    RUN_TEST(test_nav_nearest_structure_labels_track_changes);
+    RUN_TEST(test_nav_fly_octree_plans_around_walls);
+    RUN_TEST(test_bsp_trace_clips_brushes);
+    RUN_TEST(test_pool_runs_every_index_once);
+    RUN_TEST(test_nav_packed_graph_matches_float);
+    RUN_TEST(test_batch_kernels_match_scalar);
+    RUN_TEST(test_nav_async_load_publishes);
+    RUN_TEST(test_nav_async_load_missing_file);
+    RUN_TEST(test_navcache_components);
+    RUN_TEST(test_navcache_sidecar_roundtrip);
+    RUN_TEST(test_nav_file_unchanged);
+    RUN_TEST(test_navlearn_walk_edge_needs_confirmation);
+    RUN_TEST(test_navlearn_jump_and_new_nodes);
+    RUN_TEST(test_navlearn_ignores_bots);
+#ifndef _WIN32
+    RUN_TEST(test_navshm_shared_copy_on_write);
+    RUN_TEST(test_navshm_create_reclaims_stale_segment);
+#endif
+
+    printf("\nMap Profile Tests:\n");
+    RUN_TEST(test_mapprofile_defaults_without_file);
+    RUN_TEST(test_mapprofile_compiles_file);
+
+    printf("\nLog Tests:\n");
+    RUN_TEST(test_log_rate_limits_and_folds);
+    RUN_TEST(test_log_flush_is_bounded);
+    RUN_TEST(test_log_info_leaves_room_for_warnings);
+
     printf("\n=====================\n");
     printf("Results: %d tests, %d passed, %d failed\n",
            tests_run, tests_passed, tests_failed);
@@ -0,0 +1,297 @@
+/*
+ * game_test.c -- tests for the game DLL's edict bookkeeping
+ *
+ * bot_test links the bot code against stubbed G_* helpers, so the real
+ * edict and client slot management in g_main.c is tested here instead:
+ * the real g_main.c is linked with a mock engine and stub Bot_* calls,
+ * and driven through GetGameAPI like the server would.
+ *
+ * Build:  cmake --build . --target game_test
+ * Run:    ./game_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "g_local.h"
+#include "bot.h"
+
+/* -----------------------------------------------------------------------
+   Minimal test framework (as in bot_test.c)
+   ----------------------------------------------------------------------- */
+static int tests_run    = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void name(void)
+
+#define ASSERT_TRUE(expr) do { \
+    tests_run++; \
+    if (expr) { tests_passed++; } \
+    else { tests_failed++; \
+        printf("  FAIL: %s:%d: %s\n", __FILE__, __LINE__, #expr); } \
+} while (0)
+
+#define ASSERT_FALSE(expr)      ASSERT_TRUE(!(expr))
+#define ASSERT_EQ(a, b)         ASSERT_TRUE((a) == (b))
+#define ASSERT_NE(a, b)         ASSERT_TRUE((a) != (b))
+#define ASSERT_NULL(ptr)        ASSERT_TRUE((ptr) == NULL)
+#define ASSERT_NOT_NULL(ptr)    ASSERT_TRUE((ptr) != NULL)
+
+#define RUN_TEST(name) do { \
+    printf("  Running: %s\n", #name); \
+    name(); \
+} while (0)
+
+/* -----------------------------------------------------------------------
+   Mock engine
+   ----------------------------------------------------------------------- */
+static cvar_t mock_maxclients_cvar  = { "maxclients",  "4",    NULL, 0, false, 4.0f,    NULL };
+static cvar_t mock_maxentities_cvar = { "maxentities", "1024", NULL, 0, false, 1024.0f, NULL };
+static cvar_t mock_other_cvar       = { "other",       "0",    NULL, 0, false, 0.0f,    NULL };
+
+static void mock_dprintf(char *fmt, ...)
+{
+    (void)fmt;
+}
+
+static void mock_error(char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    exit(1);
+}
+
+static void *mock_TagMalloc(int size, int tag)
+{
+    (void)tag;
+    return calloc(1, (size_t)size);
+}
+
+static void mock_FreeTags(int tag)
+{
+    (void)tag;
+}
+
+static cvar_t *mock_cvar(char *var_name, char *value, int flags)
+{
+    (void)value; (void)flags;
+    if (strcmp(var_name, "maxclients") == 0) return &mock_maxclients_cvar;
+    if (strcmp(var_name, "maxentities") == 0) return &mock_maxentities_cvar;
+    return &mock_other_cvar;
+}
+
+static void mock_unlinkentity(edict_t *ent)
+{
+    (void)ent;
+}
+
+/* -----------------------------------------------------------------------
+   Bot subsystem stubs (g_main.c calls these)
+   ----------------------------------------------------------------------- */
+void     Bot_Init(void) {}
+void     Bot_Shutdown(void) {}
+void     Bot_MapStart(const char *mapname) { (void)mapname; }
+void     Bot_Disconnect(edict_t *ent) { G_FreeClientSlot(ent); }
+void     Bot_Frame(void) {}
+void     Bot_ClientThink(edict_t *ent, usercmd_t *cmd) { (void)ent; (void)cmd; }
+qboolean Bot_WriteSnapshot(const char *filename) { (void)filename; return true; }
+qboolean Bot_ReadSnapshot(const char *filename) { (void)filename; return true; }
+qboolean Bot_ServerCommand(void) { return false; }
+
+/* -----------------------------------------------------------------------
+   Helpers
+   ----------------------------------------------------------------------- */
+static game_export_t *ge;
+
+/* Load the "DLL" and start a map with the given limits */
+static void test_start(int clients, int entities)
+{
+    game_import_t import;
+
+    memset(&import, 0, sizeof(import));
+    import.dprintf      = mock_dprintf;
+    import.error        = mock_error;
+    import.TagMalloc    = mock_TagMalloc;
+    import.FreeTags     = mock_FreeTags;
+    import.cvar         = mock_cvar;
+    import.unlinkentity = mock_unlinkentity;
+
+    mock_maxclients_cvar.value  = (float)clients;
+    mock_maxentities_cvar.value = (float)entities;
+
+    ge = GetGameAPI(&import);
+    ge->Init();
+    ge->SpawnEntities("test", "", "");
+}
+
+static void test_finish(void)
+{
+    ge->Shutdown();
+}
+
+static int test_num(const edict_t *e)
+{
+    return (int)(e - g_edicts);
+}
+
+/* -----------------------------------------------------------------------
+   Free edict queue
+   ----------------------------------------------------------------------- */
+TEST(test_free_queue_reuse_delay)
+{
+    edict_t *a, *b, *c;
+    int      top;
+
+    test_start(4, 64);
+
+    /* Edicts freed in the first two seconds come straight back */
+    level.time = 1.0f;
+    a = G_Spawn();
+    ASSERT_EQ(test_num(a), 5);
+    G_FreeEdict(a);
+    ASSERT_TRUE(G_Spawn() == a);
+
+    /* Later ones wait EDICT_REUSE_DELAY (0.5 s) */
+    level.time = 10.0f;
+    G_FreeEdict(a);
+    top = ge->num_edicts;
+    level.time = 10.4f;
+    b = G_Spawn();
+    ASSERT_NE(b, a);
+    ASSERT_EQ(ge->num_edicts, top + 1);
+    level.time = 10.6f;
+    ASSERT_TRUE(G_Spawn() == a);
+
+    /* Oldest first */
+    level.time = 20.0f;
+    G_FreeEdict(b);
+    level.time = 20.1f;
+    G_FreeEdict(a);
+    level.time = 21.0f;
+    c = G_Spawn();
+    ASSERT_TRUE(c == b);
+    ASSERT_TRUE(G_Spawn() == a);
+    ASSERT_EQ(ge->num_edicts, top + 1);
+
+    /* A queued edict brought back into use elsewhere is skipped */
+    level.time = 30.0f;
+    G_FreeEdict(a);
+    G_FreeEdict(b);
+    G_InitEdict(a);
+    level.time = 31.0f;
+    ASSERT_TRUE(G_Spawn() == b);
+
+    test_finish();
+}
+
+TEST(test_free_queue_holds_maxentities)
+{
+    static edict_t *spawned[1800];
+    int             i, top, first;
+
+    /* maxentities above MAX_EDICTS: every free must still be queued */
+    test_start(4, 2048);
+    ASSERT_EQ(ge->max_edicts, 2048);
+
+    level.time = 5.0f;
+    for (i = 0; i < 1800; i++)
+        spawned[i] = G_Spawn();
+    first = test_num(spawned[0]);
+    top   = ge->num_edicts;
+    ASSERT_EQ(top, first + 1800);
+    for (i = 0; i < 1800; i++)
+        G_FreeEdict(spawned[i]);
+
+    level.time = 6.0f;
+    for (i = 0; i < 1800; i++)
+        ASSERT_TRUE(G_Spawn() == spawned[i]);
+    ASSERT_EQ(ge->num_edicts, top);
+
+    test_finish();
+}
+
+/* -----------------------------------------------------------------------
+   Client slots
+   ----------------------------------------------------------------------- */
+TEST(test_client_slots_top_down)
+{
+    edict_t *e;
+
+    test_start(4, 64);
+
+    /* Bots fill from maxclients down, away from the engine's humans */
+    ASSERT_EQ(test_num(G_AllocClientSlot()), 4);
+    e = G_AllocClientSlot();
+    ASSERT_EQ(test_num(e), 3);
+
+    /* A freed slot is the next one handed out */
+    G_FreeClientSlot(e);
+    ASSERT_TRUE(G_AllocClientSlot() == e);
+
+    /* A slot a human took in the meantime is passed over */
+    ge->ClientConnect(&g_edicts[2], "");
+    ge->ClientBegin(&g_edicts[2]);
+    ASSERT_EQ(test_num(G_AllocClientSlot()), 1);
+    ASSERT_NULL(G_AllocClientSlot());
+
+    test_finish();
+}
+
+TEST(test_client_slot_reservation)
+{
+    edict_t *human = NULL;
+
+    test_start(4, 64);
+    level.time = 10.0f;
+
+    /* A connecting human holds its slot before ClientBegin */
+    human = &g_edicts[4];
+    ASSERT_TRUE(ge->ClientConnect(human, ""));
+    ASSERT_EQ(test_num(G_AllocClientSlot()), 3);
+    ASSERT_EQ(test_num(G_AllocClientSlot()), 2);
+
+    /* ... for CLIENT_RESERVE_TIME (90 s), in case it never arrives */
+    level.time = 99.0f;
+    ASSERT_EQ(test_num(G_AllocClientSlot()), 1);
+    ASSERT_NULL(G_AllocClientSlot());
+    level.time = 100.5f;
+    ASSERT_TRUE(G_AllocClientSlot() == human);
+
+    /* A disconnect drops the reservation at once */
+    G_FreeClientSlot(human);
+    level.time = 200.0f;
+    ASSERT_TRUE(ge->ClientConnect(human, ""));
+    ASSERT_NULL(G_AllocClientSlot());
+    ge->ClientDisconnect(human);
+    ASSERT_TRUE(G_AllocClientSlot() == human);
+
+    test_finish();
+}
+
+/* =======================================================================
+   Main
+   ======================================================================= */
+int main(void)
+{
+    printf("q2gloombot Game Test Suite\n");
+    printf("==========================\n\n");
+
+    printf("Edict Tests:\n");
+    RUN_TEST(test_free_queue_reuse_delay);
+    RUN_TEST(test_free_queue_holds_maxentities);
+
+    printf("\nClient Slot Tests:\n");
+    RUN_TEST(test_client_slots_top_down);
+    RUN_TEST(test_client_slot_reservation);
+
+    printf("\n==========================\n");
+    printf("Results: %d tests, %d passed, %d failed\n",
+           tests_run, tests_passed, tests_failed);
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,815 @@
+/*
+ * gamehost.c -- engine stand-in for end-to-end bot benchmarks
+ *
+ * bot_test links the bot sources straight in with mocked gi.* calls, so
+ * it never crosses the real DLL boundary or touches real map collision.
+ * gamehost loads the built game library the way the server does
+ * (dlopen + GetGameAPI), hands it a game_import_t whose traces run
+ * against a compiled map (bot_bsp.h), adds bots through "sv addbot" and
+ * times RunFrame.  No network, no clients, no renderer.
+ *
+ *   gamehost <game.so> <map.bsp> [frames] [bots] [+set <cvar> <value>]...
+ *
+ * frames defaults to 600 (one minute of server time), bots to the game's
+ * MAX_BOTS (read from its exported bot_max_bots), which is also the most
+ * it will add.  The game reads
+ * maps/<map>.nav relative to the working directory, so run this from the
+ * game directory.
+ *
+ * What the stand-in does not do:
+ *   - Brush entities (doors, lifts) are not solid; only the world model
+ *     is loaded.  Linked bounding-box edicts are clipped against.
+ *   - There is no PVS: inPVS and inPHS are always true.
+ *   - Pmove does nothing and no usercmds are run, so bots stand where
+ *     they are put.  This game does not spawn players yet either, so
+ *     each bot is dropped on a random floor after it is added.
+ *   - gi.error prints and exits rather than dropping to the console.
+ *
+ * POSIX only (dlopen, clock_gettime).  Not part of the game DLL.
+ */
+
+#include "q_shared.h"
+#include "game.h"
+#include "bot_bsp.h"
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HOST_FRAMES      600
+#define HOST_MAX_ARGS    16
+#define HOST_CMD_BUF     8192
+#define HOST_PLACE_TRIES 4096
+
+#define EDICT_NUM(n) \
+    ((edict_t *)((byte *)s_ge->edicts + s_ge->edict_size * (n)))
+
+static game_export_t *s_ge;
+static bsp_map_t      s_map;
+static bsp_tracer_t   s_tracer;
+static byte          *s_linked;     /* per edict; set while linked */
+static cvar_t        *s_cvars;
+
+static int   s_argc;
+static char  s_argv_buf[HOST_MAX_ARGS][MAX_TOKEN_CHARS];
+static char  s_args[HOST_CMD_BUF];
+static char  s_cmd_text[HOST_CMD_BUF];
+static int   s_cmd_len;
+
+static unsigned int s_seed = 1;
+
+/* Wall-clock seconds */
+static double Seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Deterministic, so two runs place bots on the same floors */
+static float Random(void)
+{
+    s_seed = s_seed * 1103515245u + 12345u;
+    return (float)((s_seed >> 8) & 0xFFFF) / 65536.0f;
+}
+
+static char *CopyString(const char *s)
+{
+    char *out = malloc(strlen(s) + 1);
+
+    if (!out) {
+        fprintf(stderr, "gamehost: out of memory\n");
+        exit(1);
+    }
+    strcpy(out, s);
+    return out;
+}
+
+/* -----------------------------------------------------------------------
+   Printing
+   ----------------------------------------------------------------------- */
+
+static void PF_bprintf(int printlevel, char *fmt, ...)
+{
+    va_list ap;
+
+    (void)printlevel;
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+}
+
+static void PF_dprintf(char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+}
+
+static void PF_cprintf(edict_t *ent, int printlevel, char *fmt, ...)
+{
+    va_list ap;
+
+    (void)ent; (void)printlevel;
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+}
+
+static void PF_centerprintf(edict_t *ent, char *fmt, ...)
+{
+    (void)ent; (void)fmt;
+}
+
+static void PF_error(char *fmt, ...)
+{
+    va_list ap;
+
+    fprintf(stderr, "gamehost: game error: ");
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+/* -----------------------------------------------------------------------
+   Sound, models and network messages: accepted and dropped
+   ----------------------------------------------------------------------- */
+
+static void PF_sound(edict_t *ent, int channel, int soundindex, float volume,
+                     float attenuation, float timeofs)
+{
+    (void)ent; (void)channel; (void)soundindex;
+    (void)volume; (void)attenuation; (void)timeofs;
+}
+
+static void PF_positioned_sound(vec3_t origin, edict_t *ent, int channel,
+                                int soundindex, float volume,
+                                float attenuation, float timeofs)
+{
+    (void)origin; (void)ent; (void)channel; (void)soundindex;
+    (void)volume; (void)attenuation; (void)timeofs;
+}
+
+static void PF_configstring(int num, char *string)
+{
+    (void)num; (void)string;
+}
+
+static int PF_index(char *name)
+{
+    (void)name;
+    return 0;
+}
+
+static void PF_setmodel(edict_t *ent, char *name)
+{
+    (void)ent; (void)name;
+}
+
+static void PF_multicast(vec3_t origin, multicast_t to)
+{
+    (void)origin; (void)to;
+}
+
+static void PF_unicast(edict_t *ent, qboolean reliable)
+{
+    (void)ent; (void)reliable;
+}
+
+static void PF_WriteInt(int c)       { (void)c; }
+static void PF_WriteFloat(float f)   { (void)f; }
+static void PF_WriteString(char *s)  { (void)s; }
+static void PF_WriteVec(vec3_t v)    { (void)v; }
+
+static void PF_DebugGraph(float value, int color)
+{
+    (void)value; (void)color;
+}
+
+static void PF_Pmove(pmove_t *pm)
+{
+    (void)pm;
+}
+
+/* -----------------------------------------------------------------------
+   Collision: the world from the BSP, plus linked bounding boxes
+   ----------------------------------------------------------------------- */
+
+static void PF_linkentity(edict_t *ent)
+{
+    int n = (int)(((byte *)ent - (byte *)s_ge->edicts) / s_ge->edict_size);
+
+    VectorAdd(ent->s.origin, ent->mins, ent->absmin);
+    VectorAdd(ent->s.origin, ent->maxs, ent->absmax);
+    VectorSubtract(ent->maxs, ent->mins, ent->size);
+    /* Like the server, pad by a unit so touching boxes overlap */
+    ent->absmin[0] -= 1; ent->absmin[1] -= 1; ent->absmin[2] -= 1;
+    ent->absmax[0] += 1; ent->absmax[1] += 1; ent->absmax[2] += 1;
+    ent->linkcount++;
+    s_linked[n] = 1;
+}
+
+static void PF_unlinkentity(edict_t *ent)
+{
+    int n = (int)(((byte *)ent - (byte *)s_ge->edicts) / s_ge->edict_size);
+
+    s_linked[n] = 0;
+}
+
+static int PF_BoxEdicts(vec3_t mins, vec3_t maxs, edict_t **list,
+                        int maxcount, int areatype)
+{
+    int i, count = 0;
+
+    for (i = 1; i < s_ge->num_edicts && count < maxcount; i++) {
+        edict_t *e = EDICT_NUM(i);
+
+        if (!s_linked[i] || !e->inuse)
+            continue;
+        if ((areatype == AREA_TRIGGERS) != (e->solid == SOLID_TRIGGER))
+            continue;
+        if (e->absmin[0] > maxs[0] || e->absmin[1] > maxs[1] ||
+            e->absmin[2] > maxs[2] || e->absmax[0] < mins[0] ||
+            e->absmax[1] < mins[1] || e->absmax[2] < mins[2])
+            continue;
+        list[count++] = e;
+    }
+    return count;
+}
+
+/*
+ * Sweep mins..maxs from start to end against one edict's box, shortening
+ * tr if it is hit first.  The edict's box is grown by the mover's so the
+ * mover can be treated as a point (slab test).
+ */
+static void ClipBox(trace_t *tr, const vec3_t start, const vec3_t mins,
+                    const vec3_t maxs, const vec3_t end, edict_t *e,
+                    int contents)
+{
+    float enter = -1.0f, leave = 1.0f, len;
+    int   axis = -1, side = 0, j;
+    vec3_t lo, hi, delta;
+
+    VectorSubtract(end, start, delta);
+    for (j = 0; j < 3; j++) {
+        float d0, d1, f;
+
+        lo[j] = e->s.origin[j] + e->mins[j] - maxs[j];
+        hi[j] = e->s.origin[j] + e->maxs[j] - mins[j];
+
+        if (delta[j] == 0.0f) {
+            if (start[j] < lo[j] || start[j] > hi[j])
+                return;
+            continue;
+        }
+        d0 = delta[j] > 0.0f ? lo[j] : hi[j];
+        d1 = delta[j] > 0.0f ? hi[j] : lo[j];
+        f  = (d0 - start[j]) / delta[j];
+        if (f > enter) {
+            enter = f;
+            axis  = j;
+            side  = delta[j] > 0.0f ? -1 : 1;
+        }
+        f = (d1 - start[j]) / delta[j];
+        if (f < leave)
+            leave = f;
+    }
+    if (enter > leave || leave < 0.0f)
+        return;
+
+    if (enter < 0.0f) {
+        /* Starts inside the box; only stuck if it never gets out */
+        tr->startsolid = true;
+        tr->ent        = e;
+        if (leave >= 1.0f) {
+            tr->allsolid = true;
+            tr->fraction = 0.0f;
+            VectorCopy(start, tr->endpos);
+            tr->contents = contents;
+        }
+        return;
+    }
+    if (enter >= tr->fraction)
+        return;
+
+    len = VectorLength(delta);
+    enter -= 0.03125f / (len > 0.0f ? len : 1.0f);
+    if (enter < 0.0f)
+        enter = 0.0f;
+    tr->fraction = enter;
+    for (j = 0; j < 3; j++)
+        tr->endpos[j] = start[j] + enter * delta[j];
+    memset(&tr->plane, 0, sizeof(tr->plane));
+    if (axis >= 0) {
+        tr->plane.normal[axis] = (float)side;
+        tr->plane.dist = side * (side < 0 ? lo[axis] : hi[axis]);
+    }
+    tr->contents = contents;
+    tr->ent      = e;
+}
+
+static trace_t PF_trace(vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end,
+                        edict_t *passent, int contentmask)
+{
+    trace_t tr;
+    int     i;
+
+    if (!mins) mins = vec3_origin;
+    if (!maxs) maxs = vec3_origin;
+
+    tr = Bsp_Trace(&s_tracer, start, mins, maxs, end, contentmask);
+    tr.ent = (tr.fraction < 1.0f || tr.startsolid) ? EDICT_NUM(0) : NULL;
+    if (tr.allsolid)
+        return tr;
+
+    for (i = 1; i < s_ge->num_edicts; i++) {
+        edict_t *e = EDICT_NUM(i);
+        int      contents;
+
+        if (!s_linked[i] || !e->inuse || e->solid != SOLID_BBOX)
+            continue;
+        if (e == passent || (passent && (e->owner == passent ||
+                                         passent->owner == e)))
+            continue;
+        contents = (e->svflags & SVF_DEADMONSTER) ? CONTENTS_DEADMONSTER
+                                                  : CONTENTS_MONSTER;
+        if (!(contentmask & contents))
+            continue;
+        ClipBox(&tr, start, mins, maxs, end, e, contents);
+        if (tr.allsolid)
+            break;
+    }
+    return tr;
+}
+
+static int PF_pointcontents(vec3_t point)
+{
+    return Bsp_PointContents(&s_map, point);
+}
+
+static qboolean PF_inPVS(vec3_t p1, vec3_t p2)
+{
+    (void)p1; (void)p2;
+    return true;
+}
+
+static void PF_SetAreaPortalState(int portalnum, qboolean open)
+{
+    (void)portalnum; (void)open;
+}
+
+static qboolean PF_AreasConnected(int area1, int area2)
+{
+    (void)area1; (void)area2;
+    return true;
+}
+
+/* -----------------------------------------------------------------------
+   Tagged memory
+   ----------------------------------------------------------------------- */
+
+typedef struct zhead_s {
+    struct zhead_s *prev, *next;
+    int             tag;
+    int             pad;        /* keeps the block 16-byte aligned on LP64 */
+} zhead_t;
+
+static zhead_t s_zchain = { &s_zchain, &s_zchain, 0, 0 };
+
+static void *PF_TagMalloc(int size, int tag)
+{
+    zhead_t *z = calloc(1, sizeof(zhead_t) + (size_t)(size > 0 ? size : 0));
+
+    if (!z)
+        PF_error("TagMalloc: failed on allocation of %d bytes", size);
+    z->tag  = tag;
+    z->next = s_zchain.next;
+    z->prev = &s_zchain;
+    s_zchain.next->prev = z;
+    s_zchain.next = z;
+    return z + 1;
+}
+
+static void PF_TagFree(void *block)
+{
+    zhead_t *z = (zhead_t *)block - 1;
+
+    z->prev->next = z->next;
+    z->next->prev = z->prev;
+    free(z);
+}
+
+static void PF_FreeTags(int tag)
+{
+    zhead_t *z, *next;
+
+    for (z = s_zchain.next; z != &s_zchain; z = next) {
+        next = z->next;
+        if (z->tag == tag)
+            PF_TagFree(z + 1);
+    }
+}
+
+/* -----------------------------------------------------------------------
+   Cvars
+   ----------------------------------------------------------------------- */
+
+static cvar_t *FindCvar(const char *name)
+{
+    cvar_t *v;
+
+    for (v = s_cvars; v; v = v->next)
+        if (!strcmp(v->name, name))
+            return v;
+    return NULL;
+}
+
+static cvar_t *PF_cvar_set(char *name, char *value)
+{
+    cvar_t *v = FindCvar(name);
+
+    if (!v) {
+        v = calloc(1, sizeof(*v));
+        if (!v)
+            PF_error("cvar: out of memory");
+        v->name   = CopyString(name);
+        v->string = CopyString(value);
+        v->next   = s_cvars;
+        s_cvars   = v;
+    } else if (strcmp(v->string, value)) {
+        free(v->string);
+        v->string = CopyString(value);
+    }
+    v->value    = (float)atof(v->string);
+    v->modified = true;
+    return v;
+}
+
+static cvar_t *PF_cvar(char *name, char *value, int flags)
+{
+    cvar_t *v = FindCvar(name);
+
+    if (!v) {
+        if (!value)
+            return NULL;
+        v = PF_cvar_set(name, value);
+    }
+    v->flags |= flags;
+    return v;
+}
+
+/* -----------------------------------------------------------------------
+   Command arguments and the command buffer
+   ----------------------------------------------------------------------- */
+
+static int PF_argc(void)
+{
+    return s_argc;
+}
+
+static char *PF_argv(int n)
+{
+    static char empty[1];
+
+    return (n >= 0 && n < s_argc) ? s_argv_buf[n] : empty;
+}
+
+static char *PF_args(void)
+{
+    return s_args;
+}
+
+/* Split line into the arguments gi.argc/argv/args hand the game */
+static void TokenizeLine(const char *line)
+{
+    char *p = (char *)line, *tok;
+
+    s_argc    = 0;
+    s_args[0] = '\0';
+    while (s_argc < HOST_MAX_ARGS) {
+        const char *before = p;
+
+        tok = COM_Parse(&p);
+        if (!p && !tok[0])
+            break;
+        if (s_argc == 1) {
+            while (*before && *before <= ' ')
+                before++;
+            Com_sprintf(s_args, sizeof(s_args), "%s", before);
+        }
+        Com_sprintf(s_argv_buf[s_argc++], MAX_TOKEN_CHARS, "%s", tok);
+        if (!p)
+            break;
+    }
+}
+
+/* Like the server, queue console text and run it between frames */
+static void PF_AddCommandString(char *text)
+{
+    int len = (int)strlen(text);
+
+    if (s_cmd_len + len >= HOST_CMD_BUF) {
+        printf("gamehost: command buffer overflow\n");
+        return;
+    }
+    memcpy(s_cmd_text + s_cmd_len, text, (size_t)len);
+    s_cmd_len += len;
+}
+
+static void ExecuteLine(const char *line)
+{
+    TokenizeLine(line);
+    if (s_argc == 0)
+        return;
+
+    if ((!strcmp(s_argv_buf[0], "set") || !strcmp(s_argv_buf[0], "seta")) &&
+        s_argc >= 3) {
+        PF_cvar_set(s_argv_buf[1], s_argv_buf[2]);
+    } else if (!strcmp(s_argv_buf[0], "sv") && s_argc >= 2) {
+        /* The game sees "sv addbot x" as argv(0) = "addbot" */
+        char rest[HOST_CMD_BUF];
+
+        Com_sprintf(rest, sizeof(rest), "%s", s_args);
+        TokenizeLine(rest);
+        s_ge->ServerCommand();
+    } else {
+        printf("gamehost: ignored command '%s'\n", s_argv_buf[0]);
+    }
+}
+
+static void ExecuteCommands(void)
+{
+    char line[HOST_CMD_BUF];
+    int  i, start = 0;
+
+    while (start < s_cmd_len) {
+        for (i = start; i < s_cmd_len && s_cmd_text[i] != '\n' &&
+                        s_cmd_text[i] != ';'; i++)
+            ;
+        memcpy(line, s_cmd_text + start, (size_t)(i - start));
+        line[i - start] = '\0';
+        start = i + 1;
+        ExecuteLine(line);
+    }
+    s_cmd_len = 0;
+}
+
+/* -----------------------------------------------------------------------
+   Setup and the timed run
+   ----------------------------------------------------------------------- */
+
+static void InitImport(game_import_t *gi)
+{
+    memset(gi, 0, sizeof(*gi));
+    gi->bprintf            = PF_bprintf;
+    gi->dprintf            = PF_dprintf;
+    gi->cprintf            = PF_cprintf;
+    gi->centerprintf       = PF_centerprintf;
+    gi->sound              = PF_sound;
+    gi->positioned_sound   = PF_positioned_sound;
+    gi->configstring       = PF_configstring;
+    gi->error              = PF_error;
+    gi->modelindex         = PF_index;
+    gi->soundindex         = PF_index;
+    gi->imageindex         = PF_index;
+    gi->setmodel           = PF_setmodel;
+    gi->trace              = PF_trace;
+    gi->pointcontents      = PF_pointcontents;
+    gi->inPVS              = PF_inPVS;
+    gi->inPHS              = PF_inPVS;
+    gi->SetAreaPortalState = PF_SetAreaPortalState;
+    gi->AreasConnected     = PF_AreasConnected;
+    gi->linkentity         = PF_linkentity;
+    gi->unlinkentity       = PF_unlinkentity;
+    gi->BoxEdicts          = PF_BoxEdicts;
+    gi->Pmove              = PF_Pmove;
+    gi->multicast          = PF_multicast;
+    gi->unicast            = PF_unicast;
+    gi->WriteChar          = PF_WriteInt;
+    gi->WriteByte          = PF_WriteInt;
+    gi->WriteShort         = PF_WriteInt;
+    gi->WriteLong          = PF_WriteInt;
+    gi->WriteFloat         = PF_WriteFloat;
+    gi->WriteString        = PF_WriteString;
+    gi->WritePosition      = PF_WriteVec;
+    gi->WriteDir           = PF_WriteVec;
+    gi->WriteAngle         = PF_WriteFloat;
+    gi->TagMalloc          = PF_TagMalloc;
+    gi->TagFree            = PF_TagFree;
+    gi->FreeTags           = PF_FreeTags;
+    gi->cvar               = PF_cvar;
+    gi->cvar_set           = PF_cvar_set;
+    gi->cvar_forceset      = PF_cvar_set;
+    gi->argc               = PF_argc;
+    gi->argv               = PF_argv;
+    gi->args               = PF_args;
+    gi->AddCommandString   = PF_AddCommandString;
+    gi->DebugGraph         = PF_DebugGraph;
+}
+
+/*
+ * Stand in for player spawning: drop a player hull down random columns
+ * until it lands on walkable floor inside the map.
+ */
+static qboolean PlaceOnFloor(edict_t *e)
+{
+    static vec3_t mins = { -16, -16, -24 }, maxs = { 16, 16, 32 };
+    vec3_t start, end;
+    trace_t tr;
+    int    i, j;
+
+    for (i = 0; i < HOST_PLACE_TRIES; i++) {
+        for (j = 0; j < 3; j++)
+            start[j] = s_map.mins[j] + 32.0f +
+                       Random() * (s_map.maxs[j] - s_map.mins[j] - 64.0f);
+        VectorCopy(start, end);
+        end[2] = s_map.mins[2];
+
+        if (Bsp_PointContents(&s_map, start) & MASK_PLAYERSOLID)
+            continue;
+        tr = Bsp_Trace(&s_tracer, start, mins, maxs, end, MASK_PLAYERSOLID);
+        if (tr.startsolid || tr.fraction == 1.0f || tr.plane.normal[2] < 0.7f)
+            continue;
+
+        VectorCopy(tr.endpos, e->s.origin);
+        VectorCopy(mins, e->mins);
+        VectorCopy(maxs, e->maxs);
+        e->solid    = SOLID_BBOX;
+        e->clipmask = MASK_PLAYERSOLID;
+        PF_linkentity(e);
+        return true;
+    }
+    return false;
+}
+
+static int CompareDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static int Usage(void)
+{
+    fprintf(stderr,
+            "usage: gamehost <game.so> <map.bsp> [frames] [bots] "
+            "[+set <cvar> <value>]...\n");
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    game_export_t *(*get_api)(game_import_t *);
+    game_import_t  import;
+    void          *lib;
+    char           err[256], mapname[MAX_QPATH], libpath[MAX_OSPATH];
+    const char    *base, *dot;
+    double        *times, total = 0.0;
+    const int     *max_bots;
+    int            frames = HOST_FRAMES, bots = -1;
+    int            i, pos = 0, maxclients, placed = 0, added = 0;
+
+    /* Positional arguments first, then +set pairs */
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "+set")) {
+            if (i + 2 >= argc)
+                return Usage();
+            PF_cvar_set(argv[i + 1], argv[i + 2]);
+            i += 2;
+        } else if (pos == 2) {
+            frames = atoi(argv[i]);
+            pos++;
+        } else if (pos == 3) {
+            bots = atoi(argv[i]);
+            pos++;
+        } else if (pos < 2) {
+            pos++;
+        } else {
+            return Usage();
+        }
+    }
+    if (argc < 3 || !strcmp(argv[1], "+set") || !strcmp(argv[2], "+set") ||
+        frames < 1 || (pos > 3 && bots < 0))
+        return Usage();
+
+    if (!Bsp_Load(argv[2], &s_map, err, sizeof(err))) {
+        fprintf(stderr, "gamehost: %s\n", err);
+        return 1;
+    }
+    if (!Bsp_TracerInit(&s_tracer, &s_map)) {
+        fprintf(stderr, "gamehost: out of memory\n");
+        return 1;
+    }
+    base = strrchr(argv[2], '/');
+    base = base ? base + 1 : argv[2];
+    Com_sprintf(mapname, sizeof(mapname), "%s", base);
+    dot = strrchr(mapname, '.');
+    if (dot)
+        mapname[dot - mapname] = '\0';
+
+    /* dlopen searches the library path unless the name has a slash */
+    if (strchr(argv[1], '/'))
+        Com_sprintf(libpath, sizeof(libpath), "%s", argv[1]);
+    else
+        Com_sprintf(libpath, sizeof(libpath), "./%s", argv[1]);
+    lib = dlopen(libpath, RTLD_NOW | RTLD_LOCAL);
+    if (!lib) {
+        fprintf(stderr, "gamehost: %s\n", dlerror());
+        return 1;
+    }
+    *(void **)&get_api = dlsym(lib, "GetGameAPI");
+    if (!get_api) {
+        fprintf(stderr, "gamehost: %s has no GetGameAPI\n", libpath);
+        return 1;
+    }
+
+    /* The bot limit is whatever the library was built with */
+    max_bots = (const int *)dlsym(lib, "bot_max_bots");
+    if (!max_bots) {
+        fprintf(stderr, "gamehost: %s has no bot_max_bots\n", libpath);
+        return 1;
+    }
+    if (bots < 0) {
+        bots = *max_bots;
+    } else if (bots > *max_bots) {
+        printf("gamehost: %d bots requested, the game allows %d\n",
+               bots, *max_bots);
+        bots = *max_bots;
+    }
+
+    InitImport(&import);
+    s_ge = get_api(&import);
+    if (!s_ge || s_ge->apiversion != GAME_API_VERSION) {
+        fprintf(stderr, "gamehost: game API version %d, expected %d\n",
+                s_ge ? s_ge->apiversion : -1, GAME_API_VERSION);
+        return 1;
+    }
+
+    /* Every bot needs a client slot; the engine latches maxclients */
+    if (!FindCvar("maxclients")) {
+        Com_sprintf(err, sizeof(err), "%d", bots > 8 ? bots : 8);
+        PF_cvar_set("maxclients", err);
+    }
+
+    s_ge->Init();
+    s_linked = calloc((size_t)s_ge->max_edicts, 1);
+    times    = malloc(sizeof(double) * (size_t)frames);
+    if (!s_linked || !times) {
+        fprintf(stderr, "gamehost: out of memory\n");
+        return 1;
+    }
+    s_ge->SpawnEntities(mapname, s_map.entities, "");
+
+    /* Add bots through the console, alternating teams */
+    for (i = 0; i < bots; i++) {
+        Com_sprintf(err, sizeof(err), "sv addbot %s\n",
+                    (i & 1) ? "alien" : "human");
+        PF_AddCommandString(err);
+    }
+    ExecuteCommands();
+
+    maxclients = (int)FindCvar("maxclients")->value;
+    for (i = 1; i <= maxclients && i < s_ge->num_edicts; i++) {
+        edict_t *e = EDICT_NUM(i);
+
+        if (!e->inuse || !e->client)
+            continue;
+        added++;
+        if (PlaceOnFloor(e))
+            placed++;
+    }
+    printf("gamehost: %s on %s, %d of %d bots added, %d placed\n",
+           libpath, mapname, added, bots, placed);
+
+    for (i = 0; i < frames; i++) {
+        double t0;
+
+        ExecuteCommands();
+        t0 = Seconds();
+        s_ge->RunFrame();
+        times[i] = (Seconds() - t0) * 1000.0;
+        total += times[i];
+    }
+
+    qsort(times, (size_t)frames, sizeof(double), CompareDouble);
+    printf("gamehost: %d frames, %d bots: mean %.3f ms, p50 %.3f ms, "
+           "p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           frames, added, total / frames,
+           times[frames / 2], times[frames * 9 / 10],
+           times[frames * 99 / 100], times[frames - 1]);
+
+    s_ge->Shutdown();
+    dlclose(lib);
+    free(times);
+    free(s_linked);
+    Bsp_TracerFree(&s_tracer);
+    Bsp_Free(&s_map);
+    return 0;
+}
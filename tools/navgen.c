@@ -0,0 +1,334 @@
+/*
+ * navgen.c -- offline nav generation and visibility for tools/navtool
+ *
+ * See navgen.h.  Every job writes only to its own column, node or
+ * matrix row, so the pool needs no other locking.
+ */
+
+#include "navgen.h"
+#include "bot_pool.h"
+#include <float.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define NAVGEN_FALL_STEP    16.0f    /* step down through solid           */
+#define NAVGEN_MAX_SPACING  1024.0f
+
+static const vec3_t s_hull_mins = { -16, -16, -24 };
+static const vec3_t s_hull_maxs = {  16,  16,  32 };
+static const vec3_t s_point     = {   0,   0,   0 };
+
+static bsp_tracer_t s_tracers[BOT_POOL_MAX_WORKERS];
+
+typedef struct {
+    const bsp_map_t *map;
+    float            spacing;
+    int              nx, ny;
+    vec3_t          *floors;         /* NAVGEN_MAX_FLOORS per column */
+    int             *floor_count;
+    int             *first_node;     /* per column, into bank */
+    nav_node_t      *bank;
+    int              count;
+    const nav_node_t *nodes;         /* visibility */
+    byte            *matrix;
+    int              visible[BOT_POOL_MAX_WORKERS];
+} navgen_job_t;
+
+static qboolean NavGen_InitTracers(const bsp_map_t *map, int workers)
+{
+    int i;
+
+    if (workers > BOT_POOL_MAX_WORKERS)
+        workers = BOT_POOL_MAX_WORKERS;
+
+    for (i = 0; i < workers; i++) {
+        if (!Bsp_TracerInit(&s_tracers[i], map)) {
+            while (--i >= 0)
+                Bsp_TracerFree(&s_tracers[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void NavGen_FreeTracers(int workers)
+{
+    int i;
+
+    if (workers > BOT_POOL_MAX_WORKERS)
+        workers = BOT_POOL_MAX_WORKERS;
+
+    for (i = 0; i < workers; i++)
+        Bsp_TracerFree(&s_tracers[i]);
+}
+
+/* -----------------------------------------------------------------------
+   Floors
+   ----------------------------------------------------------------------- */
+
+/* Drop the hull down each column, recording every floor it stands on */
+static void NavGen_Columns(void *ctx, int worker, int begin, int end)
+{
+    navgen_job_t *job = (navgen_job_t *)ctx;
+    bsp_tracer_t *t   = &s_tracers[worker];
+    int c;
+
+    for (c = begin; c < end; c++) {
+        vec3_t *floors = &job->floors[c * NAVGEN_MAX_FLOORS];
+        vec3_t  start, stop;
+        int     count = 0;
+
+        start[0] = job->map->mins[0] + (c % job->nx + 0.5f) * job->spacing;
+        start[1] = job->map->mins[1] + (c / job->nx + 0.5f) * job->spacing;
+        start[2] = job->map->maxs[2];
+        VectorCopy(start, stop);
+        stop[2] = job->map->mins[2];
+
+        while (count < NAVGEN_MAX_FLOORS && start[2] > stop[2]) {
+            trace_t tr = Bsp_Trace(t, start, s_hull_mins, s_hull_maxs, stop,
+                                   MASK_PLAYERSOLID);
+
+            if (tr.startsolid) {
+                start[2] -= NAVGEN_FALL_STEP;
+                continue;
+            }
+            if (tr.fraction == 1.0f)
+                break;
+            if (tr.plane.normal[2] >= NAVGEN_MIN_NORMAL_Z &&
+                !(Bsp_PointContents(job->map, tr.endpos) & CONTENTS_SOLID)) {
+                VectorCopy(tr.endpos, floors[count]);
+                count++;
+            }
+
+            /* Carry on with the hull's top just under this surface */
+            start[2] = tr.endpos[2] + s_hull_mins[2] - s_hull_maxs[2] - 1.0f;
+        }
+        job->floor_count[c] = count;
+    }
+}
+
+/* -----------------------------------------------------------------------
+   Links
+   ----------------------------------------------------------------------- */
+
+/* True if the hull can get from a to b over a step or jump, with no pit */
+static qboolean NavGen_Reach(bsp_tracer_t *t, const vec3_t a, const vec3_t b)
+{
+    vec3_t  p, q, mid, low;
+    trace_t tr;
+    float   top = (a[2] > b[2] ? a[2] : b[2]) + NAVGEN_STEP;
+    float   floor = (a[2] < b[2] ? a[2] : b[2]);
+
+    VectorCopy(a, p);
+    p[2] = top;
+    tr = Bsp_Trace(t, a, s_hull_mins, s_hull_maxs, p, MASK_PLAYERSOLID);
+    if (tr.fraction < 1.0f || tr.startsolid)
+        return false;
+
+    VectorCopy(b, q);
+    q[2] = top;
+    tr = Bsp_Trace(t, p, s_hull_mins, s_hull_maxs, q, MASK_PLAYERSOLID);
+    if (tr.fraction < 1.0f)
+        return false;
+
+    /* Lands on b, not on something in between */
+    tr = Bsp_Trace(t, q, s_hull_mins, s_hull_maxs, b, MASK_PLAYERSOLID);
+    if (tr.fraction < 1.0f && tr.endpos[2] > b[2] + 1.0f)
+        return false;
+
+    /* Ground under the midpoint: no pit between them */
+    VectorAdd(p, q, mid);
+    VectorScale(mid, 0.5f, mid);
+    VectorCopy(mid, low);
+    low[2] = floor - NAVGEN_JUMP;
+    tr = Bsp_Trace(t, mid, s_hull_mins, s_hull_maxs, low, MASK_PLAYERSOLID);
+    return tr.fraction < 1.0f && tr.endpos[2] >= floor - NAVGEN_STEP;
+}
+
+static void NavGen_Links(void *ctx, int worker, int begin, int end)
+{
+    static const int dirs[8][2] = {
+        { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 },
+        { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+    };
+    navgen_job_t *job = (navgen_job_t *)ctx;
+    bsp_tracer_t *t   = &s_tracers[worker];
+    vec3_t        delta;
+    int           i, d, k;
+
+    for (i = begin; i < end; i++) {
+        nav_node_t *a = &job->bank[i];
+        int         c = (int)((a->origin[0] - job->map->mins[0]) / job->spacing) +
+                        job->nx * (int)((a->origin[1] - job->map->mins[1]) / job->spacing);
+
+        for (d = 0; d < 8; d++) {
+            int   cx = c % job->nx + dirs[d][0], cy = c / job->nx + dirs[d][1];
+            int   n, best = -1;
+            float best_dz = FLT_MAX;
+
+            if (cx < 0 || cy < 0 || cx >= job->nx || cy >= job->ny)
+                continue;
+            n = cx + job->nx * cy;
+
+            for (k = 0; k < job->floor_count[n]; k++) {
+                const nav_node_t *b = &job->bank[job->first_node[n] + k];
+                float dz = b->origin[2] - a->origin[2];
+
+                if (dz > NAVGEN_JUMP || dz < -NAVGEN_DROP ||
+                    fabsf(dz) >= best_dz || !NavGen_Reach(t, a->origin, b->origin))
+                    continue;
+                best    = job->first_node[n] + k;
+                best_dz = fabsf(dz);
+            }
+            if (best < 0)
+                continue;
+
+            k = a->num_neighbors++;
+            a->neighbors[k] = best;
+            a->movement_required[k] =
+                job->bank[best].origin[2] - a->origin[2] > NAVGEN_STEP
+                ? NAV_MOVE_JUMP : NAV_MOVE_WALK;
+            a->edge_caps[k] = Node_MoveCaps(a->movement_required[k]);
+            VectorSubtract(job->bank[best].origin, a->origin, delta);
+            a->neighbor_costs[k] = VectorLength(delta);
+        }
+    }
+}
+
+/* -----------------------------------------------------------------------
+   Public API
+   ----------------------------------------------------------------------- */
+
+int NavGen_Build(const bsp_map_t *map, float *spacing, int workers,
+                 nav_node_t *bank)
+{
+    navgen_job_t job;
+    int          columns = 0, total = 0, c, k, i;
+
+    if (!NavGen_InitTracers(map, workers))
+        return -1;
+    memset(&job, 0, sizeof(job));
+    job.map  = map;
+    job.bank = bank;
+
+    for (job.spacing = *spacing; ; job.spacing *= 1.25f) {
+        if (job.spacing > NAVGEN_MAX_SPACING) {
+            total = -1;
+            break;
+        }
+        job.nx  = (int)ceilf((map->maxs[0] - map->mins[0]) / job.spacing);
+        job.ny  = (int)ceilf((map->maxs[1] - map->mins[1]) / job.spacing);
+        if (job.nx < 1) job.nx = 1;
+        if (job.ny < 1) job.ny = 1;
+        columns = job.nx * job.ny;
+
+        free(job.floors);
+        free(job.floor_count);
+        free(job.first_node);
+        job.floors      = malloc(sizeof(vec3_t) * NAVGEN_MAX_FLOORS * (size_t)columns);
+        job.floor_count = malloc(sizeof(int) * (size_t)columns);
+        job.first_node  = malloc(sizeof(int) * (size_t)columns);
+        if (!job.floors || !job.floor_count || !job.first_node) {
+            total = -1;
+            break;
+        }
+
+        BotPool_Run(columns, workers, 16, NavGen_Columns, &job);
+        for (c = 0, total = 0; c < columns; c++) {
+            job.first_node[c] = total;
+            total += job.floor_count[c];
+        }
+        if (total <= MAX_NAV_NODES)
+            break;
+    }
+
+    if (total > 0) {
+        for (c = 0; c < columns; c++) {
+            for (k = 0; k < job.floor_count[c]; k++) {
+                nav_node_t *n = &bank[job.first_node[c] + k];
+
+                memset(n, 0, sizeof(*n));
+                n->id = n->ext_id = job.first_node[c] + k;
+                VectorCopy(job.floors[c * NAVGEN_MAX_FLOORS + k], n->origin);
+                n->flags       = NAV_GROUND;
+                n->team_access = NAV_TEAM_ALL;
+                if (Bsp_PointContents(map, n->origin) & CONTENTS_WATER)
+                    n->flags |= NAV_WATER;
+            }
+        }
+        for (i = total; i < MAX_NAV_NODES; i++)
+            bank[i].id = BOT_INVALID_NODE;
+        BotPool_Run(total, workers, 32, NavGen_Links, &job);
+        *spacing = job.spacing;
+    } else {
+        total = -1;
+    }
+
+    free(job.floors);
+    free(job.floor_count);
+    free(job.first_node);
+    NavGen_FreeTracers(workers);
+    return total;
+}
+
+/* Trace row i of the upper triangle */
+static void NavGen_VisRows(void *ctx, int worker, int begin, int end)
+{
+    navgen_job_t *job = (navgen_job_t *)ctx;
+    bsp_tracer_t *t   = &s_tracers[worker];
+    int           row = NAVGEN_VIS_ROW(job->count), i, j;
+
+    for (i = begin; i < end; i++) {
+        vec3_t eye;
+
+        if (job->nodes[i].id == BOT_INVALID_NODE)
+            continue;
+        VectorCopy(job->nodes[i].origin, eye);
+        eye[2] += NAVGEN_EYE;
+
+        for (j = i + 1; j < job->count; j++) {
+            vec3_t  other;
+            trace_t tr;
+
+            if (job->nodes[j].id == BOT_INVALID_NODE)
+                continue;
+            VectorCopy(job->nodes[j].origin, other);
+            other[2] += NAVGEN_EYE;
+            tr = Bsp_Trace(t, eye, s_point, s_point, other, MASK_OPAQUE);
+            if (tr.fraction < 1.0f || tr.startsolid)
+                continue;
+            job->matrix[i * row + j / 8] |= (byte)(1 << (j & 7));
+            job->visible[worker]++;
+        }
+    }
+}
+
+int NavGen_Visibility(const bsp_map_t *map, const nav_node_t *bank,
+                      int count, int workers, byte *matrix)
+{
+    navgen_job_t job;
+    int          row = NAVGEN_VIS_ROW(count), pairs = 0, i, j;
+
+    if (!NavGen_InitTracers(map, workers))
+        return -1;
+    memset(&job, 0, sizeof(job));
+    job.map    = map;
+    job.nodes  = bank;
+    job.count  = count;
+    job.matrix = matrix;
+    memset(matrix, 0, (size_t)row * (size_t)count);
+
+    /* Rows shrink towards the end; stealing evens that out */
+    BotPool_Run(count, workers, 1, NavGen_VisRows, &job);
+
+    for (i = 0; i < count; i++) {
+        for (j = i + 1; j < count; j++) {
+            if (matrix[i * row + j / 8] & (1 << (j & 7)))
+                matrix[j * row + i / 8] |= (byte)(1 << (i & 7));
+        }
+    }
+    for (i = 0; i < BOT_POOL_MAX_WORKERS; i++)
+        pairs += job.visible[i];
+    NavGen_FreeTracers(workers);
+    return pairs;
+}
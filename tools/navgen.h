@@ -0,0 +1,62 @@
+/*
+ * navgen.h -- offline nav generation and visibility for tools/navtool
+ *
+ * Both run on a loaded BSP (bot_bsp.h) with no engine, spreading their
+ * traces over a work-stealing pool (bot_pool.h).
+ *
+ * GENERATION
+ * ----------
+ * The world is cut into square columns spacing units wide.  A player
+ * hull is dropped down each column, and again below every floor it
+ * lands on, so stacked floors each get a node.  Landings on slopes
+ * steeper than NAVGEN_MIN_NORMAL_Z, or in the void outside the map,
+ * are dropped.  Each node is then linked to the nearest-height node in
+ * each of the eight neighbouring columns.  A link needs clear headroom
+ * and ground under its midpoint.  Rises above NAVGEN_STEP need a jump,
+ * and rises above NAVGEN_JUMP or drops below NAVGEN_DROP are not
+ * linked.  If there are more than MAX_NAV_NODES floors, spacing grows
+ * by a quarter until they fit.
+ *
+ * VISIBILITY
+ * ----------
+ * One eye-to-eye trace per node pair, against MASK_OPAQUE.  The result
+ * is a symmetric bit matrix: bit j of row i (rows of NAVGEN_VIS_ROW(n)
+ * bytes) is set when i and j can see each other.
+ */
+
+#ifndef NAVGEN_H
+#define NAVGEN_H
+
+#include "bot_bsp.h"
+#include "bot_nodes.h"
+
+#define NAVGEN_SPACING       96.0f   /* default column width              */
+#define NAVGEN_MAX_FLOORS    16      /* nodes one column may hold         */
+#define NAVGEN_MIN_NORMAL_Z  0.7f    /* walkable slope                    */
+#define NAVGEN_STEP          18.0f   /* climbable without a jump          */
+#define NAVGEN_JUMP          48.0f   /* highest rise a jump link may take */
+#define NAVGEN_DROP          160.0f  /* deepest drop a link may take      */
+#define NAVGEN_EYE           22.0f   /* eye height above the node origin  */
+
+#define NAVGEN_VIS_MAGIC     0x5349564E  /* "NVIS" little-endian */
+#define NAVGEN_VIS_VERSION   1
+#define NAVGEN_VIS_ROW(n)    (((n) + 7) / 8)
+
+/*
+ * Generate a graph for map into bank[MAX_NAV_NODES] (IDs from 0, ext_id
+ * the same).  *spacing is the column width to start from and comes back
+ * as the one used.  Returns the node count, or -1 if the map has no
+ * floors or still has too many at a spacing of 1024.
+ */
+int NavGen_Build(const bsp_map_t *map, float *spacing, int workers,
+                 nav_node_t *bank);
+
+/*
+ * Fill matrix (count rows of NAVGEN_VIS_ROW(count) bytes) with which
+ * nodes of bank can see each other.  Returns the number of visible
+ * pairs, or -1 if a tracer could not be set up.
+ */
+int NavGen_Visibility(const bsp_map_t *map, const nav_node_t *bank,
+                      int count, int workers, byte *matrix);
+
+#endif /* NAVGEN_H */
@@ -0,0 +1,225 @@
+/*
+ * navtool.c -- offline .nav file utility for q2gloombot
+ *
+ * Converts nav graphs between the binary and text formats and prints a
+ * short summary.  Uses the same reader and writer as the game, so any
+ * file navtool accepts will load in the server.  With a compiled map it
+ * also generates graphs and node visibility without an engine, tracing
+ * on every core (-j sets the thread count).
+ *
+ *   navtool info     <file.nav>
+ *   navtool totext   <in.nav> <out.nav>
+ *   navtool tobinary <in.nav> <out.nav>
+ *   navtool [-j N] gen <map.bsp> <out.nav> [spacing]
+ *   navtool [-j N] vis <map.bsp> <file.nav> [out.vis]
+ */
+
+#include "bot_navfile.h"
+#include "bot_pool.h"
+#include "navgen.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static nav_node_t s_bank[MAX_NAV_NODES];
+static byte       s_vis[MAX_NAV_NODES * NAVGEN_VIS_ROW(MAX_NAV_NODES)];
+static int        s_workers;
+
+static int Usage(void)
+{
+    fprintf(stderr,
+            "usage: navtool info     <file.nav>\n"
+            "       navtool totext   <in.nav> <out.nav>\n"
+            "       navtool tobinary <in.nav> <out.nav>\n"
+            "       navtool [-j N] gen <map.bsp> <out.nav> [spacing]\n"
+            "       navtool [-j N] vis <map.bsp> <file.nav> [out.vis]\n");
+    return 2;
+}
+
+/* Wall-clock seconds, for reporting */
+static double Seconds(void)
+{
+#ifdef _WIN32
+    return GetTickCount64() / 1000.0;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static qboolean LoadBsp(const char *path, bsp_map_t *map)
+{
+    char err[256];
+
+    if (!Bsp_Load(path, map, err, sizeof(err))) {
+        fprintf(stderr, "navtool: %s\n", err);
+        return false;
+    }
+    printf("%s: %d nodes, %d leafs, %d brushes, %d brush sides\n", path,
+           map->num_nodes, map->num_leafs, map->num_brushes, map->num_sides);
+    return true;
+}
+
+static int Info(const char *path)
+{
+    nav_file_format_t format;
+    char err[256];
+    int  count, loaded, links = 0, i;
+
+    if (!NavFile_Read(path, s_bank, &count, &loaded, &format, err, sizeof(err))) {
+        fprintf(stderr, "navtool: %s\n", err);
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (s_bank[i].id != BOT_INVALID_NODE)
+            links += s_bank[i].num_neighbors;
+    }
+    printf("%s: %s, %d nodes, %d directed links, highest id %d\n", path,
+           format == NAV_FORMAT_TEXT ? "text" : "binary", loaded, links,
+           count - 1);
+    return 0;
+}
+
+static int Convert(const char *in, const char *out, nav_file_format_t to)
+{
+    char err[256];
+    int  count, loaded, written;
+
+    if (!NavFile_Read(in, s_bank, &count, &loaded, NULL, err, sizeof(err))) {
+        fprintf(stderr, "navtool: %s\n", err);
+        return 1;
+    }
+    written = NavFile_Write(out, s_bank, count, to, err, sizeof(err));
+    if (written < 0) {
+        fprintf(stderr, "navtool: %s\n", err);
+        return 1;
+    }
+    printf("%s -> %s: %d nodes (%s)\n", in, out, written,
+           to == NAV_FORMAT_TEXT ? "text" : "binary");
+    return 0;
+}
+
+static int Generate(const char *bsp, const char *out, float spacing)
+{
+    bsp_map_t map;
+    char      err[256];
+    double    t0;
+    int       count, links = 0, i;
+
+    if (spacing <= 0.0f) {
+        fprintf(stderr, "navtool: bad spacing\n");
+        return 2;
+    }
+    if (!LoadBsp(bsp, &map))
+        return 1;
+
+    t0    = Seconds();
+    count = NavGen_Build(&map, &spacing, s_workers, s_bank);
+    Bsp_Free(&map);
+    if (count < 0) {
+        fprintf(stderr, "navtool: no walkable floor fits %d nodes\n",
+                MAX_NAV_NODES);
+        return 1;
+    }
+    for (i = 0; i < count; i++)
+        links += s_bank[i].num_neighbors;
+    printf("generated %d nodes, %d directed links at spacing %.0f "
+           "in %.2f s on %d threads\n", count, links, spacing,
+           Seconds() - t0, s_workers);
+
+    if (NavFile_Write(out, s_bank, count, NAV_FORMAT_BINARY, err, sizeof(err)) < 0) {
+        fprintf(stderr, "navtool: %s\n", err);
+        return 1;
+    }
+    return 0;
+}
+
+/* NAVGEN_VIS_MAGIC, version, node count, then the matrix rows */
+static qboolean WriteVis(const char *path, int count)
+{
+    int   header[3], i;
+    byte  bytes[12];
+    FILE *f = fopen(path, "wb");
+
+    if (!f)
+        return false;
+    header[0] = NAVGEN_VIS_MAGIC;
+    header[1] = NAVGEN_VIS_VERSION;
+    header[2] = count;
+    for (i = 0; i < 12; i++)
+        bytes[i] = (byte)((unsigned int)header[i / 4] >> (8 * (i % 4)));
+    if (fwrite(bytes, 1, sizeof(bytes), f) != sizeof(bytes) ||
+        fwrite(s_vis, 1, (size_t)count * NAVGEN_VIS_ROW(count), f) !=
+        (size_t)count * NAVGEN_VIS_ROW(count)) {
+        fclose(f);
+        return false;
+    }
+    return fclose(f) == 0;
+}
+
+static int Visibility(const char *bsp, const char *nav, const char *out)
+{
+    bsp_map_t map;
+    char      err[256];
+    double    t0, secs;
+    int       count, loaded, pairs;
+
+    if (!NavFile_Read(nav, s_bank, &count, &loaded, NULL, err, sizeof(err))) {
+        fprintf(stderr, "navtool: %s\n", err);
+        return 1;
+    }
+    if (!LoadBsp(bsp, &map))
+        return 1;
+
+    t0    = Seconds();
+    pairs = NavGen_Visibility(&map, s_bank, count, s_workers, s_vis);
+    secs  = Seconds() - t0;
+    Bsp_Free(&map);
+    if (pairs < 0) {
+        fprintf(stderr, "navtool: out of memory\n");
+        return 1;
+    }
+    printf("%d nodes, %d of %d pairs visible; %.2f s on %d threads "
+           "(%.0f traces/s)\n", loaded, pairs, loaded * (loaded - 1) / 2,
+           secs, s_workers,
+           secs > 0.0 ? loaded * (loaded - 1) / 2 / secs : 0.0);
+
+    if (out && !WriteVis(out, count)) {
+        fprintf(stderr, "navtool: cannot write '%s'\n", out);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    s_workers = BotPool_DefaultWorkers();
+    if (argc >= 3 && strcmp(argv[1], "-j") == 0) {
+        s_workers = atoi(argv[2]);
+        if (s_workers < 1 || s_workers > BOT_POOL_MAX_WORKERS)
+            return Usage();
+        argc -= 2;
+        argv += 2;
+    }
+
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "gen") == 0)
+        return Generate(argv[2], argv[3],
+                        argc == 5 ? (float)atof(argv[4]) : NAVGEN_SPACING);
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "vis") == 0)
+        return Visibility(argv[2], argv[3], argc == 5 ? argv[4] : NULL);
+    if (argc == 3 && strcmp(argv[1], "info") == 0)
+        return Info(argv[2]);
+    if (argc == 4 && strcmp(argv[1], "totext") == 0)
+        return Convert(argv[2], argv[3], NAV_FORMAT_TEXT);
+    if (argc == 4 && strcmp(argv[1], "tobinary") == 0)
+        return Convert(argv[2], argv[3], NAV_FORMAT_BINARY);
+    return Usage();
+}